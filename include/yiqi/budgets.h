@@ -0,0 +1,58 @@
+/*
+ * budgets.h:
+ * Assertions which fail a test when client code goes over
+ * a budget for something the active tool measures
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_BUDGETS_H
+#define YIQI_BUDGETS_H
+
+#include <gtest/gtest.h>
+
+#include <yiqi/instrumentation.h>
+
+/**
+ * @brief YIQI_EXPECT_METRIC_LE checks that the named metric, as measured
+ * in the most recent region of client code, is no more than limit. Tools
+ * which measure from outside of the test process check it against all
+ * of the test's client code once their results are read back, and the
+ * check is skipped if the active tool does not measure that metric.
+ * Further messages can be streamed in, as with EXPECT_LE, and are
+ * only shown when the check is made in the test itself.
+ */
+#define YIQI_EXPECT_METRIC_LE(metric, limit) \
+    if (double yiqiMeasured = 0) \
+        ; \
+    else if (!::yiqi::MeasuredInLastRegion (metric, yiqiMeasured)) \
+        ::yiqi::CheckWhenReadBack (metric, limit); \
+    else \
+        EXPECT_LE (yiqiMeasured, limit) << "measuring " << metric
+
+/**
+ * @brief EXPECT_INSTRUCTIONS_LE checks the instructions executed
+ */
+#define EXPECT_INSTRUCTIONS_LE(limit) \
+    YIQI_EXPECT_METRIC_LE ("Ir", limit)
+
+/**
+ * @brief EXPECT_D1_MISSES_LE checks the level 1 data cache misses
+ */
+#define EXPECT_D1_MISSES_LE(limit) \
+    YIQI_EXPECT_METRIC_LE ("D1.misses", limit)
+
+/**
+ * @brief EXPECT_HEAP_ALLOCATIONS_LE checks the number of heap allocations
+ */
+#define EXPECT_HEAP_ALLOCATIONS_LE(limit) \
+    YIQI_EXPECT_METRIC_LE ("heap.allocations", limit)
+
+/**
+ * @brief EXPECT_WALLTIME_MEDIAN_LE checks the median wall time of
+ * client code, in nanoseconds
+ */
+#define EXPECT_WALLTIME_MEDIAN_LE(limit) \
+    YIQI_EXPECT_METRIC_LE ("median.ns", limit)
+
+#endif // YIQI_BUDGETS_H
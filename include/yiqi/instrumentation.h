@@ -0,0 +1,71 @@
+/*
+ * instrumentation.h:
+ * The public interface to Yiqi for tests, which allows them
+ * to mark where client code begins and ends
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_INSTRUMENTATION_H
+#define YIQI_INSTRUMENTATION_H
+
+#include <functional>
+#include <map>
+#include <string>
+
+namespace yiqi
+{
+    /**
+     * @brief ExecuteClientCode runs some client code such that only
+     * that code is measured by the active instrumentation tool, leaving
+     * out the test framework and any fixtures. Client code run
+     * from within other client code is measured as part of the
+     * outermost region.
+     * @param code the client code to run
+     */
+    void ExecuteClientCode (std::function <void ()> const &code);
+
+    /**
+     * @brief MeasuredInLastRegion looks up what the active tool measured
+     * in the most recent region of client code in the current test.
+     * Tools which can only measure from outside of the test process,
+     * such as cachegrind, measure nothing here.
+     * @param metric the name of the metric, for instance Ir or median.ns
+     * @param value set to the measured value, if there is one
+     * @return true if the metric was measured
+     */
+    bool MeasuredInLastRegion (char const *metric, double &value);
+
+    /* The total of each metric for all of a region's client code,
+     * by the metric's name */
+    typedef std::map <std::string, double> RegionMetrics;
+
+    /**
+     * @brief MeasuredInLastRegion is everything the active tool measured
+     * in the most recent region of client code in the current test, for
+     * matching against budgets
+     * @return the total of each metric measured, which is empty for
+     * tools which can only measure from outside of the test process
+     */
+    RegionMetrics MeasuredInLastRegion ();
+
+    /**
+     * @brief CheckWhenReadBack keeps a budget for a metric which the
+     * active tool could not measure in this process, such as Ir under
+     * cachegrind or callgrind, to be checked against everything the
+     * tool measured in the current test once it has been read back.
+     * Going over it fails the run rather than the test itself. Nothing
+     * is kept outside of an instrumented process.
+     * @param metric the name of the metric
+     * @param limit the most that may be measured for it
+     */
+    void CheckWhenReadBack (char const *metric, double limit);
+}
+
+/**
+ * @brief CLIENT_CODE runs the block of client code passed to it
+ * with yiqi::ExecuteClientCode, capturing everything by reference
+ */
+#define CLIENT_CODE(...) ::yiqi::ExecuteClientCode ([&]() __VA_ARGS__);
+
+#endif // YIQI_INSTRUMENTATION_H
@@ -0,0 +1,105 @@
+/*
+ * metric_matchers.cpp:
+ * Provide Google Test Matchers which check a set of
+ * yiqi::measurement::Metrics, or what was measured in the last
+ * region of client code, against a budget for one of them.
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <ostream>
+
+#include "metric_matchers.h"
+
+namespace ymatch = yiqi::matchers;
+namespace ymeas = yiqi::measurement;
+
+ymatch::MetricLEMatcher::MetricLEMatcher (std::string const &name,
+                                          double            limit) :
+    mName (name),
+    mLimit (limit)
+{
+}
+
+void
+ymatch::MetricLEMatcher::DescribeTo (std::ostream *os) const
+{
+    *os << "has " << mName << " at most " << mLimit
+        << ", or does not measure it";
+}
+
+void
+ymatch::MetricLEMatcher::DescribeNegationTo (std::ostream *os) const
+{
+    *os << "has " << mName << " over " << mLimit;
+}
+
+bool
+ymatch::MetricLEMatcher::MatchAndExplain (ymeas::Metrics const           &metrics,
+                                          ::testing::MatchResultListener *listener) const
+{
+    for (ymeas::Metric const &metric : metrics)
+    {
+        /* Only the total for all of client code counts */
+        if (metric.function.empty () && metric.name == mName)
+            return MatchValue (&metric.value, listener);
+    }
+
+    return MatchValue (nullptr, listener);
+}
+
+bool
+ymatch::MetricLEMatcher::MatchAndExplain (yiqi::RegionMetrics const      &metrics,
+                                          ::testing::MatchResultListener *listener) const
+{
+    auto const found (metrics.find (mName));
+
+    if (found == metrics.end ())
+        return MatchValue (nullptr, listener);
+
+    return MatchValue (&found->second, listener);
+}
+
+bool
+ymatch::MetricLEMatcher::MatchValue (double const                   *value,
+                                     ::testing::MatchResultListener *listener) const
+{
+    if (!value)
+    {
+        *listener << "which does not measure " << mName;
+        return true;
+    }
+
+    *listener << "whose " << mName << " is " << *value;
+    return *value <= mLimit;
+}
+
+ymatch::MetricLEMatcherType
+ymatch::MetricLE (std::string const &name, double limit)
+{
+    return ::testing::MakePolymorphicMatcher (MetricLEMatcher (name, limit));
+}
+
+ymatch::MetricLEMatcherType
+ymatch::InstructionsLE (double limit)
+{
+    return MetricLE ("Ir", limit);
+}
+
+ymatch::MetricLEMatcherType
+ymatch::D1MissesLE (double limit)
+{
+    return MetricLE ("D1.misses", limit);
+}
+
+ymatch::MetricLEMatcherType
+ymatch::HeapAllocationsLE (double limit)
+{
+    return MetricLE ("heap.allocations", limit);
+}
+
+ymatch::MetricLEMatcherType
+ymatch::WalltimeMedianLE (double limit)
+{
+    return MetricLE ("median.ns", limit);
+}
@@ -0,0 +1,88 @@
+/*
+ * metric_matchers.h:
+ * Provide Google Test Matchers which check a set of
+ * yiqi::measurement::Metrics, or what was measured in the last
+ * region of client code, against a budget for one of them.
+ *
+ * A metric which was not measured at all always matches, as
+ * not every tool can measure every metric.
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_METRIC_MATCHERS_H
+#define YIQI_METRIC_MATCHERS_H
+
+#include <iosfwd>
+#include <string>
+
+#include <gmock/gmock.h>
+
+#include <yiqi/instrumentation.h>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace matchers
+    {
+        /* Matches both yiqi::measurement::Metrics and the
+         * yiqi::RegionMetrics from yiqi::MeasuredInLastRegion () */
+        class MetricLEMatcher
+        {
+            public:
+
+                MetricLEMatcher (std::string const &name, double limit);
+
+                void DescribeTo (std::ostream *os) const;
+                void DescribeNegationTo (std::ostream *os) const;
+
+                bool MatchAndExplain (measurement::Metrics const     &metrics,
+                                      ::testing::MatchResultListener *listener) const;
+                bool MatchAndExplain (RegionMetrics const            &metrics,
+                                      ::testing::MatchResultListener *listener) const;
+
+            private:
+
+                bool MatchValue (double const                   *value,
+                                 ::testing::MatchResultListener *listener) const;
+
+                std::string mName;
+                double      mLimit;
+        };
+
+        typedef ::testing::PolymorphicMatcher <MetricLEMatcher> MetricLEMatcherType;
+
+        /**
+         * @brief MetricLE matches metrics where the total for client
+         * code named name is at most limit, or was not measured
+         */
+        MetricLEMatcherType MetricLE (std::string const &name, double limit);
+
+        /**
+         * @brief InstructionsLE matches at most limit instructions
+         * executed (Ir)
+         */
+        MetricLEMatcherType InstructionsLE (double limit);
+
+        /**
+         * @brief D1MissesLE matches at most limit level 1 data
+         * cache misses (D1.misses)
+         */
+        MetricLEMatcherType D1MissesLE (double limit);
+
+        /**
+         * @brief HeapAllocationsLE matches at most limit heap
+         * allocations (heap.allocations)
+         */
+        MetricLEMatcherType HeapAllocationsLE (double limit);
+
+        /**
+         * @brief WalltimeMedianLE matches a median wall time of at
+         * most limit nanoseconds (median.ns)
+         */
+        MetricLEMatcherType WalltimeMedianLE (double limit);
+    }
+}
+
+#endif // YIQI_METRIC_MATCHERS_H
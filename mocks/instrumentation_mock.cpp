@@ -7,16 +7,26 @@
 
 #include "instrumentation_mock.h"
 
+using ::testing::_;
 using ::testing::AtLeast;
+using ::testing::Invoke;
 using ::testing::ReturnRef;
 
 namespace ymock = yiqi::mock;
+namespace yit = yiqi::instrumentation::tools;
 
 namespace
 {
     std::string const DefaultWrapperName ("");
     std::string const DefaultWrapperOptions ("");
     std::string const DefaultInstrumentationName ("");
+
+    yiqi::measurement::RegionResult
+    RunCodeDirectly (yit::Tool::ClientCode const &code)
+    {
+        code ();
+        return yiqi::measurement::RegionResult ();
+    }
 }
 
 ymock::instrumentation::tools::Tool::Tool ()
@@ -27,7 +37,8 @@ ymock::instrumentation::tools::Tool::Tool ()
         .WillByDefault (ReturnRef (DefaultWrapperOptions));
     ON_CALL (*this, InstrumentationName ())
         .WillByDefault (ReturnRef (DefaultInstrumentationName));
-
+    ON_CALL (*this, RunClientCode (_))
+        .WillByDefault (Invoke (RunCodeDirectly));
 }
 
 ymock::instrumentation::tools::Tool::~Tool ()
@@ -41,4 +52,17 @@ ymock::instrumentation::tools::Tool::IgnoreCalls ()
     EXPECT_CALL (*this, InstrumentationName ()).Times (AtLeast (0));
     EXPECT_CALL (*this, WrapperOptions ()).Times (AtLeast (0));
     EXPECT_CALL (*this, ToolIdentifier ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, RunClientCode (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, RepeatsClientCode ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, StartClientRegion ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, StopClientRegion ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, ClientRegionResult ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, ProcessPerTest ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, ReadProcessResults (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, StartTest (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, EndTest (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, DumpsPerTest ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, ReadTestResults (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, StreamsResults ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, ConsumeResults (_, _, _)).Times (AtLeast (0));
 }
@@ -40,6 +40,27 @@ namespace yiqi
                                             std::string const & ());
                         MOCK_CONST_METHOD0 (ToolIdentifier,
                                             ToolID ());
+                        MOCK_METHOD1 (RunClientCode,
+                                      measurement::RegionResult (
+                                          ClientCode const &));
+                        MOCK_CONST_METHOD0 (RepeatsClientCode, bool ());
+                        MOCK_METHOD0 (StartClientRegion, void ());
+                        MOCK_METHOD0 (StopClientRegion, void ());
+                        MOCK_CONST_METHOD0 (ClientRegionResult,
+                                            measurement::RegionResult ());
+                        MOCK_CONST_METHOD0 (ProcessPerTest, bool ());
+                        MOCK_CONST_METHOD1 (ReadProcessResults,
+                                            measurement::Metrics (pid_t));
+                        MOCK_METHOD1 (StartTest, void (std::string const &));
+                        MOCK_METHOD1 (EndTest, void (std::string const &));
+                        MOCK_CONST_METHOD0 (DumpsPerTest, bool ());
+                        MOCK_CONST_METHOD1 (ReadTestResults,
+                                            measurement::Results (pid_t));
+                        MOCK_CONST_METHOD0 (StreamsResults, bool ());
+                        MOCK_METHOD3 (ConsumeResults,
+                                      measurement::TestFailures (pid_t,
+                                                                 char const *,
+                                                                 size_t));
                 };
             }
         }
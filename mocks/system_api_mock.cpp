@@ -27,4 +27,12 @@ ymock::system::api::SystemCalls::IgnoreCalls ()
     EXPECT_CALL (*this, ExecInPlace (_, _, _)).Times (AtLeast (0));
     EXPECT_CALL (*this, GetExecutablePath ()).Times (AtLeast (0));
     EXPECT_CALL (*this, GetSystemEnvironment ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, SpawnChild (_, _, _, _)).Times (AtLeast (0));
+    EXPECT_CALL (*this, WaitForChild (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, KillChild (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, CreatePipe ()).Times (AtLeast (0));
+    EXPECT_CALL (*this, ReadFd (_, _, _)).Times (AtLeast (0));
+    EXPECT_CALL (*this, CloseFd (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, PollReadable (_)).Times (AtLeast (0));
+    EXPECT_CALL (*this, GetLoadedObjects ()).Times (AtLeast (0));
 }
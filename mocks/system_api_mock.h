@@ -41,6 +41,19 @@ namespace yiqi
                         MOCK_CONST_METHOD0 (GetExecutablePath, std::string ());
                         MOCK_CONST_METHOD0 (GetSystemEnvironment,
                                             char const * const * ());
+                        MOCK_CONST_METHOD4 (SpawnChild,
+                                            pid_t (char const         *,
+                                                   char const * const *,
+                                                   char const * const *,
+                                                   InheritedFds const &));
+                        MOCK_CONST_METHOD1 (WaitForChild, int (pid_t));
+                        MOCK_CONST_METHOD1 (KillChild, void (pid_t));
+                        MOCK_CONST_METHOD0 (CreatePipe, Pipe ());
+                        MOCK_CONST_METHOD3 (ReadFd,
+                                            size_t (int, char *, size_t));
+                        MOCK_CONST_METHOD1 (CloseFd, void (int));
+                        MOCK_CONST_METHOD1 (PollReadable, Fds (Fds const &));
+                        MOCK_CONST_METHOD0 (GetLoadedObjects, LoadedObjects ());
                 };
             }
         }
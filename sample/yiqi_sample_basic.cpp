@@ -1,12 +1,38 @@
 /*
- * simple_test.cpp
- * A small test that doesn't do anything.
+ * yiqi_sample_basic.cpp
+ * A small test that marks out its client code, so that
+ * only that code is instrumented.
  *
  * See LICENCE.md for Copyright information
  */
 
 #include <gtest/gtest.h>
 
+#include <yiqi/budgets.h>
+#include <yiqi/instrumentation.h>
+
+namespace
+{
+    int AddNumbers (int x, int y)
+    {
+        return x + y;
+    }
+}
+
 TEST (Yiqi, Main)
 {
+    int x = 0;
+    int y = 1;
+
+    int result = 0;
+
+    CLIENT_CODE ({
+        result = AddNumbers (x, y);
+    })
+
+    EXPECT_EQ (1, result);
+
+    /* Only checked by tools which measure these */
+    EXPECT_INSTRUCTIONS_LE (1000);
+    EXPECT_WALLTIME_MEDIAN_LE (1000000);
 }
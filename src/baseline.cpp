@@ -0,0 +1,261 @@
+/*
+ * baseline.cpp:
+ * Compares what was measured in each test against a stored
+ * baseline, to catch tests which have got slower
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "baseline.h"
+#include "constants.h"
+
+namespace yconst = yiqi::constants;
+namespace ybase = yiqi::baseline;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    /* Test, tool and metric */
+    typedef std::tuple <std::string, std::string, std::string> Measurement;
+
+    /* A measurement, and which region of client code in the test it
+     * was measured in, as a test may run client code several times */
+    typedef std::pair <Measurement, size_t> Key;
+
+    Measurement MeasurementOf (ymeas::Result const &result)
+    {
+        return Measurement (result.test, result.tool, result.metric.name);
+    }
+
+    /* Baselines only cover whole tests, as there are far
+     * too many functions to keep track of */
+    bool IsWholeTest (ymeas::Result const &result)
+    {
+        return result.metric.function.empty ();
+    }
+
+    /* Each measurement of a whole test in results, with its key */
+    std::vector <std::pair <Key, ymeas::Result const *>>
+    KeyedWholeTests (ymeas::Results const &results)
+    {
+        std::map <Measurement, size_t>                        regions;
+        std::vector <std::pair <Key, ymeas::Result const *>> keyed;
+
+        for (ymeas::Result const &result : results)
+        {
+            if (!IsWholeTest (result))
+                continue;
+
+            Measurement const measurement (MeasurementOf (result));
+            keyed.push_back (std::make_pair (
+                                 Key (measurement, regions[measurement]++),
+                                 &result));
+        }
+
+        return keyed;
+    }
+
+    std::string TestAndRegion (ybase::Regression const &regression)
+    {
+        if (!regression.region)
+            return regression.test;
+
+        return regression.test + " (region " +
+               std::to_string (regression.region + 1) + ")";
+    }
+
+    std::string FormatValue (double value)
+    {
+        std::stringstream ss;
+        ss << std::setprecision (15) << value;
+        return ss.str ();
+    }
+
+    std::string FormatChange (ybase::Regression const &regression)
+    {
+        std::stringstream ss;
+
+        if (regression.baseline == 0)
+            ss << "from zero";
+        else
+            ss << std::showpos << std::fixed << std::setprecision (2)
+               << 100 * (regression.measured - regression.baseline) /
+                  std::fabs (regression.baseline)
+               << "%";
+
+        return ss.str ();
+    }
+}
+
+ybase::Options::Options () :
+    update (false),
+    tolerance ({ 0.02, 0 })
+{
+}
+
+ybase::Regressions
+ybase::Compare (ymeas::Results const &baseline,
+                ymeas::Results const &measured,
+                Tolerance const      &tolerance)
+{
+    std::map <Key, double> expected;
+
+    for (auto const &keyed : KeyedWholeTests (baseline))
+        expected[keyed.first] = keyed.second->metric.value;
+
+    Regressions regressions;
+
+    for (auto const &keyed : KeyedWholeTests (measured))
+    {
+        ymeas::Result const &result (*keyed.second);
+        auto const          found (expected.find (keyed.first));
+
+        if (found == expected.end ())
+            continue;
+
+        double const allowed (
+            std::max (tolerance.absolute,
+                      tolerance.relative * std::fabs (found->second)));
+
+        if (result.metric.value > found->second + allowed)
+            regressions.push_back (Regression {
+                                       result.test,
+                                       result.tool,
+                                       result.metric.name,
+                                       found->second,
+                                       result.metric.value,
+                                       keyed.first.second
+                                   });
+    }
+
+    return regressions;
+}
+
+ymeas::Results
+ybase::Update (ymeas::Results const &baseline,
+               ymeas::Results const &measured)
+{
+    ymeas::Results         updated;
+    std::vector <Key>      keys;
+    std::map <Key, size_t> index;
+
+    for (auto const &keyed : KeyedWholeTests (baseline))
+    {
+        index[keyed.first] = updated.size ();
+        keys.push_back (keyed.first);
+        updated.push_back (*keyed.second);
+    }
+
+    /* How many regions each measurement now has */
+    std::map <Measurement, size_t> regions;
+
+    for (auto const &keyed : KeyedWholeTests (measured))
+    {
+        auto const found (index.find (keyed.first));
+
+        regions[keyed.first.first] = keyed.first.second + 1;
+
+        if (found != index.end ())
+            updated[found->second] = *keyed.second;
+        else
+        {
+            index[keyed.first] = updated.size ();
+            keys.push_back (keyed.first);
+            updated.push_back (*keyed.second);
+        }
+    }
+
+    /* Regions which the tests measured here no longer have */
+    ymeas::Results kept;
+
+    for (size_t i = 0; i < updated.size (); ++i)
+    {
+        auto const found (regions.find (keys[i].first));
+
+        if (found == regions.end () || keys[i].second < found->second)
+            kept.push_back (updated[i]);
+    }
+
+    return kept;
+}
+
+ymeas::Results
+ybase::Read (std::string const &path)
+{
+    std::ifstream file (path);
+
+    /* There is no baseline until the first one is written */
+    if (!file)
+        return ymeas::Results ();
+
+    return ymeas::ReadResults (file);
+}
+
+void
+ybase::Write (std::string const    &path,
+              ymeas::Results const &baseline)
+{
+    std::ofstream file (path, std::ios::trunc);
+
+    if (!file)
+        throw std::runtime_error ("could not write baseline " + path);
+
+    for (ymeas::Result const &result : baseline)
+        ymeas::WriteResults (file, result.test, result.tool, { result.metric });
+
+    if (!file)
+        throw std::runtime_error ("could not write baseline " + path);
+}
+
+void
+ybase::PrintRegressions (std::ostream      &os,
+                         Regressions const &regressions)
+{
+    typedef std::vector <std::string> Row;
+
+    std::vector <Row> rows =
+    {
+        { "Test", "Tool", "Metric", "Baseline", "Measured", "Change" }
+    };
+
+    for (Regression const &regression : regressions)
+        rows.push_back (Row {
+                            TestAndRegion (regression),
+                            regression.tool,
+                            regression.metric,
+                            FormatValue (regression.baseline),
+                            FormatValue (regression.measured),
+                            FormatChange (regression)
+                        });
+
+    std::vector <size_t> widths (rows[0].size (), 0);
+
+    for (Row const &row : rows)
+        for (size_t i = 0; i < row.size (); ++i)
+            widths[i] = std::max (widths[i], row[i].size ());
+
+    os << yconst::YiqiRegressedHeader
+       << regressions.size ()
+       << " measurements over baseline" << std::endl;
+
+    for (Row const &row : rows)
+    {
+        os << " ";
+
+        /* The last column is not padded, to avoid trailing spaces */
+        for (size_t i = 0; i + 1 < row.size (); ++i)
+            os << " " << std::left << std::setw (widths[i]) << row[i];
+
+        os << " " << row.back () << std::right << std::endl;
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * baseline.h:
+ * Compares what was measured in each test against a stored
+ * baseline, to catch tests which have got slower
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_BASELINE_H
+#define YIQI_BASELINE_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace baseline
+    {
+        /**
+         * @brief Tolerance is how far over its baseline a measurement
+         * may go before it counts as a regression. The larger of the
+         * two allowances applies.
+         */
+        struct Tolerance
+        {
+            /* As a fraction of the baseline, eg 0.02 for 2% */
+            double relative;
+            double absolute;
+        };
+
+        struct Options
+        {
+            Options ();
+
+            /* Where the baseline is kept, or empty for none */
+            std::string file;
+
+            /* Store this run's measurements instead of comparing */
+            bool        update;
+            Tolerance   tolerance;
+        };
+
+        /**
+         * @brief Regression is a measurement which went over its baseline
+         * by more than the tolerance allows
+         */
+        struct Regression
+        {
+            std::string test;
+            std::string tool;
+            std::string metric;
+            double      baseline;
+            double      measured;
+
+            /* Which of the test's regions of client code, counting
+             * from zero, for tests with more than one */
+            size_t      region;
+        };
+
+        typedef std::vector <Regression> Regressions;
+
+        /**
+         * @brief Compare looks up each measurement of a region of a test's
+         * client code in the baseline, by test, tool, metric and which of
+         * the test's regions it was, in the order they ran. Per function
+         * measurements, and those with no baseline, are left out.
+         * @param baseline the stored baseline
+         * @param measured what was measured in this run
+         * @param tolerance how far over the baseline is acceptable
+         * @return the measurements which regressed, in the order
+         * they were measured
+         */
+        Regressions Compare (measurement::Results const &baseline,
+                             measurement::Results const &measured,
+                             Tolerance const            &tolerance);
+
+        /**
+         * @brief Update
+         * @param baseline the stored baseline
+         * @param measured what was measured in this run
+         * @return baseline with the measurements of each region of a
+         * test's client code in measured in place of those with the same
+         * test, tool and metric, including any regions the test no
+         * longer has
+         */
+        measurement::Results Update (measurement::Results const &baseline,
+                                     measurement::Results const &measured);
+
+        /**
+         * @brief Read reads a baseline in the same form as a results file
+         * @param path the baseline file
+         * @throws std::runtime_error if the baseline is malformed
+         * @return the baseline, or nothing if there is no file at path
+         */
+        measurement::Results Read (std::string const &path);
+
+        /**
+         * @brief Write replaces the baseline file at path
+         * @param path the baseline file
+         * @param baseline the new baseline
+         * @throws std::runtime_error if the file could not be written
+         */
+        void Write (std::string const          &path,
+                    measurement::Results const &baseline);
+
+        /**
+         * @brief PrintRegressions prints a table of regressions with
+         * the baseline, measured value and relative change of each
+         * @param os the stream to print to
+         * @param regressions the regressions, from Compare
+         */
+        void PrintRegressions (std::ostream      &os,
+                               Regressions const &regressions);
+    }
+}
+
+#endif // YIQI_BASELINE_H
@@ -0,0 +1,260 @@
+/*
+ * cache_geometry.cpp:
+ * Describes the caches that cachegrind and callgrind should
+ * simulate, either as found on this machine or as found on
+ * a named processor
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "cache_geometry.h"
+
+namespace ygeo = yiqi::geometry;
+
+char const * ygeo::HostProfile = "host";
+
+namespace
+{
+    unsigned long const KiB (1024);
+    unsigned long const MiB (1024 * KiB);
+
+    /* The level 1 caches of each core, and the last level cache of
+     * the largest part which shares one, from the vendors' manuals */
+    std::map <std::string, ygeo::Caches> const & Profiles ()
+    {
+        static std::map <std::string, ygeo::Caches> const profiles =
+        {
+            {
+                "skylake-sp",
+                { { 32 * KiB, 8, 64 },
+                  { 32 * KiB, 8, 64 },
+                  { 38 * MiB + 512 * KiB, 11, 64 } }
+            },
+            {
+                "icelake-sp",
+                { { 32 * KiB, 8, 64 },
+                  { 48 * KiB, 12, 64 },
+                  { 60 * MiB, 12, 64 } }
+            },
+            {
+                "sapphirerapids",
+                { { 32 * KiB, 8, 64 },
+                  { 48 * KiB, 12, 64 },
+                  { 112 * MiB + 512 * KiB, 15, 64 } }
+            },
+            {
+                "zen3",
+                { { 32 * KiB, 8, 64 },
+                  { 32 * KiB, 8, 64 },
+                  { 32 * MiB, 16, 64 } }
+            },
+            {
+                "zen4",
+                { { 32 * KiB, 8, 64 },
+                  { 32 * KiB, 8, 64 },
+                  { 32 * MiB, 16, 64 } }
+            },
+            {
+                "neoverse-n1",
+                { { 64 * KiB, 4, 64 },
+                  { 64 * KiB, 4, 64 },
+                  { 32 * MiB, 16, 64 } }
+            }
+        };
+
+        return profiles;
+    }
+
+    std::string ReadLine (std::string const &path)
+    {
+        std::ifstream file (path);
+        std::string   line;
+
+        std::getline (file, line);
+        boost::trim (line);
+
+        return line;
+    }
+
+    unsigned int ReadNumber (std::string const &path)
+    {
+        std::istringstream line (ReadLine (path));
+        unsigned int       number (0);
+
+        line >> number;
+        return number;
+    }
+
+    std::string CacheOption (char const *name, ygeo::Cache const &cache)
+    {
+        std::stringstream ss;
+        ygeo::Cache const simulated (ygeo::Simulatable (cache));
+
+        ss << "--" << name << "="
+           << simulated.size << ","
+           << simulated.associativity << ","
+           << simulated.lineSize;
+
+        return ss.str ();
+    }
+}
+
+unsigned long
+ygeo::ParseSize (std::string const &size)
+{
+    std::istringstream ss (size);
+    unsigned long      bytes (0);
+    char               suffix (0);
+
+    if (!(ss >> bytes))
+        throw std::runtime_error ("malformed cache size " + size);
+
+    if (ss >> suffix)
+    {
+        switch (std::toupper (suffix))
+        {
+            case 'K':
+                bytes *= KiB;
+                break;
+            case 'M':
+                bytes *= MiB;
+                break;
+            case 'G':
+                bytes *= 1024 * MiB;
+                break;
+            default:
+                throw std::runtime_error ("malformed cache size " + size);
+        }
+    }
+
+    return bytes;
+}
+
+ygeo::Caches
+ygeo::ReadSystemCaches (std::string const &directory)
+{
+    Caches       caches = Caches ();
+    unsigned int lastLevel (0);
+
+    /* The index directories are numbered from zero with no gaps */
+    for (unsigned int index = 0; ; ++index)
+    {
+        std::string const cacheDirectory (directory + "/index" +
+                                          std::to_string (index));
+        std::string const type (ReadLine (cacheDirectory + "/type"));
+
+        if (type.empty ())
+            break;
+
+        std::string const size (ReadLine (cacheDirectory + "/size"));
+        unsigned int const level (ReadNumber (cacheDirectory + "/level"));
+        Cache              cache = Cache ();
+
+        if (!size.empty ())
+            cache.size = ParseSize (size);
+
+        cache.associativity = ReadNumber (cacheDirectory +
+                                          "/ways_of_associativity");
+        cache.lineSize = ReadNumber (cacheDirectory +
+                                     "/coherency_line_size");
+
+        /* Fully associative caches say they have no ways */
+        if (!cache.size || !cache.associativity || !cache.lineSize)
+            continue;
+
+        if (level == 1 && type == "Instruction")
+            caches.instruction = cache;
+        else if (level == 1 && type == "Data")
+            caches.data = cache;
+
+        if (type != "Instruction" && level > 1 && level >= lastLevel)
+        {
+            caches.lastLevel = cache;
+            lastLevel = level;
+        }
+    }
+
+    return caches;
+}
+
+std::vector <std::string>
+ygeo::ProfileNames ()
+{
+    std::vector <std::string> names = { HostProfile };
+
+    for (auto const &profile : Profiles ())
+        names.push_back (profile.first);
+
+    return names;
+}
+
+ygeo::Caches
+ygeo::ProfileCaches (std::string const &profile)
+{
+    if (profile == HostProfile)
+        return ReadSystemCaches ("/sys/devices/system/cpu/cpu0/cache");
+
+    auto const found (Profiles ().find (profile));
+
+    if (found == Profiles ().end ())
+        throw std::runtime_error ("no cache profile named " + profile +
+                                  ", use one of " +
+                                  boost::algorithm::join (ProfileNames (),
+                                                          ", "));
+
+    return found->second;
+}
+
+ygeo::Cache
+ygeo::Simulatable (Cache const &cache)
+{
+    if (!cache.size || !cache.associativity || !cache.lineSize)
+        return cache;
+
+    unsigned long const sets (cache.size /
+                              (cache.associativity * cache.lineSize));
+
+    if (!sets)
+        return cache;
+
+    unsigned long simulatedSets (1);
+
+    while (simulatedSets * 2 <= sets)
+        simulatedSets *= 2;
+
+    /* Fewer sets, with more ways in each to make up for it, and the size
+     * made to divide exactly between the sets */
+    double const factor (double (sets) / simulatedSets);
+
+    Cache simulated (cache);
+    simulated.associativity = static_cast <unsigned int> (
+        0.5 + factor * cache.associativity);
+    simulated.size = cache.lineSize * simulated.associativity * simulatedSets;
+
+    return simulated;
+}
+
+std::string
+ygeo::ValgrindOptions (Caches const &caches)
+{
+    std::vector <std::string> options;
+
+    if (caches.instruction.size)
+        options.push_back (CacheOption ("I1", caches.instruction));
+
+    if (caches.data.size)
+        options.push_back (CacheOption ("D1", caches.data));
+
+    if (caches.lastLevel.size)
+        options.push_back (CacheOption ("LL", caches.lastLevel));
+
+    return boost::algorithm::join (options, " ");
+}
@@ -0,0 +1,105 @@
+/*
+ * cache_geometry.h:
+ * Describes the caches that cachegrind and callgrind should
+ * simulate, either as found on this machine or as found on
+ * a named processor
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_CACHE_GEOMETRY_H
+#define YIQI_CACHE_GEOMETRY_H
+
+#include <string>
+#include <vector>
+
+namespace yiqi
+{
+    namespace geometry
+    {
+        /**
+         * @brief Cache describes a single cache. A size of zero means that
+         * the cache is not known.
+         */
+        struct Cache
+        {
+            unsigned long size;
+            unsigned int  associativity;
+            unsigned int  lineSize;
+        };
+
+        /**
+         * @brief Caches are the caches that valgrind simulates: the level
+         * 1 instruction and data caches, and the last level cache
+         */
+        struct Caches
+        {
+            Cache instruction;
+            Cache data;
+            Cache lastLevel;
+        };
+
+        /**
+         * @brief HostProfile is the name of the profile for the caches of
+         * the machine the tests run on
+         */
+        extern char const * HostProfile;
+
+        /**
+         * @brief ParseSize parses a cache size as the kernel writes it,
+         * for instance 32K
+         * @throws std::runtime_error if size is not a number of bytes with
+         * an optional K, M or G suffix
+         * @return the size in bytes
+         */
+        unsigned long ParseSize (std::string const &size);
+
+        /**
+         * @brief ReadSystemCaches reads the caches of a processor from the
+         * index directories that Linux keeps for it in sysfs
+         * @param directory where the index directories are, for instance
+         * /sys/devices/system/cpu/cpu0/cache
+         * @return the caches which could be read. The last level cache is
+         * the highest level data or unified cache.
+         */
+        Caches ReadSystemCaches (std::string const &directory);
+
+        /**
+         * @brief ProfileNames
+         * @return the name of each profile which ProfileCaches knows,
+         * including HostProfile
+         */
+        std::vector <std::string> ProfileNames ();
+
+        /**
+         * @brief ProfileCaches looks up the caches for a profile
+         * @param profile HostProfile for the caches of this machine, read
+         * from sysfs, or the name of a processor such as skylake-sp
+         * @throws std::runtime_error if there is no such profile
+         * @return the caches for the profile
+         */
+        Caches ProfileCaches (std::string const &profile);
+
+        /**
+         * @brief Simulatable adjusts a cache for valgrind, which can only
+         * simulate caches with a power of two number of sets. As valgrind
+         * does with the last level cache it finds itself, the number of sets
+         * is rounded down to a power of two, the associativity raised by
+         * the same factor and the size worked out again from those.
+         * @param cache the cache to adjust
+         * @return the cache as valgrind should simulate it
+         */
+        Cache Simulatable (Cache const &cache);
+
+        /**
+         * @brief ValgrindOptions
+         * @param caches the caches to simulate
+         * @return the --I1, --D1 and --LL options for the known caches,
+         * separated by spaces, or an empty string to leave valgrind to
+         * find the caches itself
+         */
+        std::string ValgrindOptions (Caches const &caches);
+    }
+}
+
+#endif // YIQI_CACHE_GEOMETRY_H
@@ -0,0 +1,168 @@
+/*
+ * cachegrind_output.cpp:
+ * Reads back the output files which cachegrind leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+
+#include "cachegrind_output.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yocg = yiqi::output::cachegrind;
+
+namespace
+{
+    std::string const EventsHeader ("events:");
+    std::string const SummaryHeader ("summary:");
+
+    bool StartsWith (std::string const &line, std::string const &prefix)
+    {
+        return line.compare (0, prefix.size (), prefix) == 0;
+    }
+
+    ymeas::Metric const * FindEvent (ymeas::Metrics const &events,
+                                     std::string const    &name)
+    {
+        for (ymeas::Metric const &event : events)
+            if (event.name == name)
+                return &event;
+
+        return nullptr;
+    }
+
+    typedef std::vector <std::string> EventNames;
+
+    /* Adds a metric named name with the sum of all of the named
+     * events, but only if all of them were collected */
+    void AddTotal (ymeas::Metrics       &totals,
+                   ymeas::Metrics const &events,
+                   std::string const    &name,
+                   EventNames const     &summed)
+    {
+        double total = 0;
+
+        for (std::string const &eventName : summed)
+        {
+            ymeas::Metric const *event (FindEvent (events, eventName));
+
+            if (!event)
+                return;
+
+            total += event->value;
+        }
+
+        totals.push_back (ymeas::Metric { name, total });
+    }
+
+    /* Adds a metric named name with the ratio of the summed events
+     * to the summed references, but only if all of them were
+     * collected and something was referenced */
+    void AddRate (ymeas::Metrics       &rates,
+                  ymeas::Metrics const &events,
+                  std::string const    &name,
+                  EventNames const     &counted,
+                  EventNames const     &references)
+    {
+        ymeas::Metrics totals;
+
+        AddTotal (totals, events, "counted", counted);
+        AddTotal (totals, events, "references", references);
+
+        if (totals.size () != 2 || totals[1].value == 0)
+            return;
+
+        rates.push_back (ymeas::Metric {
+                             name,
+                             totals[0].value / totals[1].value
+                         });
+    }
+}
+
+ymeas::Metrics
+yocg::ReadSummary (std::istream &output)
+{
+    EventNames  names;
+    std::string summary;
+    bool        foundEvents = false;
+    bool        foundSummary = false;
+    std::string line;
+
+    while (std::getline (output, line))
+    {
+        if (StartsWith (line, EventsHeader))
+        {
+            std::stringstream ss (line.substr (EventsHeader.size ()));
+            std::string       name;
+
+            names.clear ();
+            while (ss >> name)
+                names.push_back (name);
+
+            foundEvents = true;
+        }
+        else if (StartsWith (line, SummaryHeader))
+        {
+            summary = line.substr (SummaryHeader.size ());
+            foundSummary = true;
+        }
+    }
+
+    if (!foundEvents)
+        throw std::runtime_error ("cachegrind output has no events: line");
+
+    if (!foundSummary)
+        throw std::runtime_error ("cachegrind output has no summary: line");
+
+    ymeas::Metrics    events;
+    std::stringstream ss (summary);
+    double            value = 0;
+
+    for (std::string const &name : names)
+    {
+        /* Trailing zeroes may be left out */
+        if (!(ss >> value))
+            value = 0;
+
+        events.push_back (ymeas::Metric { name, value });
+    }
+
+    if (ss >> value)
+        throw std::runtime_error ("cachegrind summary: has more values "
+                                  "than there are events");
+
+    return events;
+}
+
+ymeas::Metrics
+yocg::CacheTotals (ymeas::Metrics const &events)
+{
+    ymeas::Metrics totals;
+
+    AddTotal (totals, events, "I1.refs", { "Ir" });
+    AddTotal (totals, events, "I1.misses", { "I1mr" });
+    AddTotal (totals, events, "D1.refs", { "Dr", "Dw" });
+    AddTotal (totals, events, "D1.misses", { "D1mr", "D1mw" });
+    AddTotal (totals, events, "LL.refs", { "I1mr", "D1mr", "D1mw" });
+    AddTotal (totals, events, "LL.misses", { "ILmr", "DLmr", "DLmw" });
+
+    return totals;
+}
+
+ymeas::Metrics
+yocg::MissRates (ymeas::Metrics const &events)
+{
+    ymeas::Metrics rates;
+
+    AddRate (rates, events, "D1.miss.rate",
+             { "D1mr", "D1mw" }, { "Dr", "Dw" });
+    AddRate (rates, events, "LLd.miss.rate",
+             { "DLmr", "DLmw" }, { "Dr", "Dw" });
+    AddRate (rates, events, "Bc.mispredict.rate", { "Bcm" }, { "Bc" });
+    AddRate (rates, events, "Bi.mispredict.rate", { "Bim" }, { "Bi" });
+
+    return rates;
+}
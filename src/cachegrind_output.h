@@ -0,0 +1,62 @@
+/*
+ * cachegrind_output.h:
+ * Reads back the output files which cachegrind leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_CACHEGRIND_OUTPUT_H
+#define YIQI_CACHEGRIND_OUTPUT_H
+
+#include <iosfwd>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace cachegrind
+        {
+            /**
+             * @brief ReadSummary reads the totals for each event
+             * from the events: and summary: lines of cachegrind output
+             * @param output a stream of cachegrind output
+             * @throws std::runtime_error if there is no events: or
+             * summary: line, or the summary has more values than
+             * there are events
+             * @return a metric named for each event (eg, Ir, D1mr)
+             */
+            measurement::Metrics ReadSummary (std::istream &output);
+
+            /**
+             * @brief CacheTotals derives the total references and misses
+             * for the I1, D1 and LL caches from the raw event totals,
+             * in the same way that cachegrind does. Totals which depend
+             * on events that were not collected are left out.
+             * @param events raw event totals, from ReadSummary
+             * @return metrics named I1.refs, I1.misses, D1.refs,
+             * D1.misses, LL.refs and LL.misses
+             */
+            measurement::Metrics
+            CacheTotals (measurement::Metrics const &events);
+
+            /**
+             * @brief MissRates derives the rates at which data references
+             * miss the D1 and last level caches, and the rates at which
+             * conditional and indirect branches are mispredicted, from the
+             * raw event totals. Rates which depend on events that were not
+             * collected, or where nothing was referenced, are left out.
+             * @param events raw event totals, from ReadSummary or from a
+             * callgrind profile run with --cache-sim and --branch-sim
+             * @return metrics named D1.miss.rate, LLd.miss.rate,
+             * Bc.mispredict.rate and Bi.mispredict.rate, each between
+             * zero and one
+             */
+            measurement::Metrics
+            MissRates (measurement::Metrics const &events);
+        }
+    }
+}
+
+#endif // YIQI_CACHEGRIND_OUTPUT_H
@@ -0,0 +1,772 @@
+/*
+ * callgrind_output.cpp:
+ * Reads back the profiles which callgrind leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "cachegrind_output.h"
+#include "callgrind_output.h"
+#include "mapped_file.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yocg = yiqi::output::cachegrind;
+namespace yocl = yiqi::output::callgrind;
+namespace ysys = yiqi::system;
+
+namespace
+{
+    /* A range of characters inside the mapped profile. Only names
+     * are ever copied out into strings */
+    struct Range
+    {
+        char const *begin;
+        char const *end;
+
+        bool empty () const
+        {
+            return begin == end;
+        }
+
+        std::string str () const
+        {
+            return std::string (begin, end);
+        }
+    };
+
+    bool ConsumePrefix (Range &range, char const *prefix)
+    {
+        size_t const length (strlen (prefix));
+
+        if (static_cast <size_t> (range.end - range.begin) < length ||
+            strncmp (range.begin, prefix, length) != 0)
+            return false;
+
+        range.begin += length;
+        return true;
+    }
+
+    void SkipSpaces (Range &range)
+    {
+        while (!range.empty () &&
+               (*range.begin == ' ' || *range.begin == '\t'))
+            ++range.begin;
+    }
+
+    bool IsDigit (char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    int HexValue (char c)
+    {
+        if (IsDigit (c))
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+
+        return -1;
+    }
+
+    /* Reads a decimal or 0x-prefixed hexadecimal number */
+    bool ReadNumber (Range &range, unsigned long long &number)
+    {
+        SkipSpaces (range);
+
+        if (range.empty () || !IsDigit (*range.begin))
+            return false;
+
+        number = 0;
+
+        if (ConsumePrefix (range, "0x"))
+        {
+            while (!range.empty () && HexValue (*range.begin) >= 0)
+                number = number * 16 + HexValue (*range.begin++);
+        }
+        else
+        {
+            while (!range.empty () && IsDigit (*range.begin))
+                number = number * 10 + (*range.begin++ - '0');
+        }
+
+        return true;
+    }
+
+    typedef std::unordered_map <unsigned long long, std::string> NameTable;
+
+    class Parser
+    {
+        public:
+
+            explicit Parser (bool collectLines);
+
+            void ReadLine (Range line);
+            yocl::Profile Finish ();
+
+        private:
+
+            std::string ReadName (Range value, NameTable &table);
+            std::string ReadName (Range              value,
+                                  NameTable          &table,
+                                  unsigned long long &id);
+            size_t SourceFileIndex (std::string const  &name,
+                                    unsigned long long id);
+            size_t FunctionIndex (std::string const &object,
+                                  std::string const &file,
+                                  std::string const &name);
+            void ReadEvents (Range value);
+            void ReadPositions (Range value);
+            void ReadPosition (Range                            &line,
+                               std::vector <unsigned long long> &positions);
+            void ReadCosts (Range line);
+            void ReadCall ();
+            void ReadJump (Range value, bool conditional);
+
+            yocl::Profile mProfile;
+
+            /* Compressed names, which are shared between fl, fi, fe,
+             * cfi and cfl, between fn and cfn, and between ob and cob */
+            NameTable mFiles;
+            NameTable mFunctions;
+            NameTable mObjects;
+
+            std::unordered_map <std::string, size_t> mFunctionIndices;
+
+            /* Where each caller and callee pair is in the calls */
+            std::map <std::pair <size_t, size_t>, size_t> mCallIndices;
+
+            /* Lines are only read when asked for, as they are only
+             * needed to annotate source */
+            bool mCollectLines;
+
+            /* Each file which lines are in, and where each of them
+             * is in those files by compressed name and by name, so
+             * that lines are found without copying the file name */
+            std::vector <std::string>                        mSourceFiles;
+            std::unordered_map <unsigned long long, size_t>  mSourceFileIds;
+            std::unordered_map <std::string, size_t>         mSourceFileNames;
+
+            /* Where each line of each of those files is in the lines */
+            std::map <std::pair <size_t, unsigned long long>,
+                      size_t> mLineIndices;
+
+            std::string mObject;
+            std::string mFile;
+            size_t      mFileIndex;
+            size_t      mFunction;
+
+            /* The file that following lines are in, which fi and fe
+             * change for code inlined from elsewhere */
+            std::string mSourceFileName;
+            size_t      mSourceFile;
+
+            /* The cob, cfi and cfn for the next calls line */
+            std::string mCallObject;
+            std::string mCallFile;
+            std::string mCallFunction;
+            bool        mHaveCallObject;
+            bool        mHaveCallFile;
+
+            /* The function called on the last calls line, whose
+             * inclusive cost is on the next cost line */
+            size_t      mCallee;
+            bool        mCallPending;
+
+            size_t                           mPositionCount;
+
+            /* Which of the positions is the line, if any is */
+            size_t                           mLinePosition;
+            std::vector <unsigned long long> mPositions;
+            std::vector <unsigned long long> mJumpTarget;
+
+            /* The costs on the current line, in the order of the last
+             * events line, and where each of those events is in the
+             * profile's events */
+            yocl::Costs                      mLineCosts;
+            std::vector <size_t>             mEventIndices;
+    };
+
+    size_t const NoFunction = static_cast <size_t> (-1);
+    size_t const NoPosition = static_cast <size_t> (-1);
+    size_t const NoFile = static_cast <size_t> (-1);
+
+    /* The id of a name which was not compressed */
+    unsigned long long const NoId = static_cast <unsigned long long> (-1);
+}
+
+Parser::Parser (bool collectLines) :
+    mCollectLines (collectLines),
+    mFileIndex (NoFile),
+    mFunction (NoFunction),
+    mSourceFile (NoFile),
+    mHaveCallObject (false),
+    mHaveCallFile (false),
+    mCallee (NoFunction),
+    mCallPending (false),
+    mPositionCount (1),
+    mLinePosition (0),
+    mPositions (1, 0)
+{
+    /* Lines before any fl are in a file with no name */
+    mFileIndex = SourceFileIndex (mFile, NoId);
+    mSourceFile = mFileIndex;
+}
+
+std::string
+Parser::ReadName (Range value, NameTable &table)
+{
+    unsigned long long id = 0;
+    return ReadName (value, table, id);
+}
+
+std::string
+Parser::ReadName (Range              value,
+                  NameTable          &table,
+                  unsigned long long &id)
+{
+    SkipSpaces (value);
+
+    /* Either "(id) name", which defines id, "(id)" which refers
+     * back to it, or a plain name */
+    id = NoId;
+
+    if (value.empty () || *value.begin != '(')
+        return value.str ();
+
+    ++value.begin;
+
+    if (!ReadNumber (value, id) || !ConsumePrefix (value, ")"))
+        throw std::runtime_error ("malformed compressed name in callgrind "
+                                  "profile");
+
+    SkipSpaces (value);
+
+    if (!value.empty ())
+        table[id] = value.str ();
+
+    NameTable::const_iterator const name (table.find (id));
+
+    if (name == table.end ())
+    {
+        std::stringstream ss;
+        ss << "callgrind profile refers to undefined name (" << id << ")";
+        throw std::runtime_error (ss.str ());
+    }
+
+    return name->second;
+}
+
+size_t
+Parser::SourceFileIndex (std::string const  &name,
+                         unsigned long long id)
+{
+    if (!mCollectLines)
+        return NoFile;
+
+    /* Compressed names are looked up by their id, so the name
+     * itself is only looked up the first time that id is seen */
+    if (id != NoId)
+    {
+        auto const found (mSourceFileIds.find (id));
+
+        if (found != mSourceFileIds.end ())
+            return found->second;
+    }
+
+    auto found (mSourceFileNames.find (name));
+
+    if (found == mSourceFileNames.end ())
+    {
+        mSourceFiles.push_back (name);
+        found = mSourceFileNames.insert (
+                    std::make_pair (name, mSourceFiles.size () - 1)).first;
+    }
+
+    if (id != NoId)
+        mSourceFileIds[id] = found->second;
+
+    return found->second;
+}
+
+size_t
+Parser::FunctionIndex (std::string const &object,
+                       std::string const &file,
+                       std::string const &name)
+{
+    std::string key (object);
+    key.append (1, '\0').append (file).append (1, '\0').append (name);
+
+    auto const found (mFunctionIndices.find (key));
+
+    if (found != mFunctionIndices.end ())
+        return found->second;
+
+    size_t const events (mProfile.events.size ());
+
+    mProfile.functions.push_back (yocl::FunctionCosts {
+                                      object,
+                                      file,
+                                      name,
+                                      yocl::Costs (events, 0),
+                                      yocl::Costs (events, 0)
+                                  });
+
+    size_t const index (mProfile.functions.size () - 1);
+    mFunctionIndices.insert (std::make_pair (key, index));
+
+    return index;
+}
+
+void
+Parser::ReadEvents (Range value)
+{
+    std::stringstream ss (value.str ());
+    std::string       event;
+
+    /* Each part of a profile names its events again, which may not
+     * be the same ones, so costs are kept against every event named
+     * in any part rather than starting again */
+    mEventIndices.clear ();
+
+    while (ss >> event)
+    {
+        auto const found (std::find (mProfile.events.begin (),
+                                     mProfile.events.end (),
+                                     event));
+
+        mEventIndices.push_back (found - mProfile.events.begin ());
+
+        if (found == mProfile.events.end ())
+            mProfile.events.push_back (event);
+    }
+
+    size_t const events (mProfile.events.size ());
+
+    mLineCosts.assign (mEventIndices.size (), 0);
+    mProfile.totals.resize (events, 0);
+
+    for (yocl::FunctionCosts &function : mProfile.functions)
+    {
+        function.exclusive.resize (events, 0);
+        function.inclusive.resize (events, 0);
+    }
+
+    for (yocl::Call &call : mProfile.calls)
+        call.inclusive.resize (events, 0);
+
+    for (yocl::LineCosts &line : mProfile.lines)
+        line.exclusive.resize (events, 0);
+}
+
+void
+Parser::ReadPositions (Range value)
+{
+    std::stringstream ss (value.str ());
+    std::string       position;
+
+    mPositionCount = 0;
+    mLinePosition = NoPosition;
+
+    while (ss >> position)
+    {
+        if (position == "line")
+            mLinePosition = mPositionCount;
+
+        ++mPositionCount;
+    }
+
+    if (!mPositionCount)
+        mPositionCount = 1;
+
+    mPositions.assign (mPositionCount, 0);
+}
+
+void
+Parser::ReadPosition (Range                            &line,
+                      std::vector <unsigned long long> &positions)
+{
+    /* Positions may be relative to the previous cost line,
+     * or "*" for the same position */
+    for (size_t i = 0; i < mPositionCount; ++i)
+    {
+        SkipSpaces (line);
+
+        if (line.empty ())
+            throw std::runtime_error ("callgrind profile line is missing "
+                                      "positions");
+
+        unsigned long long offset = 0;
+        char const         sign = *line.begin;
+
+        if (sign == '*')
+            ++line.begin;
+        else if (sign == '+' || sign == '-')
+        {
+            ++line.begin;
+            if (!ReadNumber (line, offset))
+                throw std::runtime_error ("malformed relative position in "
+                                          "callgrind profile");
+
+            if (sign == '+')
+                positions[i] += offset;
+            else
+                positions[i] -= offset;
+        }
+        else if (!ReadNumber (line, positions[i]))
+            throw std::runtime_error ("malformed position in callgrind "
+                                      "profile");
+    }
+}
+
+void
+Parser::ReadCosts (Range line)
+{
+    ReadPosition (line, mPositions);
+
+    /* Trailing costs which are zero may be left out */
+    size_t events = 0;
+    unsigned long long cost = 0;
+
+    while (ReadNumber (line, cost))
+    {
+        if (events == mLineCosts.size ())
+            throw std::runtime_error ("callgrind cost line has more costs "
+                                      "than there are events");
+
+        mLineCosts[events++] = cost;
+    }
+
+    std::fill (mLineCosts.begin () + events, mLineCosts.end (), 0);
+
+    if (mFunction == NoFunction)
+        throw std::runtime_error ("callgrind cost line outside of any "
+                                  "function");
+
+    yocl::FunctionCosts &function (mProfile.functions[mFunction]);
+
+    if (mCallPending)
+    {
+        /* The cost of the call is inclusive of the callee, which is
+         * already counted in its own costs if it calls itself */
+        mCallPending = false;
+
+        if (mCallee == mFunction)
+            return;
+
+        auto const key (std::make_pair (mFunction, mCallee));
+        auto found (mCallIndices.find (key));
+
+        if (found == mCallIndices.end ())
+        {
+            mProfile.calls.push_back (yocl::Call {
+                                          mFunction,
+                                          mCallee,
+                                          yocl::Costs (mProfile.events.size (),
+                                                       0)
+                                      });
+            found = mCallIndices.insert (
+                        std::make_pair (key, mProfile.calls.size () - 1)).first;
+        }
+
+        yocl::Costs &callCosts (mProfile.calls[found->second].inclusive);
+
+        for (size_t i = 0; i < events; ++i)
+        {
+            function.inclusive[mEventIndices[i]] += mLineCosts[i];
+            callCosts[mEventIndices[i]] += mLineCosts[i];
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < events; ++i)
+    {
+        function.exclusive[mEventIndices[i]] += mLineCosts[i];
+        mProfile.totals[mEventIndices[i]] += mLineCosts[i];
+    }
+
+    /* The line after a jump only gives where it jumped from,
+     * without any costs */
+    if (!mCollectLines || mLinePosition == NoPosition || !events)
+        return;
+
+    auto const key (std::make_pair (mSourceFile, mPositions[mLinePosition]));
+    auto found (mLineIndices.find (key));
+
+    if (found == mLineIndices.end ())
+    {
+        mProfile.lines.push_back (yocl::LineCosts {
+                                      mSourceFiles[key.first],
+                                      key.second,
+                                      yocl::Costs (mProfile.events.size (), 0)
+                                  });
+        found = mLineIndices.insert (
+                    std::make_pair (key, mProfile.lines.size () - 1)).first;
+    }
+
+    yocl::Costs &lineCosts (mProfile.lines[found->second].exclusive);
+
+    for (size_t i = 0; i < events; ++i)
+        lineCosts[mEventIndices[i]] += mLineCosts[i];
+}
+
+void
+Parser::ReadCall ()
+{
+    /* Without a cfi, the callee is in the file of the current
+     * position, which fi and fe may have moved out of fl */
+    mCallee = FunctionIndex (mHaveCallObject ? mCallObject : mObject,
+                             mHaveCallFile ? mCallFile : mSourceFileName,
+                             mCallFunction);
+    mCallPending = true;
+
+    /* cob and cfi only last for a single call */
+    mHaveCallObject = false;
+    mHaveCallFile = false;
+}
+
+void
+Parser::ReadJump (Range value, bool conditional)
+{
+    /* "jump=count target" or "jcnd=executed/count target", where
+     * the count may also just follow after a space */
+    unsigned long long count = 0;
+
+    if (!ReadNumber (value, count))
+        throw std::runtime_error ("malformed jump in callgrind profile");
+
+    if (conditional)
+    {
+        SkipSpaces (value);
+        ConsumePrefix (value, "/");
+
+        if (!ReadNumber (value, count))
+            throw std::runtime_error ("malformed conditional jump in "
+                                      "callgrind profile");
+    }
+
+    /* The target is relative to the current position, but callgrind
+     * does not move on from it, so only the position line following
+     * the jump, which is read like a cost line, moves the position */
+    mJumpTarget = mPositions;
+    ReadPosition (value, mJumpTarget);
+}
+
+void
+Parser::ReadLine (Range line)
+{
+    if (line.empty () || *line.begin == '#')
+        return;
+
+    char const first (*line.begin);
+
+    if (IsDigit (first) || first == '+' || first == '-' || first == '*')
+        ReadCosts (line);
+    else if (ConsumePrefix (line, "fn="))
+    {
+        mFunction = FunctionIndex (mObject,
+                                   mFile,
+                                   ReadName (line, mFunctions));
+        mSourceFileName = mFile;
+        mSourceFile = mFileIndex;
+    }
+    else if (ConsumePrefix (line, "fl="))
+    {
+        unsigned long long id = 0;
+
+        mFile = ReadName (line, mFiles, id);
+        mFileIndex = SourceFileIndex (mFile, id);
+        mSourceFileName = mFile;
+        mSourceFile = mFileIndex;
+    }
+    else if (ConsumePrefix (line, "fi=") ||
+             ConsumePrefix (line, "fe="))
+    {
+        /* Inlined code is still counted against the function it
+         * was inlined into, but its lines are in another file */
+        unsigned long long id = 0;
+
+        mSourceFileName = ReadName (line, mFiles, id);
+        mSourceFile = SourceFileIndex (mSourceFileName, id);
+    }
+    else if (ConsumePrefix (line, "ob="))
+        mObject = ReadName (line, mObjects);
+    else if (ConsumePrefix (line, "cob="))
+    {
+        mCallObject = ReadName (line, mObjects);
+        mHaveCallObject = true;
+    }
+    else if (ConsumePrefix (line, "cfi=") ||
+             ConsumePrefix (line, "cfl="))
+    {
+        mCallFile = ReadName (line, mFiles);
+        mHaveCallFile = true;
+    }
+    else if (ConsumePrefix (line, "cfn="))
+        mCallFunction = ReadName (line, mFunctions);
+    else if (ConsumePrefix (line, "calls="))
+        ReadCall ();
+    else if (ConsumePrefix (line, "jump="))
+        ReadJump (line, false);
+    else if (ConsumePrefix (line, "jcnd="))
+        ReadJump (line, true);
+    else if (ConsumePrefix (line, "jfi="))
+    {
+        /* Where jumps go is not needed, but the names they use
+         * may be compressed and referred back to afterwards */
+        ReadName (line, mFiles);
+    }
+    else if (ConsumePrefix (line, "jfn="))
+        ReadName (line, mFunctions);
+    else if (ConsumePrefix (line, "events:"))
+        ReadEvents (line);
+    else if (ConsumePrefix (line, "positions:"))
+        ReadPositions (line);
+    else if (ConsumePrefix (line, "desc: Trigger: "))
+        mProfile.trigger = line.str ();
+
+    /* Everything else, such as descriptions and the summary, is not
+     * needed */
+}
+
+yocl::Profile
+Parser::Finish ()
+{
+    for (yocl::FunctionCosts &function : mProfile.functions)
+        for (size_t i = 0; i < function.inclusive.size (); ++i)
+            function.inclusive[i] += function.exclusive[i];
+
+    return std::move (mProfile);
+}
+
+yocl::Profile
+yocl::ReadProfile (char const *data, size_t size, bool collectLines)
+{
+    Parser      parser (collectLines);
+    char const  *end (data + size);
+    char const  *line (data);
+
+    while (line < end)
+    {
+        char const *lineEnd (static_cast <char const *> (
+                                 memchr (line, '\n', end - line)));
+
+        if (!lineEnd)
+            lineEnd = end;
+
+        Range range = { line, lineEnd };
+
+        if (!range.empty () && *(range.end - 1) == '\r')
+            --range.end;
+
+        parser.ReadLine (range);
+        line = lineEnd + 1;
+    }
+
+    return parser.Finish ();
+}
+
+yocl::Profile
+yocl::ReadProfileFile (std::string const &path, bool collectLines)
+{
+    ysys::MappedFile const file (path);
+    return ReadProfile (file.data (), file.size (), collectLines);
+}
+
+ymeas::Metrics
+yocl::EventTotals (Profile const &profile)
+{
+    ymeas::Metrics totals;
+
+    for (size_t i = 0; i < profile.events.size (); ++i)
+        totals.push_back (ymeas::Metric {
+                              profile.events[i],
+                              static_cast <double> (profile.totals[i])
+                          });
+
+    return totals;
+}
+
+ymeas::Metrics
+yocl::FunctionTotals (Profile const &profile)
+{
+    ymeas::Metrics totals;
+
+    for (FunctionCosts const &function : profile.functions)
+    {
+        std::string const name (function.file + ":" + function.name);
+
+        for (size_t i = 0; i < profile.events.size (); ++i)
+        {
+            if (!function.exclusive[i])
+                continue;
+
+            totals.push_back (ymeas::Metric {
+                                  profile.events[i],
+                                  static_cast <double> (function.exclusive[i]),
+                                  name
+                              });
+        }
+    }
+
+    return totals;
+}
+
+ymeas::Metrics
+yocl::FunctionInclusiveTotals (Profile const &profile)
+{
+    ymeas::Metrics totals;
+
+    for (FunctionCosts const &function : profile.functions)
+    {
+        std::string const name (function.file + ":" + function.name);
+
+        for (size_t i = 0; i < profile.events.size (); ++i)
+        {
+            if (!function.inclusive[i])
+                continue;
+
+            totals.push_back (ymeas::Metric {
+                                  profile.events[i] + ".inclusive",
+                                  static_cast <double> (function.inclusive[i]),
+                                  name
+                              });
+        }
+    }
+
+    return totals;
+}
+
+ymeas::Metrics
+yocl::FunctionMissRates (Profile const &profile)
+{
+    ymeas::Metrics rates;
+
+    for (FunctionCosts const &function : profile.functions)
+    {
+        ymeas::Metrics events;
+
+        for (size_t i = 0; i < profile.events.size (); ++i)
+            events.push_back (ymeas::Metric {
+                                  profile.events[i],
+                                  static_cast <double> (function.exclusive[i])
+                              });
+
+        for (ymeas::Metric rate : yocg::MissRates (events))
+        {
+            rate.function = function.file + ":" + function.name;
+            rates.push_back (rate);
+        }
+    }
+
+    return rates;
+}
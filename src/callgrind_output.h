@@ -0,0 +1,165 @@
+/*
+ * callgrind_output.h:
+ * Reads back the profiles which callgrind leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_CALLGRIND_OUTPUT_H
+#define YIQI_CALLGRIND_OUTPUT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace callgrind
+        {
+            /* One count for each event in the profile, in order */
+            typedef std::vector <unsigned long long> Costs;
+
+            /**
+             * @brief FunctionCosts is what a single function cost
+             */
+            struct FunctionCosts
+            {
+                std::string object;
+                std::string file;
+                std::string name;
+
+                /* Spent in the function itself */
+                Costs       exclusive;
+
+                /* Spent in the function and everything it called,
+                 * apart from calls to itself */
+                Costs       inclusive;
+            };
+
+            /**
+             * @brief LineCosts is what a single line of source cost
+             */
+            struct LineCosts
+            {
+                std::string        file;
+                unsigned long long line;
+
+                /* Spent on the line itself, leaving out calls */
+                Costs              exclusive;
+            };
+
+            /**
+             * @brief Call is what one function cost in calls to another,
+             * summed over every place it called it from
+             */
+            struct Call
+            {
+                /* Indices into the profile's functions */
+                size_t      caller;
+                size_t      callee;
+
+                /* Spent in the callee and everything it called */
+                Costs       inclusive;
+            };
+
+            /**
+             * @brief Profile is the costs of everything in a callgrind
+             * profile, summed over every part of it
+             */
+            struct Profile
+            {
+                /* What made callgrind write the profile out, for
+                 * instance "Client Request: label" */
+                std::string                 trigger;
+
+                std::vector <std::string>   events;
+                Costs                       totals;
+                std::vector <FunctionCosts> functions;
+
+                /* Calls from one function to another, leaving out
+                 * calls from a function to itself */
+                std::vector <Call>          calls;
+
+                /* Each line of source with a cost, in the file the
+                 * line is in, which for inlined code is not the
+                 * function's own. Empty if the profile has no lines
+                 * or they were not asked for. */
+                std::vector <LineCosts>     lines;
+            };
+
+            /**
+             * @brief ReadProfile reads a profile in callgrind's format in
+             * a single pass, without copying it. Compressed names, relative
+             * positions and missing trailing costs are all understood.
+             * Cachegrind's format is a subset of callgrind's, so cachegrind
+             * profiles can be read too.
+             * @param data the profile, which need not be null-terminated
+             * @param size the length of the profile in bytes
+             * @param collectLines whether to add up the costs of each line
+             * as well, which is only needed to annotate source
+             * @throws std::runtime_error if the profile is malformed
+             * @return the costs in that profile
+             */
+            Profile ReadProfile (char const *data,
+                                 size_t     size,
+                                 bool       collectLines = false);
+
+            /**
+             * @brief ReadProfileFile maps the file at path into memory
+             * and reads it with ReadProfile
+             * @param path the path to a callgrind.out file
+             * @param collectLines whether to add up the costs of each line
+             * @throws std::system_error if the file could not be mapped
+             * @throws std::runtime_error if the profile is malformed
+             * @return the costs in that profile
+             */
+            Profile ReadProfileFile (std::string const &path,
+                                     bool              collectLines = false);
+
+            /**
+             * @brief EventTotals
+             * @param profile a Profile, from ReadProfile
+             * @return a metric named for each event (eg, Ir) with the
+             * total cost of that event
+             */
+            measurement::Metrics EventTotals (Profile const &profile);
+
+            /**
+             * @brief FunctionTotals
+             * @param profile a Profile, from ReadProfile
+             * @return a metric for each event of each function with
+             * a non-zero exclusive cost, where the function is named
+             * file:name, as cg_annotate does
+             */
+            measurement::Metrics FunctionTotals (Profile const &profile);
+
+            /**
+             * @brief FunctionInclusiveTotals
+             * @param profile a Profile, from ReadProfile
+             * @return a metric for each event of each function with
+             * a non-zero inclusive cost, named for the event with
+             * .inclusive after it (eg, Ir.inclusive), where the function
+             * is named file:name
+             */
+            measurement::Metrics
+            FunctionInclusiveTotals (Profile const &profile);
+
+            /**
+             * @brief FunctionMissRates
+             * @param profile a Profile, from ReadProfile, of a run with
+             * --cache-sim=yes and --branch-sim=yes
+             * @return the miss and mispredict rates, as worked out by
+             * cachegrind::MissRates, of the exclusive costs of each
+             * function, where the function is named file:name
+             */
+            measurement::Metrics
+            FunctionMissRates (Profile const &profile);
+        }
+    }
+}
+
+#endif // YIQI_CALLGRIND_OUTPUT_H
@@ -0,0 +1,157 @@
+/*
+ * clocks.cpp:
+ * Monotonic, high resolution clocks for timing client code
+ * in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <chrono>
+
+#if defined (__x86_64__) || defined (__i386__)
+#define YIQI_HAVE_TSC 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#include "clocks.h"
+
+namespace ytime = yiqi::timing;
+
+namespace
+{
+    class SteadyClock :
+        public ytime::Clock
+    {
+        private:
+
+            Ticks Now () const;
+            double Nanoseconds (Ticks elapsed) const;
+            std::string const & Name () const;
+    };
+
+#ifdef YIQI_HAVE_TSC
+    class TSCClock :
+        public ytime::Clock
+    {
+        public:
+
+            TSCClock ();
+
+        private:
+
+            Ticks Now () const;
+            double Nanoseconds (Ticks elapsed) const;
+            std::string const & Name () const;
+
+            double mNanosecondsPerTick;
+    };
+
+    bool HasInvariantTSC ()
+    {
+        unsigned int eax, ebx, ecx, edx;
+
+        if (!__get_cpuid (0x80000000, &eax, &ebx, &ecx, &edx) ||
+            eax < 0x80000007)
+            return false;
+
+        __get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx);
+
+        /* Advanced power management information, invariant TSC bit */
+        return edx & (1 << 8);
+    }
+
+    unsigned long long ReadTSC ()
+    {
+        /* Stop the processor from reading the counter before earlier
+         * instructions have finished, or after later ones have started */
+        _mm_lfence ();
+        unsigned long long const ticks (__rdtsc ());
+        _mm_lfence ();
+
+        return ticks;
+    }
+#endif
+}
+
+ytime::Clock::Ticks
+SteadyClock::Now () const
+{
+    auto const sinceEpoch (std::chrono::steady_clock::now ().time_since_epoch ());
+    return sinceEpoch.count ();
+}
+
+double
+SteadyClock::Nanoseconds (Ticks elapsed) const
+{
+    typedef std::chrono::duration <double, std::nano> DoubleNanoseconds;
+
+    std::chrono::steady_clock::duration const duration (elapsed);
+    return std::chrono::duration_cast <DoubleNanoseconds> (duration).count ();
+}
+
+std::string const &
+SteadyClock::Name () const
+{
+    static std::string const name ("steady_clock");
+    return name;
+}
+
+#ifdef YIQI_HAVE_TSC
+TSCClock::TSCClock ()
+{
+    /* The processor doesn't tell us how fast the counter ticks,
+     * so measure it against the steady clock */
+    typedef std::chrono::steady_clock Steady;
+    std::chrono::milliseconds const calibrationPeriod (10);
+
+    Steady::time_point const startTime (Steady::now ());
+    unsigned long long const startTicks (ReadTSC ());
+
+    while (Steady::now () - startTime < calibrationPeriod)
+        ;
+
+    Steady::time_point const endTime (Steady::now ());
+    unsigned long long const endTicks (ReadTSC ());
+
+    std::chrono::duration <double, std::nano> const elapsed (endTime -
+                                                             startTime);
+    mNanosecondsPerTick = elapsed.count () / (endTicks - startTicks);
+}
+
+ytime::Clock::Ticks
+TSCClock::Now () const
+{
+    return ReadTSC ();
+}
+
+double
+TSCClock::Nanoseconds (Ticks elapsed) const
+{
+    return elapsed * mNanosecondsPerTick;
+}
+
+std::string const &
+TSCClock::Name () const
+{
+    static std::string const name ("tsc");
+    return name;
+}
+#endif
+
+ytime::Clock::Unique
+ytime::MakeSteadyClock ()
+{
+    return Clock::Unique (new SteadyClock ());
+}
+
+ytime::Clock::Unique
+ytime::MakeBestClock ()
+{
+#ifdef YIQI_HAVE_TSC
+    if (HasInvariantTSC ())
+        return Clock::Unique (new TSCClock ());
+#endif
+
+    return MakeSteadyClock ();
+}
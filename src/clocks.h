@@ -0,0 +1,78 @@
+/*
+ * clocks.h:
+ * Monotonic, high resolution clocks for timing client code
+ * in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_CLOCKS_H
+#define YIQI_CLOCKS_H
+
+#include <memory>
+#include <string>
+
+namespace yiqi
+{
+    namespace timing
+    {
+        class Clock
+        {
+            public:
+
+                typedef std::unique_ptr <Clock> Unique;
+                typedef unsigned long long      Ticks;
+
+                virtual ~Clock () {};
+
+                /**
+                 * @brief Now
+                 * @return the number of ticks since some fixed, arbitrary
+                 * point. Never goes backwards.
+                 */
+                virtual Ticks Now () const = 0;
+
+                /**
+                 * @brief Nanoseconds converts the difference between two
+                 * readings of Now, so that the readings themselves are
+                 * subtracted without losing any resolution
+                 * @param elapsed the later reading less the earlier one
+                 * @return how long elapsed is in nanoseconds
+                 */
+                virtual double Nanoseconds (Ticks elapsed) const = 0;
+
+                /**
+                 * @brief Name
+                 * @return a short name for where the time comes from
+                 */
+                virtual std::string const & Name () const = 0;
+
+            protected:
+
+                Clock () = default;
+
+            private:
+
+                Clock (Clock const &) = delete;
+                Clock & operator= (Clock const &) = delete;
+        };
+
+        /**
+         * @brief MakeSteadyClock
+         * @return a Clock based on std::chrono::steady_clock
+         */
+        Clock::Unique MakeSteadyClock ();
+
+        /**
+         * @brief MakeBestClock picks the clock with the least overhead
+         * which is still safe to use. The x86 time stamp counter is used
+         * if the processor says it is invariant, that is it ticks at the
+         * same rate whatever the power state, and std::chrono::steady_clock
+         * is used otherwise.
+         * @return the best available Clock
+         */
+        Clock::Unique MakeBestClock ();
+    }
+}
+
+#endif // YIQI_CLOCKS_H
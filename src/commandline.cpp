@@ -8,9 +8,12 @@
  */
 
 #include <algorithm>
+#include <deque>
 #include <stdexcept>
 #include <vector>
 
+#include <boost/algorithm/string.hpp>
+
 #include <folly/ScopeGuard.h>
 
 #include <cstring>
@@ -42,15 +45,31 @@ ycom::BuildCommandLine (int                 argc,
     if (!wrapper.empty ())
         arguments.push_back (wrapper);
 
-    /* Tool arguments */
+    /* Tool arguments, which are separated by spaces, but
+     * need to be passed as separate arguments */
     std::string const &toolOption (tool.WrapperOptions ());
 
     if (!toolOption.empty ())
-        arguments.push_back (toolOption);
+    {
+        ycom::CommandArguments toolArguments;
+        boost::split (toolArguments,
+                      toolOption,
+                      boost::is_any_of (" "),
+                      boost::token_compress_on);
+
+        for (std::string const &argument : toolArguments)
+            if (!argument.empty ())
+                arguments.push_back (argument);
+    }
 
     /* The name of this test binary */
     arguments.push_back (argv[0]);
 
+    /* Its own arguments, so that the instrumented process
+     * sees the same options */
+    for (int i = 1; i < argc; ++i)
+        arguments.push_back (argv[i]);
+
     return arguments;
 }
 
@@ -85,8 +104,13 @@ namespace yiqi
 
                 friend void swap (Private &lhs, Private &rhs);
 
+                typedef std::deque <std::string> StringStorage;
+
+                /* Storage for appended strings is a deque, as
+                 * vector would move strings around when it grows,
+                 * leaving the pointers in vector dangling */
                 std::vector <char const *> vector;
-                std::vector <std::string>  storedNewStrings;
+                StringStorage              storedNewStrings;
 
             private:
 
@@ -290,7 +314,7 @@ namespace
 void
 ycom::NullTermArray::eraseAppended (StringVector const &values)
 {
-    typedef typename StringVector::iterator SVIterator;
+    typedef typename Private::StringStorage::iterator SVIterator;
 
     SVIterator storedNewStringsEnd = priv->storedNewStrings.end ();
     /* Start search from at least values.size () from the end */
@@ -341,7 +365,9 @@ ycom::NullTermArray::eraseAppended (StringVector const &values)
         {
             auto stringEqualsCharacterArray =
                 [](CVIterator const &lhs, CSVIterator const &rhs) -> bool {
-                    return *lhs == rhs->c_str ();
+                    /* values are copies, so compare contents and
+                     * not pointers */
+                    return *lhs && *rhs == *lhs;
                 };
 
             auto lastPointerInVector =
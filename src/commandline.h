@@ -34,7 +34,9 @@ namespace yiqi
          * @param argc the program argc
          * @param argv the program argv
          * @param tool a yiqi::instrumentation::tools::Tool representing the
-         * instrumentation that should be performed and the command required
+         * instrumentation that should be performed and the command required.
+         * Its space-separated WrapperOptions become separate arguments
+         * and the arguments after the program name are passed on as-is
          * @return an std::vector of std::string with the
          * command line to pass to exec ()
          */
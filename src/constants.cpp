@@ -16,8 +16,42 @@ namespace yconst = yiqi::constants;
 char const * yconst::ValgrindWrapper = "valgrind";
 char const * yconst::ValgrindToolOptionPrefix = "--tool=";
 char const * yconst::YiqiToolOption = "yiqi_tool";
+char const * yconst::YiqiCallgrindFastOption = "yiqi_callgrind_fast";
+char const * yconst::YiqiTimerWarmupOption = "yiqi_timer_warmup";
+char const * yconst::YiqiTimerIterationsOption = "yiqi_timer_iterations";
+char const * yconst::YiqiCacheProfileOption = "yiqi_cache_profile";
+char const * yconst::YiqiFlameGraphsOption = "yiqi_flame_graphs";
+char const * yconst::YiqiAnnotateOption = "yiqi_annotate";
+char const * yconst::YiqiResultsFileOption = "yiqi_results_file";
+char const * yconst::YiqiFailFastOption = "yiqi_fail_fast";
+char const * yconst::YiqiJobsOption = "yiqi_jobs";
+char const * yconst::YiqiDurationsFileOption = "yiqi_durations_file";
+char const * yconst::YiqiCacheOption = "yiqi_cache";
+char const * yconst::YiqiBaselineOption = "yiqi_baseline";
+char const * yconst::YiqiUpdateBaselineOption = "yiqi_update_baseline";
+char const * yconst::YiqiBaselineToleranceOption = "yiqi_baseline_tolerance";
+char const * yconst::YiqiBaselineAbsoluteToleranceOption =
+    "yiqi_baseline_absolute_tolerance";
+char const * yconst::YiqiDifferenceFromOption = "yiqi_difference_from";
+char const * yconst::YiqiDifferenceToOption = "yiqi_difference_to";
+char const * yconst::YiqiDifferenceFunctionsOption =
+    "yiqi_difference_functions";
 char const * yconst::YiqiToolEnvKey = "__YIQI_INSTRUMENTATION_TOOL_ACTIVE";
+char const * yconst::YiqiOutputDirectoryEnvKey = "__YIQI_OUTPUT_DIRECTORY";
 char const * yconst::YiqiRunningUnderHeader = "[YIQI] RUNNING UNDER INSTRUMENTATION: ";
+char const * yconst::YiqiMeasuredHeader = "[YIQI] MEASURED: ";
+char const * yconst::GoogleTestFilterOption = "--gtest_filter=";
+char const * yconst::GoogleTestShardIndexEnvKey = "GTEST_SHARD_INDEX";
+char const * yconst::GoogleTestTotalShardsEnvKey = "GTEST_TOTAL_SHARDS";
+int const yconst::ResultsStreamFd = 3;
+char const * yconst::YiqiTestStartedMarker = "[YIQI] TEST STARTED: ";
+char const * yconst::YiqiEntryLeakCheckMarker = "[YIQI] ENTRY LEAK CHECK";
+char const * yconst::YiqiEntryLeakCheckDoneMarker =
+    "[YIQI] ENTRY LEAK CHECK DONE";
+char const * yconst::YiqiFailedHeader = "[YIQI] FAILED: ";
+char const * yconst::YiqiRegressedHeader = "[YIQI] REGRESSED: ";
+char const * yconst::YiqiCachedHeader = "[YIQI] CACHED: ";
+char const * yconst::YiqiDifferenceHeader = "[YIQI] DIFFERENCE: ";
 
 yconst::ToolsArray const & yconst::InstrumentationToolNames()
 {
@@ -29,7 +63,13 @@ yconst::ToolsArray const & yconst::InstrumentationToolNames()
             { InstrumentationTool::Memcheck, "memcheck" },
             { InstrumentationTool::Callgrind, "callgrind" },
             { InstrumentationTool::Cachegrind, "cachegrind" },
-            { InstrumentationTool::Passthrough, "passthrough" }
+            { InstrumentationTool::Passthrough, "passthrough" },
+            { InstrumentationTool::Massif, "massif" },
+            { InstrumentationTool::Dhat, "dhat" },
+            { InstrumentationTool::Perf, "perf" },
+            { InstrumentationTool::Heap, "heap" },
+            { InstrumentationTool::Rusage, "rusage" },
+            { InstrumentationTool::CallgrindSimulation, "callgrind_sim" }
         }
     };
 
@@ -32,6 +32,13 @@ namespace yiqi
          */
         extern char const * YiqiToolEnvKey;
 
+        /**
+         * @brief YiqiOutputDirectoryEnvKey the environment variable naming
+         * the directory which valgrind tools write their output files to,
+         * made afresh for each run
+         */
+        extern char const * YiqiOutputDirectoryEnvKey;
+
         /**
          * @brief YiqiRunningUnderHeader message header when detected to be running under an
          * instrumentation tool (e.g. __YIQI_INSTRUMENTATION_TOOL_ACTIVE
@@ -39,6 +46,80 @@ namespace yiqi
          */
         extern char const * YiqiRunningUnderHeader;
 
+        /**
+         * @brief YiqiMeasuredHeader message header for each metric
+         * measured by an instrumentation tool
+         */
+        extern char const * YiqiMeasuredHeader;
+
+        /**
+         * @brief GoogleTestFilterOption the option which tells
+         * Google Test which tests to run, up to and including the "="
+         */
+        extern char const * GoogleTestFilterOption;
+
+        /**
+         * @brief GoogleTestShardIndexEnvKey the environment variable which
+         * tells Google Test which shard of the tests to run, from zero
+         */
+        extern char const * GoogleTestShardIndexEnvKey;
+
+        /**
+         * @brief GoogleTestTotalShardsEnvKey the environment variable which
+         * tells Google Test how many shards the tests are split into
+         */
+        extern char const * GoogleTestTotalShardsEnvKey;
+
+        /**
+         * @brief ResultsStreamFd the file descriptor which an instrumented
+         * process writes results to as it runs, for tools which stream
+         * their results to a supervising process
+         */
+        extern int const ResultsStreamFd;
+
+        /**
+         * @brief YiqiTestStartedMarker is written to an instrumentation
+         * tool's output when each test starts, so that anything the tool
+         * finds can be traced back to the test
+         */
+        extern char const * YiqiTestStartedMarker;
+
+        /**
+         * @brief YiqiEntryLeakCheckMarker is written to memcheck's output
+         * just before the leak check made as client code starts. Leaks
+         * reported from then on belong to whatever ran before client code.
+         */
+        extern char const * YiqiEntryLeakCheckMarker;
+
+        /**
+         * @brief YiqiEntryLeakCheckDoneMarker is written to memcheck's
+         * output once the leak check made as client code starts is done
+         */
+        extern char const * YiqiEntryLeakCheckDoneMarker;
+
+        /**
+         * @brief YiqiFailedHeader message header for each problem an
+         * instrumentation tool found in a test
+         */
+        extern char const * YiqiFailedHeader;
+
+        /**
+         * @brief YiqiRegressedHeader message header for the table of
+         * measurements which went over their baseline
+         */
+        extern char const * YiqiRegressedHeader;
+
+        /**
+         * @brief YiqiCachedHeader message header for each test which
+         * was not run again, as what it found last time was kept
+         */
+        extern char const * YiqiCachedHeader;
+
+        /**
+         * @brief YiqiDifferenceHeader message header for the table of
+         * measurements which changed since an earlier run
+         */
+        extern char const * YiqiDifferenceHeader;
 
         /**
          * @brief YiqiToolOption the current string describing how to specify
@@ -46,6 +127,119 @@ namespace yiqi
          */
         extern char const * YiqiToolOption;
 
+        /**
+         * @brief YiqiCallgrindFastOption the option which makes
+         * callgrind only instrument client code
+         */
+        extern char const * YiqiCallgrindFastOption;
+
+        /**
+         * @brief YiqiTimerWarmupOption the option which sets how many
+         * times the timer runs client code before timing it
+         */
+        extern char const * YiqiTimerWarmupOption;
+
+        /**
+         * @brief YiqiTimerIterationsOption the option which sets how many
+         * times the timer runs and times client code
+         */
+        extern char const * YiqiTimerIterationsOption;
+
+        /**
+         * @brief YiqiCacheProfileOption the option which names the
+         * processor whose caches cachegrind and callgrind simulate
+         */
+        extern char const * YiqiCacheProfileOption;
+
+        /**
+         * @brief YiqiFlameGraphsOption the option which names a directory
+         * for callgrind to draw flame graphs of each test in
+         */
+        extern char const * YiqiFlameGraphsOption;
+
+        /**
+         * @brief YiqiAnnotateOption the option which names a directory
+         * for cachegrind and callgrind to write annotated client code to
+         */
+        extern char const * YiqiAnnotateOption;
+
+        /**
+         * @brief YiqiResultsFileOption the option which names a file
+         * to write every measured metric to, in a machine readable form
+         */
+        extern char const * YiqiResultsFileOption;
+
+        /**
+         * @brief YiqiFailFastOption the option which stops the instrumented
+         * process as soon as a tool finds the first problem in a test
+         */
+        extern char const * YiqiFailFastOption;
+
+        /**
+         * @brief YiqiJobsOption the option which sets how many
+         * instrumented processes run tests at the same time
+         */
+        extern char const * YiqiJobsOption;
+
+        /**
+         * @brief YiqiDurationsFileOption the option which names a file
+         * to keep how long each test took to run in, so that the slowest
+         * tests can be started first next time
+         */
+        extern char const * YiqiDurationsFileOption;
+
+        /**
+         * @brief YiqiCacheOption the option which names a directory to
+         * keep what a tool found in each test in, so that tests do not
+         * have to be run under the tool again until their code changes
+         */
+        extern char const * YiqiCacheOption;
+
+        /**
+         * @brief YiqiBaselineOption the option which names a file of
+         * measurements to compare each test's measurements against
+         */
+        extern char const * YiqiBaselineOption;
+
+        /**
+         * @brief YiqiUpdateBaselineOption the option which stores this
+         * run's measurements in the baseline, rather than comparing
+         */
+        extern char const * YiqiUpdateBaselineOption;
+
+        /**
+         * @brief YiqiBaselineToleranceOption the option which sets how
+         * far over its baseline a measurement may go, as a fraction
+         * of the baseline
+         */
+        extern char const * YiqiBaselineToleranceOption;
+
+        /**
+         * @brief YiqiBaselineAbsoluteToleranceOption the option which
+         * sets how far over its baseline a measurement may go, in the
+         * measurement's own units
+         */
+        extern char const * YiqiBaselineAbsoluteToleranceOption;
+
+        /**
+         * @brief YiqiDifferenceFromOption the option which names the
+         * results file of an earlier run to compare against
+         */
+        extern char const * YiqiDifferenceFromOption;
+
+        /**
+         * @brief YiqiDifferenceToOption the option which names the
+         * results file of a later run, to compare two runs without
+         * running any tests
+         */
+        extern char const * YiqiDifferenceToOption;
+
+        /**
+         * @brief YiqiDifferenceFunctionsOption the option which sets how
+         * many of the functions which changed the most are shown
+         */
+        extern char const * YiqiDifferenceFunctionsOption;
+
         /**
          * @brief The InstrumentationTools enum lists
          * all of the available tools that we can use
@@ -60,7 +254,13 @@ namespace yiqi
             Memcheck = 2,
             Callgrind = 3,
             Cachegrind = 4,
-            Passthrough = 5
+            Passthrough = 5,
+            Massif = 6,
+            Dhat = 7,
+            Perf = 8,
+            Heap = 9,
+            Rusage = 10,
+            CallgrindSimulation = 11
         };
 
         struct InstrumentationToolName
@@ -69,7 +269,7 @@ namespace yiqi
             char const          *name;
         };
 
-        typedef std::array <InstrumentationToolName, 6> ToolsArray;
+        typedef std::array <InstrumentationToolName, 12> ToolsArray;
         /**
          * @brief InstrumentationToolNames
          * @return an array of all instrumentation tool names
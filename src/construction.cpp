@@ -5,12 +5,20 @@
  * See LICENCE.md for Copyright information
  */
 
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+
+#include "cache_geometry.h"
 #include "construction.h"
 #include "constants.h"
 #include "instrumentation_tool.h"
 
 namespace yconst = yiqi::constants;
 namespace yc = yiqi::construction;
+namespace ygeo = yiqi::geometry;
 namespace yit = yiqi::instrumentation::tools;
 namespace po = boost::program_options;
 
@@ -22,16 +30,106 @@ namespace
         auto const noneString (yconst::StringFromTool (noneTool));
         return noneString;
     }
+
+    po::variables_map
+    ParseOptions (int                  argc,
+                  const char * const   *argv,
+                  yc::Options const    &description)
+    {
+        po::variables_map       variableMap;
+        po::command_line_parser parser (argc, argv);
+
+        po::store (parser.options (description).run (),
+                   variableMap);
+        po::notify (variableMap);
+
+        return variableMap;
+    }
 }
 
 po::options_description
 yc::FetchOptionsDescription ()
 {
+    ToolOptions const       defaults;
+    BaselineOptions const   baseline;
+    DifferenceOptions const difference;
     po::options_description description ("Options");
     description.add_options ()
         (yconst::YiqiToolOption,
          po::value <std::string> ()->default_value (GetNoneString ()),
-         "Tool");
+         "Tool, or a comma separated list of tools. Tools without an "
+         "instrumentation wrapper all run in this process first, then the "
+         "tests are run again under each tool with one")
+        (yconst::YiqiCallgrindFastOption,
+         po::bool_switch ()->default_value (false),
+         "Only have callgrind instrument client code. This is much "
+         "faster, but the simulated caches will be cold in client code")
+        (yconst::YiqiTimerWarmupOption,
+         po::value <unsigned int> ()->default_value (defaults.timerWarmup),
+         "Number of times the timer runs client code before timing it")
+        (yconst::YiqiTimerIterationsOption,
+         po::value <unsigned int> ()->default_value (defaults.timerIterations),
+         "Number of times the timer runs and times client code")
+        (yconst::YiqiCacheProfileOption,
+         po::value <std::string> ()->default_value (defaults.cacheProfile),
+         "Processor whose caches cachegrind and callgrind simulate, such "
+         "as skylake-sp, or host for the caches of this machine")
+        (yconst::YiqiFlameGraphsOption,
+         po::value <std::string> ()->default_value (""),
+         "Directory for callgrind to write folded stacks and flame graphs "
+         "to, for each test and for all of them together")
+        (yconst::YiqiAnnotateOption,
+         po::value <std::string> ()->default_value (""),
+         "Directory for cachegrind and callgrind to write client code to, "
+         "with what each line cost over all of the tests against it")
+        (yconst::YiqiResultsFileOption,
+         po::value <std::string> ()->default_value (""),
+         "File to write all measurements to, one per line, with the test, "
+         "tool, function, metric and value separated by tabs")
+        (yconst::YiqiFailFastOption,
+         po::bool_switch ()->default_value (false),
+         "Stop running tests as soon as a tool finds a problem in one")
+        (yconst::YiqiJobsOption,
+         po::value <unsigned int> ()->default_value (1),
+         "Number of instrumented processes to split the tests between, "
+         "or 0 for one for each processor")
+        (yconst::YiqiDurationsFileOption,
+         po::value <std::string> ()->default_value (""),
+         "File to keep how long each test took in, so that the slowest "
+         "tests start first when running several at once")
+        (yconst::YiqiCacheOption,
+         po::value <std::string> ()->default_value (""),
+         "Directory to keep what the tool found in each test in, so that "
+         "tests are only run under the tool again once their code changes")
+        (yconst::YiqiBaselineOption,
+         po::value <std::string> ()->default_value (""),
+         "File of measurements to compare each test against, failing "
+         "the run if any have regressed")
+        (yconst::YiqiUpdateBaselineOption,
+         po::bool_switch ()->default_value (false),
+         "Store this run's measurements in the baseline instead of "
+         "comparing against it")
+        (yconst::YiqiBaselineToleranceOption,
+         po::value <double> ()->default_value (baseline.tolerance.relative),
+         "How far over its baseline a measurement may go, as a fraction "
+         "of the baseline")
+        (yconst::YiqiBaselineAbsoluteToleranceOption,
+         po::value <double> ()->default_value (baseline.tolerance.absolute),
+         "How far over its baseline a measurement may go, in its own units. "
+         "The larger of the two tolerances applies")
+        (yconst::YiqiDifferenceFromOption,
+         po::value <std::string> ()->default_value (""),
+         "Results file of an earlier run to compare this run against, "
+         "showing each measurement which changed and the functions which "
+         "changed the most")
+        (yconst::YiqiDifferenceToOption,
+         po::value <std::string> ()->default_value (""),
+         "Results file of a later run to compare the earlier one against, "
+         "instead of running the tests")
+        (yconst::YiqiDifferenceFunctionsOption,
+         po::value <unsigned int> ()->default_value (difference.functions),
+         "Number of functions to show for each measurement which changed, "
+         "both of those which went up the most and those which went down");
 
     return description;
 }
@@ -41,12 +139,7 @@ yc::ParseOptionsForTool(int                argc,
                         const char * const *argv,
                         const yc::Options  &description)
 {
-    po::variables_map       variableMap;
-    po::command_line_parser parser (argc, argv);
-
-    po::store (parser.options (description).run (),
-               variableMap);
-    po::notify (variableMap);
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
 
     if (variableMap.count (yconst::YiqiToolOption))
         return variableMap[yconst::YiqiToolOption].as <std::string> ();
@@ -54,10 +147,245 @@ yc::ParseOptionsForTool(int                argc,
     return GetNoneString ();
 }
 
+std::vector <std::string>
+yc::ParseOptionsForTools (int                argc,
+                          const char * const *argv,
+                          const yc::Options  &description)
+{
+    std::vector <std::string> names;
+    boost::split (names,
+                  ParseOptionsForTool (argc, argv, description),
+                  boost::is_any_of (","));
+
+    std::vector <std::string> tools;
+
+    for (std::string &name : names)
+    {
+        boost::trim (name);
+
+        if (name.empty () ||
+            std::find (tools.begin (), tools.end (), name) != tools.end ())
+            continue;
+
+        tools.push_back (name);
+    }
+
+    if (tools.empty ())
+        tools.push_back (GetNoneString ());
+
+    return tools;
+}
+
+std::string
+yc::ParseOptionsForResultsFile (int                argc,
+                                const char * const *argv,
+                                const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+
+    if (variableMap.count (yconst::YiqiResultsFileOption))
+        return variableMap[yconst::YiqiResultsFileOption].as <std::string> ();
+
+    return std::string ();
+}
+
+std::string
+yc::ParseOptionsForDurationsFile (int                argc,
+                                  const char * const *argv,
+                                  const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+
+    if (variableMap.count (yconst::YiqiDurationsFileOption))
+        return variableMap[yconst::YiqiDurationsFileOption].as <std::string> ();
+
+    return std::string ();
+}
+
+std::string
+yc::ParseOptionsForCacheDirectory (int                argc,
+                                   const char * const *argv,
+                                   const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+
+    if (variableMap.count (yconst::YiqiCacheOption))
+        return variableMap[yconst::YiqiCacheOption].as <std::string> ();
+
+    return std::string ();
+}
+
+bool
+yc::ParseOptionsForFailFast (int                argc,
+                             const char * const *argv,
+                             const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+
+    if (variableMap.count (yconst::YiqiFailFastOption))
+        return variableMap[yconst::YiqiFailFastOption].as <bool> ();
+
+    return false;
+}
+
+unsigned int
+yc::ParseOptionsForJobs (int                argc,
+                         const char * const *argv,
+                         const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+    unsigned int      jobs = 1;
+
+    if (variableMap.count (yconst::YiqiJobsOption))
+        jobs = variableMap[yconst::YiqiJobsOption].as <unsigned int> ();
+
+    /* Which may not be known, in which case it is zero */
+    if (jobs == 0)
+        jobs = std::max (1u, std::thread::hardware_concurrency ());
+
+    return jobs;
+}
+
+yc::BaselineOptions
+yc::ParseOptionsForBaseline (int                argc,
+                             const char * const *argv,
+                             const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+    BaselineOptions   options;
+
+    if (variableMap.count (yconst::YiqiBaselineOption))
+    {
+        auto const &file (variableMap[yconst::YiqiBaselineOption]);
+        options.file = file.as <std::string> ();
+    }
+
+    if (variableMap.count (yconst::YiqiUpdateBaselineOption))
+    {
+        auto const &update (variableMap[yconst::YiqiUpdateBaselineOption]);
+        options.update = update.as <bool> ();
+    }
+
+    if (variableMap.count (yconst::YiqiBaselineToleranceOption))
+    {
+        auto const &relative (variableMap[yconst::YiqiBaselineToleranceOption]);
+        options.tolerance.relative = relative.as <double> ();
+    }
+
+    if (variableMap.count (yconst::YiqiBaselineAbsoluteToleranceOption))
+    {
+        auto const &absolute (
+            variableMap[yconst::YiqiBaselineAbsoluteToleranceOption]);
+        options.tolerance.absolute = absolute.as <double> ();
+    }
+
+    if (options.update && options.file.empty ())
+        throw std::runtime_error ("updating the baseline needs a baseline "
+                                  "file to update");
+
+    if (options.tolerance.relative < 0 || options.tolerance.absolute < 0)
+        throw std::runtime_error ("baseline tolerances cannot be negative");
+
+    return options;
+}
+
+yc::DifferenceOptions
+yc::ParseOptionsForDifference (int                argc,
+                               const char * const *argv,
+                               const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+    DifferenceOptions options;
+
+    if (variableMap.count (yconst::YiqiDifferenceFromOption))
+    {
+        auto const &before (variableMap[yconst::YiqiDifferenceFromOption]);
+        options.before = before.as <std::string> ();
+    }
+
+    if (variableMap.count (yconst::YiqiDifferenceToOption))
+    {
+        auto const &after (variableMap[yconst::YiqiDifferenceToOption]);
+        options.after = after.as <std::string> ();
+    }
+
+    if (variableMap.count (yconst::YiqiDifferenceFunctionsOption))
+    {
+        auto const &functions (
+            variableMap[yconst::YiqiDifferenceFunctionsOption]);
+        options.functions = functions.as <unsigned int> ();
+    }
+
+    if (!options.after.empty () && options.before.empty ())
+        throw std::runtime_error ("comparing against a later run needs "
+                                  "the results of an earlier one");
+
+    return options;
+}
+
+yc::ToolOptions
+yc::ParseOptionsForToolOptions (int                argc,
+                                const char * const *argv,
+                                const yc::Options  &description)
+{
+    po::variables_map variableMap (ParseOptions (argc, argv, description));
+    ToolOptions       options;
+
+    if (variableMap.count (yconst::YiqiCallgrindFastOption))
+    {
+        auto const &fast (variableMap[yconst::YiqiCallgrindFastOption]);
+        options.callgrindFast = fast.as <bool> ();
+    }
+
+    if (variableMap.count (yconst::YiqiTimerWarmupOption))
+    {
+        auto const &warmup (variableMap[yconst::YiqiTimerWarmupOption]);
+        options.timerWarmup = warmup.as <unsigned int> ();
+    }
+
+    if (variableMap.count (yconst::YiqiTimerIterationsOption))
+    {
+        auto const &iterations (variableMap[yconst::YiqiTimerIterationsOption]);
+        options.timerIterations = iterations.as <unsigned int> ();
+    }
+
+    if (options.timerIterations == 0)
+        throw std::runtime_error ("the timer needs at least one iteration");
+
+    if (variableMap.count (yconst::YiqiCacheProfileOption))
+    {
+        auto const &profile (variableMap[yconst::YiqiCacheProfileOption]);
+        options.cacheProfile = profile.as <std::string> ();
+    }
+
+    if (variableMap.count (yconst::YiqiFlameGraphsOption))
+    {
+        auto const &directory (variableMap[yconst::YiqiFlameGraphsOption]);
+        options.flameGraphDirectory = directory.as <std::string> ();
+    }
+
+    if (variableMap.count (yconst::YiqiAnnotateOption))
+    {
+        auto const &directory (variableMap[yconst::YiqiAnnotateOption]);
+        options.annotationDirectory = directory.as <std::string> ();
+    }
+
+    std::vector <std::string> const profiles (ygeo::ProfileNames ());
+
+    if (std::find (profiles.begin (),
+                   profiles.end (),
+                   options.cacheProfile) == profiles.end ())
+        throw std::runtime_error ("no cache profile named " +
+                                  options.cacheProfile);
+
+    return options;
+}
+
 yit::Tool::Unique
-yc::MakeSpecifiedTool (yconst::InstrumentationTool toolID)
+yc::MakeSpecifiedTool (yconst::InstrumentationTool toolID,
+                       ToolOptions const           &options)
 {
-    typedef ToolUniquePtr (*ToolFactory) ();
+    typedef ToolUniquePtr (*ToolFactory) (ToolOptions const &);
     typedef std::map <yconst::InstrumentationTool, ToolFactory> FactoryMap;
 
     static FactoryMap const toolConstructors
@@ -68,10 +396,17 @@ yc::MakeSpecifiedTool (yconst::InstrumentationTool toolID)
         { yconst::InstrumentationTool::Callgrind, yit::MakeCallgrindTool },
         { yconst::InstrumentationTool::Cachegrind, yit::MakeCachegrindTool },
         { yconst::InstrumentationTool::Passthrough, yit::MakePassthroughTool },
+        { yconst::InstrumentationTool::Massif, yit::MakeMassifTool },
+        { yconst::InstrumentationTool::Dhat, yit::MakeDhatTool },
+        { yconst::InstrumentationTool::Perf, yit::MakePerfTool },
+        { yconst::InstrumentationTool::Heap, yit::MakeHeapTool },
+        { yconst::InstrumentationTool::Rusage, yit::MakeRusageTool },
+        { yconst::InstrumentationTool::CallgrindSimulation,
+          yit::MakeCallgrindSimulationTool },
     };
 
     ToolFactory const factory = toolConstructors.at (toolID);
-    return factory ();
+    return factory (options);
 }
 
 
@@ -84,5 +419,27 @@ yc::ParseOptionsToToolUniquePtr (int                argc,
                                                 argv,
                                                 description));
     auto const toolID (yconst::ToolFromString (toolString));
-    return MakeSpecifiedTool (toolID);
+    auto const options (ParseOptionsForToolOptions (argc,
+                                                    argv,
+                                                    description));
+    return MakeSpecifiedTool (toolID, options);
+}
+
+yc::ToolUniquePtrs
+yc::ParseOptionsToToolUniquePtrs (int                argc,
+                                  const char * const *argv,
+                                  const yc::Options  &description)
+{
+    auto const options (ParseOptionsForToolOptions (argc,
+                                                    argv,
+                                                    description));
+    ToolUniquePtrs tools;
+
+    for (std::string const &name : ParseOptionsForTools (argc,
+                                                         argv,
+                                                         description))
+        tools.push_back (MakeSpecifiedTool (yconst::ToolFromString (name),
+                                            options));
+
+    return tools;
 }
@@ -11,8 +11,11 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <boost/program_options.hpp>
 
+#include "baseline.h"
+#include "difference.h"
 #include "instrumentation_tools_available.h"
 
 namespace yiqi
@@ -34,6 +37,7 @@ namespace yiqi
     {
         typedef yiqi::instrumentation::tools::Tool InstrumentationToolCommand;
         typedef std::unique_ptr <InstrumentationToolCommand> ToolUniquePtr;
+        typedef std::vector <ToolUniquePtr> ToolUniquePtrs;
 
         /**
          * @brief FetchOptionsDescription returns the
@@ -62,8 +66,164 @@ namespace yiqi
                              const char * const *argv,
                              Options const      &description);
 
+        /**
+         * @brief ParseOptionsForTools
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return The name of each tool in the comma separated list passed
+         * as the instrumentation tool, in order and without repeats
+         */
+        std::vector <std::string>
+        ParseOptionsForTools (int                argc,
+                              const char * const *argv,
+                              Options const      &description);
+
+        /**
+         * @brief ParseOptionsForResultsFile
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return The path to write results to, or an empty string if
+         * results should not be written
+         */
+        std::string
+        ParseOptionsForResultsFile (int                argc,
+                                    const char * const *argv,
+                                    Options const      &description);
+
+        /**
+         * @brief ParseOptionsForDurationsFile
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return The path to keep test durations in, or an empty string if
+         * they should not be kept
+         */
+        std::string
+        ParseOptionsForDurationsFile (int                argc,
+                                      const char * const *argv,
+                                      Options const      &description);
+
+        /**
+         * @brief ParseOptionsForCacheDirectory
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return The directory to keep results in between runs, or an
+         * empty string if they should not be kept
+         */
+        std::string
+        ParseOptionsForCacheDirectory (int                argc,
+                                       const char * const *argv,
+                                       Options const      &description);
+
+        /**
+         * @brief ParseOptionsForFailFast
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return Whether to stop running tests on the first problem
+         * that a tool finds
+         */
+        bool
+        ParseOptionsForFailFast (int                argc,
+                                 const char * const *argv,
+                                 Options const      &description);
+
+        /**
+         * @brief ParseOptionsForJobs
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return How many instrumented processes to run at once, which is
+         * at least one
+         */
+        unsigned int
+        ParseOptionsForJobs (int                argc,
+                             const char * const *argv,
+                             Options const      &description);
+
+        typedef yiqi::baseline::Options BaselineOptions;
+
+        /**
+         * @brief ParseOptionsForBaseline
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @throws std::runtime_error if updating without a baseline file,
+         * or a tolerance is negative
+         * @return A yiqi::baseline::Options with where the baseline is
+         * and how to compare against it
+         */
+        BaselineOptions
+        ParseOptionsForBaseline (int                argc,
+                                 const char * const *argv,
+                                 Options const      &description);
+
+        typedef yiqi::difference::Options DifferenceOptions;
+
+        /**
+         * @brief ParseOptionsForDifference
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @throws std::runtime_error if given a later run without an
+         * earlier one to compare it to
+         * @return A yiqi::difference::Options with which runs to compare
+         */
+        DifferenceOptions
+        ParseOptionsForDifference (int                argc,
+                                   const char * const *argv,
+                                   Options const      &description);
+
+        typedef yiqi::instrumentation::tools::ToolOptions ToolOptions;
+
+        /**
+         * @brief ParseOptionsForToolOptions
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @throws std::runtime_error if the options are out of range,
+         * for instance a timer with no iterations
+         * @return A yiqi::instrumentation::tools::ToolOptions with the
+         * settings for the tool
+         */
+        ToolOptions
+        ParseOptionsForToolOptions (int                argc,
+                                    const char * const *argv,
+                                    Options const      &description);
+
         ToolUniquePtr
-        MakeSpecifiedTool (yiqi::constants::InstrumentationTool);
+        MakeSpecifiedTool (yiqi::constants::InstrumentationTool,
+                           ToolOptions const &options = ToolOptions ());
 
         /**
          * @brief ParseOptionsToParameters
@@ -79,6 +239,22 @@ namespace yiqi
         ParseOptionsToToolUniquePtr (int                argc,
                                      const char * const *argv,
                                      Options const      &description);
+
+        /**
+         * @brief ParseOptionsToToolUniquePtrs
+         * @param argc Number of arguments from main()
+         * @param argv Arguments from main()
+         * @param description A boost::program_options::options_description
+         * object which describes which options should be available
+         * @throws A boost::program_options::error on encountering a malformed
+         * or unknown option
+         * @return A tool for each name in the comma separated list passed
+         * as the instrumentation tool, in order
+         */
+        ToolUniquePtrs
+        ParseOptionsToToolUniquePtrs (int                argc,
+                                      const char * const *argv,
+                                      Options const      &description);
     }
 }
 
@@ -0,0 +1,116 @@
+/*
+ * deferred_budgets.cpp:
+ * Keeps the budgets which an instrumented process could not check
+ * itself, so that they can be checked against what is read back
+ * once it has exited
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "deferred_budgets.h"
+
+namespace ybud = yiqi::budgets;
+namespace ymeas = yiqi::measurement;
+
+std::string
+ybud::BudgetsFile (std::string const &directory, pid_t pid)
+{
+    std::stringstream ss;
+    ss << directory << "/budgets." << pid;
+
+    return ss.str ();
+}
+
+void
+ybud::WriteBudget (std::ostream &os, Budget const &budget)
+{
+    os << budget.test << '\t'
+       << budget.metric << '\t'
+       << std::setprecision (std::numeric_limits <double>::max_digits10)
+       << budget.limit << '\n';
+}
+
+ybud::Budgets
+ybud::ReadBudgets (std::istream &is)
+{
+    Budgets     budgets;
+    std::string line;
+
+    while (std::getline (is, line))
+    {
+        if (line.empty ())
+            continue;
+
+        std::string::size_type const first (line.find ('\t'));
+        std::string::size_type const last (line.rfind ('\t'));
+
+        if (first == std::string::npos || first == last)
+            throw std::runtime_error ("malformed budget: " + line);
+
+        std::string const value (line.substr (last + 1));
+        size_t            parsed = 0;
+        double            limit = 0;
+
+        try
+        {
+            limit = std::stod (value, &parsed);
+        }
+        catch (std::exception const &)
+        {
+        }
+
+        if (value.empty () || parsed != value.size ())
+            throw std::runtime_error ("malformed budget: " + line);
+
+        budgets.push_back (Budget {
+                               line.substr (0, first),
+                               line.substr (first + 1, last - first - 1),
+                               limit
+                           });
+    }
+
+    return budgets;
+}
+
+ymeas::TestFailures
+ybud::Check (Budgets const        &budgets,
+             ymeas::Results const &results)
+{
+    ymeas::TestFailures failures;
+
+    for (Budget const &budget : budgets)
+    {
+        for (ymeas::Result const &result : results)
+        {
+            /* Only the total for all of client code counts */
+            if (result.test != budget.test ||
+                !result.metric.function.empty () ||
+                result.metric.name != budget.metric)
+                continue;
+
+            if (result.metric.value > budget.limit)
+            {
+                std::stringstream description;
+                description << budget.metric << " was "
+                            << result.metric.value
+                            << ", over its budget of " << budget.limit;
+
+                failures.push_back (ymeas::TestFailure {
+                                        budget.test,
+                                        description.str ()
+                                    });
+            }
+
+            break;
+        }
+    }
+
+    return failures;
+}
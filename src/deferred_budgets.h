@@ -0,0 +1,76 @@
+/*
+ * deferred_budgets.h:
+ * Keeps the budgets which an instrumented process could not check
+ * itself, so that they can be checked against what is read back
+ * once it has exited
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_DEFERRED_BUDGETS_H
+#define YIQI_DEFERRED_BUDGETS_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace budgets
+    {
+        /**
+         * @brief Budget is the most that a test's client code may
+         * measure for a metric
+         */
+        struct Budget
+        {
+            std::string test;
+            std::string metric;
+            double      limit;
+        };
+
+        typedef std::vector <Budget> Budgets;
+
+        /**
+         * @brief BudgetsFile is where the process pid keeps its budgets
+         * @param directory the directory for this run's output files
+         * @param pid the instrumented process
+         * @return the path of the file
+         */
+        std::string BudgetsFile (std::string const &directory, pid_t pid);
+
+        /**
+         * @brief WriteBudget writes budget on a line of its own, with
+         * the test, metric and limit separated by tabs
+         * @param os the stream to write to
+         * @param budget the budget to write
+         */
+        void WriteBudget (std::ostream &os, Budget const &budget);
+
+        /**
+         * @brief ReadBudgets reads every budget written by WriteBudget
+         * @param is the stream to read from
+         * @throws std::runtime_error if a line is malformed
+         * @return the budgets, in the order they were written
+         */
+        Budgets ReadBudgets (std::istream &is);
+
+        /**
+         * @brief Check checks each budget against what was measured
+         * in all of the client code of its test. A budget for a metric
+         * which was not measured is not checked, as not every tool can
+         * measure every metric.
+         * @param budgets the budgets to check
+         * @param results what was read back for each test
+         * @return a failure for each budget which was gone over
+         */
+        measurement::TestFailures Check (Budgets const              &budgets,
+                                         measurement::Results const &results);
+    }
+}
+
+#endif // YIQI_DEFERRED_BUDGETS_H
@@ -0,0 +1,317 @@
+/*
+ * dhat_output.cpp:
+ * Reads back the JSON output files which DHAT leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "dhat_output.h"
+
+namespace pt = boost::property_tree;
+namespace ymeas = yiqi::measurement;
+namespace yodh = yiqi::output::dhat;
+
+namespace
+{
+    /* Every region of client code runs below this */
+    std::string const ClientCodeFrame ("yiqi::ExecuteClientCode");
+
+    /* Frames in valgrind's replacements for malloc, new and so on,
+     * and in the ones yiqi uses to count allocations natively */
+    std::vector <std::string> const AllocatorFrames =
+    {
+        "vg_replace_malloc.c",
+        "vgpreload_",
+        "heap_interposer.cpp"
+    };
+
+    bool IsAllocatorFrame (std::string const &frame)
+    {
+        for (std::string const &allocator : AllocatorFrames)
+            if (frame.find (allocator) != std::string::npos)
+                return true;
+
+        return false;
+    }
+
+    bool InClientCode (yodh::Site const &site)
+    {
+        for (std::string const &frame : site.frames)
+            if (frame.find (ClientCodeFrame) != std::string::npos)
+                return true;
+
+        return false;
+    }
+
+    /* A count which was not recorded for one of the sites
+     * was not recorded for the sum either */
+    double Sum (double lhs, double rhs)
+    {
+        return lhs < 0 || rhs < 0 ? -1 : lhs + rhs;
+    }
+
+    /* Sites whose stacks only differ past the innermost frame
+     * outside the allocator get the same name, so they are added
+     * together, in the order that each name first appears */
+    yodh::Sites MergedByName (yodh::Sites const &sites)
+    {
+        yodh::Sites                     merged;
+        std::map <std::string, size_t>  indices;
+
+        for (yodh::Site const &site : sites)
+        {
+            auto const inserted (indices.insert (
+                                     std::make_pair (yodh::SiteName (site),
+                                                     merged.size ())));
+
+            if (inserted.second)
+            {
+                merged.push_back (site);
+                continue;
+            }
+
+            yodh::Site &into (merged[inserted.first->second]);
+
+            into.bytes += site.bytes;
+            into.blocks += site.blocks;
+            into.lifetimes = Sum (into.lifetimes, site.lifetimes);
+            into.reads += site.reads;
+            into.writes += site.writes;
+            into.unusedBytes = Sum (into.unusedBytes, site.unusedBytes);
+        }
+
+        return merged;
+    }
+
+    /* DHAT run-length encodes the access counts for each offset,
+     * with a negative count -n meaning the next count repeats n
+     * times, so this counts the offsets which were never accessed */
+    double UnusedOffsets (pt::ptree const &accesses)
+    {
+        double unused = 0;
+        double repeat = 1;
+
+        for (auto const &entry : accesses)
+        {
+            double const count (entry.second.get_value <double> ());
+
+            if (count < 0)
+            {
+                repeat = -count;
+                continue;
+            }
+
+            if (count == 0)
+                unused += repeat;
+
+            repeat = 1;
+        }
+
+        return unused;
+    }
+
+    double PerByte (double count, double bytes)
+    {
+        return bytes ? count / bytes : 0;
+    }
+}
+
+yodh::Profile
+yodh::ReadProfile (std::istream &output)
+{
+    pt::ptree root;
+
+    try
+    {
+        pt::read_json (output, root);
+    }
+    catch (pt::json_parser_error const &e)
+    {
+        throw std::runtime_error (std::string ("malformed DHAT output: ") +
+                                  e.what ());
+    }
+
+    try
+    {
+        if (root.get <std::string> ("mode", "heap") != "heap")
+            throw std::runtime_error ("DHAT output does not profile the heap");
+
+        std::vector <std::string> frameTable;
+
+        for (auto const &frame : root.get_child ("ftbl"))
+            frameTable.push_back (frame.second.get_value <std::string> ());
+
+        bool const lifetimes (root.get <bool> ("bklt", false));
+        Profile    profile { root.get <double> ("tuth", -1), Sites () };
+
+        if (!lifetimes)
+            profile.shortLivedThreshold = -1;
+
+        for (auto const &point : root.get_child ("pps"))
+        {
+            pt::ptree const &pp (point.second);
+            Site            site
+            {
+                std::vector <std::string> (),
+                pp.get <double> ("tb"),
+                pp.get <double> ("tbk"),
+                lifetimes ? pp.get <double> ("tl") : -1,
+                pp.get <double> ("rb", 0),
+                pp.get <double> ("wb", 0),
+                -1
+            };
+
+            for (auto const &frame : pp.get_child ("fs"))
+                site.frames.push_back (
+                    frameTable.at (frame.second.get_value <size_t> ()));
+
+            if (auto const accesses = pp.get_child_optional ("acc"))
+                site.unusedBytes = UnusedOffsets (*accesses) * site.blocks;
+
+            profile.sites.push_back (site);
+        }
+
+        return profile;
+    }
+    catch (pt::ptree_error const &e)
+    {
+        throw std::runtime_error (std::string ("malformed DHAT output: ") +
+                                  e.what ());
+    }
+    catch (std::out_of_range const &)
+    {
+        throw std::runtime_error ("malformed DHAT output: "
+                                  "frame out of range");
+    }
+}
+
+yodh::Profile
+yodh::ReadProfileFile (std::string const &path)
+{
+    std::ifstream file (path);
+
+    if (!file)
+        throw std::runtime_error ("could not read " + path);
+
+    return ReadProfile (file);
+}
+
+std::string
+yodh::SiteName (Site const &site)
+{
+    for (std::string const &frame : site.frames)
+    {
+        if (IsAllocatorFrame (frame))
+            continue;
+
+        /* Drop the address, as it is not the same from build to build */
+        size_t const address (frame.find (": "));
+
+        if (boost::starts_with (frame, "0x") && address != std::string::npos)
+            return frame.substr (address + 2);
+
+        return frame;
+    }
+
+    return std::string ();
+}
+
+ymeas::Metrics
+yodh::ClientCodeMetrics (Profile const &profile,
+                         size_t        sites)
+{
+    Sites client;
+
+    std::copy_if (profile.sites.begin (),
+                  profile.sites.end (),
+                  std::back_inserter (client),
+                  InClientCode);
+
+    if (client.empty ())
+        return ymeas::Metrics ();
+
+    double bytes = 0, blocks = 0, reads = 0, writes = 0;
+    double shortLivedBytes = 0, unusedBytes = 0;
+    bool   accessesRecorded = false;
+
+    for (Site const &site : client)
+    {
+        bytes += site.bytes;
+        blocks += site.blocks;
+        reads += site.reads;
+        writes += site.writes;
+
+        if (site.blocks && site.lifetimes >= 0 &&
+            site.lifetimes / site.blocks < profile.shortLivedThreshold)
+            shortLivedBytes += site.bytes;
+
+        if (site.unusedBytes >= 0)
+        {
+            unusedBytes += site.unusedBytes;
+            accessesRecorded = true;
+        }
+    }
+
+    ymeas::Metrics metrics =
+    {
+        { "bytes.allocated", bytes },
+        { "blocks.allocated", blocks },
+        { "reads.per.byte", PerByte (reads, bytes) },
+        { "writes.per.byte", PerByte (writes, bytes) }
+    };
+
+    if (profile.shortLivedThreshold >= 0)
+        metrics.push_back (ymeas::Metric {
+                               "short.lived.fraction",
+                               PerByte (shortLivedBytes, bytes)
+                           });
+
+    if (accessesRecorded)
+        metrics.push_back (ymeas::Metric { "unused.bytes", unusedBytes });
+
+    client = MergedByName (client);
+
+    std::stable_sort (client.begin (),
+                      client.end (),
+                      [](Site const &lhs, Site const &rhs) {
+                          return lhs.bytes > rhs.bytes;
+                      });
+
+    if (client.size () > sites)
+        client.resize (sites);
+
+    for (Site const &site : client)
+    {
+        std::string const name (SiteName (site));
+
+        metrics.push_back ({ "bytes.allocated", site.bytes, name });
+        metrics.push_back ({ "blocks.allocated", site.blocks, name });
+        metrics.push_back ({ "reads.per.byte",
+                             PerByte (site.reads, site.bytes),
+                             name });
+        metrics.push_back ({ "writes.per.byte",
+                             PerByte (site.writes, site.bytes),
+                             name });
+
+        if (site.blocks && site.lifetimes >= 0)
+            metrics.push_back ({ "lifetime.mean",
+                                 site.lifetimes / site.blocks,
+                                 name });
+
+        if (site.unusedBytes >= 0)
+            metrics.push_back ({ "unused.bytes", site.unusedBytes, name });
+    }
+
+    return metrics;
+}
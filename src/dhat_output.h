@@ -0,0 +1,105 @@
+/*
+ * dhat_output.h:
+ * Reads back the JSON output files which DHAT leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_DHAT_OUTPUT_H
+#define YIQI_DHAT_OUTPUT_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace dhat
+        {
+            /**
+             * @brief Site is everything allocated from one stack,
+             * which DHAT calls a program point
+             */
+            struct Site
+            {
+                /* Innermost first, as DHAT describes them,
+                 * eg "0x4005B4: f (a.cpp:10)" */
+                std::vector <std::string> frames;
+
+                double bytes;
+                double blocks;
+
+                /* The sum of how long each block lived, in DHAT's
+                 * time unit, or negative if not recorded */
+                double lifetimes;
+                double reads;
+                double writes;
+
+                /* Bytes which were never read or written, over all
+                 * blocks, or negative if DHAT did not record accesses
+                 * at each offset in the blocks */
+                double unusedBytes;
+            };
+
+            typedef std::vector <Site> Sites;
+
+            struct Profile
+            {
+                /* Blocks which lived for less than this, on average,
+                 * are short-lived, or negative if not recorded */
+                double shortLivedThreshold;
+                Sites  sites;
+            };
+
+            /**
+             * @brief ReadProfile
+             * @param output a stream of DHAT's JSON output
+             * @throws std::runtime_error if the output is malformed or
+             * does not profile the heap
+             * @return every allocation site in the output
+             */
+            Profile ReadProfile (std::istream &output);
+
+            /**
+             * @brief ReadProfileFile
+             * @param path a DHAT output file
+             * @throws std::runtime_error if the file could not be read
+             * or is malformed
+             * @return every allocation site in the file
+             */
+            Profile ReadProfileFile (std::string const &path);
+
+            /**
+             * @brief SiteName
+             * @param site an allocation site
+             * @return the innermost frame in site which is not in an
+             * allocation function, without its address
+             */
+            std::string SiteName (Site const &site);
+
+            /**
+             * @brief ClientCodeMetrics summarises allocation sites which
+             * were reached through yiqi::ExecuteClientCode, as a whole
+             * and for each of the sites which allocated the most
+             * @param profile everything DHAT recorded
+             * @param sites the most sites to report on their own
+             * @return bytes.allocated, blocks.allocated, reads.per.byte,
+             * writes.per.byte and, where recorded, short.lived.fraction
+             * (of bytes) and unused.bytes over all client code sites.
+             * Then, for each site, named by SiteName, with sites of the
+             * same name added together, in order of bytes allocated: bytes.allocated, blocks.allocated,
+             * reads.per.byte, writes.per.byte and, where recorded,
+             * lifetime.mean and unused.bytes. Nothing if client code
+             * allocated nothing.
+             */
+            measurement::Metrics ClientCodeMetrics (Profile const &profile,
+                                                    size_t        sites);
+        }
+    }
+}
+
+#endif // YIQI_DHAT_OUTPUT_H
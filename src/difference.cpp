@@ -0,0 +1,426 @@
+/*
+ * difference.cpp:
+ * Compares everything measured in two runs, down to each function,
+ * to show where a test got more or less expensive
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <tuple>
+
+#include <boost/algorithm/string.hpp>
+
+#include "cachegrind_output.h"
+#include "constants.h"
+#include "difference.h"
+
+namespace yconst = yiqi::constants;
+namespace yocg = yiqi::output::cachegrind;
+namespace ydiff = yiqi::difference;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    /* Test, tool, function and metric */
+    typedef std::tuple <std::string,
+                        std::string,
+                        std::string,
+                        std::string> Key;
+
+    typedef std::pair <std::string, std::string> TestAndTool;
+
+    /* Test, tool and function */
+    typedef std::tuple <std::string,
+                        std::string,
+                        std::string> Group;
+
+    /* The statistics of the timer's samples, which describe the
+     * samples as a whole rather than counting anything */
+    std::set <std::string> const SampleStatistics =
+    {
+        "min.ns",
+        "median.ns",
+        "mean.ns",
+        "stddev.ns",
+        "mad.ns",
+        "ci95.low.ns",
+        "ci95.high.ns"
+    };
+
+    /* Whether two measurements of the same thing can be added
+     * together, which rates, ratios, means and peaks cannot */
+    bool Additive (std::string const &metric)
+    {
+        return !boost::ends_with (metric, ".rate") &&
+               !boost::ends_with (metric, ".fraction") &&
+               !boost::ends_with (metric, ".per.byte") &&
+               !boost::ends_with (metric, ".mean") &&
+               metric.find ("peak.") == std::string::npos &&
+               !SampleStatistics.count (metric);
+    }
+
+    std::string const InclusiveSuffix (".inclusive");
+
+    /* Whether the angle bracket at position is part of the name of
+     * an operator, such as operator<<, rather than the start of
+     * template arguments */
+    bool IsOperator (std::string const &name, size_t position)
+    {
+        std::string const before (name.substr (0, position));
+
+        return boost::ends_with (before, "operator") ||
+               boost::ends_with (before, "operator<");
+    }
+
+    /* Leaves out everything between the outermost angle brackets */
+    std::string WithoutTemplateArguments (std::string const &name)
+    {
+        std::string  stripped;
+        unsigned int depth (0);
+
+        for (size_t i = 0; i < name.size (); ++i)
+        {
+            char const c (name[i]);
+
+            if (c == '<' && depth == 0 && IsOperator (name, i))
+                stripped += c;
+            else if (c == '<')
+            {
+                if (depth++ == 0)
+                    stripped += "<>";
+            }
+            else if (c == '>' && depth > 0)
+                --depth;
+            else if (depth == 0)
+            {
+                /* Including a closing bracket outside of any, as
+                 * in operator-> */
+                stripped += c;
+            }
+        }
+
+        return stripped;
+    }
+
+    std::string FormatValue (double value)
+    {
+        std::stringstream ss;
+        ss << std::setprecision (15) << value;
+        return ss.str ();
+    }
+
+    std::string FormatDelta (ydiff::Change const &change)
+    {
+        std::stringstream ss;
+        ss << std::showpos << std::setprecision (15)
+           << change.after - change.before;
+        return ss.str ();
+    }
+
+    std::string FormatChange (ydiff::Change const &change)
+    {
+        std::stringstream ss;
+
+        if (change.before == 0)
+            ss << "from zero";
+        else
+            ss << std::showpos << std::fixed << std::setprecision (2)
+               << 100 * (change.after - change.before) /
+                  std::fabs (change.before)
+               << "%";
+
+        return ss.str ();
+    }
+
+    double Delta (ydiff::Change const &change)
+    {
+        return change.after - change.before;
+    }
+
+    typedef std::vector <ydiff::Change const *> ChangePointers;
+
+    /* Up to count of the functions whose metric went up the most,
+     * then up to count of those whose metric went down the most */
+    ChangePointers MostChanged (ChangePointers const &functions,
+                                std::string const    &metric,
+                                unsigned int         count)
+    {
+        ChangePointers changed;
+
+        for (ydiff::Change const *change : functions)
+            if (change->metric == metric)
+                changed.push_back (change);
+
+        std::stable_sort (changed.begin (),
+                          changed.end (),
+                          [](ydiff::Change const *a, ydiff::Change const *b) {
+                              return Delta (*a) > Delta (*b);
+                          });
+
+        ChangePointers shown;
+
+        for (size_t i = 0; i < changed.size () && i < count; ++i)
+            if (Delta (*changed[i]) > 0)
+                shown.push_back (changed[i]);
+
+        for (size_t i = 0; i < changed.size () && i < count; ++i)
+        {
+            ydiff::Change const *change (changed[changed.size () - 1 - i]);
+
+            if (Delta (*change) < 0)
+                shown.push_back (change);
+        }
+
+        return shown;
+    }
+}
+
+ydiff::Options::Options () :
+    functions (5)
+{
+}
+
+std::string
+ydiff::CanonicalFunction (std::string const &function)
+{
+    /* Clones made for constant propagation and the like, as
+     * either the symbol or the demangler names them */
+    static std::regex const cloneSuffix (
+        "( \\[clone [^\\]]*\\])|"
+        "(\\.(constprop|isra|part|cold|lto_priv|clone)(\\.[0-9]+)?)");
+    static std::regex const lambdaNumber ("#[0-9]+\\}");
+
+    /* Only the name, not the file, after the first colon */
+    size_t const      colon (function.find (':'));
+    size_t const      nameStart (colon == std::string::npos ? 0 : colon + 1);
+    std::string const file (function.substr (0, nameStart));
+    std::string       name (function.substr (nameStart));
+
+    name = WithoutTemplateArguments (name);
+    name = std::regex_replace (name, cloneSuffix, "");
+    name = std::regex_replace (name, lambdaNumber, "#}");
+
+    return file + name;
+}
+
+ydiff::Changes
+ydiff::Compare (ymeas::Results const &before, ymeas::Results const &after)
+{
+    std::map <Key, double>  beforeValues;
+    std::map <Key, double>  afterValues;
+    std::vector <Key>       order;
+    std::set <TestAndTool>  beforeTests;
+    std::set <TestAndTool>  afterTests;
+
+    /* Measurements which cannot be added together, and which more
+     * than one region or function had in either run, so that there
+     * is nothing to compare them by */
+    std::set <Key>          leftOut;
+
+    auto const add = [&leftOut](ymeas::Results const   &results,
+                                std::map <Key, double> &values,
+                                std::set <TestAndTool> &tests,
+                                std::vector <Key>      &keys) {
+        std::set <Key>                   merged;
+        std::map <Group, ymeas::Metrics> events;
+
+        for (ymeas::Result const &result : results)
+        {
+            std::string const function (
+                result.metric.function.empty () ?
+                    std::string () :
+                    CanonicalFunction (result.metric.function));
+            Key const key (result.test,
+                           result.tool,
+                           function,
+                           result.metric.name);
+
+            auto const inserted (values.insert (std::make_pair (key, 0.0)));
+
+            if (inserted.second)
+                keys.push_back (key);
+            else if (!Additive (result.metric.name))
+                merged.insert (key);
+
+            inserted.first->second += result.metric.value;
+            tests.insert (TestAndTool (result.test, result.tool));
+        }
+
+        for (auto const &value : values)
+        {
+            Key const &key (value.first);
+
+            if (Additive (std::get <3> (key)))
+                events[Group (std::get <0> (key),
+                              std::get <1> (key),
+                              std::get <2> (key))].push_back (
+                    ymeas::Metric { std::get <3> (key), value.second });
+        }
+
+        /* Miss and mispredict rates can be worked out again from
+         * the events they were added up from */
+        for (Key const &key : merged)
+        {
+            Group const group (std::get <0> (key),
+                               std::get <1> (key),
+                               std::get <2> (key));
+            bool        recomputed = false;
+
+            for (ymeas::Metric const &rate : yocg::MissRates (events[group]))
+            {
+                if (rate.name == std::get <3> (key))
+                {
+                    values[key] = rate.value;
+                    recomputed = true;
+                }
+            }
+
+            if (!recomputed)
+                leftOut.insert (key);
+        }
+    };
+
+    std::vector <Key> beforeOrder;
+
+    add (after, afterValues, afterTests, order);
+    add (before, beforeValues, beforeTests, beforeOrder);
+
+    /* Then anything which went away, as it was ordered before */
+    for (Key const &key : beforeOrder)
+        if (!afterValues.count (key))
+            order.push_back (key);
+
+    Changes changes;
+
+    for (Key const &key : order)
+    {
+        TestAndTool const test (std::get <0> (key), std::get <1> (key));
+
+        if (!beforeTests.count (test) || !afterTests.count (test) ||
+            leftOut.count (key))
+            continue;
+
+        auto const beforeValue (beforeValues.find (key));
+        auto const afterValue (afterValues.find (key));
+        bool const wholeTest (std::get <2> (key).empty ());
+
+        if (wholeTest && (beforeValue == beforeValues.end () ||
+                          afterValue == afterValues.end ()))
+            continue;
+
+        Change const change
+        {
+            std::get <0> (key),
+            std::get <1> (key),
+            std::get <3> (key),
+            std::get <2> (key),
+            beforeValue == beforeValues.end () ? 0 : beforeValue->second,
+            afterValue == afterValues.end () ? 0 : afterValue->second
+        };
+
+        if (change.before != change.after)
+            changes.push_back (change);
+    }
+
+    return changes;
+}
+
+void
+ydiff::PrintDifferences (std::ostream  &os,
+                         Changes const &changes,
+                         unsigned int  functions)
+{
+    typedef std::vector <std::string> Row;
+
+    /* Everything which changed in each test, in order */
+    std::vector <TestAndTool>                    tests;
+    std::map <TestAndTool, ChangePointers>       wholeTests;
+    std::map <TestAndTool, ChangePointers>       functionChanges;
+
+    for (Change const &change : changes)
+    {
+        TestAndTool const test (change.test, change.tool);
+
+        if (!wholeTests.count (test) && !functionChanges.count (test))
+            tests.push_back (test);
+
+        if (change.function.empty ())
+            wholeTests[test].push_back (&change);
+        else
+            functionChanges[test].push_back (&change);
+    }
+
+    std::vector <Row> rows =
+    {
+        {
+            "Test", "Tool", "Metric", "Function",
+            "Before", "After", "Delta", "Change"
+        }
+    };
+
+    size_t measurements (0);
+
+    for (TestAndTool const &test : tests)
+    {
+        for (Change const *whole : wholeTests[test])
+        {
+            ++measurements;
+
+            ChangePointers shown (MostChanged (functionChanges[test],
+                                               whole->metric,
+                                               functions));
+            ChangePointers const inclusive (
+                MostChanged (functionChanges[test],
+                             whole->metric + InclusiveSuffix,
+                             functions));
+
+            shown.insert (shown.begin (), whole);
+            shown.insert (shown.end (), inclusive.begin (), inclusive.end ());
+
+            for (Change const *change : shown)
+                rows.push_back (Row {
+                                    change->test,
+                                    change->tool,
+                                    change->metric,
+                                    change->function.empty () ?
+                                        "-" : change->function,
+                                    FormatValue (change->before),
+                                    FormatValue (change->after),
+                                    FormatDelta (*change),
+                                    FormatChange (*change)
+                                });
+        }
+    }
+
+    os << yconst::YiqiDifferenceHeader
+       << measurements
+       << " measurements changed" << std::endl;
+
+    if (!measurements)
+        return;
+
+    std::vector <size_t> widths (rows[0].size (), 0);
+
+    for (Row const &row : rows)
+        for (size_t i = 0; i < row.size (); ++i)
+            widths[i] = std::max (widths[i], row[i].size ());
+
+    for (Row const &row : rows)
+    {
+        os << " ";
+
+        /* The last column is not padded, to avoid trailing spaces */
+        for (size_t i = 0; i + 1 < row.size (); ++i)
+            os << " " << std::left << std::setw (widths[i]) << row[i];
+
+        os << " " << row.back () << std::right << std::endl;
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * difference.h:
+ * Compares everything measured in two runs, down to each function,
+ * to show where a test got more or less expensive
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_DIFFERENCE_H
+#define YIQI_DIFFERENCE_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace difference
+    {
+        struct Options
+        {
+            Options ();
+
+            /* The results file of the earlier run, or empty for none */
+            std::string  before;
+
+            /* The results file of the later run, or empty to compare
+             * against what this run measures */
+            std::string  after;
+
+            /* How many of the functions which changed the most to show,
+             * each way, for each measurement of a test that changed */
+            unsigned int functions;
+        };
+
+        /**
+         * @brief Change is a measurement which was different in the
+         * later run
+         */
+        struct Change
+        {
+            std::string test;
+            std::string tool;
+            std::string metric;
+
+            /* The function, by its CanonicalFunction name, or empty
+             * for all of the test's client code */
+            std::string function;
+
+            double      before;
+            double      after;
+        };
+
+        typedef std::vector <Change> Changes;
+
+        /**
+         * @brief CanonicalFunction names a function so that the same
+         * code is named the same way from one build to the next. Template
+         * arguments are left out, as are the numbers the compiler gives
+         * lambdas and the suffixes it gives specialised clones, so
+         * functions which were only renamed cancel out.
+         * @param function a function as named in a results file, which
+         * is file:name
+         * @return the name to compare by
+         */
+        std::string CanonicalFunction (std::string const &function);
+
+        /**
+         * @brief Compare finds everything which changed between two runs.
+         * Functions are compared by their CanonicalFunction name, with
+         * the costs of each function which shares a name added together,
+         * as are the costs of each region of client code in a test. Miss
+         * and mispredict rates are worked out again from the added up
+         * events, and other measurements which cannot be added, such as
+         * timings and peaks, are left out where there is more than one.
+         * A function which only appears in one run cost nothing in the
+         * other. Tests which were not measured by the same tool in both
+         * runs, and measurements of whole tests which only one run has,
+         * are left out.
+         * @param before what the earlier run measured
+         * @param after what the later run measured
+         * @return the changes, in the order the later run measured them
+         */
+        Changes Compare (measurement::Results const &before,
+                         measurement::Results const &after);
+
+        /**
+         * @brief PrintDifferences prints a table of each measurement of
+         * a whole test which changed, each followed by the functions
+         * whose cost of the same thing, by itself and inclusive of what
+         * it called, went up the most and then went down the most
+         * @param os the stream to print to
+         * @param changes the changes, from Compare
+         * @param functions how many functions to show each way
+         */
+        void PrintDifferences (std::ostream  &os,
+                               Changes const &changes,
+                               unsigned int  functions);
+    }
+}
+
+#endif // YIQI_DIFFERENCE_H
@@ -0,0 +1,395 @@
+/*
+ * flame_graph.cpp:
+ * Folds the call graph in a callgrind profile into stacks, and
+ * draws those stacks as a flame graph
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+#include "flame_graph.h"
+
+namespace yocl = yiqi::output::callgrind;
+namespace yofg = yiqi::output::flamegraph;
+
+namespace
+{
+    /* Stacks cheaper than this much of the total are not followed */
+    double const MinimumShare (1e-5);
+
+    /* Deeper stacks than this are cut short, should the call graph
+     * go round in a cycle which is not caught otherwise */
+    size_t const MaximumDepth (256);
+
+    std::string FrameName (std::string const &function)
+    {
+        /* Semicolons separate the frames of a folded stack */
+        std::string name (function);
+        std::replace (name.begin (), name.end (), ';', ':');
+
+        return name;
+    }
+
+    class Folder
+    {
+        public:
+
+            Folder (yocl::Profile const &profile, size_t event);
+
+            yofg::FoldedStacks Fold ();
+
+        private:
+
+            void FoldFunction (size_t            function,
+                               double            share,
+                               std::string const &stack,
+                               size_t            depth);
+
+            yocl::Profile const &mProfile;
+            size_t const        mEvent;
+            double const        mMinimum;
+
+            /* The calls made by each function */
+            std::vector <std::vector <size_t>> mCallsFrom;
+            std::vector <bool>                 mOnStack;
+
+            yofg::FoldedStacks mStacks;
+    };
+
+    /* One frame of a flame graph, which is the same function
+     * called along the same stack */
+    struct Frame
+    {
+        std::string                     name;
+        double                          cost;
+        std::map <std::string, size_t>  children;
+    };
+
+    typedef std::vector <Frame> Frames;
+
+    double const GraphWidth (1200);
+    double const FrameHeight (16);
+    double const Padding (10);
+    double const TitleHeight (40);
+    double const CharacterWidth (7);
+
+    /* Frames narrower than this could not be seen */
+    double const MinimumWidth (0.1);
+
+    std::string EscapeXML (std::string const &text)
+    {
+        std::string escaped;
+
+        for (char const c : text)
+        {
+            switch (c)
+            {
+                case '&':
+                    escaped += "&amp;";
+                    break;
+                case '<':
+                    escaped += "&lt;";
+                    break;
+                case '>':
+                    escaped += "&gt;";
+                    break;
+                case '"':
+                    escaped += "&quot;";
+                    break;
+                default:
+                    escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    /* Warm colours, the same for the same function every time */
+    std::string FrameColour (std::string const &name)
+    {
+        unsigned long hash (2166136261u);
+
+        for (char const c : name)
+            hash = ((hash ^ static_cast <unsigned char> (c)) * 16777619u) &
+                   0xffffffffu;
+
+        std::stringstream ss;
+        ss << "rgb(" << 205 + hash % 50 << ","
+           << (hash >> 8) % 230 << ","
+           << (hash >> 16) % 55 << ")";
+
+        return ss.str ();
+    }
+
+    /* As much of the name as fits in width, if any of it does */
+    std::string FittedText (std::string const &name, double width)
+    {
+        size_t const fits (static_cast <size_t> (
+                               std::max (0.0, (width - 6) / CharacterWidth)));
+
+        if (fits < 3)
+            return std::string ();
+
+        if (name.size () <= fits)
+            return name;
+
+        return name.substr (0, fits - 2) + "..";
+    }
+
+    size_t Depth (Frames const &frames, size_t frame)
+    {
+        size_t deepest (0);
+
+        for (auto const &child : frames[frame].children)
+            deepest = std::max (deepest, Depth (frames, child.second));
+
+        return deepest + 1;
+    }
+
+    class Drawing
+    {
+        public:
+
+            Drawing (std::ostream      &output,
+                     Frames const      &frames,
+                     std::string const &event,
+                     double            height);
+
+            void Draw (size_t frame, double x, size_t depth);
+
+        private:
+
+            std::ostream      &mOutput;
+            Frames const      &mFrames;
+            std::string const &mEvent;
+            double const      mHeight;
+            double const      mScale;
+    };
+}
+
+Folder::Folder (yocl::Profile const &profile, size_t event) :
+    mProfile (profile),
+    mEvent (event),
+    mMinimum (event < profile.totals.size () ?
+                  profile.totals[event] * MinimumShare :
+                  0),
+    mCallsFrom (profile.functions.size ()),
+    mOnStack (profile.functions.size (), false)
+{
+    for (size_t call = 0; call < profile.calls.size (); ++call)
+        mCallsFrom[profile.calls[call].caller].push_back (call);
+}
+
+yofg::FoldedStacks
+Folder::Fold ()
+{
+    if (mEvent >= mProfile.events.size ())
+        return mStacks;
+
+    /* Whatever a function cost that no call into it accounts for
+     * was spent with it at the bottom of the stack */
+    std::vector <double> called (mProfile.functions.size (), 0);
+
+    for (yocl::Call const &call : mProfile.calls)
+        called[call.callee] += call.inclusive[mEvent];
+
+    for (size_t function = 0; function < mProfile.functions.size ();
+         ++function)
+    {
+        double const share (mProfile.functions[function].inclusive[mEvent] -
+                            called[function]);
+
+        if (share > 0 && share >= mMinimum)
+            FoldFunction (function, share, std::string (), 0);
+    }
+
+    return mStacks;
+}
+
+void
+Folder::FoldFunction (size_t            function,
+                      double            share,
+                      std::string const &stack,
+                      size_t            depth)
+{
+    yocl::FunctionCosts const &costs (mProfile.functions[function]);
+    double const              inclusive (costs.inclusive[mEvent]);
+
+    if (inclusive <= 0)
+        return;
+
+    /* How much of everything the function cost was along this stack */
+    double const      fraction (std::min (1.0, share / inclusive));
+    std::string const frames (stack.empty () ?
+                                  FrameName (costs.name) :
+                                  stack + ";" + FrameName (costs.name));
+    double const      exclusive (costs.exclusive[mEvent] * fraction);
+
+    if (exclusive > 0)
+        mStacks[frames] += exclusive;
+
+    mOnStack[function] = true;
+
+    for (size_t const index : mCallsFrom[function])
+    {
+        yocl::Call const &call (mProfile.calls[index]);
+        double const     callShare (call.inclusive[mEvent] * fraction);
+
+        if (callShare <= 0 || callShare < mMinimum)
+            continue;
+
+        if (mOnStack[call.callee] || depth + 1 >= MaximumDepth)
+        {
+            std::string const &callee (mProfile.functions[call.callee].name);
+            mStacks[frames + ";" + FrameName (callee)] += callShare;
+            continue;
+        }
+
+        FoldFunction (call.callee, callShare, frames, depth + 1);
+    }
+
+    mOnStack[function] = false;
+}
+
+Drawing::Drawing (std::ostream      &output,
+                  Frames const      &frames,
+                  std::string const &event,
+                  double            height) :
+    mOutput (output),
+    mFrames (frames),
+    mEvent (event),
+    mHeight (height),
+    mScale (frames[0].cost > 0 ?
+                (GraphWidth - 2 * Padding) / frames[0].cost :
+                0)
+{
+}
+
+void
+Drawing::Draw (size_t frame, double x, size_t depth)
+{
+    Frame const  &drawn (mFrames[frame]);
+    double const width (drawn.cost * mScale);
+
+    if (width < MinimumWidth)
+        return;
+
+    double const y (mHeight - Padding - (depth + 1) * FrameHeight);
+    double const percent (100 * drawn.cost / mFrames[0].cost);
+    std::string const name (EscapeXML (drawn.name));
+
+    mOutput << "<g><title>" << name << " ("
+            << std::llround (drawn.cost) << " " << EscapeXML (mEvent) << ", "
+            << std::setprecision (2) << std::fixed << percent << "%)</title>"
+            << std::setprecision (1)
+            << "<rect x=\"" << x << "\" y=\"" << y
+            << "\" width=\"" << width << "\" height=\"" << FrameHeight - 1
+            << "\" fill=\"" << FrameColour (drawn.name)
+            << "\" rx=\"2\" ry=\"2\"/>";
+
+    std::string const text (FittedText (drawn.name, width));
+
+    if (!text.empty ())
+        mOutput << "<text x=\"" << x + 3 << "\" y=\""
+                << y + FrameHeight - 4.5 << "\">"
+                << EscapeXML (text) << "</text>";
+
+    mOutput << "</g>\n";
+
+    /* Children sit on top of their caller, left to right by name */
+    double childX (x);
+
+    for (auto const &child : drawn.children)
+    {
+        Draw (child.second, childX, depth + 1);
+        childX += mFrames[child.second].cost * mScale;
+    }
+}
+
+yofg::FoldedStacks
+yofg::FoldStacks (callgrind::Profile const &profile, size_t event)
+{
+    return Folder (profile, event).Fold ();
+}
+
+void
+yofg::MergeStacks (FoldedStacks &into, FoldedStacks const &stacks)
+{
+    for (auto const &stack : stacks)
+        into[stack.first] += stack.second;
+}
+
+void
+yofg::WriteFoldedStacks (std::ostream &output, FoldedStacks const &stacks)
+{
+    for (auto const &stack : stacks)
+    {
+        long long const cost (std::llround (stack.second));
+
+        if (cost > 0)
+            output << stack.first << " " << cost << "\n";
+    }
+}
+
+void
+yofg::WriteFlameGraph (std::ostream       &output,
+                       FoldedStacks const &stacks,
+                       std::string const  &title,
+                       std::string const  &event)
+{
+    /* Everything sits on top of a single frame for the whole graph */
+    Frames frames (1, Frame { "all", 0, {} });
+
+    for (auto const &stack : stacks)
+    {
+        size_t            frame (0);
+        std::stringstream names (stack.first);
+        std::string       name;
+
+        frames[0].cost += stack.second;
+
+        while (std::getline (names, name, ';'))
+        {
+            auto const found (frames[frame].children.find (name));
+            size_t     child;
+
+            if (found == frames[frame].children.end ())
+            {
+                child = frames.size ();
+                frames[frame].children[name] = child;
+                frames.push_back (Frame { name, 0, {} });
+            }
+            else
+                child = found->second;
+
+            frames[child].cost += stack.second;
+            frame = child;
+        }
+    }
+
+    double const height (TitleHeight + Depth (frames, 0) * FrameHeight +
+                         Padding);
+
+    output << std::fixed << std::setprecision (1)
+           << "<?xml version=\"1.0\" standalone=\"no\"?>\n"
+           << "<svg version=\"1.1\" width=\"" << GraphWidth
+           << "\" height=\"" << height
+           << "\" viewBox=\"0 0 " << GraphWidth << " " << height
+           << "\" xmlns=\"http://www.w3.org/2000/svg\">\n"
+           << "<rect x=\"0\" y=\"0\" width=\"100%\" height=\"100%\" "
+           << "fill=\"#f8f8f8\"/>\n"
+           << "<text x=\"" << GraphWidth / 2 << "\" y=\"24\" "
+           << "text-anchor=\"middle\" font-family=\"Verdana\" "
+           << "font-size=\"17\">" << EscapeXML (title) << "</text>\n"
+           << "<g font-family=\"Verdana\" font-size=\"12\">\n";
+
+    Drawing (output, frames, event, height).Draw (0, Padding, 0);
+
+    output << "</g>\n</svg>\n";
+}
@@ -0,0 +1,83 @@
+/*
+ * flame_graph.h:
+ * Folds the call graph in a callgrind profile into stacks, and
+ * draws those stacks as a flame graph
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_FLAME_GRAPH_H
+#define YIQI_FLAME_GRAPH_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+#include "callgrind_output.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace flamegraph
+        {
+            /* The cost of each stack, named from the outermost function
+             * to the innermost, separated by semicolons */
+            typedef std::map <std::string, double> FoldedStacks;
+
+            /**
+             * @brief FoldStacks works out the stacks which were costly in
+             * a profile. Callgrind only records which function called
+             * which, so where a function was called from several places,
+             * what it cost is shared between them in proportion to what
+             * each call cost. A call back into a function already on the
+             * stack is shown as a single frame, and stacks costing less
+             * than a hundred-thousandth of the total are left out.
+             * @param profile a Profile, from ReadProfile
+             * @param event the index of the event to fold, for instance
+             * zero for Ir
+             * @return the exclusive cost of the innermost function of
+             * each stack
+             */
+            FoldedStacks FoldStacks (callgrind::Profile const &profile,
+                                     size_t                   event);
+
+            /**
+             * @brief MergeStacks adds the cost of each of stacks to the
+             * same stack in into, such as to draw a whole suite at once
+             * @param into the stacks to add to
+             * @param stacks the stacks to add
+             */
+            void MergeStacks (FoldedStacks &into, FoldedStacks const &stacks);
+
+            /**
+             * @brief WriteFoldedStacks writes a line of the form
+             * "outer;inner cost" for each stack, which flamegraph.pl,
+             * speedscope and others can read. Costs are rounded to whole
+             * numbers, and stacks rounded down to nothing are left out.
+             * @param output the stream to write to
+             * @param stacks the stacks to write
+             */
+            void WriteFoldedStacks (std::ostream       &output,
+                                    FoldedStacks const &stacks);
+
+            /**
+             * @brief WriteFlameGraph draws stacks as a flame graph, in an
+             * SVG which needs nothing else to be viewed. The outermost
+             * functions are at the bottom, and each function is as wide
+             * as the cost of the stacks it is part of.
+             * @param output the stream to write to
+             * @param stacks the stacks to draw
+             * @param title what to write above the graph
+             * @param event what the costs count, for instance Ir
+             */
+            void WriteFlameGraph (std::ostream       &output,
+                                  FoldedStacks const &stacks,
+                                  std::string const  &title,
+                                  std::string const  &event);
+        }
+    }
+}
+
+#endif // YIQI_FLAME_GRAPH_H
@@ -0,0 +1,150 @@
+/*
+ * heap_counters.cpp:
+ * Counts heap allocations made by client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "heap_counters.h"
+
+namespace yheap = yiqi::heap;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    /* Only plain data, so that it needs no constructor and can be
+     * touched from inside malloc without allocating or locking */
+    struct ThreadState
+    {
+        bool          counting;
+        yheap::Counts counts;
+    };
+
+    thread_local ThreadState state;
+
+    size_t SizeClass (size_t requested)
+    {
+        size_t sizeClass (0);
+
+        while (sizeClass < yheap::SizeClassLimits.size () &&
+               requested > yheap::SizeClassLimits[sizeClass])
+            ++sizeClass;
+
+        return sizeClass;
+    }
+
+    /* Allocates through a pointer the compiler cannot see through,
+     * as a malloc it can see being freed again may be left out */
+    void * (* volatile const ProbeAllocate) (size_t) = std::malloc;
+    void (* volatile const ProbeFree) (void *) = std::free;
+
+    bool AllocationCounted ()
+    {
+        ThreadState const saved (state);
+
+        yheap::StartCounting ();
+        ProbeFree (ProbeAllocate (1));
+        yheap::StopCounting ();
+
+        bool const counted (state.counts.allocations > 0);
+
+        state = saved;
+        return counted;
+    }
+
+    std::string SizeClassName (size_t sizeClass)
+    {
+        std::stringstream ss;
+
+        if (sizeClass < yheap::SizeClassLimits.size ())
+            ss << "heap.allocations.size.le."
+               << yheap::SizeClassLimits[sizeClass];
+        else
+            ss << "heap.allocations.size.gt."
+               << yheap::SizeClassLimits.back ();
+
+        return ss.str ();
+    }
+}
+
+void
+yheap::StartCounting ()
+{
+    state.counts = Counts ();
+    state.counting = true;
+}
+
+void
+yheap::StopCounting ()
+{
+    state.counting = false;
+}
+
+bool
+yheap::Counting ()
+{
+    return state.counting;
+}
+
+yheap::Counts const &
+yheap::ThreadCounts ()
+{
+    return state.counts;
+}
+
+void
+yheap::RecordAllocation (size_t requested, size_t usable)
+{
+    Counts &counts (state.counts);
+
+    ++counts.allocations;
+    counts.bytesAllocated += usable;
+    counts.liveBytes += usable;
+    counts.peakLiveBytes = std::max (counts.peakLiveBytes, counts.liveBytes);
+    ++counts.sizeClasses[SizeClass (requested)];
+}
+
+void
+yheap::RecordFree (size_t usable)
+{
+    Counts &counts (state.counts);
+
+    ++counts.frees;
+    counts.bytesFreed += usable;
+    counts.liveBytes -= usable;
+}
+
+bool
+yheap::AllocationsIntercepted ()
+{
+    /* See heap_interposer.cpp. Whether it replaced the C library's
+     * functions depends on how the program was linked. */
+    static bool const intercepted (AllocationCounted ());
+    return intercepted;
+}
+
+ymeas::Metrics
+yheap::CountMetrics (Counts const &counts)
+{
+    ymeas::Metrics metrics =
+    {
+        { "heap.allocations", double (counts.allocations) },
+        { "heap.frees", double (counts.frees) },
+        { "heap.bytes.allocated", double (counts.bytesAllocated) },
+        { "heap.bytes.freed", double (counts.bytesFreed) },
+        { "heap.peak.live.bytes", double (counts.peakLiveBytes) }
+    };
+
+    for (size_t i = 0; i < counts.sizeClasses.size (); ++i)
+    {
+        if (counts.sizeClasses[i])
+            metrics.push_back ({ SizeClassName (i),
+                                 double (counts.sizeClasses[i]) });
+    }
+
+    return metrics;
+}
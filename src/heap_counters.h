@@ -0,0 +1,109 @@
+/*
+ * heap_counters.h:
+ * Counts heap allocations made by client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_HEAP_COUNTERS_H
+#define YIQI_HEAP_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace heap
+    {
+        /**
+         * @brief SizeClassLimits are the largest requested size, in bytes,
+         * counted in each size class. Anything larger is counted in one
+         * more class after the last.
+         */
+        std::array <size_t, 7> const SizeClassLimits =
+        {
+            { 16, 64, 256, 1024, 4096, 16384, 65536 }
+        };
+
+        /**
+         * @brief Counts is what has happened on the heap since counting
+         * last started on a thread. Bytes are the sizes of the blocks the
+         * allocator actually gave out, as the size asked for is no longer
+         * known when a block is freed. Size classes are by the size asked
+         * for.
+         */
+        struct Counts
+        {
+            uint64_t allocations;
+            uint64_t frees;
+            uint64_t bytesAllocated;
+            uint64_t bytesFreed;
+            int64_t  liveBytes;
+            int64_t  peakLiveBytes;
+            std::array <uint64_t, SizeClassLimits.size () + 1> sizeClasses;
+        };
+
+        /**
+         * @brief StartCounting sets this thread's counts to zero and
+         * starts counting its allocations and frees
+         */
+        void StartCounting ();
+
+        /**
+         * @brief StopCounting stops counting this thread's allocations
+         * and frees, leaving the counts to be read back
+         */
+        void StopCounting ();
+
+        /**
+         * @brief Counting
+         * @return true if this thread's allocations are being counted
+         */
+        bool Counting ();
+
+        /**
+         * @brief ThreadCounts
+         * @return this thread's counts
+         */
+        Counts const & ThreadCounts ();
+
+        /**
+         * @brief RecordAllocation counts an allocation on this thread.
+         * Called by the allocation functions, so it must not allocate.
+         * @param requested the size that was asked for
+         * @param usable the size of the block that was given out
+         */
+        void RecordAllocation (size_t requested, size_t usable);
+
+        /**
+         * @brief RecordFree counts a block being freed on this thread.
+         * Called by the allocation functions, so it must not allocate.
+         * @param usable the size of the block being freed
+         */
+        void RecordFree (size_t usable);
+
+        /**
+         * @brief AllocationsIntercepted finds out whether yiqi's allocation
+         * functions replace the C library's in this program, by checking
+         * that an allocation of its own is counted. They only do when the
+         * program is linked against the yiqi_heap library on glibc.
+         * @return true if there is anything to count
+         */
+        bool AllocationsIntercepted ();
+
+        /**
+         * @brief CountMetrics turns counts into metrics. Size classes with
+         * no allocations in them are left out.
+         * @param counts the counts to report
+         * @return heap.allocations, heap.frees, heap.bytes.allocated,
+         * heap.bytes.freed and heap.peak.live.bytes, followed by
+         * heap.allocations.size.le.N for each size class
+         */
+        measurement::Metrics CountMetrics (Counts const &counts);
+    }
+}
+
+#endif // YIQI_HEAP_COUNTERS_H
@@ -0,0 +1,135 @@
+/*
+ * heap_interposer.cpp:
+ * Replaces the C library's allocation functions with ones which
+ * count the allocations made by client code, then pass each call
+ * on to the C library's own implementation.
+ *
+ * operator new and operator delete are not replaced, as they
+ * allocate with malloc and free, so they are counted here anyway.
+ *
+ * This is the only file in the yiqi_heap library, which only tests
+ * using the heap tool link against, so that nothing else has its
+ * allocator replaced.
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include "heap_counters.h"
+
+namespace yheap = yiqi::heap;
+
+/* Nothing refers to the replacements by name, so the yiqi_heap
+ * library has the linker treat this as undefined, which brings this
+ * file in from the archive */
+extern "C" void
+yiqi_heap_allocation_functions ()
+{
+}
+
+#ifdef __GLIBC__
+
+#include <cerrno>
+
+#include <malloc.h>
+
+extern "C"
+{
+    /* glibc's own implementations, which it exports for exactly
+     * this purpose */
+    void * __libc_malloc (size_t);
+    void * __libc_calloc (size_t, size_t);
+    void * __libc_realloc (void *, size_t);
+    void * __libc_memalign (size_t, size_t);
+    void * __libc_valloc (size_t);
+    void * __libc_pvalloc (size_t);
+    void   __libc_free (void *);
+}
+
+namespace
+{
+    void * Counted (void *block, size_t requested)
+    {
+        if (block && yheap::Counting ())
+            yheap::RecordAllocation (requested, malloc_usable_size (block));
+
+        return block;
+    }
+
+    void CountFree (void *block)
+    {
+        if (block && yheap::Counting ())
+            yheap::RecordFree (malloc_usable_size (block));
+    }
+}
+
+extern "C"
+{
+    void * malloc (size_t size) noexcept
+    {
+        return Counted (__libc_malloc (size), size);
+    }
+
+    void * calloc (size_t count, size_t size) noexcept
+    {
+        return Counted (__libc_calloc (count, size), count * size);
+    }
+
+    void * realloc (void *block, size_t size) noexcept
+    {
+        /* A block which is moved, grown or shrunk counts as the old
+         * one being freed and a new one being allocated. The old size
+         * has to be found first, as the block may be gone afterwards. */
+        bool const counting (block && yheap::Counting ());
+        size_t const oldSize (counting ? malloc_usable_size (block) : 0);
+        void *resized (__libc_realloc (block, size));
+
+        /* On failure the old block is left as it was */
+        if (counting && (resized || size == 0))
+            yheap::RecordFree (oldSize);
+
+        return Counted (resized, size);
+    }
+
+    void free (void *block) noexcept
+    {
+        CountFree (block);
+        __libc_free (block);
+    }
+
+    void * memalign (size_t alignment, size_t size) noexcept
+    {
+        return Counted (__libc_memalign (alignment, size), size);
+    }
+
+    void * aligned_alloc (size_t alignment, size_t size) noexcept
+    {
+        return Counted (__libc_memalign (alignment, size), size);
+    }
+
+    int posix_memalign (void **block, size_t alignment, size_t size) noexcept
+    {
+        if (alignment % sizeof (void *) != 0 ||
+            (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        void *aligned (Counted (__libc_memalign (alignment, size), size));
+
+        if (!aligned)
+            return ENOMEM;
+
+        *block = aligned;
+        return 0;
+    }
+
+    void * valloc (size_t size) noexcept
+    {
+        return Counted (__libc_valloc (size), size);
+    }
+
+    void * pvalloc (size_t size) noexcept
+    {
+        return Counted (__libc_pvalloc (size), size);
+    }
+}
+
+#endif
@@ -6,28 +6,72 @@
  * See LICENCE.md for Copyright information
  */
 
-#include <sstream>
-#include <mutex>
+#include <iostream>
 
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <valgrind/cachegrind.h>
+
+#include "cache_geometry.h"
+#include "cachegrind_output.h"
+#include "callgrind_output.h"
 #include "constants.h"
 #include "instrumentation_tool.h"
 #include "instrumentation_tool_valgrind_base.h"
 #include "instrumentation_tools_available.h"
+#include "source_annotation.h"
 
 namespace yconst = yiqi::constants;
+namespace ygeo = yiqi::geometry;
 namespace yit = yiqi::instrumentation::tools;
 namespace yitv = yiqi::instrumentation::tools::valgrind;
+namespace ymeas = yiqi::measurement;
+namespace yocg = yiqi::output::cachegrind;
+namespace yoan = yiqi::output::annotation;
+namespace yocl = yiqi::output::callgrind;
 
 namespace
 {
     class CachegrindTool :
         public yitv::ToolBase
     {
+        public:
+
+            CachegrindTool (yit::ToolOptions const &options);
+
         private:
 
             Tool::ToolID ToolIdentifier () const;
             std::string const & ToolAdditionalOptions () const;
+            bool WritesOutputFile () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            bool ProcessPerTest () const;
+            ymeas::Metrics ReadProcessResults (pid_t pid) const;
+
+            std::string const mOptions;
+
+            /* Where to write annotated client code, if anywhere, and
+             * what each line cost in every test read back so far */
+            std::string const         mAnnotationDirectory;
+            mutable yoan::Annotation  mAnnotation;
     };
+
+    /* Only client code is counted, and the cache simulation
+     * is off by default in newer versions of cachegrind */
+    std::string const SimulationOptions ("--cache-sim=yes "
+                                         "--instr-at-start=no");
+}
+
+CachegrindTool::CachegrindTool (yit::ToolOptions const &options) :
+    mOptions (boost::trim_right_copy (
+                  SimulationOptions + " " +
+                  ygeo::ValgrindOptions (
+                      ygeo::ProfileCaches (options.cacheProfile)))),
+    mAnnotationDirectory (options.annotationDirectory)
+{
 }
 
 yconst::InstrumentationTool
@@ -39,12 +83,84 @@ CachegrindTool::ToolIdentifier () const
 std::string const &
 CachegrindTool::ToolAdditionalOptions () const
 {
-    static std::string const options ("");
-    return options;
+    return mOptions;
+}
+
+void
+CachegrindTool::StartClientRegion ()
+{
+    CACHEGRIND_START_INSTRUMENTATION;
+}
+
+void
+CachegrindTool::StopClientRegion ()
+{
+    CACHEGRIND_STOP_INSTRUMENTATION;
+}
+
+bool
+CachegrindTool::WritesOutputFile () const
+{
+    return true;
+}
+
+bool
+CachegrindTool::ProcessPerTest () const
+{
+    /* Cachegrind only writes its counts out when the process
+     * exits, so the only way to get counts for each test is
+     * to run each test on its own */
+    return true;
+}
+
+ymeas::Metrics
+CachegrindTool::ReadProcessResults (pid_t pid) const
+{
+    std::string const outputFileName (OutputFile (pid));
+
+    if (access (outputFileName.c_str (), R_OK) != 0)
+        return ymeas::Metrics ();
+
+    /* Cachegrind's output is a subset of callgrind's, so it can
+     * be streamed through the same parser */
+    yocl::Profile const profile (
+        yocl::ReadProfileFile (outputFileName,
+                               !mAnnotationDirectory.empty ()));
+    unlink (outputFileName.c_str ());
+
+    ymeas::Metrics metrics (yocl::EventTotals (profile));
+    ymeas::Metrics const cacheTotals (yocg::CacheTotals (metrics));
+    ymeas::Metrics const functionTotals (yocl::FunctionTotals (profile));
+
+    metrics.insert (metrics.end (), cacheTotals.begin (), cacheTotals.end ());
+    metrics.insert (metrics.end (),
+                    functionTotals.begin (),
+                    functionTotals.end ());
+
+    if (mAnnotationDirectory.empty ())
+        return metrics;
+
+    /* Written again as each test's process is read back, so that
+     * it covers every test so far, and without losing results
+     * should it not be written */
+    try
+    {
+        yoan::AddProfile (mAnnotation, profile);
+        yoan::WriteReports (mAnnotationDirectory,
+                            yconst::StringFromTool (ToolIdentifier ()),
+                            mAnnotation);
+    }
+    catch (std::exception const &e)
+    {
+        std::cerr << "failed to annotate client code: " << e.what ()
+                  << std::endl;
+    }
+
+    return metrics;
 }
 
 yit::ToolUniquePtr
-yit::MakeCachegrindTool ()
+yit::MakeCachegrindTool (ToolOptions const &options)
 {
-    return yit::ToolUniquePtr (new CachegrindTool ());
+    return yit::ToolUniquePtr (new CachegrindTool (options));
 }
@@ -6,45 +6,352 @@
  * See LICENCE.md for Copyright information
  */
 
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <mutex>
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <valgrind/callgrind.h>
+
+#include "cache_geometry.h"
+#include "cachegrind_output.h"
+#include "callgrind_output.h"
 #include "constants.h"
+#include "flame_graph.h"
 #include "instrumentation_tool.h"
 #include "instrumentation_tool_valgrind_base.h"
 #include "instrumentation_tools_available.h"
+#include "source_annotation.h"
 
 namespace yconst = yiqi::constants;
+namespace ygeo = yiqi::geometry;
 namespace yit = yiqi::instrumentation::tools;
 namespace yitv = yiqi::instrumentation::tools::valgrind;
+namespace ymeas = yiqi::measurement;
+namespace yoan = yiqi::output::annotation;
+namespace yocg = yiqi::output::cachegrind;
+namespace yocl = yiqi::output::callgrind;
+namespace yofg = yiqi::output::flamegraph;
 
 namespace
 {
     class CallgrindTool :
         public yitv::ToolBase
     {
+        public:
+
+            CallgrindTool (yit::ToolOptions const &options, bool simulate);
+
         private:
 
             Tool::ToolID ToolIdentifier () const;
             std::string const & ToolAdditionalOptions () const;
+            char const * ValgrindToolName () const;
+            bool WritesOutputFile () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            void StartTest (std::string const &name);
+            void EndTest (std::string const &name);
+            bool DumpsPerTest () const;
+            ymeas::Results ReadTestResults (pid_t pid) const;
+
+            /* Only instrument client code, rather than just only
+             * collecting data from it */
+            bool const        mInstrumentClientCodeOnly;
+
+            /* Simulate the caches and branch predictors, so that
+             * misses and mispredicts are counted in each function */
+            bool const        mSimulate;
+            std::string const mOptions;
+
+            /* Where to draw flame graphs, if anywhere, and the stacks
+             * of every test read back so far, for the whole suite */
+            std::string const          mFlameGraphDirectory;
+            mutable yofg::FoldedStacks mSuiteStacks;
+
+            /* Where to write annotated client code, if anywhere, and
+             * what each line cost in every test read back so far */
+            std::string const          mAnnotationDirectory;
+            mutable yoan::Annotation   mAnnotation;
     };
+
+    std::string const CollectOptions ("--collect-atstart=no");
+    std::string const InstrumentOptions ("--instr-atstart=no");
+
+    /* Jumps are not read back, but make the profiles show which
+     * branches were taken when opened in KCachegrind */
+    std::string const SimulationOptions ("--cache-sim=yes --branch-sim=yes "
+                                         "--collect-jumps=yes");
+
+    /* How callgrind describes a dump made by CALLGRIND_DUMP_STATS_AT */
+    std::string const ClientRequestTrigger ("Client Request: ");
+
+    /* Everything is drawn from the first event, which is Ir */
+    size_t const FlameGraphEvent (0);
+
+    std::string const SuiteFlameGraph ("suite");
+
+    /* Writes name.folded and name.svg for stacks into directory */
+    void WriteFlameGraph (std::string const        &directory,
+                          std::string const        &name,
+                          std::string const        &title,
+                          std::string const        &event,
+                          yofg::FoldedStacks const &stacks)
+    {
+        if (mkdir (directory.c_str (), 0777) == -1 && errno != EEXIST)
+            throw std::runtime_error ("could not create flame graph "
+                                      "directory " + directory);
+
+        /* Parameterised tests have slashes in their names */
+        std::string fileName (name);
+        std::replace (fileName.begin (), fileName.end (), '/', '_');
+
+        std::string const path (directory + "/" + fileName);
+        std::ofstream     folded (path + ".folded", std::ios::trunc);
+        std::ofstream     graph (path + ".svg", std::ios::trunc);
+
+        yofg::WriteFoldedStacks (folded, stacks);
+        yofg::WriteFlameGraph (graph, stacks, title, event);
+
+        if (!folded || !graph)
+            throw std::runtime_error ("could not write flame graph " + path);
+    }
+
+    void Append (ymeas::Metrics &metrics, ymeas::Metrics const &more)
+    {
+        metrics.insert (metrics.end (), more.begin (), more.end ());
+    }
+
+    /* The event totals, along with the cache totals and the miss
+     * and mispredict rates if the profile has the events to work
+     * them out from */
+    ymeas::Metrics TotalMetrics (yocl::Profile const &profile)
+    {
+        ymeas::Metrics metrics (yocl::EventTotals (profile));
+        ymeas::Metrics const events (metrics);
+
+        Append (metrics, yocg::CacheTotals (events));
+        Append (metrics, yocg::MissRates (events));
+        return metrics;
+    }
+
+    /* Everything measured in client code in a profile */
+    ymeas::Metrics ProfileMetrics (yocl::Profile const &profile)
+    {
+        ymeas::Metrics metrics (TotalMetrics (profile));
+
+        Append (metrics, yocl::FunctionTotals (profile));
+        Append (metrics, yocl::FunctionInclusiveTotals (profile));
+        Append (metrics, yocl::FunctionMissRates (profile));
+
+        return metrics;
+    }
+}
+
+CallgrindTool::CallgrindTool (yit::ToolOptions const &options,
+                              bool                    simulate) :
+    mInstrumentClientCodeOnly (options.callgrindFast),
+    mSimulate (simulate),
+    mOptions (boost::trim_right_copy (
+                  (mInstrumentClientCodeOnly ?
+                       CollectOptions + " " + InstrumentOptions :
+                       CollectOptions) + " " +
+                  (mSimulate ? SimulationOptions + " " : std::string ()) +
+                  ygeo::ValgrindOptions (
+                      ygeo::ProfileCaches (options.cacheProfile)))),
+    mFlameGraphDirectory (options.flameGraphDirectory),
+    mAnnotationDirectory (options.annotationDirectory)
+{
 }
 
 yconst::InstrumentationTool
 CallgrindTool::ToolIdentifier () const
 {
-    return yconst::InstrumentationTool::Callgrind;
+    return mSimulate ? yconst::InstrumentationTool::CallgrindSimulation :
+                       yconst::InstrumentationTool::Callgrind;
 }
 
 std::string const &
 CallgrindTool::ToolAdditionalOptions () const
 {
-    static std::string const options ("");
-    return options;
+    /* Collection is toggled on and off around client code */
+    return mOptions;
+}
+
+char const *
+CallgrindTool::ValgrindToolName () const
+{
+    /* Simulating is still callgrind, just with more options */
+    return yconst::StringFromTool (yconst::InstrumentationTool::Callgrind);
+}
+
+void
+CallgrindTool::StartClientRegion ()
+{
+    /* Callgrind has to translate client code again once
+     * instrumentation starts, so this is comparatively slow,
+     * but it is still far cheaper than instrumenting the test
+     * framework */
+    if (mInstrumentClientCodeOnly)
+        CALLGRIND_START_INSTRUMENTATION;
+
+    CALLGRIND_TOGGLE_COLLECT;
+}
+
+void
+CallgrindTool::StopClientRegion ()
+{
+    CALLGRIND_TOGGLE_COLLECT;
+
+    if (mInstrumentClientCodeOnly)
+        CALLGRIND_STOP_INSTRUMENTATION;
+}
+
+bool
+CallgrindTool::WritesOutputFile () const
+{
+    return true;
+}
+
+void
+CallgrindTool::StartTest (std::string const &name)
+{
+    /* Leave out anything collected between tests */
+    CALLGRIND_ZERO_STATS;
+}
+
+void
+CallgrindTool::EndTest (std::string const &name)
+{
+    /* Dumping zeroes the counts again, ready for the next test */
+    CALLGRIND_DUMP_STATS_AT (name.c_str ());
+}
+
+bool
+CallgrindTool::DumpsPerTest () const
+{
+    /* So that a single process is enough to profile every test */
+    return true;
+}
+
+ymeas::Results
+CallgrindTool::ReadTestResults (pid_t pid) const
+{
+    std::string const tool (yconst::StringFromTool (ToolIdentifier ()));
+    ymeas::Results    results;
+
+    /* What the suite's flame graph counts, once there is one */
+    std::string       suiteEvent;
+
+    std::string const outputFileName (OutputFile (pid));
+
+    /* Nothing is collected after the last test, so the dump made
+     * as the process exits is only removed */
+    unlink (outputFileName.c_str ());
+
+    /* Each dump goes to its own file, numbered from one */
+    for (unsigned int part = 1; ; ++part)
+    {
+        std::stringstream profileFileName;
+        profileFileName << outputFileName << "." << part;
+
+        if (access (profileFileName.str ().c_str (), R_OK) != 0)
+            break;
+
+        yocl::Profile const profile (
+            yocl::ReadProfileFile (profileFileName.str (),
+                                   !mAnnotationDirectory.empty ()));
+        unlink (profileFileName.str ().c_str ());
+
+        /* Anything else was not dumped at the end of a test */
+        if (!boost::starts_with (profile.trigger, ClientRequestTrigger))
+            continue;
+
+        std::string const test (
+            profile.trigger.substr (ClientRequestTrigger.size ()));
+
+        for (ymeas::Metric const &metric : ProfileMetrics (profile))
+            results.push_back (ymeas::Result { test, tool, metric });
+
+        if (!mAnnotationDirectory.empty ())
+            yoan::AddProfile (mAnnotation, profile);
+
+        if (mFlameGraphDirectory.empty () ||
+            FlameGraphEvent >= profile.events.size ())
+            continue;
+
+        std::string const &event (profile.events[FlameGraphEvent]);
+
+        /* A graph which cannot be drawn is no reason to lose results */
+        try
+        {
+            yofg::FoldedStacks const stacks (
+                yofg::FoldStacks (profile, FlameGraphEvent));
+
+            yofg::MergeStacks (mSuiteStacks, stacks);
+            suiteEvent = event;
+
+            WriteFlameGraph (mFlameGraphDirectory, test, test, event, stacks);
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to draw flame graph for " << test << ": "
+                      << e.what () << std::endl;
+        }
+    }
+
+    /* Drawn again as each process is read back, so that it
+     * covers the tests from every one of them */
+    if (!suiteEvent.empty ())
+    {
+        try
+        {
+            WriteFlameGraph (mFlameGraphDirectory,
+                             SuiteFlameGraph,
+                             "All tests",
+                             suiteEvent,
+                             mSuiteStacks);
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to draw flame graph for all tests: "
+                      << e.what () << std::endl;
+        }
+    }
+
+    /* Likewise written again to cover every process's tests */
+    if (!mAnnotationDirectory.empty ())
+    {
+        try
+        {
+            yoan::WriteReports (mAnnotationDirectory, tool, mAnnotation);
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to annotate client code: " << e.what ()
+                      << std::endl;
+        }
+    }
+
+    return results;
+}
+
+yit::ToolUniquePtr
+yit::MakeCallgrindTool (ToolOptions const &options)
+{
+    return yit::ToolUniquePtr (new CallgrindTool (options, false));
 }
 
 yit::ToolUniquePtr
-yit::MakeCallgrindTool ()
+yit::MakeCallgrindSimulationTool (ToolOptions const &options)
 {
-    return yit::ToolUniquePtr (new CallgrindTool ());
+    return yit::ToolUniquePtr (new CallgrindTool (options, true));
 }
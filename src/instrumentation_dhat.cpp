@@ -0,0 +1,104 @@
+/*
+ * instrumentation_dhat.cpp:
+ * Provides an implementation of a yiqi::instrumentation::tools::Tool
+ * which profiles how the code under test uses the heap using DHAT
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+
+#include <unistd.h>
+
+#include "constants.h"
+#include "dhat_output.h"
+#include "instrumentation_tool.h"
+#include "instrumentation_tool_valgrind_base.h"
+#include "instrumentation_tools_available.h"
+
+namespace yconst = yiqi::constants;
+namespace yit = yiqi::instrumentation::tools;
+namespace yitv = yiqi::instrumentation::tools::valgrind;
+namespace ymeas = yiqi::measurement;
+namespace yodh = yiqi::output::dhat;
+
+namespace
+{
+    class DhatTool :
+        public yitv::ToolBase
+    {
+        private:
+
+            Tool::ToolID ToolIdentifier () const;
+            std::string const & ToolAdditionalOptions () const;
+            bool WritesOutputFile () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            bool ProcessPerTest () const;
+            ymeas::Metrics ReadProcessResults (pid_t pid) const;
+    };
+
+    /* How many of the sites in client code which allocated
+     * the most are reported on their own */
+    size_t const ReportedSites = 10;
+}
+
+yconst::InstrumentationTool
+DhatTool::ToolIdentifier () const
+{
+    return yconst::InstrumentationTool::Dhat;
+}
+
+std::string const &
+DhatTool::ToolAdditionalOptions () const
+{
+    /* Client code is picked out by yiqi::ExecuteClientCode being on
+     * the stack, which DHAT's default of 12 frames would cut off for
+     * anything allocated more than a few calls into client code */
+    static std::string const options ("--num-callers=500");
+    return options;
+}
+
+void
+DhatTool::StartClientRegion ()
+{
+}
+
+void
+DhatTool::StopClientRegion ()
+{
+}
+
+bool
+DhatTool::WritesOutputFile () const
+{
+    return true;
+}
+
+bool
+DhatTool::ProcessPerTest () const
+{
+    /* DHAT only writes out its profile when the process exits. It
+     * cannot be turned on and off around client code either, so
+     * client code is picked out by the stacks of each allocation. */
+    return true;
+}
+
+ymeas::Metrics
+DhatTool::ReadProcessResults (pid_t pid) const
+{
+    std::string const outputFileName (OutputFile (pid));
+
+    if (access (outputFileName.c_str (), R_OK) != 0)
+        return ymeas::Metrics ();
+
+    yodh::Profile const profile (yodh::ReadProfileFile (outputFileName));
+    unlink (outputFileName.c_str ());
+
+    return yodh::ClientCodeMetrics (profile, ReportedSites);
+}
+
+yit::ToolUniquePtr
+yit::MakeDhatTool (ToolOptions const &)
+{
+    return yit::ToolUniquePtr (new DhatTool ());
+}
@@ -0,0 +1,83 @@
+/*
+ * instrumentation_heap.cpp:
+ * Provides an implementation of a yiqi::instrumentation::tools::Tool
+ * which counts heap allocations made by client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <iostream>
+
+#include "constants.h"
+#include "heap_counters.h"
+#include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
+#include "instrumentation_tools_available.h"
+
+namespace yconst = yiqi::constants;
+namespace yheap = yiqi::heap;
+namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yiqi::instrumentation::tools::native;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    class HeapTool :
+        public yitn::ToolBase
+    {
+        public:
+
+            HeapTool (yit::ToolOptions const &options);
+
+        private:
+
+            yconst::InstrumentationTool ToolIdentifier () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            ymeas::RegionResult ClientRegionResult () const;
+    };
+}
+
+HeapTool::HeapTool (yit::ToolOptions const &options)
+{
+    if (!yheap::AllocationsIntercepted ())
+        std::cerr << yconst::StringFromTool (ToolIdentifier ())
+                  << ": allocations cannot be counted, as the program"
+                  << " is not linked against yiqi_heap or not using glibc"
+                  << std::endl;
+}
+
+yconst::InstrumentationTool
+HeapTool::ToolIdentifier () const
+{
+    return yconst::InstrumentationTool::Heap;
+}
+
+void
+HeapTool::StartClientRegion ()
+{
+    yheap::StartCounting ();
+}
+
+void
+HeapTool::StopClientRegion ()
+{
+    yheap::StopCounting ();
+}
+
+ymeas::RegionResult
+HeapTool::ClientRegionResult () const
+{
+    ymeas::RegionResult result;
+
+    if (yheap::AllocationsIntercepted ())
+        result.metrics = yheap::CountMetrics (yheap::ThreadCounts ());
+
+    return result;
+}
+
+yit::ToolUniquePtr
+yit::MakeHeapTool (ToolOptions const &options)
+{
+    return yit::ToolUniquePtr (new HeapTool (options));
+}
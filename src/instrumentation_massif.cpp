@@ -0,0 +1,103 @@
+/*
+ * instrumentation_massif.cpp:
+ * Provides an implementation of a yiqi::instrumentation::tools::Tool
+ * which profiles the heap and stack usage of the code under test
+ * using massif
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+
+#include <unistd.h>
+
+#include "constants.h"
+#include "instrumentation_tool.h"
+#include "instrumentation_tool_valgrind_base.h"
+#include "instrumentation_tools_available.h"
+#include "massif_output.h"
+
+namespace yconst = yiqi::constants;
+namespace yit = yiqi::instrumentation::tools;
+namespace yitv = yiqi::instrumentation::tools::valgrind;
+namespace ymeas = yiqi::measurement;
+namespace yoms = yiqi::output::massif;
+
+namespace
+{
+    class MassifTool :
+        public yitv::ToolBase
+    {
+        private:
+
+            Tool::ToolID ToolIdentifier () const;
+            std::string const & ToolAdditionalOptions () const;
+            bool WritesOutputFile () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            bool ProcessPerTest () const;
+            ymeas::Metrics ReadProcessResults (pid_t pid) const;
+    };
+
+    /* How many of the functions which allocated the most
+     * at the peak are reported */
+    size_t const PeakAllocations = 10;
+}
+
+yconst::InstrumentationTool
+MassifTool::ToolIdentifier () const
+{
+    return yconst::InstrumentationTool::Massif;
+}
+
+std::string const &
+MassifTool::ToolAdditionalOptions () const
+{
+    /* Stacks are off by default, as they make massif much slower */
+    static std::string const options ("--stacks=yes");
+    return options;
+}
+
+void
+MassifTool::StartClientRegion ()
+{
+}
+
+void
+MassifTool::StopClientRegion ()
+{
+}
+
+bool
+MassifTool::WritesOutputFile () const
+{
+    return true;
+}
+
+bool
+MassifTool::ProcessPerTest () const
+{
+    /* Massif cannot be turned on and off around client code, and
+     * it only writes out its snapshots when the process exits, so
+     * the peak for a test is the peak for a process of its own */
+    return true;
+}
+
+ymeas::Metrics
+MassifTool::ReadProcessResults (pid_t pid) const
+{
+    std::string const outputFileName (OutputFile (pid));
+
+    if (access (outputFileName.c_str (), R_OK) != 0)
+        return ymeas::Metrics ();
+
+    yoms::Snapshots const snapshots (yoms::ReadSnapshotsFile (outputFileName));
+    unlink (outputFileName.c_str ());
+
+    return yoms::PeakMetrics (snapshots, PeakAllocations);
+}
+
+yit::ToolUniquePtr
+yit::MakeMassifTool (ToolOptions const &)
+{
+    return yit::ToolUniquePtr (new MassifTool ());
+}
@@ -6,28 +6,112 @@
  * See LICENCE.md for Copyright information
  */
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <mutex>
 
+#include <boost/algorithm/string.hpp>
+
+#include <valgrind/memcheck.h>
+
 #include "constants.h"
 #include "instrumentation_tool.h"
 #include "instrumentation_tool_valgrind_base.h"
 #include "instrumentation_tools_available.h"
+#include "memcheck_xml.h"
 
 namespace yconst = yiqi::constants;
 namespace yit = yiqi::instrumentation::tools;
 namespace yitv = yiqi::instrumentation::tools::valgrind;
+namespace ymeas = yiqi::measurement;
+namespace yomc = yiqi::output::memcheck;
 
 namespace
 {
+    /* What memcheck had found so far at some point in time */
+    struct MemcheckCounts
+    {
+        unsigned long errors;
+        unsigned long definitelyLost;
+        unsigned long possiblyLost;
+    };
+
     class MemcheckTool :
         public yitv::ToolBase
     {
+        public:
+
+            MemcheckTool ();
+
         private:
 
             Tool::ToolID ToolIdentifier () const;
             std::string const & ToolAdditionalOptions () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            ymeas::RegionResult ClientRegionResult () const;
+            void StartTest (std::string const &name);
+            bool StreamsResults () const;
+            ymeas::TestFailures ConsumeResults (pid_t      stream,
+                                                char const *data,
+                                                size_t     size);
+
+            void ErrorFound (yomc::Error const &error);
+
+            MemcheckCounts mAtStart;
+            MemcheckCounts mAtStop;
+
+            /* Only used in the supervising process, which reads
+             * a separate stream from each instrumented process */
+            typedef std::unique_ptr <yomc::StreamReader> Reader;
+
+            std::map <pid_t, Reader> mReaders;
+            ymeas::TestFailures      mFailures;
     };
+
+    /* Only definite leaks fail a test, as possible leaks
+     * are too often false alarms */
+    bool FailsTest (yomc::Error const &error)
+    {
+        return !boost::starts_with (error.kind, "Leak_") ||
+               error.kind == "Leak_DefinitelyLost";
+    }
+
+    /* Only reports memory which has been leaked since the last leak
+     * check, so leaks are only ever reported in the region which
+     * caused them */
+    MemcheckCounts CheckForNewProblems ()
+    {
+        unsigned long reachable = 0;
+        unsigned long suppressed = 0;
+        MemcheckCounts counts = { 0, 0, 0 };
+
+        VALGRIND_DO_ADDED_LEAK_CHECK;
+        VALGRIND_COUNT_LEAKS (counts.definitelyLost,
+                              counts.possiblyLost,
+                              reachable,
+                              suppressed);
+        /* Still reachable and suppressed memory is not a problem */
+        static_cast <void> (reachable);
+        static_cast <void> (suppressed);
+
+        counts.errors = VALGRIND_COUNT_ERRORS;
+
+        return counts;
+    }
+
+    unsigned long Increase (unsigned long before, unsigned long after)
+    {
+        return after > before ? after - before : 0;
+    }
+}
+
+MemcheckTool::MemcheckTool () :
+    mAtStart ({ 0, 0, 0 }),
+    mAtStop ({ 0, 0, 0 })
+{
 }
 
 yconst::InstrumentationTool
@@ -39,12 +123,104 @@ MemcheckTool::ToolIdentifier () const
 std::string const &
 MemcheckTool::ToolAdditionalOptions () const
 {
-    static std::string const options ("");
+    /* Errors are streamed to the supervising process as XML */
+    static std::string const options ([]() {
+        std::stringstream ss;
+        ss << "--xml=yes --xml-fd=" << yconst::ResultsStreamFd;
+        return ss.str ();
+    } ());
+
     return options;
 }
 
+void
+MemcheckTool::StartClientRegion ()
+{
+    /* Anything leaked by the test framework or fixtures is taken
+     * out of the way here, so that it is not blamed on client code.
+     * The leaks it reports are marked so that they are left out. */
+    VALGRIND_PRINTF ("%s\n", yconst::YiqiEntryLeakCheckMarker);
+    mAtStart = CheckForNewProblems ();
+    VALGRIND_PRINTF ("%s\n", yconst::YiqiEntryLeakCheckDoneMarker);
+}
+
+void
+MemcheckTool::StopClientRegion ()
+{
+    mAtStop = CheckForNewProblems ();
+}
+
+ymeas::RegionResult
+MemcheckTool::ClientRegionResult () const
+{
+    unsigned long const errors (Increase (mAtStart.errors,
+                                          mAtStop.errors));
+    unsigned long const definitelyLost (Increase (mAtStart.definitelyLost,
+                                                  mAtStop.definitelyLost));
+    unsigned long const possiblyLost (Increase (mAtStart.possiblyLost,
+                                                mAtStop.possiblyLost));
+
+    ymeas::RegionResult result;
+
+    result.metrics.push_back (ymeas::Metric { "errors",
+                                              double (errors) });
+    result.metrics.push_back (ymeas::Metric { "definitely.lost.bytes",
+                                              double (definitelyLost) });
+    result.metrics.push_back (ymeas::Metric { "possibly.lost.bytes",
+                                              double (possiblyLost) });
+
+    /* Each error is already streamed to the supervising process
+     * with where it happened, which fails the test from there */
+    return result;
+}
+
+void
+MemcheckTool::StartTest (std::string const &name)
+{
+    /* Shows up in the XML output, so that the supervising process
+     * knows which test to blame errors on */
+    VALGRIND_PRINTF ("%s%s\n", yconst::YiqiTestStartedMarker, name.c_str ());
+}
+
+bool
+MemcheckTool::StreamsResults () const
+{
+    return true;
+}
+
+ymeas::TestFailures
+MemcheckTool::ConsumeResults (pid_t      stream,
+                              char const *data,
+                              size_t     size)
+{
+    Reader &reader (mReaders[stream]);
+
+    if (!reader)
+        reader.reset (new yomc::StreamReader (
+                          std::bind (&MemcheckTool::ErrorFound,
+                                     this,
+                                     std::placeholders::_1)));
+
+    reader->Feed (data, size);
+
+    ymeas::TestFailures failures;
+    failures.swap (mFailures);
+
+    return failures;
+}
+
+void
+MemcheckTool::ErrorFound (yomc::Error const &error)
+{
+    if (FailsTest (error))
+        mFailures.push_back (ymeas::TestFailure {
+                                 error.test,
+                                 yomc::Describe (error)
+                             });
+}
+
 yit::ToolUniquePtr
-yit::MakeMemcheckTool ()
+yit::MakeMemcheckTool (ToolOptions const &)
 {
     return yit::ToolUniquePtr (new MemcheckTool ());
 }
@@ -8,55 +8,32 @@
 
 #include "constants.h"
 #include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
 #include "instrumentation_tools_available.h"
 
 namespace yconst = yiqi::constants;
 namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yiqi::instrumentation::tools::native;
 
 namespace
 {
     class NoneTool :
-        public yit::Tool
+        public yitn::ToolBase
     {
         private:
 
-            std::string const & InstrumentationWrapper () const;
-            std::string const & WrapperOptions () const;
-            std::string const & InstrumentationName () const;
             yconst::InstrumentationTool ToolIdentifier () const;
     };
 }
 
-std::string const &
-NoneTool::InstrumentationName () const
-{
-    static std::string const name (
-        yconst::StringFromTool (ToolIdentifier ()));
-    return name;
-}
-
 yconst::InstrumentationTool
 NoneTool::ToolIdentifier () const
 {
     return yconst::InstrumentationTool::None;
 }
 
-std::string const &
-NoneTool::InstrumentationWrapper () const
-{
-    static std::string const wrapper ("");
-    return wrapper;
-}
-
-std::string const &
-NoneTool::WrapperOptions () const
-{
-    static std::string const options ("");
-    return options;
-}
-
 yit::ToolUniquePtr
-yit::MakeNoneTool ()
+yit::MakeNoneTool (ToolOptions const &)
 {
     return yit::ToolUniquePtr (new NoneTool ());
 }
@@ -8,21 +8,24 @@
 
 #include "constants.h"
 #include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
 #include "instrumentation_tools_available.h"
 
 namespace yconst = yiqi::constants;
 namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yiqi::instrumentation::tools::native;
 
 namespace
 {
     class PassthroughTool :
-        public yit::Tool
+        public yitn::ToolBase
     {
         private:
 
+            /* The process is still wrapped, just by something
+             * which only runs it */
             std::string const & InstrumentationWrapper () const;
             std::string const & WrapperOptions () const;
-            std::string const & InstrumentationName () const;
             yconst::InstrumentationTool ToolIdentifier () const;
     };
 }
@@ -40,14 +43,6 @@ PassthroughTool::InstrumentationWrapper () const
     return wrapper;
 }
 
-std::string const &
-PassthroughTool::InstrumentationName () const
-{
-    static std::string const name (
-        yconst::StringFromTool (ToolIdentifier ()));
-    return name;
-}
-
 std::string const &
 PassthroughTool::WrapperOptions () const
 {
@@ -56,7 +51,7 @@ PassthroughTool::WrapperOptions () const
 }
 
 yit::ToolUniquePtr
-yit::MakePassthroughTool ()
+yit::MakePassthroughTool (ToolOptions const &)
 {
     return yit::ToolUniquePtr (new PassthroughTool ());
 }
@@ -0,0 +1,85 @@
+/*
+ * instrumentation_perf.cpp:
+ * Provides an implementation of a yiqi::instrumentation::tools::Tool
+ * which counts hardware and software events in client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <iostream>
+
+#include "constants.h"
+#include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
+#include "instrumentation_tools_available.h"
+#include "perf_counters.h"
+
+namespace yconst = yiqi::constants;
+namespace ycount = yiqi::counters;
+namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yiqi::instrumentation::tools::native;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    class PerfTool :
+        public yitn::ToolBase
+    {
+        public:
+
+            PerfTool (yit::ToolOptions const &options);
+
+        private:
+
+            yconst::InstrumentationTool ToolIdentifier () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            ymeas::RegionResult ClientRegionResult () const;
+
+            ycount::Counters::Unique mCounters;
+    };
+}
+
+PerfTool::PerfTool (yit::ToolOptions const &options) :
+    mCounters (ycount::MakePerfEventCounters ())
+{
+    /* Carry on with whatever could be opened, but say so, since
+     * the counts people expect might be missing */
+    if (mCounters->Description () != "hardware and software")
+        std::cerr << yconst::StringFromTool (ToolIdentifier ()) << ": counting with "
+                  << mCounters->Description ()
+                  << " counters, see perf_event_paranoid" << std::endl;
+}
+
+yconst::InstrumentationTool
+PerfTool::ToolIdentifier () const
+{
+    return yconst::InstrumentationTool::Perf;
+}
+
+void
+PerfTool::StartClientRegion ()
+{
+    mCounters->Start ();
+}
+
+void
+PerfTool::StopClientRegion ()
+{
+    mCounters->Stop ();
+}
+
+ymeas::RegionResult
+PerfTool::ClientRegionResult () const
+{
+    ymeas::RegionResult result;
+    result.metrics = mCounters->Read ();
+
+    return result;
+}
+
+yit::ToolUniquePtr
+yit::MakePerfTool (ToolOptions const &options)
+{
+    return yit::ToolUniquePtr (new PerfTool (options));
+}
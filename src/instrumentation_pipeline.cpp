@@ -0,0 +1,94 @@
+/*
+ * instrumentation_pipeline.cpp:
+ * Runs a region of client code under several instrumentation
+ * tools at once
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+
+#include <folly/ScopeGuard.h>
+
+#include "constants.h"
+#include "instrumentation_pipeline.h"
+#include "instrumentation_tool.h"
+#include "measurement.h"
+
+namespace yconst = yiqi::constants;
+namespace yit = yiqi::instrumentation::tools;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    /* Tools are started outermost first, so the ones which do the
+     * most to start and stop go outside: rusage reads files, which
+     * allocates, perf makes system calls, and heap only sets a flag.
+     * Nothing the outer tools do is then counted by the inner ones. */
+    unsigned int
+    NestingDepth (yconst::InstrumentationTool tool)
+    {
+        switch (tool)
+        {
+            case yconst::InstrumentationTool::Rusage:
+                return 0;
+            case yconst::InstrumentationTool::Perf:
+                return 1;
+            case yconst::InstrumentationTool::Heap:
+                return 3;
+            default:
+                return 2;
+        }
+    }
+}
+
+std::vector <ymeas::RegionResult>
+yit::RunClientCodeUnderEach (std::vector <Tool::Unique> const &tools,
+                             Tool::ClientCode           const &code)
+{
+    std::vector <ymeas::RegionResult> results (tools.size ());
+    std::vector <size_t>              nested;
+
+    for (size_t i = 0; i < tools.size (); ++i)
+        if (!tools[i]->RepeatsClientCode ())
+            nested.push_back (i);
+
+    std::stable_sort (nested.begin (),
+                      nested.end (),
+                      [&tools](size_t lhs, size_t rhs) {
+                          return NestingDepth (tools[lhs]->ToolIdentifier ()) <
+                                 NestingDepth (tools[rhs]->ToolIdentifier ());
+                      });
+
+    if (!nested.empty ())
+    {
+        size_t started = 0;
+
+        /* Always stop whatever was started, innermost first, even if
+         * the client code throws, otherwise we would go on to measure
+         * the test framework */
+        auto stopRegions = folly::makeGuard ([&tools, &nested, &started]() {
+            while (started > 0)
+                tools[nested[--started]]->StopClientRegion ();
+        });
+
+        for (size_t i : nested)
+        {
+            tools[i]->StartClientRegion ();
+            ++started;
+        }
+
+        code ();
+    }
+
+    for (size_t i : nested)
+        results[i] = tools[i]->ClientRegionResult ();
+
+    /* The tools which repeat the client code go last, so that the
+     * others see its first run, as they would on their own */
+    for (size_t i = 0; i < tools.size (); ++i)
+        if (tools[i]->RepeatsClientCode ())
+            results[i] = tools[i]->RunClientCode (code);
+
+    return results;
+}
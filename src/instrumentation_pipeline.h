@@ -0,0 +1,41 @@
+/*
+ * instrumentation_pipeline.h:
+ * Runs a region of client code under several instrumentation
+ * tools at once
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_INSTRUMENTATION_PIPELINE_H
+#define YIQI_INSTRUMENTATION_PIPELINE_H
+
+#include <vector>
+
+#include "instrumentation_tool.h"
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace instrumentation
+    {
+        namespace tools
+        {
+            /**
+             * @brief RunClientCodeUnderEach runs code once with every
+             * tool which does not repeat it measuring that same run,
+             * then has the tools which repeat it run it themselves.
+             * What a tool counts therefore does not depend on which
+             * other tools it runs with.
+             * @param tools the tools to measure code under
+             * @param code the client code to run
+             * @return what each tool measured or found wrong, in the
+             * order of tools
+             */
+            std::vector <measurement::RegionResult>
+            RunClientCodeUnderEach (std::vector <Tool::Unique> const &tools,
+                                    Tool::ClientCode           const &code);
+        }
+    }
+}
+
+#endif // YIQI_INSTRUMENTATION_PIPELINE_H
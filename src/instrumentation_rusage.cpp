@@ -0,0 +1,82 @@
+/*
+ * instrumentation_rusage.cpp:
+ * Provides an implementation of a yiqi::instrumentation::tools::Tool
+ * which measures the processor time, context switches, page faults,
+ * memory and I/O used by client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include "constants.h"
+#include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
+#include "instrumentation_tools_available.h"
+#include "resource_usage.h"
+
+namespace yconst = yiqi::constants;
+namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yiqi::instrumentation::tools::native;
+namespace ymeas = yiqi::measurement;
+namespace yres = yiqi::resources;
+
+namespace
+{
+    class RusageTool :
+        public yitn::ToolBase
+    {
+        public:
+
+            RusageTool (yit::ToolOptions const &options);
+
+        private:
+
+            yconst::InstrumentationTool ToolIdentifier () const;
+            void StartClientRegion ();
+            void StopClientRegion ();
+            ymeas::RegionResult ClientRegionResult () const;
+
+            yres::Usage mEntry;
+            yres::Usage mExit;
+    };
+}
+
+RusageTool::RusageTool (yit::ToolOptions const &options) :
+    mEntry (),
+    mExit ()
+{
+}
+
+yconst::InstrumentationTool
+RusageTool::ToolIdentifier () const
+{
+    return yconst::InstrumentationTool::Rusage;
+}
+
+void
+RusageTool::StartClientRegion ()
+{
+    /* Best effort, the peak is since the process started otherwise */
+    yres::ResetPeakResidentSize ();
+    mEntry = yres::Sample ();
+}
+
+void
+RusageTool::StopClientRegion ()
+{
+    mExit = yres::Sample ();
+}
+
+ymeas::RegionResult
+RusageTool::ClientRegionResult () const
+{
+    ymeas::RegionResult result;
+    result.metrics = yres::UsageMetrics (mEntry, mExit);
+
+    return result;
+}
+
+yit::ToolUniquePtr
+yit::MakeRusageTool (ToolOptions const &options)
+{
+    return yit::ToolUniquePtr (new RusageTool (options));
+}
@@ -1,62 +1,112 @@
 /*
  * instrumentation_timer.h:
  * Provides an implementation of a yiqi::instrumentation::tools::Tool
- * which would provide timing data
+ * which times client code in-process
  *
  * See LICENCE.md for Copyright information
  */
 
+#include "clocks.h"
 #include "constants.h"
 #include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
 #include "instrumentation_tools_available.h"
+#include "statistics.h"
 
 namespace yconst = yiqi::constants;
 namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yiqi::instrumentation::tools::native;
+namespace ymeas = yiqi::measurement;
+namespace ystat = yiqi::statistics;
+namespace ytime = yiqi::timing;
 
 namespace
 {
     class TimerTool :
-        public yit::Tool
+        public yitn::ToolBase
     {
+        public:
+
+            TimerTool (yit::ToolOptions const &options);
+
         private:
 
-            std::string const & InstrumentationWrapper () const;
-            std::string const & WrapperOptions () const;
-            std::string const & InstrumentationName () const;
             yconst::InstrumentationTool ToolIdentifier () const;
+            ymeas::RegionResult RunClientCode (ClientCode const &code);
+
+            /* Timing needs many runs, so the client code cannot be
+             * timed in the same run as other tools measure it */
+            bool RepeatsClientCode () const;
+
+            ytime::Clock::Unique mClock;
+            unsigned int         mWarmup;
+            unsigned int         mIterations;
     };
 }
 
+TimerTool::TimerTool (yit::ToolOptions const &options) :
+    mClock (ytime::MakeBestClock ()),
+    mWarmup (options.timerWarmup),
+    mIterations (options.timerIterations)
+{
+}
+
 yconst::InstrumentationTool
 TimerTool::ToolIdentifier () const
 {
     return yconst::InstrumentationTool::Timer;
 }
 
-std::string const &
-TimerTool::InstrumentationName () const
+ymeas::RegionResult
+TimerTool::RunClientCode (ClientCode const &code)
 {
-    static std::string const name (
-        yconst::StringFromTool (ToolIdentifier ()));
-    return name;
-}
+    /* Fill the caches and branch predictors, and get any lazy
+     * initialisation out of the way */
+    for (unsigned int i = 0; i < mWarmup; ++i)
+        code ();
 
-std::string const &
-TimerTool::InstrumentationWrapper () const
-{
-    static std::string const wrapper ("");
-    return wrapper;
+    ystat::Samples samples;
+    samples.reserve (mIterations);
+
+    for (unsigned int i = 0; i < mIterations; ++i)
+    {
+        ytime::Clock::Ticks const start (mClock->Now ());
+        code ();
+        ytime::Clock::Ticks const end (mClock->Now ());
+
+        samples.push_back (mClock->Nanoseconds (end - start));
+    }
+
+    ymeas::RegionResult result;
+
+    if (samples.empty ())
+        return result;
+
+    ystat::Summary const summary (ystat::Summarise (samples));
+
+    result.metrics =
+    {
+        { "iterations", double (samples.size ()) },
+        { "min.ns", summary.min },
+        { "median.ns", summary.median },
+        { "mean.ns", summary.mean },
+        { "stddev.ns", summary.stddev },
+        { "mad.ns", summary.mad },
+        { "ci95.low.ns", summary.ciLow },
+        { "ci95.high.ns", summary.ciHigh }
+    };
+
+    return result;
 }
 
-std::string const &
-TimerTool::WrapperOptions () const
+bool
+TimerTool::RepeatsClientCode () const
 {
-    static std::string const options ("");
-    return options;
+    return true;
 }
 
 yit::ToolUniquePtr
-yit::MakeTimerTool ()
+yit::MakeTimerTool (ToolOptions const &options)
 {
-    return yit::ToolUniquePtr (new TimerTool ());
+    return yit::ToolUniquePtr (new TimerTool (options));
 }
@@ -10,10 +10,14 @@
 #ifndef YIQI_INSTRUMENTATION_TOOL_H
 #define YIQI_INSTRUMENTATION_TOOL_H
 
+#include <functional>
 #include <string>
 #include <memory>
 
+#include <sys/types.h>
+
 #include <constants.h>
+#include <measurement.h>
 
 namespace yiqi
 {
@@ -36,6 +40,7 @@ namespace yiqi
 
                     typedef std::unique_ptr <Tool> Unique;
                     typedef yiqi::constants::InstrumentationTool ToolID;
+                    typedef std::function <void ()> ClientCode;
 
                     virtual ~Tool () {};
 
@@ -65,6 +70,126 @@ namespace yiqi
                      */
                     virtual ToolID ToolIdentifier () const = 0;
 
+                    /**
+                     * @brief RunClientCode runs a region of client code
+                     * inside of the instrumented process, such that only
+                     * that region contributes to the instrumentation
+                     * results
+                     * @param code the client code to run
+                     * @return anything the tool measured or found wrong
+                     * in that region
+                     */
+                    virtual measurement::RegionResult
+                    RunClientCode (ClientCode const &code) = 0;
+
+                    /**
+                     * @brief RepeatsClientCode
+                     * @return true if RunClientCode runs the client code
+                     * more than once, so that this tool cannot measure
+                     * the same single run as other tools
+                     */
+                    virtual bool RepeatsClientCode () const = 0;
+
+                    /**
+                     * @brief StartClientRegion starts measuring a single
+                     * run of client code, which other tools may be
+                     * measuring at the same time. Not called for tools
+                     * which repeat client code.
+                     */
+                    virtual void StartClientRegion () = 0;
+
+                    /**
+                     * @brief StopClientRegion is called once client
+                     * code has finished running, even if it threw
+                     */
+                    virtual void StopClientRegion () = 0;
+
+                    /**
+                     * @brief ClientRegionResult is called once every
+                     * tool measuring the region has been stopped
+                     * @return anything the tool measured or found wrong
+                     * in that region
+                     */
+                    virtual measurement::RegionResult
+                    ClientRegionResult () const = 0;
+
+                    /**
+                     * @brief ProcessPerTest
+                     * @return true if this tool can only tell tests apart
+                     * by running each of them in its own instrumented
+                     * process
+                     */
+                    virtual bool ProcessPerTest () const = 0;
+
+                    /**
+                     * @brief ReadProcessResults reads back whatever an
+                     * instrumented process left behind once it has exited
+                     * @param pid the process id of the instrumented process
+                     * @throws std::runtime_error if the results were
+                     * malformed
+                     * @return the metrics measured in that process's
+                     * client code, or nothing if it left nothing behind
+                     */
+                    virtual measurement::Metrics
+                    ReadProcessResults (pid_t pid) const = 0;
+
+                    /**
+                     * @brief StartTest is called inside of the instrumented
+                     * process just before each test starts
+                     * @param name the full name (Case.Test) of the test
+                     */
+                    virtual void StartTest (std::string const &name) = 0;
+
+                    /**
+                     * @brief EndTest is called inside of the instrumented
+                     * process just after each test ends
+                     * @param name the full name (Case.Test) of the test
+                     */
+                    virtual void EndTest (std::string const &name) = 0;
+
+                    /**
+                     * @brief DumpsPerTest
+                     * @return true if a single instrumented process leaves
+                     * results behind for each test it ran, which
+                     * ReadTestResults reads back once it has exited
+                     */
+                    virtual bool DumpsPerTest () const = 0;
+
+                    /**
+                     * @brief ReadTestResults reads back the results for
+                     * each test which an instrumented process left behind
+                     * @param pid the process id of the instrumented process
+                     * @throws std::runtime_error if the results were
+                     * malformed
+                     * @return the metrics measured in each test's client
+                     * code, or nothing if it left nothing behind
+                     */
+                    virtual measurement::Results
+                    ReadTestResults (pid_t pid) const = 0;
+
+                    /**
+                     * @brief StreamsResults
+                     * @return true if the instrumented process writes results
+                     * to yiqi::constants::ResultsStreamFd as it runs, which
+                     * a supervising process should read with ConsumeResults
+                     */
+                    virtual bool StreamsResults () const = 0;
+
+                    /**
+                     * @brief ConsumeResults reads the next piece of what an
+                     * instrumented process wrote to its results stream
+                     * @param stream the process id of the instrumented
+                     * process, as there may be more than one at once
+                     * @param data the next piece of the stream
+                     * @param size the length of data
+                     * @throws std::runtime_error if the stream is malformed
+                     * @return any problems found in that piece
+                     */
+                    virtual measurement::TestFailures
+                    ConsumeResults (pid_t      stream,
+                                    char const *data,
+                                    size_t     size) = 0;
+
                 protected:
 
                     Tool () = default;
@@ -0,0 +1,129 @@
+/*
+ * instrumentation_tool_native_base.cpp:
+ * Provides a template for building instrumentation tools which
+ * measure client code from inside the test process, without any
+ * instrumentation wrapper
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <folly/ScopeGuard.h>
+
+#include "constants.h"
+#include "instrumentation_tool.h"
+#include "instrumentation_tool_native_base.h"
+
+namespace yconst = yiqi::constants;
+namespace yit = yiqi::instrumentation::tools;
+namespace yitn = yit::native;
+
+std::string const &
+yitn::ToolBase::InstrumentationWrapper () const
+{
+    static std::string const wrapper ("");
+    return wrapper;
+}
+
+std::string const &
+yitn::ToolBase::WrapperOptions () const
+{
+    static std::string const options ("");
+    return options;
+}
+
+std::string const &
+yitn::ToolBase::InstrumentationName () const
+{
+    if (mInstrumentationName.empty ())
+        mInstrumentationName = yconst::StringFromTool (ToolIdentifier ());
+
+    return mInstrumentationName;
+}
+
+yiqi::measurement::RegionResult
+yitn::ToolBase::RunClientCode (ClientCode const &code)
+{
+    StartClientRegion ();
+
+    {
+        /* Always stop the region, even if the client code throws,
+         * otherwise we would go on to measure the test framework */
+        auto stopRegion = folly::makeGuard ([this]() {
+                                                StopClientRegion ();
+                                            });
+
+        code ();
+    }
+
+    return ClientRegionResult ();
+}
+
+bool
+yitn::ToolBase::RepeatsClientCode () const
+{
+    return false;
+}
+
+void
+yitn::ToolBase::StartClientRegion ()
+{
+}
+
+void
+yitn::ToolBase::StopClientRegion ()
+{
+}
+
+yiqi::measurement::RegionResult
+yitn::ToolBase::ClientRegionResult () const
+{
+    return yiqi::measurement::RegionResult ();
+}
+
+bool
+yitn::ToolBase::ProcessPerTest () const
+{
+    return false;
+}
+
+yiqi::measurement::Metrics
+yitn::ToolBase::ReadProcessResults (pid_t pid) const
+{
+    return yiqi::measurement::Metrics ();
+}
+
+void
+yitn::ToolBase::StartTest (std::string const &name)
+{
+}
+
+void
+yitn::ToolBase::EndTest (std::string const &name)
+{
+}
+
+bool
+yitn::ToolBase::DumpsPerTest () const
+{
+    return false;
+}
+
+yiqi::measurement::Results
+yitn::ToolBase::ReadTestResults (pid_t pid) const
+{
+    return yiqi::measurement::Results ();
+}
+
+bool
+yitn::ToolBase::StreamsResults () const
+{
+    return false;
+}
+
+yiqi::measurement::TestFailures
+yitn::ToolBase::ConsumeResults (pid_t      stream,
+                                char const *data,
+                                size_t     size)
+{
+    return yiqi::measurement::TestFailures ();
+}
@@ -0,0 +1,76 @@
+/*
+ * instrumentation_tool_native_base.h:
+ * Provides a template for building instrumentation tools which
+ * measure client code from inside the test process, without any
+ * instrumentation wrapper
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_INSTRUMENTATION_TOOL_NATIVE_BASE_H
+#define YIQI_INSTRUMENTATION_TOOL_NATIVE_BASE_H
+
+#include "instrumentation_tool.h"
+
+namespace yiqi
+{
+    namespace instrumentation
+    {
+        namespace tools
+        {
+            namespace native
+            {
+                class ToolBase :
+                    public yiqi::instrumentation::tools::Tool
+                {
+                    protected:
+
+                        ToolBase () = default;
+
+                    private:
+
+                        /* Nothing wraps the test process, so client
+                         * code runs in the same process as main () */
+                        std::string const & InstrumentationWrapper () const;
+                        std::string const & WrapperOptions () const;
+                        std::string const & InstrumentationName () const;
+
+                        /* By default, client code runs once between
+                         * StartClientRegion and StopClientRegion, which
+                         * do nothing, and nothing is measured */
+                        measurement::RegionResult
+                        RunClientCode (ClientCode const &code);
+                        bool RepeatsClientCode () const;
+                        void StartClientRegion ();
+                        void StopClientRegion ();
+                        measurement::RegionResult
+                        ClientRegionResult () const;
+
+                        /* Everything is measured as each region of
+                         * client code runs, so there is nothing to
+                         * read back afterwards, and tests and streams
+                         * of results do not matter */
+                        bool ProcessPerTest () const;
+                        measurement::Metrics
+                        ReadProcessResults (pid_t pid) const;
+                        void StartTest (std::string const &name);
+                        void EndTest (std::string const &name);
+                        bool DumpsPerTest () const;
+                        measurement::Results
+                        ReadTestResults (pid_t pid) const;
+                        bool StreamsResults () const;
+                        measurement::TestFailures
+                        ConsumeResults (pid_t      stream,
+                                        char const *data,
+                                        size_t     size);
+
+                        /* Computed on first use, as it depends on
+                         * what the derived tool provides */
+                        mutable std::string mInstrumentationName;
+                };
+            }
+        }
+    }
+}
+
+#endif // YIQI_INSTRUMENTATION_TOOL_NATIVE_BASE_H
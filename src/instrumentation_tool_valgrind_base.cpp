@@ -6,8 +6,10 @@
  * See LICENCE.md for Copyright information
  */
 
+#include <cstdlib>
 #include <sstream>
-#include <mutex>
+
+#include <folly/ScopeGuard.h>
 
 #include "constants.h"
 #include "instrumentation_tool.h"
@@ -27,23 +29,136 @@ yitv::ToolBase::InstrumentationWrapper () const
 std::string const &
 yitv::ToolBase::WrapperOptions () const
 {
-    static std::stringstream ss;
-    static std::once_flag    fillStringStreamOnce;
+    if (mWrapperOptions.empty ())
+    {
+        std::string const &additional (ToolAdditionalOptions ());
+        std::stringstream ss;
+
+        ss << yconst::ValgrindToolOptionPrefix << ValgrindToolName ();
+
+        if (!additional.empty ())
+            ss << " " << additional;
+
+        /* Named through the environment, so that the options are the
+         * same from one run to the next, and each process by its pid */
+        if (WritesOutputFile ())
+            ss << " --" << ValgrindToolName () << "-out-file=%q{"
+               << yconst::YiqiOutputDirectoryEnvKey << "}/"
+               << ValgrindToolName () << ".out.%p";
 
-    std::call_once (fillStringStreamOnce, [&]() {
-                        ss << yconst::ValgrindToolOptionPrefix
-                           << yconst::StringFromTool (ToolIdentifier ())
-                           << ToolAdditionalOptions ();
-                    });
+        mWrapperOptions = ss.str ();
+    }
 
-    static std::string const options (ss.str ());
-    return options;
+    return mWrapperOptions;
 }
 
 std::string const &
 yitv::ToolBase::InstrumentationName () const
 {
-    static std::string const name (
-        yconst::StringFromTool (ToolIdentifier ()));
-    return name;
+    if (mInstrumentationName.empty ())
+        mInstrumentationName = yconst::StringFromTool (ToolIdentifier ());
+
+    return mInstrumentationName;
+}
+
+char const *
+yitv::ToolBase::ValgrindToolName () const
+{
+    return yconst::StringFromTool (ToolIdentifier ());
+}
+
+bool
+yitv::ToolBase::WritesOutputFile () const
+{
+    return false;
+}
+
+std::string
+yitv::ToolBase::OutputFile (pid_t pid) const
+{
+    char const *directory = getenv (yconst::YiqiOutputDirectoryEnvKey);
+    std::stringstream ss;
+
+    ss << (directory ? directory : ".") << "/"
+       << ValgrindToolName () << ".out." << pid;
+
+    return ss.str ();
+}
+
+yiqi::measurement::RegionResult
+yitv::ToolBase::RunClientCode (ClientCode const &code)
+{
+    StartClientRegion ();
+
+    {
+        /* Always stop the region, even if the client code throws,
+         * otherwise we would go on to measure the test framework */
+        auto stopRegion = folly::makeGuard ([this]() {
+                                                StopClientRegion ();
+                                            });
+
+        code ();
+    }
+
+    return ClientRegionResult ();
+}
+
+bool
+yitv::ToolBase::RepeatsClientCode () const
+{
+    return false;
+}
+
+yiqi::measurement::RegionResult
+yitv::ToolBase::ClientRegionResult () const
+{
+    return yiqi::measurement::RegionResult ();
+}
+
+bool
+yitv::ToolBase::ProcessPerTest () const
+{
+    return false;
+}
+
+yiqi::measurement::Metrics
+yitv::ToolBase::ReadProcessResults (pid_t pid) const
+{
+    return yiqi::measurement::Metrics ();
+}
+
+void
+yitv::ToolBase::StartTest (std::string const &name)
+{
+}
+
+void
+yitv::ToolBase::EndTest (std::string const &name)
+{
+}
+
+bool
+yitv::ToolBase::DumpsPerTest () const
+{
+    return false;
+}
+
+yiqi::measurement::Results
+yitv::ToolBase::ReadTestResults (pid_t pid) const
+{
+    return yiqi::measurement::Results ();
+}
+
+bool
+yitv::ToolBase::StreamsResults () const
+{
+    return false;
+}
+
+yiqi::measurement::TestFailures
+yitv::ToolBase::ConsumeResults (pid_t      stream,
+                                char const *data,
+                                size_t     size)
+{
+    return yiqi::measurement::TestFailures ();
 }
@@ -26,13 +26,87 @@ namespace yiqi
 
                         ToolBase () = default;
 
+                        /**
+                         * @brief OutputFile is where valgrind wrote the
+                         * output file of the process pid, for tools
+                         * which write one
+                         * @param pid the process which was instrumented
+                         * @return the path of the file, in the directory
+                         * named by YiqiOutputDirectoryEnvKey
+                         */
+                        std::string OutputFile (pid_t pid) const;
+
                     private:
 
                         std::string const & InstrumentationWrapper () const;
                         std::string const & WrapperOptions () const;
                         std::string const & InstrumentationName () const;
+                        measurement::RegionResult
+                        RunClientCode (ClientCode const &code);
+                        bool RepeatsClientCode () const;
+
+                        /* Most valgrind tools can tell tests apart
+                         * without re-launching, or leave nothing behind */
+                        bool ProcessPerTest () const;
+                        measurement::Metrics
+                        ReadProcessResults (pid_t pid) const;
+
+                        /* Nor do most of them need to know about tests,
+                         * or stream their results */
+                        void StartTest (std::string const &name);
+                        void EndTest (std::string const &name);
+                        bool DumpsPerTest () const;
+                        measurement::Results
+                        ReadTestResults (pid_t pid) const;
+                        bool StreamsResults () const;
+                        measurement::TestFailures
+                        ConsumeResults (pid_t      stream,
+                                        char const *data,
+                                        size_t     size);
 
                         virtual std::string const & ToolAdditionalOptions () const = 0;
+
+                        /**
+                         * @brief ValgrindToolName is what is passed to
+                         * valgrind's --tool option. By default, the
+                         * tool's own name.
+                         */
+                        virtual char const * ValgrindToolName () const;
+
+                        /**
+                         * @brief WritesOutputFile is whether the tool
+                         * writes an output file, which then goes into
+                         * the directory for this run rather than the
+                         * working directory. By default, false.
+                         */
+                        virtual bool WritesOutputFile () const;
+
+                        /**
+                         * @brief StartClientRegion is called just before
+                         * client code runs, and should make the tool
+                         * start measuring, usually by way of a valgrind
+                         * client request
+                         */
+                        virtual void StartClientRegion () = 0;
+
+                        /**
+                         * @brief StopClientRegion is called once client
+                         * code has finished running, even if it threw
+                         */
+                        virtual void StopClientRegion () = 0;
+
+                        /**
+                         * @brief ClientRegionResult is called once the
+                         * region has been stopped, to find out what the
+                         * tool found in that region. By default, nothing.
+                         */
+                        virtual measurement::RegionResult
+                        ClientRegionResult () const;
+
+                        /* Computed on first use, as they depend on
+                         * what the derived tool provides */
+                        mutable std::string mWrapperOptions;
+                        mutable std::string mInstrumentationName;
                 };
             }
         }
@@ -6,3 +6,16 @@
  *
  * See LICENCE.md for Copyright information
  */
+
+#include "cache_geometry.h"
+#include "instrumentation_tools_available.h"
+
+namespace yit = yiqi::instrumentation::tools;
+
+yit::ToolOptions::ToolOptions () :
+    callgrindFast (false),
+    timerWarmup (1),
+    timerIterations (10),
+    cacheProfile (yiqi::geometry::HostProfile)
+{
+}
@@ -11,6 +11,7 @@
 #define YIQI_INSTRUMENTATION_TOOLS_AVAILABLE_H
 
 #include <memory>
+#include <string>
 
 namespace yiqi
 {
@@ -21,12 +22,67 @@ namespace yiqi
             class Tool;
             typedef std::unique_ptr <Tool> ToolUniquePtr;
 
-            ToolUniquePtr MakeNoneTool ();
-            ToolUniquePtr MakeTimerTool ();
-            ToolUniquePtr MakeMemcheckTool ();
-            ToolUniquePtr MakeCallgrindTool ();
-            ToolUniquePtr MakeCachegrindTool ();
-            ToolUniquePtr MakePassthroughTool ();
+            /**
+             * @brief ToolOptions describes the settings from the
+             * command line which change how individual tools behave
+             */
+            struct ToolOptions
+            {
+                ToolOptions ();
+
+                /**
+                 * @brief callgrindFast only has callgrind instrument
+                 * client code, which is much faster, at the cost of
+                 * the simulated caches being cold in client code
+                 */
+                bool callgrindFast;
+
+                /**
+                 * @brief timerWarmup is the number of times the timer
+                 * runs client code before it starts timing it
+                 */
+                unsigned int timerWarmup;
+
+                /**
+                 * @brief timerIterations is the number of times the timer
+                 * runs and times client code after warming up
+                 */
+                unsigned int timerIterations;
+
+                /**
+                 * @brief cacheProfile names the processor whose caches
+                 * cachegrind and callgrind simulate, or is "host" for
+                 * the caches of the machine the tests run on
+                 */
+                std::string cacheProfile;
+
+                /**
+                 * @brief flameGraphDirectory is where callgrind writes
+                 * folded stacks and flame graphs for each test and for
+                 * the whole suite, or is empty for it not to
+                 */
+                std::string flameGraphDirectory;
+
+                /**
+                 * @brief annotationDirectory is where cachegrind and
+                 * callgrind write client code annotated with what each
+                 * line cost, or is empty for them not to
+                 */
+                std::string annotationDirectory;
+            };
+
+            ToolUniquePtr MakeNoneTool (ToolOptions const &);
+            ToolUniquePtr MakeTimerTool (ToolOptions const &);
+            ToolUniquePtr MakeMemcheckTool (ToolOptions const &);
+            ToolUniquePtr MakeCallgrindTool (ToolOptions const &);
+            ToolUniquePtr MakeCachegrindTool (ToolOptions const &);
+            ToolUniquePtr MakePassthroughTool (ToolOptions const &);
+            ToolUniquePtr MakeMassifTool (ToolOptions const &);
+            ToolUniquePtr MakeDhatTool (ToolOptions const &);
+            ToolUniquePtr MakePerfTool (ToolOptions const &);
+            ToolUniquePtr MakeHeapTool (ToolOptions const &);
+            ToolUniquePtr MakeRusageTool (ToolOptions const &);
+            ToolUniquePtr MakeCallgrindSimulationTool (ToolOptions const &);
         }
     }
 }
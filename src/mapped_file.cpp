@@ -0,0 +1,84 @@
+/*
+ * mapped_file.cpp:
+ * Maps a whole file read-only into memory, so that large
+ * files can be streamed through without copying them
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <folly/ScopeGuard.h>
+
+#include "mapped_file.h"
+
+namespace ysys = yiqi::system;
+
+namespace
+{
+    std::system_error LastError (std::string const &what)
+    {
+        return std::system_error (std::error_code (errno,
+                                                   std::system_category ()),
+                                  what);
+    }
+}
+
+ysys::MappedFile::MappedFile (std::string const &path) :
+    mData (nullptr),
+    mSize (0)
+{
+    int const fd = open (path.c_str (), O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+        throw LastError ("could not open " + path);
+
+    /* The mapping stays valid once the descriptor is closed */
+    auto closeFile = folly::makeGuard ([fd]() {
+                                           close (fd);
+                                       });
+
+    struct stat status;
+
+    if (fstat (fd, &status) == -1)
+        throw LastError ("could not stat " + path);
+
+    mSize = status.st_size;
+
+    /* Zero length mappings are not allowed */
+    if (!mSize)
+        return;
+
+    mData = mmap (nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mData == MAP_FAILED)
+    {
+        mData = nullptr;
+        throw LastError ("could not map " + path);
+    }
+
+    madvise (mData, mSize, MADV_SEQUENTIAL);
+}
+
+ysys::MappedFile::~MappedFile ()
+{
+    if (mData)
+        munmap (mData, mSize);
+}
+
+char const *
+ysys::MappedFile::data () const
+{
+    return static_cast <char const *> (mData);
+}
+
+size_t
+ysys::MappedFile::size () const
+{
+    return mSize;
+}
@@ -0,0 +1,58 @@
+/*
+ * mapped_file.h:
+ * Maps a whole file read-only into memory, so that large
+ * files can be streamed through without copying them
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_MAPPED_FILE_H
+#define YIQI_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace yiqi
+{
+    namespace system
+    {
+        class MappedFile
+        {
+            public:
+
+                /**
+                 * @brief MappedFile maps path into memory. The pages are
+                 * only read in from disk as they are touched, and the
+                 * kernel is told that they will be read in order.
+                 * @param path the file to map
+                 * @throws std::system_error if the file could not be
+                 * opened or mapped
+                 */
+                explicit MappedFile (std::string const &path);
+                ~MappedFile ();
+
+                /**
+                 * @brief data
+                 * @return the start of the file contents, which are not
+                 * null-terminated, or nullptr if the file is empty
+                 */
+                char const * data () const;
+
+                /**
+                 * @brief size
+                 * @return the size of the file in bytes
+                 */
+                size_t size () const;
+
+            private:
+
+                MappedFile (MappedFile const &) = delete;
+                MappedFile & operator= (MappedFile const &) = delete;
+
+                void   *mData;
+                size_t mSize;
+        };
+    }
+}
+
+#endif // YIQI_MAPPED_FILE_H
@@ -0,0 +1,201 @@
+/*
+ * massif_output.cpp:
+ * Reads back the output files which massif leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "massif_output.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yoms = yiqi::output::massif;
+
+namespace
+{
+    std::string const SnapshotKey ("snapshot=");
+    std::string const HeapKey ("mem_heap_B=");
+    std::string const HeapExtraKey ("mem_heap_extra_B=");
+    std::string const StacksKey ("mem_stacks_B=");
+    std::string const TreeKey ("heap_tree=");
+    std::string const PeakTree ("peak");
+
+    double ReadBytes (std::string const &line, std::string const &key)
+    {
+        std::string const value (line.substr (key.size ()));
+        size_t            parsed = 0;
+        double            bytes = 0;
+
+        try
+        {
+            bytes = std::stod (value, &parsed);
+        }
+        catch (std::exception const &)
+        {
+        }
+
+        if (value.empty () || parsed != value.size ())
+            throw std::runtime_error ("malformed massif line: " + line);
+
+        return bytes;
+    }
+
+    /* Reads a node of a tree, like " n1: 800 0x4005B4: f (a.cpp:5)",
+     * returning how deep it is, or -1 if it is not a node */
+    int ReadNode (std::string const &line, yoms::Allocation &allocation)
+    {
+        size_t const depth (line.find_first_not_of (' '));
+
+        if (depth == std::string::npos || line[depth] != 'n')
+            return -1;
+
+        size_t const bytesStart (line.find (": ", depth));
+
+        if (bytesStart == std::string::npos)
+            throw std::runtime_error ("malformed massif tree: " + line);
+
+        size_t const bytesEnd (line.find (' ', bytesStart + 2));
+        std::string const bytes (line.substr (bytesStart + 2,
+                                              bytesEnd - bytesStart - 2));
+        size_t parsed = 0;
+
+        try
+        {
+            allocation.bytes = std::stod (bytes, &parsed);
+        }
+        catch (std::exception const &)
+        {
+        }
+
+        if (bytes.empty () || parsed != bytes.size ())
+            throw std::runtime_error ("malformed massif tree: " + line);
+
+        /* Allocations too small to report on their own have
+         * no address, and so no function */
+        allocation.function.clear ();
+
+        if (bytesEnd != std::string::npos &&
+            line.compare (bytesEnd + 1, 2, "0x") == 0)
+        {
+            size_t const functionStart (line.find (": ", bytesEnd + 1));
+
+            if (functionStart != std::string::npos)
+                allocation.function = line.substr (functionStart + 2);
+        }
+
+        return static_cast <int> (depth);
+    }
+}
+
+yoms::Snapshots
+yoms::ReadSnapshots (std::istream &output)
+{
+    Snapshots   snapshots;
+    std::string line;
+
+    while (std::getline (output, line))
+    {
+        if (!line.empty () && line.back () == '\r')
+            line.pop_back ();
+
+        if (boost::starts_with (line, SnapshotKey))
+        {
+            snapshots.push_back (Snapshot { 0, 0, 0, false, Allocations () });
+            continue;
+        }
+
+        if (snapshots.empty ())
+            continue;
+
+        Snapshot &snapshot (snapshots.back ());
+
+        if (boost::starts_with (line, HeapKey))
+            snapshot.heap = ReadBytes (line, HeapKey);
+        else if (boost::starts_with (line, HeapExtraKey))
+            snapshot.heapExtra = ReadBytes (line, HeapExtraKey);
+        else if (boost::starts_with (line, StacksKey))
+            snapshot.stacks = ReadBytes (line, StacksKey);
+        else if (boost::starts_with (line, TreeKey))
+            snapshot.peak = line.substr (TreeKey.size ()) == PeakTree;
+        else
+        {
+            Allocation allocation;
+
+            /* Only the trees right under the root are kept */
+            if (ReadNode (line, allocation) == 1 &&
+                !allocation.function.empty ())
+                snapshot.allocations.push_back (allocation);
+        }
+    }
+
+    return snapshots;
+}
+
+yoms::Snapshots
+yoms::ReadSnapshotsFile (std::string const &path)
+{
+    std::ifstream file (path);
+
+    if (!file)
+        throw std::runtime_error ("could not read " + path);
+
+    return ReadSnapshots (file);
+}
+
+ymeas::Metrics
+yoms::PeakMetrics (Snapshots const &snapshots,
+                   size_t          allocations)
+{
+    if (snapshots.empty ())
+        return ymeas::Metrics ();
+
+    auto peak = std::find_if (snapshots.begin (),
+                              snapshots.end (),
+                              [](Snapshot const &s) { return s.peak; });
+
+    if (peak == snapshots.end ())
+        peak = std::max_element (snapshots.begin (),
+                                 snapshots.end (),
+                                 [](Snapshot const &lhs, Snapshot const &rhs) {
+                                     return lhs.heap + lhs.heapExtra <
+                                            rhs.heap + rhs.heapExtra;
+                                 });
+
+    double stacks = 0;
+
+    for (Snapshot const &snapshot : snapshots)
+        stacks = std::max (stacks, snapshot.stacks);
+
+    ymeas::Metrics metrics =
+    {
+        { "heap.peak.bytes", peak->heap },
+        { "heap.peak.extra.bytes", peak->heapExtra },
+        { "stacks.peak.bytes", stacks }
+    };
+
+    Allocations largest (peak->allocations);
+
+    std::stable_sort (largest.begin (),
+                      largest.end (),
+                      [](Allocation const &lhs, Allocation const &rhs) {
+                          return lhs.bytes > rhs.bytes;
+                      });
+
+    if (largest.size () > allocations)
+        largest.resize (allocations);
+
+    for (Allocation const &allocation : largest)
+        metrics.push_back (ymeas::Metric {
+                               "heap.peak.bytes",
+                               allocation.bytes,
+                               allocation.function
+                           });
+
+    return metrics;
+}
@@ -0,0 +1,88 @@
+/*
+ * massif_output.h:
+ * Reads back the output files which massif leaves behind
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_MASSIF_OUTPUT_H
+#define YIQI_MASSIF_OUTPUT_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace massif
+        {
+            /**
+             * @brief Allocation is one of the trees directly under the
+             * root of a detailed snapshot, which is all of the heap
+             * allocated by a single function and everything it called
+             */
+            struct Allocation
+            {
+                /* As massif describes it, eg "f (a.cpp:10)" */
+                std::string function;
+                double      bytes;
+            };
+
+            typedef std::vector <Allocation> Allocations;
+
+            struct Snapshot
+            {
+                double      heap;
+                double      heapExtra;
+                double      stacks;
+
+                /* Whether massif marked this as the peak */
+                bool        peak;
+
+                /* Empty unless the snapshot is detailed */
+                Allocations allocations;
+            };
+
+            typedef std::vector <Snapshot> Snapshots;
+
+            /**
+             * @brief ReadSnapshots
+             * @param output a stream of massif output
+             * @throws std::runtime_error if a snapshot or a tree in
+             * it is malformed
+             * @return every snapshot, in order
+             */
+            Snapshots ReadSnapshots (std::istream &output);
+
+            /**
+             * @brief ReadSnapshotsFile
+             * @param path a massif output file
+             * @throws std::runtime_error if the file could not be read
+             * or is malformed
+             * @return every snapshot in the file, in order
+             */
+            Snapshots ReadSnapshotsFile (std::string const &path);
+
+            /**
+             * @brief PeakMetrics summarises the snapshots at the heap's
+             * peak, which is the snapshot massif marked as the peak, or
+             * otherwise the one with the most heap in use
+             * @param snapshots every snapshot massif took
+             * @param allocations the most allocation trees to report
+             * @return heap.peak.bytes and heap.peak.extra.bytes at the
+             * peak, stacks.peak.bytes as the most stack in use in any
+             * snapshot, and heap.peak.bytes for the functions which
+             * allocated the most of the peak, largest first. Nothing if
+             * there were no snapshots.
+             */
+            measurement::Metrics PeakMetrics (Snapshots const &snapshots,
+                                              size_t          allocations);
+        }
+    }
+}
+
+#endif // YIQI_MASSIF_OUTPUT_H
@@ -0,0 +1,113 @@
+/*
+ * measurement.cpp:
+ * Provides the types used to describe what an instrumentation
+ * tool measured about some client code
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "constants.h"
+#include "measurement.h"
+
+namespace yconst = yiqi::constants;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    char const Separator = '\t';
+    size_t const ResultFields = 5;
+
+    /* Enough precision that counts are never printed
+     * in exponent form */
+    std::streamsize const CountPrecision = 15;
+}
+
+void
+ymeas::PrintMetrics (std::ostream      &os,
+                     std::string const &test,
+                     std::string const &tool,
+                     Metrics const     &metrics)
+{
+    std::streamsize const precision (os.precision (CountPrecision));
+
+    for (Metric const &metric : metrics)
+    {
+        /* There are far too many functions to print them all */
+        if (!metric.function.empty ())
+            continue;
+
+        os << yconst::YiqiMeasuredHeader
+           << test << " "
+           << tool << " "
+           << metric.name << " "
+           << metric.value << std::endl;
+    }
+
+    os.precision (precision);
+}
+
+void
+ymeas::WriteResults (std::ostream      &os,
+                     std::string const &test,
+                     std::string const &tool,
+                     Metrics const     &metrics)
+{
+    std::streamsize const precision (os.precision (CountPrecision));
+
+    for (Metric const &metric : metrics)
+        os << test << Separator
+           << tool << Separator
+           << metric.function << Separator
+           << metric.name << Separator
+           << metric.value << '\n';
+
+    os.flush ();
+    os.precision (precision);
+}
+
+ymeas::Results
+ymeas::ReadResults (std::istream &is)
+{
+    Results     results;
+    std::string line;
+    size_t      lineNumber = 0;
+
+    while (std::getline (is, line))
+    {
+        ++lineNumber;
+
+        if (line.empty () || line[0] == '#')
+            continue;
+
+        std::vector <std::string> fields;
+        boost::split (fields, line, boost::is_any_of ("\t"));
+
+        std::stringstream value (fields.size () == ResultFields ?
+                                     fields[4] : std::string ());
+        Result result;
+
+        if (fields.size () != ResultFields || !(value >> result.metric.value))
+        {
+            std::stringstream ss;
+            ss << "malformed result on line " << lineNumber
+               << ": " << line;
+            throw std::runtime_error (ss.str ());
+        }
+
+        result.test = fields[0];
+        result.tool = fields[1];
+        result.metric.function = fields[2];
+        result.metric.name = fields[3];
+
+        results.push_back (result);
+    }
+
+    return results;
+}
@@ -0,0 +1,118 @@
+/*
+ * measurement.h:
+ * Provides the types used to describe what an instrumentation
+ * tool measured about some client code
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_MEASUREMENT_H
+#define YIQI_MEASUREMENT_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace yiqi
+{
+    namespace measurement
+    {
+        /**
+         * @brief Metric is a single named value measured by an
+         * instrumentation tool, for instance the number of D1 misses
+         */
+        struct Metric
+        {
+            std::string name;
+            double      value;
+
+            /* The function the value was measured in, or empty if it
+             * was measured over all of the client code */
+            std::string function;
+        };
+
+        typedef std::vector <Metric> Metrics;
+
+        /**
+         * @brief TestFailure is a problem serious enough to fail a test,
+         * found by an instrumentation tool outside of the test's process
+         */
+        struct TestFailure
+        {
+            /* The full name of the test, or empty if no test was running */
+            std::string test;
+            std::string description;
+        };
+
+        typedef std::vector <TestFailure> TestFailures;
+
+        /**
+         * @brief Result is a Metric along with the test and tool
+         * that it was measured with
+         */
+        struct Result
+        {
+            std::string test;
+            std::string tool;
+            Metric      metric;
+        };
+
+        typedef std::vector <Result> Results;
+
+        typedef std::vector <std::string> Failures;
+
+        /**
+         * @brief RegionResult is what an instrumentation tool found out
+         * about a single region of client code
+         */
+        struct RegionResult
+        {
+            /* Anything measured about the region */
+            Metrics  metrics;
+
+            /* Problems serious enough to fail the test that ran the
+             * region, for instance memory that was definitely leaked */
+            Failures failures;
+        };
+
+        /**
+         * @brief PrintMetrics prints one line for each of metrics which
+         * was measured over all of the client code, prefixed with
+         * yiqi::constants::YiqiMeasuredHeader
+         * @param os the stream to print to
+         * @param test the full name of the test that was measured
+         * @param tool the name of the tool that measured it
+         * @param metrics the metrics to print
+         */
+        void PrintMetrics (std::ostream      &os,
+                           std::string const &test,
+                           std::string const &tool,
+                           Metrics const     &metrics);
+
+        /**
+         * @brief WriteResults writes all of metrics in the results file
+         * format, which has one line for each metric with the test, tool,
+         * function, metric name and value separated by tabs
+         * @param os the stream to write to
+         * @param test the full name of the test that was measured
+         * @param tool the name of the tool that measured it
+         * @param metrics the metrics to write
+         */
+        void WriteResults (std::ostream      &os,
+                           std::string const &test,
+                           std::string const &tool,
+                           Metrics const     &metrics);
+
+        /**
+         * @brief ReadResults reads back everything written with
+         * WriteResults. Empty lines and lines starting with # are
+         * skipped.
+         * @param is the stream to read from
+         * @throws std::runtime_error if a line is malformed
+         * @return the results, in the order they were written
+         */
+        Results ReadResults (std::istream &is);
+    }
+}
+
+#endif // YIQI_MEASUREMENT_H
@@ -0,0 +1,161 @@
+/*
+ * memcheck_xml.cpp:
+ * Reads memcheck's XML output as it is written, turning it
+ * into errors tied to the test that caused them
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "constants.h"
+#include "memcheck_xml.h"
+
+namespace yconst = yiqi::constants;
+namespace yomc = yiqi::output::memcheck;
+
+std::string
+yomc::Describe (Error const &error)
+{
+    std::stringstream ss;
+
+    ss << error.kind << ": " << error.what;
+
+    for (Frame const &frame : error.stack)
+    {
+        ss << std::endl << "    at ";
+
+        if (!frame.function.empty ())
+            ss << frame.function;
+        else
+            ss << "???";
+
+        if (!frame.file.empty ())
+            ss << " (" << frame.file << ":" << frame.line << ")";
+        else if (!frame.object.empty ())
+            ss << " (in " << frame.object << ")";
+    }
+
+    return ss.str ();
+}
+
+yomc::StreamReader::StreamReader (ErrorFunc const &found) :
+    mParser (*this),
+    mFound (found),
+    mError (),
+    mStacks (0),
+    mInEntryLeakCheck (false)
+{
+}
+
+void
+yomc::StreamReader::Feed (char const *data, size_t size)
+{
+    mParser.Feed (data, size);
+}
+
+bool
+yomc::StreamReader::InError (char const *parent) const
+{
+    /* The element containing the text is on the top of the path */
+    return mPath.size () >= 3 &&
+           mPath[mPath.size () - 2] == parent &&
+           mPath[mPath.size () - 3] == "error";
+}
+
+bool
+yomc::StreamReader::InFrame () const
+{
+    return mPath.size () >= 4 &&
+           mPath[mPath.size () - 2] == "frame" &&
+           mPath[mPath.size () - 3] == "stack" &&
+           mPath[mPath.size () - 4] == "error";
+}
+
+void
+yomc::StreamReader::StartElement (std::string const &name)
+{
+    mPath.push_back (name);
+
+    if (name == "error")
+    {
+        mError = Error ();
+        mError.test = mTest;
+        mStacks = 0;
+    }
+    else if (name == "stack")
+        ++mStacks;
+    else if (name == "frame")
+        mFrame = Frame ();
+}
+
+void
+yomc::StreamReader::EndElement (std::string const &name)
+{
+    if (mPath.empty () || mPath.back () != name)
+        throw std::runtime_error ("mismatched </" + name + "> in "
+                                  "memcheck output");
+
+    mPath.pop_back ();
+
+    if (name == "frame" && mStacks == 1 &&
+        !mPath.empty () && mPath.back () == "stack" &&
+        mPath.size () >= 2 && mPath[mPath.size () - 2] == "error")
+        mError.stack.push_back (mFrame);
+    else if (name == "error" &&
+             !(mInEntryLeakCheck &&
+               boost::starts_with (mError.kind, "Leak_")))
+        mFound (mError);
+}
+
+void
+yomc::StreamReader::Text (std::string const &text)
+{
+    if (mPath.empty ())
+        return;
+
+    std::string const &element (mPath.back ());
+    std::size_t const depth (mPath.size ());
+
+    if (element == "text" && depth >= 2 &&
+        mPath[depth - 2] == "clientmsg")
+    {
+        std::string const marker (yconst::YiqiTestStartedMarker);
+        std::string const message (boost::trim_copy (text));
+
+        if (boost::starts_with (text, marker))
+            mTest = boost::trim_copy (text.substr (marker.size ()));
+        else if (message == yconst::YiqiEntryLeakCheckMarker)
+            mInEntryLeakCheck = true;
+        else if (message == yconst::YiqiEntryLeakCheckDoneMarker)
+            mInEntryLeakCheck = false;
+    }
+    else if (depth >= 2 && mPath[depth - 2] == "error")
+    {
+        if (element == "kind")
+            mError.kind = text;
+        else if (element == "what")
+            mError.what = text;
+    }
+    else if (InError ("xwhat"))
+    {
+        if (element == "text")
+            mError.what = text;
+        else if (element == "leakedbytes")
+            mError.leakedBytes = std::stoull (text);
+    }
+    else if (InFrame () && mStacks == 1)
+    {
+        if (element == "fn")
+            mFrame.function = text;
+        else if (element == "file")
+            mFrame.file = text;
+        else if (element == "line")
+            mFrame.line = text;
+        else if (element == "obj")
+            mFrame.object = text;
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * memcheck_xml.h:
+ * Reads memcheck's XML output as it is written, turning it
+ * into errors tied to the test that caused them
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_MEMCHECK_XML_H
+#define YIQI_MEMCHECK_XML_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sax_parser.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace memcheck
+        {
+            struct Frame
+            {
+                std::string function;
+                std::string file;
+                std::string line;
+                std::string object;
+            };
+
+            typedef std::vector <Frame> Stack;
+
+            /**
+             * @brief Error is a single error reported by memcheck
+             */
+            struct Error
+            {
+                /* The test which was running, empty if none was */
+                std::string        test;
+
+                /* For instance, InvalidRead or Leak_DefinitelyLost */
+                std::string        kind;
+                std::string        what;
+
+                /* Only set for leaks */
+                unsigned long long leakedBytes;
+
+                /* Where the error happened, innermost frame first */
+                Stack              stack;
+            };
+
+            /**
+             * @brief Describe
+             * @param error an Error
+             * @return a human readable, multi-line description
+             * of error including its stack
+             */
+            std::string Describe (Error const &error);
+
+            /**
+             * @brief StreamReader reads memcheck's XML output (--xml=yes)
+             * piece by piece as it arrives. Messages starting with
+             * yiqi::constants::YiqiTestStartedMarker sent with
+             * VALGRIND_PRINTF mark which test is running. Leaks between
+             * the YiqiEntryLeakCheckMarker and YiqiEntryLeakCheckDoneMarker
+             * messages are left out, as they were not caused by client
+             * code.
+             */
+            class StreamReader :
+                private xml::SAXHandler
+            {
+                public:
+
+                    typedef std::function <void (Error const &)> ErrorFunc;
+
+                    /**
+                     * @brief StreamReader
+                     * @param found called with each error as soon as
+                     * the whole of it has been read
+                     */
+                    explicit StreamReader (ErrorFunc const &found);
+
+                    /**
+                     * @brief Feed reads the next piece of output
+                     * @param data the next piece of output
+                     * @param size the length of data
+                     * @throws std::runtime_error if the output is malformed
+                     */
+                    void Feed (char const *data, size_t size);
+
+                private:
+
+                    void StartElement (std::string const &name);
+                    void EndElement (std::string const &name);
+                    void Text (std::string const &text);
+
+                    bool InError (char const *parent) const;
+                    bool InFrame () const;
+
+                    xml::SAXParser            mParser;
+                    ErrorFunc                 mFound;
+                    std::vector <std::string> mPath;
+                    std::string               mTest;
+                    Error                     mError;
+                    Frame                     mFrame;
+
+                    /* Only the first stack of an error is where it
+                     * happened, later ones are auxiliary */
+                    unsigned int              mStacks;
+
+                    bool                      mInEntryLeakCheck;
+            };
+        }
+    }
+}
+
+#endif // YIQI_MEMCHECK_XML_H
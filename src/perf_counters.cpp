@@ -0,0 +1,247 @@
+/*
+ * perf_counters.cpp:
+ * Hardware and software performance counters for measuring
+ * client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "perf_counters.h"
+
+namespace ycount = yiqi::counters;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    struct Event
+    {
+        char const *metric;
+        uint32_t   type;
+        uint64_t   config;
+    };
+
+    /* Instructions are named as valgrind names instructions read, so
+     * that instruction budgets are checked under this tool too */
+    Event const HardwareEvents[] =
+    {
+        { "Ir", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { "cache.references", PERF_TYPE_HARDWARE,
+          PERF_COUNT_HW_CACHE_REFERENCES },
+        { "cache.misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { "branch.misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+    };
+
+    Event const SoftwareEvents[] =
+    {
+        { "task.clock.ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+        { "page.faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+        { "context.switches", PERF_TYPE_SOFTWARE,
+          PERF_COUNT_SW_CONTEXT_SWITCHES }
+    };
+
+    int OpenEvent (Event const &event, int groupLeader)
+    {
+        perf_event_attr attr;
+        std::memset (&attr, 0, sizeof (attr));
+
+        attr.size = sizeof (attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        /* Members follow their leader, so only the leader starts off
+         * disabled */
+        attr.disabled = groupLeader == -1 ? 1 : 0;
+
+        /* This thread, on whichever processor it runs on */
+        return syscall (__NR_perf_event_open, &attr, 0, -1, groupLeader,
+                        PERF_FLAG_FD_CLOEXEC);
+    }
+
+    /* A set of events which the kernel schedules onto the hardware
+     * together, so that they all count over exactly the same period */
+    class EventGroup
+    {
+        public:
+
+            template <size_t N>
+            explicit EventGroup (Event const (&events)[N]);
+            ~EventGroup ();
+
+            bool Empty () const;
+            void Enable ();
+            void Disable ();
+            void Read (ymeas::Metrics &metrics) const;
+
+        private:
+
+            EventGroup (EventGroup const &) = delete;
+            EventGroup & operator= (EventGroup const &) = delete;
+
+            std::vector <int>          mDescriptors;
+            std::vector <char const *> mMetrics;
+    };
+
+    class PerfEventCounters :
+        public ycount::Counters
+    {
+        public:
+
+            PerfEventCounters ();
+
+        private:
+
+            void Start ();
+            void Stop ();
+            ymeas::Metrics Read () const;
+            std::string const & Description () const;
+
+            EventGroup  mHardware;
+            EventGroup  mSoftware;
+            std::string mDescription;
+    };
+}
+
+template <size_t N>
+EventGroup::EventGroup (Event const (&events)[N])
+{
+    for (Event const &event : events)
+    {
+        int const leader (mDescriptors.empty () ? -1 : mDescriptors.front ());
+        int const fd (OpenEvent (event, leader));
+
+        /* The processor or kernel might not support every event, but
+         * the rest are still worth counting */
+        if (fd == -1)
+            continue;
+
+        mDescriptors.push_back (fd);
+        mMetrics.push_back (event.metric);
+    }
+}
+
+EventGroup::~EventGroup ()
+{
+    for (int fd : mDescriptors)
+        close (fd);
+}
+
+bool
+EventGroup::Empty () const
+{
+    return mDescriptors.empty ();
+}
+
+void
+EventGroup::Enable ()
+{
+    if (Empty ())
+        return;
+
+    int const leader (mDescriptors.front ());
+    ioctl (leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl (leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void
+EventGroup::Disable ()
+{
+    if (Empty ())
+        return;
+
+    ioctl (mDescriptors.front (), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void
+EventGroup::Read (ymeas::Metrics &metrics) const
+{
+    if (Empty ())
+        return;
+
+    /* Number of events, time enabled, time running, then one
+     * value per event */
+    size_t const headerSize (3);
+    std::vector <uint64_t> values (headerSize + mDescriptors.size ());
+    size_t const size (values.size () * sizeof (uint64_t));
+
+    if (read (mDescriptors.front (), values.data (), size) !=
+        static_cast <ssize_t> (size))
+        return;
+
+    uint64_t const enabled (values[1]);
+    uint64_t const running (values[2]);
+
+    /* The group never made it onto the hardware, so there is
+     * nothing to scale up */
+    if (running == 0)
+        return;
+
+    double const scale (static_cast <double> (enabled) / running);
+
+    for (size_t i = 0; i < mMetrics.size (); ++i)
+        metrics.push_back ({ mMetrics[i], values[headerSize + i] * scale });
+}
+
+PerfEventCounters::PerfEventCounters () :
+    mHardware (HardwareEvents),
+    mSoftware (SoftwareEvents)
+{
+    if (!mHardware.Empty () && !mSoftware.Empty ())
+        mDescription = "hardware and software";
+    else if (!mHardware.Empty ())
+        mDescription = "hardware only";
+    else if (!mSoftware.Empty ())
+        mDescription = "software only";
+    else
+        mDescription = "none";
+}
+
+void
+PerfEventCounters::Start ()
+{
+    mSoftware.Enable ();
+    mHardware.Enable ();
+}
+
+void
+PerfEventCounters::Stop ()
+{
+    mHardware.Disable ();
+    mSoftware.Disable ();
+}
+
+ymeas::Metrics
+PerfEventCounters::Read () const
+{
+    ymeas::Metrics metrics;
+
+    mHardware.Read (metrics);
+    mSoftware.Read (metrics);
+
+    return metrics;
+}
+
+std::string const &
+PerfEventCounters::Description () const
+{
+    return mDescription;
+}
+
+ycount::Counters::Unique
+ycount::MakePerfEventCounters ()
+{
+    return Counters::Unique (new PerfEventCounters ());
+}
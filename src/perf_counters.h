@@ -0,0 +1,81 @@
+/*
+ * perf_counters.h:
+ * Hardware and software performance counters for measuring
+ * client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_PERF_COUNTERS_H
+#define YIQI_PERF_COUNTERS_H
+
+#include <memory>
+#include <string>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace counters
+    {
+        class Counters
+        {
+            public:
+
+                typedef std::unique_ptr <Counters> Unique;
+
+                virtual ~Counters () {};
+
+                /**
+                 * @brief Start resets all counters to zero and starts
+                 * counting events in the calling thread
+                 */
+                virtual void Start () = 0;
+
+                /**
+                 * @brief Stop stops counting, leaving the counts to be
+                 * read back
+                 */
+                virtual void Stop () = 0;
+
+                /**
+                 * @brief Read
+                 * @return a metric for each counter which counted between
+                 * the last Start and Stop. Counts are scaled up where the
+                 * kernel had to share the hardware with other events.
+                 */
+                virtual measurement::Metrics Read () const = 0;
+
+                /**
+                 * @brief Description
+                 * @return a short description of which counters could be
+                 * opened, for instance "hardware and software"
+                 */
+                virtual std::string const & Description () const = 0;
+
+            protected:
+
+                Counters () = default;
+
+            private:
+
+                Counters (Counters const &) = delete;
+                Counters & operator= (Counters const &) = delete;
+        };
+
+        /**
+         * @brief MakePerfEventCounters opens a group of hardware counters,
+         * for instructions, cycles, cache references, cache misses and
+         * branch misses, and a group of software counters, for task clock,
+         * page faults and context switches, with perf_event_open. Only
+         * user space events in the calling thread are counted. Counters
+         * that cannot be opened, for instance inside a virtual machine or
+         * where perf_event_paranoid forbids it, are left out rather than
+         * treated as an error.
+         * @return Counters based on perf_event_open
+         */
+        Counters::Unique MakePerfEventCounters ();
+    }
+}
+
+#endif // YIQI_PERF_COUNTERS_H
@@ -6,13 +6,22 @@
  * See LICENCE.md for Copyright information
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #include <unistd.h>
 
+#include <boost/algorithm/string.hpp>
+
+#include <folly/ScopeGuard.h>
+
 #include "commandline.h"
 #include "constants.h"
 #include "instrumentation_tool.h"
@@ -61,6 +70,500 @@ yexec::RelaunchCurrentProgram (Tool const           &tool,
               system);
 }
 
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double SecondsSince (Clock::time_point const &started)
+    {
+        return std::chrono::duration <double> (Clock::now () - started).count ();
+    }
+
+    /* A child running a single test, which may be
+     * writing its output down a pipe to us */
+    struct RunningTest
+    {
+        std::string       test;
+        pid_t             child;
+        int               fd;
+        std::string       collected;
+        Clock::time_point started;
+    };
+}
+
+int
+yexec::RelaunchForEachTest (Tool const            &tool,
+                            TestNames const       &tests,
+                            unsigned int          slots,
+                            FetchExecFunc const   &fetchExecutable,
+                            FetchArgvFunc const   &fetchArgv,
+                            FetchEnvFunc const    &fetchEnv,
+                            ChildExitedFunc const &exited,
+                            std::ostream          &output,
+                            SystemCalls const     &system)
+{
+    std::string const   executable (fetchExecutable (tool, system));
+    ycom::NullTermArray env (fetchEnv (tool, system));
+    int                 status = 0;
+
+    auto spawn = [&](std::string const                &test,
+                     SystemCalls::InheritedFds const  &inherited) {
+        ycom::NullTermArray argv (fetchArgv (tool));
+        argv.append (std::string (yconst::GoogleTestFilterOption) + test);
+
+        return system.SpawnChild (executable.c_str (),
+                                  argv.underlyingArray (),
+                                  env.underlyingArray (),
+                                  inherited);
+    };
+
+    /* One at a time, the output can go straight through */
+    if (slots <= 1)
+    {
+        for (std::string const &test : tests)
+        {
+            Clock::time_point const started (Clock::now ());
+            pid_t const             child (
+                spawn (test, SystemCalls::InheritedFds ()));
+            int const               childStatus (system.WaitForChild (child));
+
+            status = std::max (status, childStatus);
+
+            exited (TestRun { test, child, childStatus, SecondsSince (started) });
+        }
+
+        return status;
+    }
+
+    std::vector <RunningTest> running;
+
+    /* Nothing can be left running, or open, if anything fails */
+    auto cleanUp = folly::makeGuard ([&system, &running]() {
+                                         for (RunningTest const &run : running)
+                                         {
+                                             system.CloseFd (run.fd);
+
+                                             try
+                                             {
+                                                 system.KillChild (run.child);
+                                                 system.WaitForChild (run.child);
+                                             }
+                                             catch (std::exception const &)
+                                             {
+                                             }
+                                         }
+                                     });
+
+    std::vector <char> buffer (64 * 1024);
+    auto               next = tests.begin ();
+
+    while (next != tests.end () || !running.empty ())
+    {
+        /* Keep every slot busy while there are tests left */
+        while (running.size () < slots && next != tests.end ())
+        {
+            SystemCalls::Pipe const pipe (system.CreatePipe ());
+            RunningTest             run { *next++, 0, pipe.readFd };
+
+            {
+                auto closeWriteEnd = folly::makeGuard ([&system, &pipe]() {
+                                                           system.CloseFd (pipe.writeFd);
+                                                       });
+
+                run.started = Clock::now ();
+                run.child = spawn (run.test,
+                                   {
+                                       { pipe.writeFd, STDOUT_FILENO },
+                                       { pipe.writeFd, STDERR_FILENO }
+                                   });
+            }
+
+            running.push_back (run);
+        }
+
+        SystemCalls::Fds fds;
+
+        for (RunningTest const &run : running)
+            fds.push_back (run.fd);
+
+        for (int fd : system.PollReadable (fds))
+        {
+            auto run = std::find_if (running.begin (),
+                                     running.end (),
+                                     [fd](RunningTest const &r) {
+                                         return r.fd == fd;
+                                     });
+
+            if (run == running.end ())
+                continue;
+
+            size_t const bytesRead (system.ReadFd (fd,
+                                                   &buffer[0],
+                                                   buffer.size ()));
+
+            if (bytesRead)
+            {
+                run->collected.append (&buffer[0], bytesRead);
+                continue;
+            }
+
+            /* The child has closed its output, so it is exiting */
+            RunningTest const finished (*run);
+
+            running.erase (run);
+            system.CloseFd (finished.fd);
+
+            int const childStatus (system.WaitForChild (finished.child));
+
+            status = std::max (status, childStatus);
+
+            output << finished.collected << std::flush;
+            exited (TestRun {
+                        finished.test,
+                        finished.child,
+                        childStatus,
+                        SecondsSince (finished.started)
+                    });
+        }
+    }
+
+    cleanUp.dismiss ();
+
+    return status;
+}
+
+int
+yexec::RelaunchCurrentProgramForEachTest (Tool const            &tool,
+                                          TestNames const       &tests,
+                                          unsigned int          slots,
+                                          int                   currentArgc,
+                                          char const * const *  currentArgv,
+                                          ChildExitedFunc const &exited,
+                                          std::ostream          &output,
+                                          SystemCalls const     &system)
+{
+    using namespace std::placeholders;
+
+    FetchExecFunc fetchExecutable (std::bind (yexec::FindExecutable, _1, _2));
+    FetchArgvFunc fetchArgv (std::bind (yexec::GetToolArgv, _1,
+                                        currentArgc, currentArgv));
+    FetchEnvFunc fetchEnv (std::bind (yexec::GetTestToolEnv, _1, _2));
+
+    return RelaunchForEachTest (tool,
+                                tests,
+                                slots,
+                                fetchExecutable,
+                                fetchArgv,
+                                fetchEnv,
+                                exited,
+                                output,
+                                system);
+}
+
+int
+yexec::RelaunchAndWait (Tool const              &tool,
+                        FetchExecFunc const     &fetchExecutable,
+                        FetchArgvFunc const     &fetchArgv,
+                        FetchEnvFunc const      &fetchEnv,
+                        ProcessExitedFunc const &exited,
+                        SystemCalls const       &system)
+{
+    std::string const   executable (fetchExecutable (tool, system));
+    ycom::NullTermArray argv (fetchArgv (tool));
+    ycom::NullTermArray env (fetchEnv (tool, system));
+
+    pid_t const child = system.SpawnChild (executable.c_str (),
+                                           argv.underlyingArray (),
+                                           env.underlyingArray (),
+                                           SystemCalls::InheritedFds ());
+    int const   status = system.WaitForChild (child);
+
+    exited (child);
+
+    return status;
+}
+
+int
+yexec::RelaunchCurrentProgramAndWait (Tool const              &tool,
+                                      int                     currentArgc,
+                                      char const * const *    currentArgv,
+                                      ProcessExitedFunc const &exited,
+                                      SystemCalls const       &system)
+{
+    using namespace std::placeholders;
+
+    FetchExecFunc fetchExecutable (std::bind (yexec::FindExecutable, _1, _2));
+    FetchArgvFunc fetchArgv (std::bind (yexec::GetToolArgv, _1,
+                                        currentArgc, currentArgv));
+    FetchEnvFunc fetchEnv (std::bind (yexec::GetToolEnv, _1, _2));
+
+    return RelaunchAndWait (tool,
+                            fetchExecutable,
+                            fetchArgv,
+                            fetchEnv,
+                            exited,
+                            system);
+}
+
+int
+yexec::RelaunchAndStream (Tool const               &tool,
+                          FetchExecFunc const      &fetchExecutable,
+                          FetchArgvFunc const      &fetchArgv,
+                          FetchEnvFunc const       &fetchEnv,
+                          StreamConsumerFunc const &consume,
+                          SystemCalls const        &system)
+{
+    std::string const   executable (fetchExecutable (tool, system));
+    ycom::NullTermArray argv (fetchArgv (tool));
+    ycom::NullTermArray env (fetchEnv (tool, system));
+
+    SystemCalls::Pipe const pipe (system.CreatePipe ());
+    auto closeReadEnd = folly::makeGuard ([&system, &pipe]() {
+                                              system.CloseFd (pipe.readFd);
+                                          });
+    auto closeWriteEnd = folly::makeGuard ([&system, &pipe]() {
+                                               system.CloseFd (pipe.writeFd);
+                                           });
+
+    SystemCalls::InheritedFds const inherited =
+    {
+        { pipe.writeFd, yconst::ResultsStreamFd }
+    };
+
+    pid_t const child = system.SpawnChild (executable.c_str (),
+                                           argv.underlyingArray (),
+                                           env.underlyingArray (),
+                                           inherited);
+
+    /* Otherwise we would never see the end of the stream */
+    closeWriteEnd.dismiss ();
+    system.CloseFd (pipe.writeFd);
+
+    std::vector <char> buffer (64 * 1024);
+    size_t             bytesRead;
+
+    while ((bytesRead = system.ReadFd (pipe.readFd,
+                                       &buffer[0],
+                                       buffer.size ())) > 0)
+    {
+        if (!consume (child, &buffer[0], bytesRead))
+        {
+            system.KillChild (child);
+            break;
+        }
+    }
+
+    return system.WaitForChild (child);
+}
+
+int
+yexec::RelaunchCurrentProgramAndStream (Tool const               &tool,
+                                        int                      currentArgc,
+                                        char const * const *     currentArgv,
+                                        StreamConsumerFunc const &consume,
+                                        SystemCalls const        &system)
+{
+    using namespace std::placeholders;
+
+    FetchExecFunc fetchExecutable (std::bind (yexec::FindExecutable, _1, _2));
+    FetchArgvFunc fetchArgv (std::bind (yexec::GetToolArgv, _1,
+                                        currentArgc, currentArgv));
+    FetchEnvFunc fetchEnv (std::bind (yexec::GetToolEnv, _1, _2));
+
+    return RelaunchAndStream (tool,
+                              fetchExecutable,
+                              fetchArgv,
+                              fetchEnv,
+                              consume,
+                              system);
+}
+
+namespace
+{
+    /* The read end of a pipe from one of the shards */
+    struct ShardPipe
+    {
+        pid_t       child;
+        int         fd;
+
+        /* Standard output and error, rather than results */
+        bool        isOutput;
+        std::string collected;
+    };
+
+    typedef std::vector <ShardPipe> ShardPipes;
+}
+
+int
+yexec::RelaunchShards (Tool const               &tool,
+                       unsigned int             shards,
+                       FetchExecFunc const      &fetchExecutable,
+                       FetchArgvFunc const      &fetchArgv,
+                       FetchShardEnvFunc const  &fetchEnv,
+                       StreamConsumerFunc const &consume,
+                       ProcessExitedFunc const  &exited,
+                       std::ostream             &output,
+                       SystemCalls const        &system)
+{
+    std::string const executable (fetchExecutable (tool, system));
+    std::vector <pid_t> children;
+    ShardPipes          pipes;
+
+    /* Nothing can be left running, or open, if anything fails */
+    auto cleanUp = folly::makeGuard ([&system, &children, &pipes]() {
+                                         for (ShardPipe const &pipe : pipes)
+                                             system.CloseFd (pipe.fd);
+
+                                         for (pid_t child : children)
+                                         {
+                                             try
+                                             {
+                                                 system.KillChild (child);
+                                                 system.WaitForChild (child);
+                                             }
+                                             catch (std::exception const &)
+                                             {
+                                             }
+                                         }
+                                     });
+
+    for (unsigned int index = 0; index < shards; ++index)
+    {
+        ycom::NullTermArray argv (fetchArgv (tool));
+        ycom::NullTermArray env (fetchEnv (tool, system,
+                                           Shard { index, shards }));
+
+        SystemCalls::Pipe const output (system.CreatePipe ());
+        pipes.push_back (ShardPipe { 0, output.readFd, true, std::string () });
+
+        SystemCalls::InheritedFds inherited =
+        {
+            { output.writeFd, STDOUT_FILENO },
+            { output.writeFd, STDERR_FILENO }
+        };
+        std::vector <int> writeFds = { output.writeFd };
+
+        if (consume)
+        {
+            SystemCalls::Pipe const stream (system.CreatePipe ());
+            pipes.push_back (ShardPipe { 0, stream.readFd, false, std::string () });
+            inherited.push_back ({ stream.writeFd, yconst::ResultsStreamFd });
+            writeFds.push_back (stream.writeFd);
+        }
+
+        pid_t child;
+
+        {
+            auto closeWriteEnds = folly::makeGuard ([&system, &writeFds]() {
+                                                        for (int fd : writeFds)
+                                                            system.CloseFd (fd);
+                                                    });
+
+            child = system.SpawnChild (executable.c_str (),
+                                       argv.underlyingArray (),
+                                       env.underlyingArray (),
+                                       inherited);
+        }
+
+        children.push_back (child);
+
+        for (ShardPipe &pipe : pipes)
+            if (!pipe.child)
+                pipe.child = child;
+    }
+
+    std::vector <char> buffer (64 * 1024);
+    bool               stopped = false;
+
+    while (!pipes.empty ())
+    {
+        SystemCalls::Fds fds;
+
+        for (ShardPipe const &pipe : pipes)
+            fds.push_back (pipe.fd);
+
+        for (int fd : system.PollReadable (fds))
+        {
+            auto pipe = std::find_if (pipes.begin (),
+                                      pipes.end (),
+                                      [fd](ShardPipe const &p) {
+                                          return p.fd == fd;
+                                      });
+
+            if (pipe == pipes.end ())
+                continue;
+
+            size_t const bytesRead (system.ReadFd (fd,
+                                                   &buffer[0],
+                                                   buffer.size ()));
+
+            if (bytesRead == 0)
+            {
+                if (pipe->isOutput)
+                    output << pipe->collected << std::flush;
+
+                system.CloseFd (fd);
+                pipes.erase (pipe);
+            }
+            else if (pipe->isOutput)
+                pipe->collected.append (&buffer[0], bytesRead);
+            else if (!stopped && !consume (pipe->child, &buffer[0], bytesRead))
+            {
+                /* Every shard is stopped, not just this one */
+                stopped = true;
+
+                for (pid_t child : children)
+                    system.KillChild (child);
+            }
+        }
+    }
+
+    int status = 0;
+
+    while (!children.empty ())
+    {
+        pid_t const child (children.front ());
+
+        status = std::max (status, system.WaitForChild (child));
+        children.erase (children.begin ());
+
+        exited (child);
+    }
+
+    cleanUp.dismiss ();
+
+    return status;
+}
+
+int
+yexec::RelaunchCurrentProgramSharded (Tool const               &tool,
+                                      unsigned int             shards,
+                                      int                      currentArgc,
+                                      char const * const *     currentArgv,
+                                      StreamConsumerFunc const &consume,
+                                      ProcessExitedFunc const  &exited,
+                                      std::ostream             &output,
+                                      SystemCalls const        &system)
+{
+    using namespace std::placeholders;
+
+    FetchExecFunc fetchExecutable (std::bind (yexec::FindExecutable, _1, _2));
+    FetchArgvFunc fetchArgv (std::bind (yexec::GetToolArgv, _1,
+                                        currentArgc, currentArgv));
+    FetchShardEnvFunc fetchEnv (std::bind (yexec::GetShardToolEnv,
+                                           _1, _2, _3));
+
+    return RelaunchShards (tool,
+                           shards,
+                           fetchExecutable,
+                           fetchArgv,
+                           fetchEnv,
+                           consume,
+                           exited,
+                           output,
+                           system);
+}
+
 std::string
 yexec::FindExecutable (Tool const        &tool,
                        SystemCalls const &system)
@@ -130,3 +633,157 @@ yexec::GetToolEnv (Tool const        &tool,
 
     return environment;
 }
+
+namespace
+{
+    /* Reads the value of an environment entry named by key, if
+     * entry is for key and its value is a whole number */
+    bool ReadShardVariable (std::string const &entry,
+                            char const        *key,
+                            unsigned long     &value)
+    {
+        std::string const prefix (std::string (key) + "=");
+
+        if (!boost::starts_with (entry, prefix) ||
+            entry.size () == prefix.size ())
+            return false;
+
+        std::string const number (entry.substr (prefix.size ()));
+
+        if (!boost::all (number, boost::is_digit ()))
+            return false;
+
+        value = std::strtoul (number.c_str (), nullptr, 10);
+        return true;
+    }
+
+    bool IsShardVariable (std::string const &entry)
+    {
+        return boost::starts_with (
+                   entry,
+                   std::string (yconst::GoogleTestShardIndexEnvKey) + "=") ||
+               boost::starts_with (
+                   entry,
+                   std::string (yconst::GoogleTestTotalShardsEnvKey) + "=");
+    }
+}
+
+yexec::Shard
+yexec::InheritedShard (SystemCalls const &system)
+{
+    unsigned long index = 0;
+    unsigned long total = 0;
+    bool          haveIndex = false;
+    bool          haveTotal = false;
+
+    for (char const * const *variable = system.GetSystemEnvironment ();
+         variable && *variable;
+         ++variable)
+    {
+        std::string const entry (*variable);
+
+        /* The first of any duplicate variables wins */
+        if (!haveIndex)
+            haveIndex = ReadShardVariable (entry,
+                                           yconst::GoogleTestShardIndexEnvKey,
+                                           index);
+        if (!haveTotal)
+            haveTotal = ReadShardVariable (entry,
+                                           yconst::GoogleTestTotalShardsEnvKey,
+                                           total);
+    }
+
+    /* Google Test only shards when both are set and make sense */
+    if (!haveIndex || !haveTotal || index >= total)
+        return Shard { 0, 1 };
+
+    return Shard {
+               static_cast <unsigned int> (index),
+               static_cast <unsigned int> (total)
+           };
+}
+
+yexec::TestNames
+yexec::TestsInShard (TestNames const &tests, Shard const &shard)
+{
+    TestNames inShard;
+
+    for (size_t i = shard.index; i < tests.size (); i += shard.total)
+        inShard.push_back (tests[i]);
+
+    return inShard;
+}
+
+ycom::NullTermArray
+yexec::GetTestToolEnv (Tool const        &tool,
+                       SystemCalls const &system)
+{
+    std::string const &name (tool.InstrumentationName ());
+
+    if (name.empty ())
+        throw std::logic_error ("provided tool with no InstrumentationName");
+
+    ycom::NullTermArray environment;
+
+    for (char const * const *variable = system.GetSystemEnvironment ();
+         variable && *variable;
+         ++variable)
+    {
+        std::string const entry (*variable);
+
+        if (!IsShardVariable (entry))
+            environment.append (entry);
+    }
+
+    ycom::InsertEnvironmentPair (environment,
+                                 yconst::YiqiToolEnvKey,
+                                 name.c_str ());
+
+    return environment;
+}
+
+ycom::NullTermArray
+yexec::GetShardToolEnv (Tool const        &tool,
+                        SystemCalls const &system,
+                        Shard const       &shard)
+{
+    std::string const &name (tool.InstrumentationName ());
+
+    if (name.empty ())
+        throw std::logic_error ("provided tool with no InstrumentationName");
+
+    /* Each shard of ours is a part of the shard the caller
+     * asked for, if any */
+    Shard const inherited (InheritedShard (system));
+    Shard const composed =
+    {
+        inherited.index * shard.total + shard.index,
+        inherited.total * shard.total
+    };
+
+    /* The first of any duplicate variables wins, so the caller's
+     * sharding variables are replaced rather than added to */
+    ycom::NullTermArray environment;
+
+    for (char const * const *variable = system.GetSystemEnvironment ();
+         variable && *variable;
+         ++variable)
+    {
+        std::string const entry (*variable);
+
+        if (!IsShardVariable (entry))
+            environment.append (entry);
+    }
+
+    ycom::InsertEnvironmentPair (environment,
+                                 yconst::YiqiToolEnvKey,
+                                 name.c_str ());
+    ycom::InsertEnvironmentPair (environment,
+                                 yconst::GoogleTestShardIndexEnvKey,
+                                 std::to_string (composed.index).c_str ());
+    ycom::InsertEnvironmentPair (environment,
+                                 yconst::GoogleTestTotalShardsEnvKey,
+                                 std::to_string (composed.total).c_str ());
+
+    return environment;
+}
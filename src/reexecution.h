@@ -10,8 +10,12 @@
 #define YIQI_REEXECUTION_H
 
 #include <functional>
+#include <iosfwd>
+#include <string>
 #include <vector>
 
+#include <sys/types.h>
+
 namespace yiqi
 {
     namespace commandline
@@ -77,6 +81,41 @@ namespace yiqi
         NullTermArray GetToolEnv (Tool const        &tool,
                                   SystemCalls const &system);
 
+        /**
+         * @brief Shard is one of several parts which the tests are split
+         * into, so that they can run in more than one process at once
+         */
+        struct Shard
+        {
+            unsigned int index;
+            unsigned int total;
+        };
+
+        /**
+         * @brief InheritedShard
+         * @param system a yiqi::system::api::SystemCalls
+         * @return the shard of the tests which whoever launched this
+         * process asked for with Google Test's sharding variables, or
+         * the only shard of one if they did not ask for a valid one
+         */
+        Shard InheritedShard (SystemCalls const &system);
+
+        /**
+         * @brief GetShardToolEnv
+         * @param tool a yiqi::instrumentation::tools::Tool
+         * @param system a yiqi::system::api::SystemCalls
+         * @param shard the shard of the tests which the tool
+         * executable should run, out of those in the InheritedShard
+         * @return a yiqi::commandline::NullTermArray of the environment
+         * to pass to the tool executable, with Google Test's sharding
+         * variables replaced. Shard i of N inside inherited shard k of M
+         * becomes shard k * N + i of M * N, so that the tests are still
+         * split between machines as they were asked to be.
+         */
+        NullTermArray GetShardToolEnv (Tool const        &tool,
+                                       SystemCalls const &system,
+                                       Shard const       &shard);
+
         typedef std::function <std::string (Tool const        &,
                                             SystemCalls const &)> FetchExecFunc;
         typedef std::function <NullTermArray (Tool const &)> FetchArgvFunc;
@@ -122,6 +161,273 @@ namespace yiqi
                                      char const * const * currentArgv,
                                      SystemCalls const    &system);
 
+        typedef std::vector <std::string> TestNames;
+
+        /**
+         * @brief TestsInShard picks the tests which Google Test would
+         * run in shard, that is every shard.total'th test starting from
+         * the shard.index'th
+         * @param tests the full names of the tests which would run if
+         * there were no sharding, in the order Google Test runs them
+         * @param shard the shard of those tests to pick
+         * @return the tests in that shard, in the same order
+         */
+        TestNames TestsInShard (TestNames const &tests, Shard const &shard);
+
+        /**
+         * @brief GetTestToolEnv
+         * @param tool a yiqi::instrumentation::tools::Tool
+         * @param system a yiqi::system::api::SystemCalls
+         * @return a yiqi::commandline::NullTermArray of the environment
+         * to pass to a tool executable which is given the tests it is to
+         * run by name, without Google Test's sharding variables. Those
+         * tests are already in the right shard, and a shard of them would
+         * leave most of them out.
+         */
+        NullTermArray GetTestToolEnv (Tool const        &tool,
+                                      SystemCalls const &system);
+
+        /**
+         * @brief TestRun is a child which ran a single test
+         */
+        struct TestRun
+        {
+            std::string test;
+            pid_t       child;
+            int         status;
+
+            /* From starting the child until it exited */
+            double      seconds;
+        };
+
+        typedef std::function <void (TestRun const &)> ChildExitedFunc;
+
+        /**
+         * @brief RelaunchForEachTest runs the tool binary in a new child
+         * process once for each test, passing each child a --gtest_filter
+         * selecting only its test. Up to slots children run at once, and
+         * the next test is started as soon as any child exits, in the
+         * order that tests are given in. When more than one child can
+         * run at once, the output of each is collected and written out
+         * in one piece once it exits, rather than going straight to
+         * this process's output.
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param tests the full names (Case.Test) of the tests to run
+         * @param slots the most children to run at once
+         * @param fetchExecutable a FetchExecFunc callback to fetch the
+         * path to the tool binary
+         * @param fetchArgv a FetchArgvFunc callback to fetch the argv
+         * to provide to the tool binary, before the filter is appended
+         * @param fetchEnv a FetchEnvFunc callback to fetch the environment
+         * to provide to the tool binary
+         * @param exited a ChildExitedFunc callback called once each child
+         * has exited, after its output has been written
+         * @param output where to write the output of each child
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the highest exit status of any of the children
+         */
+        int RelaunchForEachTest (Tool const            &tool,
+                                 TestNames const       &tests,
+                                 unsigned int          slots,
+                                 FetchExecFunc const   &fetchExecutable,
+                                 FetchArgvFunc const   &fetchArgv,
+                                 FetchEnvFunc const    &fetchEnv,
+                                 ChildExitedFunc const &exited,
+                                 std::ostream          &output,
+                                 SystemCalls const     &system);
+
+        /**
+         * @brief RelaunchCurrentProgramForEachTest
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param tests the full names (Case.Test) of the tests to run
+         * @param slots the most children to run at once
+         * @param currentArgc the current program argc passed to main ()
+         * @param currentArgv the current program argv passed to main ()
+         * @param exited a ChildExitedFunc callback called once each child
+         * has exited, after its output has been written
+         * @param output where to write the output of each child
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the highest exit status of any of the children
+         */
+        int RelaunchCurrentProgramForEachTest (Tool const            &tool,
+                                               TestNames const       &tests,
+                                               unsigned int          slots,
+                                               int                   currentArgc,
+                                               char const * const *  currentArgv,
+                                               ChildExitedFunc const &exited,
+                                               std::ostream          &output,
+                                               SystemCalls const     &system);
+
+        typedef std::function <void (pid_t)> ProcessExitedFunc;
+
+        /**
+         * @brief RelaunchAndWait runs the tool binary in a single new
+         * child process and waits for it to exit, rather than
+         * replacing this process with it
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param fetchExecutable a FetchExecFunc callback to fetch the
+         * path to the tool binary
+         * @param fetchArgv a FetchArgvFunc callback to fetch the argv
+         * to provide to the tool binary
+         * @param fetchEnv a FetchEnvFunc callback to fetch the environment
+         * to provide to the tool binary
+         * @param exited a ProcessExitedFunc callback called with the
+         * process ID once the child has exited
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the exit status of the child
+         */
+        int RelaunchAndWait (Tool const              &tool,
+                             FetchExecFunc const     &fetchExecutable,
+                             FetchArgvFunc const     &fetchArgv,
+                             FetchEnvFunc const      &fetchEnv,
+                             ProcessExitedFunc const &exited,
+                             SystemCalls const       &system);
+
+        /**
+         * @brief RelaunchCurrentProgramAndWait
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param currentArgc the current program argc passed to main ()
+         * @param currentArgv the current program argv passed to main ()
+         * @param exited a ProcessExitedFunc callback called with the
+         * process ID once the child has exited
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the exit status of the child
+         */
+        int RelaunchCurrentProgramAndWait (Tool const              &tool,
+                                           int                     currentArgc,
+                                           char const * const *    currentArgv,
+                                           ProcessExitedFunc const &exited,
+                                           SystemCalls const       &system);
+
+        typedef std::function <bool (pid_t,
+                                     char const *,
+                                     size_t)> StreamConsumerFunc;
+
+        /**
+         * @brief RelaunchAndStream runs the tool binary in a new child
+         * process with a pipe as yiqi::constants::ResultsStreamFd, and
+         * passes everything written to that pipe on to consume as it
+         * arrives, until the child closes it
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param fetchExecutable a FetchExecFunc callback to fetch the
+         * path to the tool binary
+         * @param fetchArgv a FetchArgvFunc callback to fetch the argv
+         * to provide to the tool binary
+         * @param fetchEnv a FetchEnvFunc callback to fetch the environment
+         * to provide to the tool binary
+         * @param consume a StreamConsumerFunc callback, which may return
+         * false to have the child terminated early
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the exit status of the child
+         */
+        int RelaunchAndStream (Tool const               &tool,
+                               FetchExecFunc const      &fetchExecutable,
+                               FetchArgvFunc const      &fetchArgv,
+                               FetchEnvFunc const       &fetchEnv,
+                               StreamConsumerFunc const &consume,
+                               SystemCalls const        &system);
+
+        /**
+         * @brief RelaunchCurrentProgramAndStream
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param currentArgc the current program argc passed to main ()
+         * @param currentArgv the current program argv passed to main ()
+         * @param consume a StreamConsumerFunc callback, which may return
+         * false to have the child terminated early
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the exit status of the child
+         */
+        int RelaunchCurrentProgramAndStream (Tool const               &tool,
+                                             int                      currentArgc,
+                                             char const * const *     currentArgv,
+                                             StreamConsumerFunc const &consume,
+                                             SystemCalls const        &system);
+
+        typedef std::function <NullTermArray (Tool const        &,
+                                              SystemCalls const &,
+                                              Shard const       &)>
+            FetchShardEnvFunc;
+
+        /**
+         * @brief RelaunchShards runs the tool binary in several child
+         * processes at once, each running its own shard of the tests.
+         * What each child writes to its standard output and error is
+         * collected, and written out all together once it is done, so
+         * that the output of different shards is not interleaved.
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param shards how many children to split the tests between
+         * @param fetchExecutable a FetchExecFunc callback to fetch the
+         * path to the tool binary
+         * @param fetchArgv a FetchArgvFunc callback to fetch the argv
+         * to provide to the tool binary
+         * @param fetchEnv a FetchShardEnvFunc callback to fetch the
+         * environment to provide to the tool binary for each shard
+         * @param consume a StreamConsumerFunc callback which is passed
+         * whatever each child writes to yiqi::constants::ResultsStreamFd,
+         * and may return false to have all of the children terminated
+         * early, or an empty function if the tool does not stream results
+         * @param exited a ProcessExitedFunc callback called with each
+         * child's process ID once all of them have exited
+         * @param output where to write the output of each child
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the highest exit status of any of the children
+         */
+        int RelaunchShards (Tool const               &tool,
+                            unsigned int             shards,
+                            FetchExecFunc const      &fetchExecutable,
+                            FetchArgvFunc const      &fetchArgv,
+                            FetchShardEnvFunc const  &fetchEnv,
+                            StreamConsumerFunc const &consume,
+                            ProcessExitedFunc const  &exited,
+                            std::ostream             &output,
+                            SystemCalls const        &system);
+
+        /**
+         * @brief RelaunchCurrentProgramSharded
+         * @param tool a yiqi::instrumentation::tools::Tool with information
+         * about what process we should relaunch under
+         * @param shards how many children to split the tests between
+         * @param currentArgc the current program argc passed to main ()
+         * @param currentArgv the current program argv passed to main ()
+         * @param consume a StreamConsumerFunc callback, or an empty
+         * function if the tool does not stream results
+         * @param exited a ProcessExitedFunc callback called with each
+         * child's process ID once all of them have exited
+         * @param output where to write the output of each child
+         * @throws std::runtime_error if the binary wasn't found
+         * @throws std::logic_error if this tool has no binary
+         * @throws std::system_error if the system call failed
+         * @return the highest exit status of any of the children
+         */
+        int RelaunchCurrentProgramSharded (Tool const               &tool,
+                                           unsigned int             shards,
+                                           int                      currentArgc,
+                                           char const * const *     currentArgv,
+                                           StreamConsumerFunc const &consume,
+                                           ProcessExitedFunc const  &exited,
+                                           std::ostream             &output,
+                                           SystemCalls const        &system);
     }
 }
 
@@ -0,0 +1,175 @@
+/*
+ * resource_usage.cpp:
+ * Samples the resources used by the test process, from getrusage
+ * and from /proc/self, for measuring client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include "resource_usage.h"
+
+namespace yres = yiqi::resources;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    uint64_t const BytesPerKilobyte (1024);
+
+    /* Calls the function with the key and number on each line
+     * of the form "key: number", skipping everything else */
+    template <typename Function>
+    void ForEachField (std::istream &stream, Function const &function)
+    {
+        std::string line;
+
+        while (std::getline (stream, line))
+        {
+            size_t const colon (line.find (':'));
+
+            if (colon == std::string::npos)
+                continue;
+
+            std::istringstream value (line.substr (colon + 1));
+            uint64_t number;
+
+            if (value >> number)
+                function (line.substr (0, colon), number);
+        }
+    }
+
+    std::string ReadWholeFile (char const *path)
+    {
+        std::ifstream file (path);
+        std::stringstream contents;
+
+        contents << file.rdbuf ();
+        return contents.str ();
+    }
+
+    double Nanoseconds (timeval const &time)
+    {
+        return time.tv_sec * 1e9 + time.tv_usec * 1e3;
+    }
+
+    /* A difference between two samples which is never negative, as
+     * counters read from different places can disagree slightly */
+    double Increase (uint64_t entry, uint64_t exit)
+    {
+        return exit > entry ? double (exit - entry) : 0.0;
+    }
+}
+
+void
+yres::ReadStatus (std::istream &status, Usage &usage)
+{
+    ForEachField (status, [&usage](std::string const &key, uint64_t value) {
+        if (key == "VmRSS")
+            usage.residentBytes = value * BytesPerKilobyte;
+        else if (key == "VmHWM")
+            usage.peakResidentBytes = value * BytesPerKilobyte;
+    });
+}
+
+void
+yres::ReadIO (std::istream &io, Usage &usage)
+{
+    ForEachField (io, [&usage](std::string const &key, uint64_t value) {
+        if (key == "rchar")
+            usage.readBytes = value;
+        else if (key == "wchar")
+            usage.writtenBytes = value;
+        else if (key == "read_bytes")
+            usage.storageReadBytes = value;
+        else if (key == "write_bytes")
+            usage.storageWrittenBytes = value;
+    });
+}
+
+yres::Usage
+yres::Sample ()
+{
+    Usage usage = Usage ();
+
+    /* Only this thread if the system can tell threads apart,
+     * otherwise the whole process */
+#ifdef RUSAGE_THREAD
+    int const who (RUSAGE_THREAD);
+#else
+    int const who (RUSAGE_SELF);
+#endif
+
+    rusage resources;
+
+    if (getrusage (who, &resources) == 0)
+    {
+        usage.userNanoseconds = Nanoseconds (resources.ru_utime);
+        usage.systemNanoseconds = Nanoseconds (resources.ru_stime);
+        usage.voluntarySwitches = resources.ru_nvcsw;
+        usage.involuntarySwitches = resources.ru_nivcsw;
+        usage.minorFaults = resources.ru_minflt;
+        usage.majorFaults = resources.ru_majflt;
+    }
+
+    /* Reading these files counts towards the bytes read, so read the
+     * counters first and keep track of what was read after them */
+    std::string const ioContents (ReadWholeFile ("/proc/self/io"));
+    std::string const statusContents (ReadWholeFile ("/proc/self/status"));
+
+    std::istringstream io (ioContents);
+    ReadIO (io, usage);
+
+    std::istringstream status (statusContents);
+    ReadStatus (status, usage);
+
+    usage.sampleReadBytes = ioContents.size () + statusContents.size ();
+
+    return usage;
+}
+
+bool
+yres::ResetPeakResidentSize ()
+{
+    /* See proc(5), clear_refs */
+    std::ofstream clearRefs ("/proc/self/clear_refs");
+    clearRefs << "5" << std::endl;
+
+    return static_cast <bool> (clearRefs);
+}
+
+ymeas::Metrics
+yres::UsageMetrics (Usage const &entry, Usage const &exit)
+{
+    double const residentChange (double (exit.residentBytes) -
+                                 double (entry.residentBytes));
+
+    return ymeas::Metrics
+    {
+        { "cpu.user.ns",
+          std::max (exit.userNanoseconds - entry.userNanoseconds, 0.0) },
+        { "cpu.system.ns",
+          std::max (exit.systemNanoseconds - entry.systemNanoseconds, 0.0) },
+        { "context.switches.voluntary",
+          Increase (entry.voluntarySwitches, exit.voluntarySwitches) },
+        { "context.switches.involuntary",
+          Increase (entry.involuntarySwitches, exit.involuntarySwitches) },
+        { "page.faults.minor", Increase (entry.minorFaults, exit.minorFaults) },
+        { "page.faults.major", Increase (entry.majorFaults, exit.majorFaults) },
+        { "rss.delta.bytes", residentChange },
+        { "rss.peak.bytes", double (exit.peakResidentBytes) },
+        { "io.read.bytes",
+          Increase (entry.readBytes + entry.sampleReadBytes, exit.readBytes) },
+        { "io.write.bytes", Increase (entry.writtenBytes, exit.writtenBytes) },
+        { "io.storage.read.bytes",
+          Increase (entry.storageReadBytes, exit.storageReadBytes) },
+        { "io.storage.write.bytes",
+          Increase (entry.storageWrittenBytes, exit.storageWrittenBytes) }
+    };
+}
@@ -0,0 +1,93 @@
+/*
+ * resource_usage.h:
+ * Samples the resources used by the test process, from getrusage
+ * and from /proc/self, for measuring client code in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_RESOURCE_USAGE_H
+#define YIQI_RESOURCE_USAGE_H
+
+#include <cstdint>
+#include <iosfwd>
+
+#include "measurement.h"
+
+namespace yiqi
+{
+    namespace resources
+    {
+        /**
+         * @brief Usage is a sample of resources used so far. Processor
+         * time, context switches and page faults are for the calling
+         * thread where the system can tell them apart. Resident set sizes
+         * and I/O are for the whole process. Anything which could not be
+         * read is left as zero.
+         */
+        struct Usage
+        {
+            double   userNanoseconds;
+            double   systemNanoseconds;
+            uint64_t voluntarySwitches;
+            uint64_t involuntarySwitches;
+            uint64_t minorFaults;
+            uint64_t majorFaults;
+            uint64_t residentBytes;
+            uint64_t peakResidentBytes;
+            uint64_t readBytes;
+            uint64_t writtenBytes;
+            uint64_t storageReadBytes;
+            uint64_t storageWrittenBytes;
+
+            /* Bytes read from /proc/self by Sample after it read the
+             * I/O counters, which are not client code's */
+            uint64_t sampleReadBytes;
+        };
+
+        /**
+         * @brief ReadStatus reads the current and peak resident set
+         * sizes from the format of /proc/self/status
+         * @param status the contents of /proc/self/status
+         * @param usage residentBytes and peakResidentBytes are set
+         */
+        void ReadStatus (std::istream &status, Usage &usage);
+
+        /**
+         * @brief ReadIO reads the bytes read and written from the format
+         * of /proc/self/io
+         * @param io the contents of /proc/self/io
+         * @param usage readBytes, writtenBytes, storageReadBytes and
+         * storageWrittenBytes are set
+         */
+        void ReadIO (std::istream &io, Usage &usage);
+
+        /**
+         * @brief Sample
+         * @return the resources used so far, with the I/O counters read
+         * before anything else in /proc/self
+         */
+        Usage Sample ();
+
+        /**
+         * @brief ResetPeakResidentSize sets the peak resident set size
+         * back to the current one, so that the next peak read back is
+         * the highest since now
+         * @return false if the system does not allow it, in which case
+         * the peak is the highest since the process started
+         */
+        bool ResetPeakResidentSize ();
+
+        /**
+         * @brief UsageMetrics
+         * @param entry the sample taken when client code started
+         * @param exit the sample taken when it finished
+         * @return the resources used between the two samples, along with
+         * the peak resident set size as of exit
+         */
+        measurement::Metrics UsageMetrics (Usage const &entry,
+                                           Usage const &exit);
+    }
+}
+
+#endif // YIQI_RESOURCE_USAGE_H
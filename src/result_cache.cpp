@@ -0,0 +1,151 @@
+/*
+ * result_cache.cpp:
+ * Keeps what a tool found in each test, so that running the
+ * same tool over the same code again does not need to run the
+ * test under instrumentation at all
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "result_cache.h"
+
+namespace ycache = yiqi::cache;
+namespace ymeas = yiqi::measurement;
+namespace ysysapi = yiqi::system::api;
+
+namespace
+{
+    std::string EntryPath (std::string const &directory,
+                           std::string const &key)
+    {
+        return directory + "/" + key;
+    }
+}
+
+std::string
+ycache::Fingerprint (std::string const &data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (char c : data)
+    {
+        hash ^= static_cast <unsigned char> (c);
+        hash *= 1099511628211ULL;
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::setw (16) << std::setfill ('0') << hash;
+
+    return ss.str ();
+}
+
+std::string
+ycache::CodeIdentity (ysysapi::SystemCalls::LoadedObjects const &objects)
+{
+    std::stringstream identity;
+
+    for (ysysapi::SystemCalls::LoadedObject const &object : objects)
+    {
+        if (!object.buildID.empty ())
+        {
+            identity << "build-id " << object.buildID << "\n";
+            continue;
+        }
+
+        std::ifstream file (object.path, std::ios::binary);
+
+        /* Objects which are not files, like the vdso, are
+         * part of the system rather than the code under test */
+        if (!file)
+        {
+            identity << "path " << object.path << "\n";
+            continue;
+        }
+
+        std::string const contents ((std::istreambuf_iterator <char> (file)),
+                                    std::istreambuf_iterator <char> ());
+
+        identity << "contents " << Fingerprint (contents) << "\n";
+    }
+
+    return identity.str ();
+}
+
+std::string
+ycache::Key (std::string const &identity,
+             std::string const &test,
+             std::string const &tool,
+             std::string const &wrapperOptions)
+{
+    /* None of these can contain a nul */
+    std::string const separator (1, '\0');
+
+    return Fingerprint (identity + separator +
+                        test + separator +
+                        tool + separator +
+                        wrapperOptions);
+}
+
+bool
+ycache::Lookup (std::string const &directory,
+                std::string const &key,
+                ymeas::Metrics    &metrics)
+{
+    std::ifstream entry (EntryPath (directory, key));
+
+    if (!entry)
+        return false;
+
+    metrics.clear ();
+
+    for (ymeas::Result const &result : ymeas::ReadResults (entry))
+        metrics.push_back (result.metric);
+
+    return true;
+}
+
+void
+ycache::Store (std::string const    &directory,
+               std::string const    &key,
+               std::string const    &test,
+               std::string const    &tool,
+               ymeas::Metrics const &metrics)
+{
+    if (mkdir (directory.c_str (), 0777) == -1 && errno != EEXIST)
+        throw std::runtime_error ("could not create cache directory " +
+                                  directory);
+
+    std::string const path (EntryPath (directory, key));
+    std::string const written (path + "." + std::to_string (getpid ()));
+
+    {
+        std::ofstream entry (written, std::ios::trunc);
+
+        /* So that it is clear what each entry is for */
+        entry << "# " << test << " " << tool << "\n";
+        ymeas::WriteResults (entry, test, tool, metrics);
+
+        if (!entry)
+            throw std::runtime_error ("could not write cache entry " +
+                                      written);
+    }
+
+    /* Only a whole entry can ever be looked up */
+    if (std::rename (written.c_str (), path.c_str ()) == -1)
+    {
+        std::remove (written.c_str ());
+        throw std::runtime_error ("could not write cache entry " + path);
+    }
+}
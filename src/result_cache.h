@@ -0,0 +1,87 @@
+/*
+ * result_cache.h:
+ * Keeps what a tool found in each test, so that running the
+ * same tool over the same code again does not need to run the
+ * test under instrumentation at all
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_RESULT_CACHE_H
+#define YIQI_RESULT_CACHE_H
+
+#include <string>
+
+#include "measurement.h"
+#include "system_api.h"
+
+namespace yiqi
+{
+    namespace cache
+    {
+        /**
+         * @brief Fingerprint
+         * @param data anything
+         * @return a 64 bit FNV-1a hash of data, in hex, which is the
+         * same from one run to the next
+         */
+        std::string Fingerprint (std::string const &data);
+
+        /**
+         * @brief CodeIdentity identifies the code which the tests run,
+         * so that anything kept from an earlier run is only used again
+         * if none of it has changed. Objects are identified by their
+         * build-id, or by their contents if they have no build-id.
+         * @param objects the objects loaded into the test process
+         * @return something which changes whenever any of the code in
+         * objects does
+         */
+        std::string CodeIdentity (system::api::SystemCalls::LoadedObjects const &objects);
+
+        /**
+         * @brief Key
+         * @param identity the CodeIdentity of the test process
+         * @param test the full name (Case.Test) of the test
+         * @param tool the name of the tool which ran it
+         * @param wrapperOptions the options the tool's wrapper was
+         * started with
+         * @return the name which what was found in test is kept under
+         */
+        std::string Key (std::string const &identity,
+                         std::string const &test,
+                         std::string const &tool,
+                         std::string const &wrapperOptions);
+
+        /**
+         * @brief Lookup
+         * @param directory where the cache is kept
+         * @param key the Key of the test
+         * @param metrics set to everything measured in the test, which
+         * may be nothing
+         * @throws std::runtime_error if the kept results are malformed
+         * @return whether anything was kept for the test
+         */
+        bool Lookup (std::string const    &directory,
+                     std::string const    &key,
+                     measurement::Metrics &metrics);
+
+        /**
+         * @brief Store keeps what was measured in a test which passed,
+         * creating directory if need be. Other processes storing and
+         * looking up at the same time never see half of what was kept.
+         * @param directory where the cache is kept
+         * @param key the Key of the test
+         * @param test the full name of the test
+         * @param tool the name of the tool which measured it
+         * @param metrics everything measured in the test
+         * @throws std::runtime_error if the results could not be kept
+         */
+        void Store (std::string const          &directory,
+                    std::string const          &key,
+                    std::string const          &test,
+                    std::string const          &tool,
+                    measurement::Metrics const &metrics);
+    }
+}
+
+#endif // YIQI_RESULT_CACHE_H
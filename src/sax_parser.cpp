@@ -0,0 +1,207 @@
+/*
+ * sax_parser.cpp:
+ * A small, incremental SAX-style XML parser, which can be fed
+ * a document in pieces as it arrives
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "sax_parser.h"
+
+namespace yxml = yiqi::xml;
+
+namespace
+{
+    bool IsSpace (char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    /* Characters up to the first space, / or the end of the tag */
+    std::string ElementName (std::string const &tag, size_t start)
+    {
+        size_t end = start;
+
+        while (end < tag.size () && !IsSpace (tag[end]) && tag[end] != '/')
+            ++end;
+
+        return tag.substr (start, end - start);
+    }
+
+    /* Appends the UTF-8 encoding of a character reference */
+    void AppendCodePoint (std::string &out, unsigned long codePoint)
+    {
+        if (codePoint < 0x80)
+            out += static_cast <char> (codePoint);
+        else if (codePoint < 0x800)
+        {
+            out += static_cast <char> (0xC0 | (codePoint >> 6));
+            out += static_cast <char> (0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast <char> (0xE0 | (codePoint >> 12));
+            out += static_cast <char> (0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast <char> (0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast <char> (0xF0 | (codePoint >> 18));
+            out += static_cast <char> (0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast <char> (0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast <char> (0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
+yxml::SAXParser::SAXParser (SAXHandler &handler) :
+    mHandler (handler),
+    mInTag (false),
+    mQuote ('\0')
+{
+}
+
+void
+yxml::SAXParser::FinishText ()
+{
+    bool const allSpace (std::all_of (mPending.begin (),
+                                      mPending.end (),
+                                      IsSpace));
+
+    if (!allSpace)
+        mHandler.Text (DecodeEntities (mPending));
+
+    mPending.clear ();
+}
+
+void
+yxml::SAXParser::FinishTag ()
+{
+    std::string tag;
+    tag.swap (mPending);
+
+    /* Declarations, comments and processing instructions */
+    if (tag.empty () || tag[0] == '!' || tag[0] == '?')
+        return;
+
+    if (tag[0] == '/')
+    {
+        mHandler.EndElement (ElementName (tag, 1));
+        return;
+    }
+
+    std::string const name (ElementName (tag, 0));
+
+    if (name.empty ())
+        throw std::runtime_error ("XML tag with no element name");
+
+    mHandler.StartElement (name);
+
+    if (tag[tag.size () - 1] == '/')
+        mHandler.EndElement (name);
+}
+
+void
+yxml::SAXParser::Feed (char const *data, size_t size)
+{
+    for (char const *c = data; c != data + size; ++c)
+    {
+        if (!mInTag)
+        {
+            if (*c == '<')
+            {
+                FinishText ();
+                mInTag = true;
+            }
+            else
+                mPending += *c;
+
+            continue;
+        }
+
+        bool const inComment (boost::starts_with (mPending, "!--"));
+
+        if (mQuote)
+        {
+            if (*c == mQuote)
+                mQuote = '\0';
+        }
+        else if ((*c == '"' || *c == '\'') && !inComment)
+            mQuote = *c;
+        else if (*c == '>' &&
+                 (!inComment || boost::ends_with (mPending, "--")))
+        {
+            mInTag = false;
+            FinishTag ();
+            continue;
+        }
+
+        mPending += *c;
+    }
+}
+
+std::string
+yxml::DecodeEntities (std::string const &text)
+{
+    std::string decoded;
+    size_t      position = 0;
+
+    decoded.reserve (text.size ());
+
+    while (position < text.size ())
+    {
+        size_t const ampersand (text.find ('&', position));
+
+        decoded.append (text, position, ampersand - position);
+
+        if (ampersand == std::string::npos)
+            break;
+
+        size_t const semicolon (text.find (';', ampersand));
+
+        if (semicolon == std::string::npos)
+            throw std::runtime_error ("unterminated XML entity");
+
+        std::string const entity (text.substr (ampersand + 1,
+                                               semicolon - ampersand - 1));
+
+        if (entity == "amp")
+            decoded += '&';
+        else if (entity == "lt")
+            decoded += '<';
+        else if (entity == "gt")
+            decoded += '>';
+        else if (entity == "quot")
+            decoded += '"';
+        else if (entity == "apos")
+            decoded += '\'';
+        else if (entity.size () > 1 && entity[0] == '#')
+        {
+            bool const hex (entity[1] == 'x' || entity[1] == 'X');
+            char const *digits (entity.c_str () + (hex ? 2 : 1));
+            char       *end;
+
+            unsigned long const codePoint (strtoul (digits,
+                                                    &end,
+                                                    hex ? 16 : 10));
+
+            if (*end || end == digits)
+                throw std::runtime_error ("malformed XML character "
+                                          "reference &" + entity + ";");
+
+            AppendCodePoint (decoded, codePoint);
+        }
+        else
+            throw std::runtime_error ("unknown XML entity &" + entity + ";");
+
+        position = semicolon + 1;
+    }
+
+    return decoded;
+}
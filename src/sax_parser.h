@@ -0,0 +1,93 @@
+/*
+ * sax_parser.h:
+ * A small, incremental SAX-style XML parser, which can be fed
+ * a document in pieces as it arrives
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_SAX_PARSER_H
+#define YIQI_SAX_PARSER_H
+
+#include <cstddef>
+#include <string>
+
+namespace yiqi
+{
+    namespace xml
+    {
+        /**
+         * @brief SAXHandler is called back as a SAXParser finds each
+         * part of a document
+         */
+        class SAXHandler
+        {
+            public:
+
+                virtual ~SAXHandler () {};
+
+                virtual void StartElement (std::string const &name) = 0;
+                virtual void EndElement (std::string const &name) = 0;
+
+                /**
+                 * @brief Text is called with the text between two tags,
+                 * with entities decoded, unless it is all whitespace
+                 * @param text the text
+                 */
+                virtual void Text (std::string const &text) = 0;
+
+            protected:
+
+                SAXHandler () = default;
+        };
+
+        /**
+         * @brief SAXParser understands enough XML for the output of
+         * instrumentation tools, that is elements, text and entities.
+         * Attributes are skipped, as are comments, declarations and
+         * processing instructions.
+         */
+        class SAXParser
+        {
+            public:
+
+                explicit SAXParser (SAXHandler &handler);
+
+                /**
+                 * @brief Feed parses the next piece of the document, which
+                 * may end anywhere, including in the middle of a tag
+                 * @param data the next piece of the document
+                 * @param size the length of data
+                 * @throws std::runtime_error if the document is malformed
+                 */
+                void Feed (char const *data, size_t size);
+
+            private:
+
+                SAXParser (SAXParser const &) = delete;
+                SAXParser & operator= (SAXParser const &) = delete;
+
+                void FinishText ();
+                void FinishTag ();
+
+                SAXHandler  &mHandler;
+
+                /* Whether we are inside a tag, and if so which quote
+                 * an attribute value is in, if any */
+                bool        mInTag;
+                char        mQuote;
+                std::string mPending;
+        };
+
+        /**
+         * @brief DecodeEntities replaces the predefined entities
+         * and character references in text
+         * @param text text from an XML document
+         * @throws std::runtime_error on an unknown or unterminated entity
+         * @return the decoded text
+         */
+        std::string DecodeEntities (std::string const &text);
+    }
+}
+
+#endif // YIQI_SAX_PARSER_H
@@ -0,0 +1,111 @@
+/*
+ * scheduling.cpp:
+ * Decides which order to run tests in when each one gets a
+ * process of its own, using how long each took last time
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#include "scheduling.h"
+
+namespace ysched = yiqi::scheduling;
+
+ysched::TestNames
+ysched::LongestFirst (TestNames const &tests,
+                      Durations const &durations)
+{
+    TestNames ordered (tests);
+
+    auto const untimedEnd =
+        std::stable_partition (ordered.begin (),
+                               ordered.end (),
+                               [&durations](std::string const &test) {
+                                   return durations.count (test) == 0;
+                               });
+
+    std::stable_sort (untimedEnd,
+                      ordered.end (),
+                      [&durations](std::string const &lhs,
+                                   std::string const &rhs) {
+                          return durations.at (lhs) > durations.at (rhs);
+                      });
+
+    return ordered;
+}
+
+ysched::Durations
+ysched::ReadDurations (std::istream &is)
+{
+    Durations   durations;
+    std::string line;
+
+    while (std::getline (is, line))
+    {
+        if (line.empty ())
+            continue;
+
+        std::string::size_type const tab (line.rfind ('\t'));
+
+        if (tab == std::string::npos || tab == 0)
+            throw std::runtime_error ("malformed duration: " + line);
+
+        std::string const value (line.substr (tab + 1));
+        size_t            parsed = 0;
+        double            seconds = 0;
+
+        try
+        {
+            seconds = std::stod (value, &parsed);
+        }
+        catch (std::exception const &)
+        {
+        }
+
+        if (value.empty () || parsed != value.size ())
+            throw std::runtime_error ("malformed duration: " + line);
+
+        durations[line.substr (0, tab)] = seconds;
+    }
+
+    return durations;
+}
+
+void
+ysched::WriteDurations (std::ostream    &os,
+                        Durations const &durations)
+{
+    for (auto const &duration : durations)
+        os << duration.first << '\t'
+           << std::setprecision (6) << duration.second << '\n';
+}
+
+ysched::Durations
+ysched::ReadDurationsFile (std::string const &path)
+{
+    std::ifstream file (path);
+
+    /* Nothing has been timed until the first run */
+    if (!file)
+        return Durations ();
+
+    return ReadDurations (file);
+}
+
+void
+ysched::WriteDurationsFile (std::string const &path,
+                            Durations const   &durations)
+{
+    std::ofstream file (path, std::ios::trunc);
+
+    WriteDurations (file, durations);
+
+    if (!file)
+        throw std::runtime_error ("could not write durations " + path);
+}
@@ -0,0 +1,75 @@
+/*
+ * scheduling.h:
+ * Decides which order to run tests in when each one gets a
+ * process of its own, using how long each took last time
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_SCHEDULING_H
+#define YIQI_SCHEDULING_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace yiqi
+{
+    namespace scheduling
+    {
+        typedef std::vector <std::string> TestNames;
+
+        /* How long each test took to run, in seconds, by full name */
+        typedef std::map <std::string, double> Durations;
+
+        /**
+         * @brief LongestFirst orders tests so that the slowest start
+         * first, which stops a single slow test from being left to
+         * run on its own at the end. Tests which have not been timed
+         * yet might be slow too, so they start before all the others.
+         * @param tests the full names (Case.Test) of the tests to run
+         * @param durations how long tests took to run last time
+         * @return tests, reordered. Tests which took as long as each
+         * other keep their order.
+         */
+        TestNames LongestFirst (TestNames const &tests,
+                                Durations const &durations);
+
+        /**
+         * @brief ReadDurations reads durations written by WriteDurations,
+         * one test per line, with its name and duration separated by a tab
+         * @param is the stream to read from
+         * @throws std::runtime_error if a line is malformed
+         * @return the durations read
+         */
+        Durations ReadDurations (std::istream &is);
+
+        /**
+         * @brief WriteDurations
+         * @param os the stream to write to
+         * @param durations the durations to write
+         */
+        void WriteDurations (std::ostream    &os,
+                             Durations const &durations);
+
+        /**
+         * @brief ReadDurationsFile
+         * @param path the durations file
+         * @throws std::runtime_error if the file is malformed
+         * @return the durations, or nothing if there is no file at path
+         */
+        Durations ReadDurationsFile (std::string const &path);
+
+        /**
+         * @brief WriteDurationsFile replaces the durations file at path
+         * @param path the durations file
+         * @param durations the durations to write
+         * @throws std::runtime_error if the file could not be written
+         */
+        void WriteDurationsFile (std::string const &path,
+                                 Durations const   &durations);
+    }
+}
+
+#endif // YIQI_SCHEDULING_H
@@ -0,0 +1,558 @@
+/*
+ * source_annotation.cpp:
+ * Puts what each line of client code cost, from the line costs in
+ * cachegrind and callgrind profiles, next to the line itself
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include "source_annotation.h"
+
+namespace yoan = yiqi::output::annotation;
+namespace yocl = yiqi::output::callgrind;
+
+namespace
+{
+    /* Lines costing at least this much of the first column of all
+     * client code are hot */
+    double const HotShare (0.01);
+
+    /* How many lines either side of a costly line are shown */
+    unsigned long long const Context (3);
+
+    /* What is shown in each column, added up from these events */
+    struct Column
+    {
+        char const                  *name;
+        std::vector <std::string>   events;
+    };
+
+    std::vector <Column> const & Columns ()
+    {
+        static std::vector <Column> const columns =
+        {
+            { "Ir", { "Ir" } },
+            { "D1 misses", { "D1mr", "D1mw" } },
+            { "LL misses", { "ILmr", "DLmr", "DLmw" } }
+        };
+
+        return columns;
+    }
+
+    /* A column the annotation has every event of, with where each
+     * of those events is in the annotation's costs */
+    struct Shown
+    {
+        std::string             name;
+        std::vector <size_t>    events;
+    };
+
+    typedef std::vector <Shown> ShownColumns;
+
+    ShownColumns ColumnsOf (yoan::Annotation const &annotation)
+    {
+        ShownColumns shown;
+
+        for (Column const &column : Columns ())
+        {
+            Shown found { column.name, {} };
+
+            for (std::string const &event : column.events)
+            {
+                auto const index (std::find (annotation.events.begin (),
+                                             annotation.events.end (),
+                                             event));
+
+                if (index == annotation.events.end ())
+                    break;
+
+                found.events.push_back (index - annotation.events.begin ());
+            }
+
+            if (found.events.size () == column.events.size ())
+                shown.push_back (found);
+        }
+
+        return shown;
+    }
+
+    unsigned long long ColumnCost (Shown const       &column,
+                                   yocl::Costs const &costs)
+    {
+        unsigned long long cost (0);
+
+        for (size_t const event : column.events)
+            if (event < costs.size ())
+                cost += costs[event];
+
+        return cost;
+    }
+
+    /* Every file the annotation has, with the total of each column */
+    struct File
+    {
+        std::string const               *name;
+        yoan::Lines const               *lines;
+        std::vector <unsigned long long> totals;
+    };
+
+    /* The files, most costly by the first column first, and the
+     * totals of each column over all of them */
+    std::vector <File> OrderedFiles (
+        yoan::Annotation const           &annotation,
+        ShownColumns const               &columns,
+        std::vector <unsigned long long> &totals)
+    {
+        std::vector <File> files;
+
+        totals.assign (columns.size (), 0);
+
+        for (auto const &file : annotation.files)
+        {
+            File ordered { &file.first,
+                           &file.second,
+                           std::vector <unsigned long long> (columns.size (),
+                                                             0) };
+
+            for (auto const &line : file.second)
+                for (size_t i = 0; i < columns.size (); ++i)
+                    ordered.totals[i] += ColumnCost (columns[i], line.second);
+
+            for (size_t i = 0; i < columns.size (); ++i)
+                totals[i] += ordered.totals[i];
+
+            files.push_back (ordered);
+        }
+
+        std::stable_sort (files.begin (),
+                          files.end (),
+                          [](File const &a, File const &b) {
+                              return !a.totals.empty () &&
+                                     a.totals[0] > b.totals[0];
+                          });
+
+        return files;
+    }
+
+    /* Zero stands for lines which were skipped over */
+    unsigned long long const Gap (0);
+
+    /* The lines to show of a file with this many lines of text, which
+     * are the costly lines and some context around them */
+    std::vector <unsigned long long> ShownLines (yoan::Lines const &lines,
+                                                 size_t            textLines)
+    {
+        std::vector <unsigned long long> shown;
+        unsigned long long               next (1);
+
+        for (auto const &line : lines)
+        {
+            unsigned long long const number (line.first);
+            unsigned long long       first (number > Context ?
+                                                number - Context :
+                                                1);
+            unsigned long long const last (number + Context);
+
+            /* Without the text, context would only be blank lines */
+            if (!textLines)
+                first = number;
+
+            first = std::max (first, next);
+
+            if (first > next)
+                shown.push_back (Gap);
+
+            for (unsigned long long shownLine = first;
+                 shownLine <= (textLines ? last : number);
+                 ++shownLine)
+            {
+                if (textLines && shownLine > textLines &&
+                    shownLine > number)
+                    break;
+
+                shown.push_back (shownLine);
+                next = shownLine + 1;
+            }
+        }
+
+        return shown;
+    }
+
+    std::string LineText (yoan::Sources const    &sources,
+                          std::string const      &file,
+                          unsigned long long     line)
+    {
+        auto const found (sources.find (file));
+
+        if (found == sources.end () || line == 0 ||
+            line > found->second.size ())
+            return std::string ();
+
+        return found->second[line - 1];
+    }
+
+    size_t TextLines (yoan::Sources const &sources, std::string const &file)
+    {
+        auto const found (sources.find (file));
+
+        return found == sources.end () ? 0 : found->second.size ();
+    }
+
+    bool IsHot (unsigned long long cost, unsigned long long total)
+    {
+        return total && cost && cost >= HotShare * total;
+    }
+
+    std::string Percent (unsigned long long cost, unsigned long long total)
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision (2)
+           << (total ? 100.0 * cost / total : 0.0) << "%";
+        return ss.str ();
+    }
+
+    /* Column: total, for each column */
+    std::string Totals (ShownColumns const                     &columns,
+                        std::vector <unsigned long long> const &totals)
+    {
+        std::vector <std::string> parts;
+
+        for (size_t i = 0; i < columns.size (); ++i)
+            parts.push_back (columns[i].name + ": " +
+                             std::to_string (totals[i]));
+
+        return boost::algorithm::join (parts, ", ");
+    }
+
+    std::string EscapeHTML (std::string const &text)
+    {
+        std::string escaped;
+
+        for (char const c : text)
+        {
+            switch (c)
+            {
+                case '&':
+                    escaped += "&amp;";
+                    break;
+                case '<':
+                    escaped += "&lt;";
+                    break;
+                case '>':
+                    escaped += "&gt;";
+                    break;
+                case '"':
+                    escaped += "&quot;";
+                    break;
+                default:
+                    escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    std::string const HTMLStyle (
+        "body { font-family: sans-serif; }\n"
+        "table { border-collapse: collapse; font-family: monospace; }\n"
+        "td { padding: 0 0.5em; white-space: pre; }\n"
+        "td.cost, td.line { text-align: right; color: #555; }\n"
+        "tr.costly { background: #fff3e0; }\n"
+        "tr.hot { background: #ffb199; font-weight: bold; }\n"
+        "tr.gap td { color: #999; }\n");
+}
+
+bool
+yoan::IsClientFile (std::string const &file)
+{
+    /* Where yiqi's own sources are, to leave out its frames */
+    static std::string const yiqiSources (
+        std::string (__FILE__).substr (
+            0, std::string (__FILE__).rfind ('/') + 1));
+
+    if (file.empty () || file == "???" || file[0] == '<')
+        return false;
+
+    if (boost::starts_with (file, "/usr/"))
+        return false;
+
+    for (char const *framework : { "gtest", "gmock", "googletest",
+                                   "googlemock", "/include/yiqi/" })
+        if (boost::contains (file, framework))
+            return false;
+
+    return yiqiSources.empty () || !boost::starts_with (file, yiqiSources);
+}
+
+void
+yoan::AddProfile (Annotation &annotation, callgrind::Profile const &profile)
+{
+    /* Where each of the profile's events is in the annotation */
+    std::vector <size_t> events;
+
+    for (std::string const &event : profile.events)
+    {
+        auto const found (std::find (annotation.events.begin (),
+                                     annotation.events.end (),
+                                     event));
+
+        events.push_back (found - annotation.events.begin ());
+
+        if (found == annotation.events.end ())
+            annotation.events.push_back (event);
+    }
+
+    for (auto &file : annotation.files)
+        for (auto &line : file.second)
+            line.second.resize (annotation.events.size (), 0);
+
+    for (callgrind::LineCosts const &line : profile.lines)
+    {
+        if (!IsClientFile (line.file) ||
+            std::all_of (line.exclusive.begin (),
+                         line.exclusive.end (),
+                         [](unsigned long long cost) { return !cost; }))
+            continue;
+
+        callgrind::Costs &costs (annotation.files[line.file][line.line]);
+        costs.resize (annotation.events.size (), 0);
+
+        for (size_t i = 0; i < line.exclusive.size (); ++i)
+            costs[events[i]] += line.exclusive[i];
+    }
+}
+
+yoan::Sources
+yoan::ReadSources (Annotation const &annotation)
+{
+    Sources sources;
+
+    for (auto const &file : annotation.files)
+    {
+        std::ifstream source (file.first);
+
+        if (!source)
+            continue;
+
+        std::vector <std::string> &text (sources[file.first]);
+        std::string               line;
+
+        while (std::getline (source, line))
+            text.push_back (line);
+    }
+
+    return sources;
+}
+
+void
+yoan::WriteText (std::ostream      &output,
+                 Annotation const  &annotation,
+                 Sources const     &sources)
+{
+    ShownColumns const               columns (ColumnsOf (annotation));
+    std::vector <unsigned long long> totals;
+    std::vector <File> const         files (OrderedFiles (annotation,
+                                                          columns,
+                                                          totals));
+
+    if (columns.empty ())
+    {
+        output << "-- No Ir or cache misses were counted in client code"
+               << std::endl;
+        return;
+    }
+
+    output << "-- Client code, " << Totals (columns, totals) << "\n"
+           << "-- Lines costing at least " << 100 * HotShare << "% of the "
+           << columns[0].name << " of all client code are marked with *\n";
+
+    std::vector <size_t> widths;
+
+    for (size_t i = 0; i < columns.size (); ++i)
+        widths.push_back (std::max (columns[i].name.size (),
+                                    std::to_string (totals[i]).size ()));
+
+    for (File const &file : files)
+    {
+        size_t const textLines (TextLines (sources, *file.name));
+
+        output << "\n-- File: " << *file.name << " ("
+               << Totals (columns, file.totals) << ", "
+               << Percent (file.totals[0], totals[0]) << " of "
+               << columns[0].name << ")\n";
+
+        if (!textLines)
+            output << "-- The source could not be read, so only the costs "
+                   << "are shown\n";
+
+        std::stringstream header;
+
+        for (size_t i = 0; i < columns.size (); ++i)
+            header << std::setw (widths[i]) << columns[i].name << " ";
+
+        output << boost::trim_right_copy (header.str ()) << "\n";
+
+        for (unsigned long long const number : ShownLines (*file.lines,
+                                                           textLines))
+        {
+            if (number == Gap)
+            {
+                output << "...\n";
+                continue;
+            }
+
+            auto const        costs (file.lines->find (number));
+            std::stringstream line;
+
+            for (size_t i = 0; i < columns.size (); ++i)
+            {
+                line << std::setw (widths[i]);
+
+                if (costs == file.lines->end ())
+                    line << ".";
+                else
+                    line << ColumnCost (columns[i], costs->second);
+
+                line << " ";
+            }
+
+            bool const hot (costs != file.lines->end () &&
+                            IsHot (ColumnCost (columns[0], costs->second),
+                                   totals[0]));
+
+            line << (hot ? "* " : "  ")
+                 << std::setw (6) << number << "  "
+                 << LineText (sources, *file.name, number);
+
+            output << boost::trim_right_copy (line.str ()) << "\n";
+        }
+    }
+
+    output.flush ();
+}
+
+void
+yoan::WriteHTML (std::ostream      &output,
+                 Annotation const  &annotation,
+                 Sources const     &sources,
+                 std::string const &title)
+{
+    ShownColumns const               columns (ColumnsOf (annotation));
+    std::vector <unsigned long long> totals;
+    std::vector <File> const         files (OrderedFiles (annotation,
+                                                          columns,
+                                                          totals));
+
+    output << "<!DOCTYPE html>\n"
+           << "<html>\n<head>\n<meta charset=\"utf-8\">\n"
+           << "<title>" << EscapeHTML (title) << "</title>\n"
+           << "<style>\n" << HTMLStyle << "</style>\n"
+           << "</head>\n<body>\n"
+           << "<h1>" << EscapeHTML (title) << "</h1>\n";
+
+    if (columns.empty ())
+    {
+        output << "<p>No Ir or cache misses were counted in client code.</p>\n"
+               << "</body>\n</html>\n";
+        return;
+    }
+
+    output << "<p>Client code, " << EscapeHTML (Totals (columns, totals))
+           << ". Lines costing at least " << 100 * HotShare << "% of the "
+           << EscapeHTML (columns[0].name)
+           << " of all client code are highlighted.</p>\n";
+
+    for (File const &file : files)
+    {
+        size_t const textLines (TextLines (sources, *file.name));
+
+        output << "<h2>" << EscapeHTML (*file.name) << "</h2>\n"
+               << "<p>" << EscapeHTML (Totals (columns, file.totals)) << ", "
+               << Percent (file.totals[0], totals[0]) << " of "
+               << EscapeHTML (columns[0].name) << "</p>\n";
+
+        if (!textLines)
+            output << "<p>The source could not be read, so only the costs "
+                   << "are shown.</p>\n";
+
+        output << "<table>\n<tr>";
+
+        for (Shown const &column : columns)
+            output << "<th>" << EscapeHTML (column.name) << "</th>";
+
+        output << "<th>Line</th><th></th></tr>\n";
+
+        for (unsigned long long const number : ShownLines (*file.lines,
+                                                           textLines))
+        {
+            if (number == Gap)
+            {
+                output << "<tr class=\"gap\"><td colspan=\""
+                       << columns.size () + 2 << "\">...</td></tr>\n";
+                continue;
+            }
+
+            auto const costs (file.lines->find (number));
+            bool const costly (costs != file.lines->end ());
+            bool const hot (costly &&
+                            IsHot (ColumnCost (columns[0], costs->second),
+                                   totals[0]));
+
+            output << "<tr"
+                   << (hot ? " class=\"hot\"" :
+                       costly ? " class=\"costly\"" : "")
+                   << ">";
+
+            for (Shown const &column : columns)
+            {
+                output << "<td class=\"cost\">";
+
+                if (costly)
+                    output << ColumnCost (column, costs->second);
+
+                output << "</td>";
+            }
+
+            output << "<td class=\"line\">" << number << "</td><td>"
+                   << EscapeHTML (LineText (sources, *file.name, number))
+                   << "</td></tr>\n";
+        }
+
+        output << "</table>\n";
+    }
+
+    output << "</body>\n</html>\n";
+}
+
+void
+yoan::WriteReports (std::string const &directory,
+                    std::string const &name,
+                    Annotation const  &annotation)
+{
+    if (mkdir (directory.c_str (), 0777) == -1 && errno != EEXIST)
+        throw std::runtime_error ("could not create annotation directory " +
+                                  directory);
+
+    Sources const     sources (ReadSources (annotation));
+    std::string const path (directory + "/" + name);
+    std::ofstream     text (path + ".txt", std::ios::trunc);
+    std::ofstream     html (path + ".html", std::ios::trunc);
+
+    WriteText (text, annotation, sources);
+    WriteHTML (html, annotation, sources, "Annotated client code");
+
+    if (!text || !html)
+        throw std::runtime_error ("could not write annotated source " + path);
+}
@@ -0,0 +1,114 @@
+/*
+ * source_annotation.h:
+ * Puts what each line of client code cost, from the line costs in
+ * cachegrind and callgrind profiles, next to the line itself
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_SOURCE_ANNOTATION_H
+#define YIQI_SOURCE_ANNOTATION_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "callgrind_output.h"
+
+namespace yiqi
+{
+    namespace output
+    {
+        namespace annotation
+        {
+            /* The cost of each line with one, by line number */
+            typedef std::map <unsigned long long, callgrind::Costs> Lines;
+
+            /**
+             * @brief Annotation is what each line of each file of client
+             * code cost, added up over every profile given to AddProfile
+             */
+            struct Annotation
+            {
+                /* What the costs of each line count, for instance Ir */
+                std::vector <std::string>           events;
+                std::map <std::string, Lines>       files;
+            };
+
+            /* The text of each file, one string to a line */
+            typedef std::map <std::string,
+                              std::vector <std::string>> Sources;
+
+            /**
+             * @brief IsClientFile decides whether a file is part of the
+             * code under test, rather than of Google Test, of yiqi, of
+             * the system or of a file valgrind could not name
+             * @param file the file, as named in a profile
+             * @return true if the file is client code
+             */
+            bool IsClientFile (std::string const &file);
+
+            /**
+             * @brief AddProfile adds what each line of client code cost
+             * in profile to annotation. Events are matched by name, so
+             * profiles counting different events can be added together.
+             * @param annotation the Annotation to add to
+             * @param profile a Profile, from ReadProfile
+             */
+            void AddProfile (Annotation                 &annotation,
+                             callgrind::Profile const   &profile);
+
+            /**
+             * @brief ReadSources reads each file in annotation, leaving
+             * out any which cannot be read
+             * @param annotation the Annotation to read the files of
+             * @return the text of each file which could be read
+             */
+            Sources ReadSources (Annotation const &annotation);
+
+            /**
+             * @brief WriteText writes each file of client code, the most
+             * costly first, with Ir and the D1 and LL misses against each
+             * line that the profiles counted them for. Hot lines, costing
+             * at least a hundredth of the Ir of all client code, are
+             * marked with a '*'. Only the costly lines and a few either
+             * side of them are written.
+             * @param output the stream to write to
+             * @param annotation the Annotation to write
+             * @param sources the text of the files, from ReadSources, with
+             * only the costs written for files it does not have
+             */
+            void WriteText (std::ostream      &output,
+                            Annotation const  &annotation,
+                            Sources const     &sources);
+
+            /**
+             * @brief WriteHTML writes the same as WriteText, as a page
+             * which needs nothing else to be viewed, with hot lines
+             * highlighted
+             * @param output the stream to write to
+             * @param annotation the Annotation to write
+             * @param sources the text of the files, from ReadSources
+             * @param title what to head the page with
+             */
+            void WriteHTML (std::ostream      &output,
+                            Annotation const  &annotation,
+                            Sources const     &sources,
+                            std::string const &title);
+
+            /**
+             * @brief WriteReports writes name.txt and name.html for
+             * annotation into directory, creating it if need be
+             * @param directory the directory to write to
+             * @param name the name of the files, without an extension
+             * @param annotation the Annotation to write
+             */
+            void WriteReports (std::string const &directory,
+                               std::string const &name,
+                               Annotation const  &annotation);
+        }
+    }
+}
+
+#endif // YIQI_SOURCE_ANNOTATION_H
@@ -0,0 +1,105 @@
+/*
+ * statistics.cpp:
+ * Summarises repeated measurements of the same piece
+ * of client code
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "statistics.h"
+
+namespace ystat = yiqi::statistics;
+
+namespace
+{
+    /* Two-tailed 95% critical values of Student's t distribution,
+     * indexed by degrees of freedom minus one */
+    double const StudentT95[] =
+    {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+        2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+        2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+        2.048, 2.045, 2.042
+    };
+
+    /* Beyond the table, the normal distribution is close enough */
+    double const Normal95 = 1.960;
+
+    double CriticalValue (size_t degreesOfFreedom)
+    {
+        size_t const tableSize (sizeof (StudentT95) / sizeof (StudentT95[0]));
+
+        if (degreesOfFreedom == 0)
+            return 0;
+
+        if (degreesOfFreedom <= tableSize)
+            return StudentT95[degreesOfFreedom - 1];
+
+        return Normal95;
+    }
+}
+
+double
+ystat::Median (Samples samples)
+{
+    if (samples.empty ())
+        throw std::logic_error ("cannot find the median of no samples");
+
+    size_t const middle (samples.size () / 2);
+
+    std::nth_element (samples.begin (),
+                      samples.begin () + middle,
+                      samples.end ());
+    double const upper (samples[middle]);
+
+    if (samples.size () % 2)
+        return upper;
+
+    double const lower (*std::max_element (samples.begin (),
+                                           samples.begin () + middle));
+    return (lower + upper) / 2;
+}
+
+ystat::Summary
+ystat::Summarise (Samples const &samples)
+{
+    if (samples.empty ())
+        throw std::logic_error ("cannot summarise no samples");
+
+    double const count (samples.size ());
+    Summary      summary;
+
+    summary.min = *std::min_element (samples.begin (), samples.end ());
+    summary.median = Median (samples);
+    summary.mean = std::accumulate (samples.begin (),
+                                    samples.end (),
+                                    0.0) / count;
+
+    double  sumOfSquares = 0;
+    Samples deviations;
+
+    for (double sample : samples)
+    {
+        sumOfSquares += (sample - summary.mean) * (sample - summary.mean);
+        deviations.push_back (std::fabs (sample - summary.median));
+    }
+
+    if (samples.size () > 1)
+        summary.stddev = std::sqrt (sumOfSquares / (count - 1));
+    else
+        summary.stddev = 0;
+
+    summary.mad = Median (deviations);
+
+    double const halfWidth (CriticalValue (samples.size () - 1) *
+                            summary.stddev / std::sqrt (count));
+    summary.ciLow = summary.mean - halfWidth;
+    summary.ciHigh = summary.mean + halfWidth;
+
+    return summary;
+}
@@ -0,0 +1,60 @@
+/*
+ * statistics.h:
+ * Summarises repeated measurements of the same piece
+ * of client code
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_STATISTICS_H
+#define YIQI_STATISTICS_H
+
+#include <vector>
+
+namespace yiqi
+{
+    namespace statistics
+    {
+        typedef std::vector <double> Samples;
+
+        /**
+         * @brief Summary describes the distribution of a set of samples
+         */
+        struct Summary
+        {
+            double min;
+            double median;
+            double mean;
+
+            /* Sample standard deviation, zero for a single sample */
+            double stddev;
+
+            /* Median absolute deviation from the median, which unlike
+             * stddev is not thrown off by the odd outlier */
+            double mad;
+
+            /* Bounds of the 95% confidence interval for the mean */
+            double ciLow;
+            double ciHigh;
+        };
+
+        /**
+         * @brief Median finds the middle value of samples, or the mean
+         * of the two middle values if there are an even number of them
+         * @param samples the samples, in any order
+         * @throws std::logic_error if samples is empty
+         * @return the median
+         */
+        double Median (Samples samples);
+
+        /**
+         * @brief Summarise describes the distribution of samples
+         * @param samples the samples, in any order
+         * @throws std::logic_error if samples is empty
+         * @return a Summary of samples
+         */
+        Summary Summarise (Samples const &samples);
+    }
+}
+
+#endif // YIQI_STATISTICS_H
@@ -10,6 +10,11 @@
 #define YIQI_SYSTEM_API_H
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
 
 namespace yiqi
 {
@@ -23,6 +28,16 @@ namespace yiqi
 
                     typedef std::unique_ptr <SystemCalls> Unique;
 
+                    /* Pairs of a file descriptor in this process and the
+                     * number it should have in a child process */
+                    typedef std::vector <std::pair <int, int> > InheritedFds;
+
+                    struct Pipe
+                    {
+                        int readFd;
+                        int writeFd;
+                    };
+
                     virtual ~SystemCalls () {};
 
                      /**
@@ -62,6 +77,105 @@ namespace yiqi
                     virtual char const * const *
                     GetSystemEnvironment () const = 0;
 
+                    /**
+                     * @brief SpawnChild starts binary in a new child
+                     * process, leaving the current process running
+                     * @param binary the fully-qualified binary path to
+                     * execute
+                     * @param argv arguments to pass to the binary
+                     * @param e a pointer to a null-terminated array of
+                     * char const * of system environment variables with
+                     * the format KEY=value
+                     * @param inherited file descriptors to pass on to the
+                     * child as different numbers. All other descriptors
+                     * opened by yiqi are closed in the child.
+                     * @throws std::system_error if the child could not
+                     * be created
+                     * @return the process ID of the child
+                     */
+                    virtual pid_t SpawnChild (char const         *binary,
+                                              char const * const *argv,
+                                              char const * const *e,
+                                              InheritedFds const &inherited)
+                                              const = 0;
+
+                    /**
+                     * @brief WaitForChild waits for a child started with
+                     * SpawnChild to exit
+                     * @param child the process ID of the child
+                     * @throws std::system_error if waiting failed
+                     * @return the exit status of the child, or 128 plus
+                     * the signal number if it was killed by a signal
+                     */
+                    virtual int WaitForChild (pid_t child) const = 0;
+
+                    /**
+                     * @brief KillChild asks a child started with SpawnChild
+                     * to terminate, without waiting for it to do so
+                     * @param child the process ID of the child
+                     * @throws std::system_error if the signal couldn't be sent
+                     */
+                    virtual void KillChild (pid_t child) const = 0;
+
+                    /**
+                     * @brief CreatePipe creates a pipe, with both ends closed
+                     * on exec unless they are passed on to a child with
+                     * SpawnChild
+                     * @throws std::system_error if the pipe couldn't be created
+                     * @return the two ends of the pipe
+                     */
+                    virtual Pipe CreatePipe () const = 0;
+
+                    /**
+                     * @brief ReadFd reads whatever is available from fd,
+                     * waiting until something is
+                     * @param fd the file descriptor to read from
+                     * @param buffer where to store what was read
+                     * @param size the size of buffer
+                     * @throws std::system_error if reading failed
+                     * @return the number of bytes read, which is 0 only
+                     * once the other end has been closed
+                     */
+                    virtual size_t ReadFd (int    fd,
+                                           char   *buffer,
+                                           size_t size) const = 0;
+
+                    /**
+                     * @brief CloseFd closes fd, ignoring any errors
+                     * @param fd the file descriptor to close
+                     */
+                    virtual void CloseFd (int fd) const = 0;
+
+                    typedef std::vector <int> Fds;
+
+                    /**
+                     * @brief PollReadable waits until at least one of fds
+                     * has something to read, or has had its other end closed
+                     * @param fds the file descriptors to wait on
+                     * @throws std::system_error if waiting failed
+                     * @return those of fds which ReadFd will not block on
+                     */
+                    virtual Fds PollReadable (Fds const &fds) const = 0;
+
+                    /* A shared object, or the executable, mapped into this
+                     * process, with the GNU build-id it was linked with in
+                     * hex, or nothing if it has none */
+                    struct LoadedObject
+                    {
+                        std::string path;
+                        std::string buildID;
+                    };
+
+                    typedef std::vector <LoadedObject> LoadedObjects;
+
+                    /**
+                     * @brief GetLoadedObjects
+                     * @return the executable and every shared object which
+                     * is loaded into this process, in the order they were
+                     * loaded
+                     */
+                    virtual LoadedObjects GetLoadedObjects () const = 0;
+
                 protected:
 
                     SystemCalls () = default;
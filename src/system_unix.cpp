@@ -5,8 +5,19 @@
  * See LICENCE.md for Copyright information
  */
 
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
 #include <system_error>
 
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include "system_api.h"
@@ -27,6 +38,17 @@ namespace
                               char const * const *environ) const;
             std::string GetExecutablePath () const;
             char const * const * GetSystemEnvironment () const;
+            pid_t SpawnChild (char const         *binary,
+                              char const * const *argv,
+                              char const * const *environ,
+                              InheritedFds const &inherited) const;
+            int WaitForChild (pid_t child) const;
+            void KillChild (pid_t child) const;
+            Pipe CreatePipe () const;
+            size_t ReadFd (int fd, char *buffer, size_t size) const;
+            void CloseFd (int fd) const;
+            Fds PollReadable (Fds const &fds) const;
+            LoadedObjects GetLoadedObjects () const;
     };
 }
 
@@ -71,6 +93,212 @@ UNIXCalls::GetSystemEnvironment () const
     return const_cast <char const * const *> (environ);
 }
 
+pid_t
+UNIXCalls::SpawnChild (char const         *binary,
+                       char const * const *argv,
+                       char const * const *env,
+                       InheritedFds const &inherited) const
+{
+    pid_t child = fork ();
+
+    if (child == -1)
+        throw std::system_error (std::error_code (errno,
+                                                  std::system_category ()));
+
+    if (child == 0)
+    {
+        /* dup2 clears close-on-exec on the new descriptor, but
+         * does nothing at all if the numbers are the same */
+        for (auto const &fds : inherited)
+        {
+            int const result (fds.first == fds.second ?
+                                  fcntl (fds.second, F_SETFD, 0) :
+                                  dup2 (fds.first, fds.second));
+
+            if (result == -1)
+                _exit (127);
+        }
+
+        execvpe (binary,
+                 const_cast <char * const *> (argv),
+                 const_cast <char * const *> (env));
+
+        /* There is no way to throw back into the parent, so just
+         * report the error and exit the way a shell would */
+        std::cerr << "failed to execute " << binary << ": "
+                  << std::error_code (errno,
+                                      std::system_category ()).message ()
+                  << std::endl;
+        _exit (127);
+    }
+
+    return child;
+}
+
+int
+UNIXCalls::WaitForChild (pid_t child) const
+{
+    int status = 0;
+
+    while (waitpid (child, &status, 0) == -1)
+    {
+        if (errno != EINTR)
+            throw std::system_error (std::error_code (errno,
+                                                      std::system_category ()));
+    }
+
+    if (WIFSIGNALED (status))
+        return 128 + WTERMSIG (status);
+
+    return WEXITSTATUS (status);
+}
+
+void
+UNIXCalls::KillChild (pid_t child) const
+{
+    if (kill (child, SIGTERM) == -1)
+        throw std::system_error (std::error_code (errno,
+                                                  std::system_category ()));
+}
+
+ysysapi::SystemCalls::Pipe
+UNIXCalls::CreatePipe () const
+{
+    int fds[2];
+
+    if (pipe2 (fds, O_CLOEXEC) == -1)
+        throw std::system_error (std::error_code (errno,
+                                                  std::system_category ()));
+
+    return Pipe { fds[0], fds[1] };
+}
+
+size_t
+UNIXCalls::ReadFd (int fd, char *buffer, size_t size) const
+{
+    ssize_t result;
+
+    while ((result = read (fd, buffer, size)) == -1)
+    {
+        if (errno != EINTR)
+            throw std::system_error (std::error_code (errno,
+                                                      std::system_category ()));
+    }
+
+    return result;
+}
+
+void
+UNIXCalls::CloseFd (int fd) const
+{
+    close (fd);
+}
+
+ysysapi::SystemCalls::Fds
+UNIXCalls::PollReadable (Fds const &fds) const
+{
+    std::vector <pollfd> polled;
+
+    for (int fd : fds)
+        polled.push_back (pollfd { fd, POLLIN, 0 });
+
+    while (poll (&polled[0], polled.size (), -1) == -1)
+    {
+        if (errno != EINTR)
+            throw std::system_error (std::error_code (errno,
+                                                      std::system_category ()));
+    }
+
+    /* A closed or broken descriptor is readable too, in that
+     * reading it will not block */
+    Fds readable;
+
+    for (pollfd const &p : polled)
+        if (p.revents)
+            readable.push_back (p.fd);
+
+    return readable;
+}
+
+namespace
+{
+    /* Looks through the notes in a loaded segment for the
+     * build-id which the linker gave the object */
+    std::string FindBuildID (char const *notes, size_t size)
+    {
+        /* Names and descriptions are padded to four bytes */
+        auto padded = [](size_t n) { return (n + 3) & ~size_t (3); };
+
+        size_t offset = 0;
+
+        while (offset + sizeof (ElfW (Nhdr)) <= size)
+        {
+            ElfW (Nhdr) const *note (
+                reinterpret_cast <ElfW (Nhdr) const *> (notes + offset));
+            char const *name (notes + offset + sizeof (ElfW (Nhdr)));
+            unsigned char const *desc (reinterpret_cast <unsigned char const *> (
+                name + padded (note->n_namesz)));
+
+            if (note->n_type == NT_GNU_BUILD_ID &&
+                note->n_namesz == 4 &&
+                std::string (name, 3) == "GNU")
+            {
+                std::stringstream ss;
+
+                for (size_t i = 0; i < note->n_descsz; ++i)
+                    ss << std::hex << std::setw (2) << std::setfill ('0')
+                       << static_cast <unsigned int> (desc[i]);
+
+                return ss.str ();
+            }
+
+            offset += sizeof (ElfW (Nhdr)) +
+                      padded (note->n_namesz) +
+                      padded (note->n_descsz);
+        }
+
+        return std::string ();
+    }
+
+    int AppendLoadedObject (dl_phdr_info *info, size_t size, void *data)
+    {
+        auto &objects (*static_cast <ysysapi::SystemCalls::LoadedObjects *> (data));
+
+        /* The executable is the only object without a name */
+        ysysapi::SystemCalls::LoadedObject object
+        {
+            info->dlpi_name && info->dlpi_name[0] ? info->dlpi_name :
+                                                    "/proc/self/exe",
+            std::string ()
+        };
+
+        for (ElfW (Half) i = 0; i < info->dlpi_phnum && object.buildID.empty (); ++i)
+        {
+            ElfW (Phdr) const &header (info->dlpi_phdr[i]);
+
+            if (header.p_type == PT_NOTE)
+                object.buildID = FindBuildID (
+                    reinterpret_cast <char const *> (info->dlpi_addr +
+                                                     header.p_vaddr),
+                    header.p_memsz);
+        }
+
+        objects.push_back (object);
+
+        return 0;
+    }
+}
+
+ysysapi::SystemCalls::LoadedObjects
+UNIXCalls::GetLoadedObjects () const
+{
+    LoadedObjects objects;
+
+    dl_iterate_phdr (AppendLoadedObject, &objects);
+
+    return objects;
+}
+
 ysysapi::SystemCalls::Unique
 ysysapi::MakeUNIXSystemCalls ()
 {
@@ -0,0 +1,66 @@
+/*
+ * testfilter.cpp:
+ * Decides which tests a Google Test filter selects, so that
+ * each of them can be run in its own process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#include "testfilter.h"
+
+namespace ytf = yiqi::testfilter;
+
+namespace
+{
+    bool MatchesAnyPattern (std::string const &name,
+                            std::string const &patterns)
+    {
+        std::vector <std::string> split;
+        boost::split (split, patterns, boost::is_any_of (":"));
+
+        for (std::string const &pattern : split)
+            if (ytf::MatchesPattern (name.c_str (), pattern.c_str ()))
+                return true;
+
+        return false;
+    }
+}
+
+bool
+ytf::MatchesPattern (char const *name, char const *pattern)
+{
+    switch (*pattern)
+    {
+        case '\0':
+            return *name == '\0';
+        case '?':
+            return *name != '\0' && MatchesPattern (name + 1, pattern + 1);
+        case '*':
+            return (*name != '\0' && MatchesPattern (name + 1, pattern)) ||
+                   MatchesPattern (name, pattern + 1);
+        default:
+            return *name == *pattern && MatchesPattern (name + 1, pattern + 1);
+    }
+}
+
+bool
+ytf::MatchesFilter (std::string const &name,
+                      std::string const &filter)
+{
+    std::string::size_type const dash (filter.find ('-'));
+    std::string positive (filter.substr (0, dash));
+    std::string negative;
+
+    if (dash != std::string::npos)
+        negative = filter.substr (dash + 1);
+
+    if (positive.empty ())
+        positive = "*";
+
+    return MatchesAnyPattern (name, positive) &&
+           (negative.empty () || !MatchesAnyPattern (name, negative));
+}
@@ -0,0 +1,44 @@
+/*
+ * testfilter.h:
+ * Decides which tests a Google Test filter selects, so that
+ * each of them can be run in its own process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#ifndef YIQI_TEST_FILTER_H
+#define YIQI_TEST_FILTER_H
+
+#include <string>
+
+namespace yiqi
+{
+    namespace testfilter
+    {
+        /**
+         * @brief MatchesPattern checks whether name matches a single
+         * Google Test pattern, where * matches any run of characters
+         * and ? matches any single character
+         * @param name the full name (Case.Test) of a test
+         * @param pattern the pattern to match against
+         * @return true if name matches pattern
+         */
+        bool MatchesPattern (char const *name, char const *pattern);
+
+        /**
+         * @brief MatchesFilter checks whether name is selected by filter,
+         * which has the same form as --gtest_filter, that is colon
+         * separated positive patterns, optionally followed by a - and
+         * colon separated negative patterns. An empty set of positive
+         * patterns selects everything.
+         * @param name the full name (Case.Test) of a test
+         * @param filter the filter to match against
+         * @return true if name matches one of the positive patterns
+         * and none of the negative ones
+         */
+        bool MatchesFilter (std::string const &name,
+                            std::string const &filter);
+    }
+}
+
+#endif // YIQI_TEST_FILTER_H
@@ -7,30 +7,59 @@
  */
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <vector>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/program_options.hpp>
 
+#include <dirent.h>
 #include <unistd.h>
 
+#include <folly/ScopeGuard.h>
+
+#include <yiqi/instrumentation.h>
+
+#include "baseline.h"
 #include "commandline.h"
 #include "constants.h"
 #include "construction.h"
+#include "deferred_budgets.h"
+#include "difference.h"
+#include "instrumentation_pipeline.h"
 #include "instrumentation_tool.h"
+#include "measurement.h"
 #include "reexecution.h"
+#include "result_cache.h"
+#include "scheduling.h"
 #include "systempaths.h"
 #include "system_api.h"
 #include "system_implementation.h"
+#include "testfilter.h"
 
 namespace po = boost::program_options;
+namespace ybase = yiqi::baseline;
+namespace ybud = yiqi::budgets;
 namespace yconst = yiqi::constants;
 namespace ycom = yiqi::commandline;
 namespace yexec = yiqi::execution;
 namespace yc = yiqi::construction;
+namespace ydiff = yiqi::difference;
+namespace ycache = yiqi::cache;
 namespace yit = yiqi::instrumentation::tools;
+namespace ymeas = yiqi::measurement;
+namespace ysched = yiqi::scheduling;
 namespace ysys = yiqi::system;
 namespace ysysapi = yiqi::system::api;
+namespace ytf = yiqi::testfilter;
 
 namespace
 {
@@ -43,6 +72,603 @@ namespace
             virtual void SetUp ();
             virtual void TearDown ();
     };
+
+    /* Lets the tool know which test is running, so that
+     * anything it finds can be traced back to the test */
+    class YiqiTestListener :
+        public ::testing::EmptyTestEventListener
+    {
+        public:
+
+            void OnTestStart (::testing::TestInfo const &test);
+            void OnTestEnd (::testing::TestInfo const &test);
+    };
+}
+
+namespace
+{
+    /* The tools which client code runs under in this process,
+     * one after the other */
+    yc::ToolUniquePtrs clientCodeTools;
+    bool               inClientCode = false;
+
+    /* What was measured in the last region of client code
+     * in the current test, for budgets to check against */
+    ymeas::Metrics    lastRegionMetrics;
+
+    /* Where to write every measured metric to, if anywhere */
+    std::string       resultsFile;
+
+    /* Everything measured in each test, or read back, in this
+     * process, down to each function. Only whole tests are compared
+     * against a baseline, but functions are compared to earlier runs. */
+    ymeas::Results    measuredResults;
+
+    /* Everything reported for each test in this process,
+     * including for each function, to keep between runs */
+    std::map <std::string, ymeas::Metrics> reportedMetrics;
+
+    void ReportMetrics (std::string const    &test,
+                        std::string const    &tool,
+                        ymeas::Metrics const &metrics)
+    {
+        ymeas::PrintMetrics (std::cout, test, tool, metrics);
+
+        ymeas::Metrics &reported (reportedMetrics[test]);
+        reported.insert (reported.end (), metrics.begin (), metrics.end ());
+
+        for (ymeas::Metric const &metric : metrics)
+            measuredResults.push_back (ymeas::Result { test, tool, metric });
+
+        if (resultsFile.empty () || metrics.empty ())
+            return;
+
+        /* Each instrumented process appends its own results */
+        std::ofstream results (resultsFile, std::ios::app);
+
+        if (!results)
+            throw std::runtime_error ("could not open results file " +
+                                      resultsFile);
+
+        ymeas::WriteResults (results, test, tool, metrics);
+    }
+}
+
+namespace
+{
+    /* The full name of the running test, or empty outside of one */
+    std::string CurrentTestName ()
+    {
+        ::testing::TestInfo const *test (
+            ::testing::UnitTest::GetInstance ()->current_test_info ());
+
+        if (!test)
+            return std::string ();
+
+        return std::string (test->test_case_name ()) + "." + test->name ();
+    }
+}
+
+void
+yiqi::ExecuteClientCode (std::function <void ()> const &code)
+{
+    /* There is no tool until main () has run, and nested client
+     * code is already being measured by the outermost region */
+    if (clientCodeTools.empty () || inClientCode)
+    {
+        code ();
+        return;
+    }
+
+    inClientCode = true;
+    auto leaveClientCode = folly::makeGuard ([]() {
+                                                 inClientCode = false;
+                                             });
+
+    std::string const testName (CurrentTestName ());
+
+    lastRegionMetrics.clear ();
+
+    std::vector <ymeas::RegionResult> const results (
+        yit::RunClientCodeUnderEach (clientCodeTools, code));
+
+    for (size_t i = 0; i < clientCodeTools.size (); ++i)
+    {
+        yit::Tool::Unique const   &tool (clientCodeTools[i]);
+        ymeas::RegionResult const &result (results[i]);
+
+        ReportMetrics (testName, tool->InstrumentationName (), result.metrics);
+
+        lastRegionMetrics.insert (lastRegionMetrics.end (),
+                                  result.metrics.begin (),
+                                  result.metrics.end ());
+
+        /* Problems found in client code fail the test which ran it */
+        for (std::string const &failure : result.failures)
+            ADD_FAILURE () << failure;
+    }
+}
+
+bool
+yiqi::MeasuredInLastRegion (char const *metric, double &value)
+{
+    for (ymeas::Metric const &measured : lastRegionMetrics)
+    {
+        if (measured.function.empty () && measured.name == metric)
+        {
+            value = measured.value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+yiqi::RegionMetrics
+yiqi::MeasuredInLastRegion ()
+{
+    RegionMetrics metrics;
+
+    for (ymeas::Metric const &measured : lastRegionMetrics)
+        if (measured.function.empty ())
+            metrics.insert (std::make_pair (measured.name, measured.value));
+
+    return metrics;
+}
+
+void
+yiqi::CheckWhenReadBack (char const *metric, double limit)
+{
+    char const *directory = getenv (yconst::YiqiOutputDirectoryEnvKey);
+
+    /* Only the instrumented processes have anything read back */
+    if (!directory || !getenv (yconst::YiqiToolEnvKey))
+        return;
+
+    /* Appended as each is kept, so that a test which crashes
+     * later on does not lose the budgets of those before it */
+    std::ofstream file (ybud::BudgetsFile (directory, getpid ()),
+                        std::ios::app);
+
+    ybud::WriteBudget (file, ybud::Budget { CurrentTestName (),
+                                            metric,
+                                            limit });
+}
+
+namespace
+{
+    /* The full names of the tests which Google Test would run in
+     * this process, given the filter it was passed and the shard
+     * it was asked to run */
+    yexec::TestNames SelectedTests (ysysapi::SystemCalls const &calls)
+    {
+        ::testing::UnitTest const &unitTest (*::testing::UnitTest::GetInstance ());
+        std::string const         filter (::testing::GTEST_FLAG (filter));
+        bool const                runDisabled (
+            ::testing::GTEST_FLAG (also_run_disabled_tests));
+        std::string const         disabledPrefix ("DISABLED_");
+        yexec::TestNames          tests;
+
+        for (int i = 0; i < unitTest.total_test_case_count (); ++i)
+        {
+            ::testing::TestCase const &testCase (*unitTest.GetTestCase (i));
+            std::string const         caseName (testCase.name ());
+
+            for (int j = 0; j < testCase.total_test_count (); ++j)
+            {
+                std::string const testName (testCase.GetTestInfo (j)->name ());
+                std::string const fullName (caseName + "." + testName);
+
+                bool const disabled (
+                    boost::starts_with (caseName, disabledPrefix) ||
+                    boost::starts_with (testName, disabledPrefix));
+
+                if (disabled && !runDisabled)
+                    continue;
+
+                if (ytf::MatchesFilter (fullName, filter))
+                    tests.push_back (fullName);
+            }
+        }
+
+        return yexec::TestsInShard (tests, yexec::InheritedShard (calls));
+    }
+
+    /* Reports the problems which a tool streams back from
+     * the instrumented process, asking for it to be stopped
+     * after the first one if failing fast */
+    class StreamedFailures
+    {
+        public:
+
+            StreamedFailures (yit::Tool &tool, bool failFast) :
+                mTool (tool),
+                mFailFast (failFast),
+                mCount (0)
+            {
+            }
+
+            bool Consume (pid_t stream, char const *data, size_t size)
+            {
+                for (ymeas::TestFailure const &failure :
+                     mTool.ConsumeResults (stream, data, size))
+                {
+                    std::cout << yconst::YiqiFailedHeader
+                              << failure.test << ": "
+                              << failure.description << std::endl;
+                    mFailedTests.insert (failure.test);
+                    ++mCount;
+                }
+
+                return !(mFailFast && mCount);
+            }
+
+            size_t Count () const
+            {
+                return mCount;
+            }
+
+            std::set <std::string> const & FailedTests () const
+            {
+                return mFailedTests;
+            }
+
+        private:
+
+            yit::Tool               &mTool;
+            bool                    mFailFast;
+            size_t                  mCount;
+            std::set <std::string>  mFailedTests;
+    };
+
+    /* Keeps what a tool found in each test which passed, so
+     * that it does not have to run again until its code changes */
+    class ResultCache
+    {
+        public:
+
+            ResultCache (std::string const          &directory,
+                         yit::Tool const            &tool,
+                         ysysapi::SystemCalls const &calls) :
+                mDirectory (directory),
+                mTool (tool)
+            {
+                if (Enabled ())
+                    mIdentity = ycache::CodeIdentity (calls.GetLoadedObjects ());
+            }
+
+            bool Enabled () const
+            {
+                return !mDirectory.empty ();
+            }
+
+            /* Reports what was kept for each of tests, returning
+             * the tests which still have to be run */
+            yexec::TestNames Replay (yexec::TestNames const &tests) const
+            {
+                yexec::TestNames remaining;
+
+                for (std::string const &test : tests)
+                {
+                    ymeas::Metrics metrics;
+
+                    if (!Enabled () ||
+                        !ycache::Lookup (mDirectory, Key (test), metrics))
+                    {
+                        remaining.push_back (test);
+                        continue;
+                    }
+
+                    std::cout << yconst::YiqiCachedHeader << test << std::endl;
+                    ReportMetrics (test, mTool.InstrumentationName (), metrics);
+                }
+
+                return remaining;
+            }
+
+            /* Keeps everything reported for a test which passed */
+            void Store (std::string const &test) const
+            {
+                if (!Enabled ())
+                    return;
+
+                try
+                {
+                    ycache::Store (mDirectory,
+                                   Key (test),
+                                   test,
+                                   mTool.InstrumentationName (),
+                                   reportedMetrics[test]);
+                }
+                catch (std::exception const &e)
+                {
+                    std::cerr << "failed to cache results for "
+                              << test << ": " << e.what () << std::endl;
+                }
+            }
+
+        private:
+
+            std::string Key (std::string const &test) const
+            {
+                return ycache::Key (mIdentity,
+                                    test,
+                                    mTool.InstrumentationName (),
+                                    mTool.WrapperOptions ());
+            }
+
+            std::string const mDirectory;
+            yit::Tool const   &mTool;
+            std::string       mIdentity;
+    };
+
+    /* Where valgrind tools write their output files for this run,
+     * so that nothing left behind by an earlier run, or by another
+     * process which had the same pid, is ever read back */
+    class OutputDirectory
+    {
+        public:
+
+            OutputDirectory ()
+            {
+                char const  *temporary = getenv ("TMPDIR");
+                std::string path (temporary && *temporary ? temporary :
+                                                            "/tmp");
+
+                path += "/yiqi.XXXXXX";
+
+                if (!mkdtemp (&path[0]))
+                    throw std::runtime_error ("could not create " + path);
+
+                mPath = path;
+
+                /* The instrumented processes are told where it is
+                 * through the environment they inherit */
+                setenv (yconst::YiqiOutputDirectoryEnvKey, mPath.c_str (), 1);
+            }
+
+            OutputDirectory (OutputDirectory const &) = delete;
+            OutputDirectory & operator= (OutputDirectory const &) = delete;
+
+            ~OutputDirectory ()
+            {
+                Remove ();
+            }
+
+            /* Removes the directory, along with anything which was
+             * not read back, such as the files of a crashed process */
+            void Remove ()
+            {
+                if (mPath.empty ())
+                    return;
+
+                if (DIR *directory = opendir (mPath.c_str ()))
+                {
+                    while (struct dirent *entry = readdir (directory))
+                    {
+                        std::string const name (entry->d_name);
+
+                        if (name != "." && name != "..")
+                            unlink ((mPath + "/" + name).c_str ());
+                    }
+
+                    closedir (directory);
+                }
+
+                rmdir (mPath.c_str ());
+                mPath.clear ();
+            }
+
+        private:
+
+            std::string mPath;
+    };
+
+    /* Keeps Google Test's sharding variables from the processes
+     * launched while it is alive, which are given the tests of this
+     * process's shard by name and so must not take a shard of them */
+    class ShardingHidden
+    {
+        public:
+
+            ShardingHidden ()
+            {
+                Hide (yconst::GoogleTestShardIndexEnvKey, mIndex);
+                Hide (yconst::GoogleTestTotalShardsEnvKey, mTotal);
+            }
+
+            ShardingHidden (ShardingHidden const &) = delete;
+            ShardingHidden & operator= (ShardingHidden const &) = delete;
+
+            ~ShardingHidden ()
+            {
+                Restore (yconst::GoogleTestShardIndexEnvKey, mIndex);
+                Restore (yconst::GoogleTestTotalShardsEnvKey, mTotal);
+            }
+
+        private:
+
+            static void Hide (char const                   *key,
+                              std::unique_ptr <std::string> &value)
+            {
+                if (char const *set = getenv (key))
+                {
+                    value.reset (new std::string (set));
+                    unsetenv (key);
+                }
+            }
+
+            static void Restore (char const                          *key,
+                                 std::unique_ptr <std::string> const &value)
+            {
+                if (value)
+                    setenv (key, value->c_str (), 1);
+            }
+
+            std::unique_ptr <std::string> mIndex;
+            std::unique_ptr <std::string> mTotal;
+    };
+
+    /* The tests which went over a budget that could only be
+     * checked once their results were read back */
+    std::set <std::string> overBudgetTests;
+
+    /* Checks the budgets which child kept against what was read
+     * back from it, failing the tests which went over them */
+    void CheckBudgets (pid_t child, ymeas::Results const &results)
+    {
+        char const *directory = getenv (yconst::YiqiOutputDirectoryEnvKey);
+
+        if (!directory)
+            return;
+
+        std::string const file (ybud::BudgetsFile (directory, child));
+        ybud::Budgets     budgets;
+
+        try
+        {
+            std::ifstream input (file);
+
+            /* Nothing was kept unless a budget went unchecked */
+            if (!input)
+                return;
+
+            budgets = ybud::ReadBudgets (input);
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to read budgets: " << e.what () << std::endl;
+        }
+
+        unlink (file.c_str ());
+
+        for (ymeas::TestFailure const &failure : ybud::Check (budgets,
+                                                               results))
+        {
+            std::cout << yconst::YiqiFailedHeader
+                      << failure.test << ": "
+                      << failure.description << std::endl;
+            overBudgetTests.insert (failure.test);
+        }
+    }
+
+    /* Reports everything left behind for each test by
+     * a single instrumented process */
+    void ReportTestResults (yit::Tool const &tool, pid_t child)
+    {
+        ymeas::Results results;
+
+        try
+        {
+            results = tool.ReadTestResults (child);
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to read results: " << e.what () << std::endl;
+        }
+
+        /* Results for the same test are kept together */
+        auto first = results.begin ();
+
+        while (first != results.end ())
+        {
+            ymeas::Metrics metrics;
+            auto           last = first;
+
+            for (; last != results.end () && last->test == first->test; ++last)
+                metrics.push_back (last->metric);
+
+            ReportMetrics (first->test, first->tool, metrics);
+            first = last;
+        }
+
+        CheckBudgets (child, results);
+    }
+
+    void ReportProcessResults (yit::Tool const   &tool,
+                              std::string const &test,
+                              pid_t             child)
+    {
+        ymeas::Results results;
+
+        try
+        {
+            ymeas::Metrics const metrics (tool.ReadProcessResults (child));
+
+            ReportMetrics (test, tool.InstrumentationName (), metrics);
+
+            for (ymeas::Metric const &metric : metrics)
+                results.push_back (ymeas::Result {
+                                       test,
+                                       tool.InstrumentationName (),
+                                       metric
+                                   });
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to read results for "
+                      << test << ": " << e.what () << std::endl;
+        }
+
+        CheckBudgets (child, results);
+    }
+
+    /* Runs each test in a process of its own, as many at once as
+     * there are jobs, returning the exit status for the whole run */
+    int RunEachTest (yit::Tool const                  &tool,
+                     std::vector <char const *> const &programArguments,
+                     unsigned int                     jobs,
+                     std::string const                &durationsFile,
+                     ResultCache const                &cache,
+                     ysysapi::SystemCalls const       &calls)
+    {
+        ysched::Durations durations;
+
+        if (!durationsFile.empty ())
+            durations = ysched::ReadDurationsFile (durationsFile);
+
+        yexec::TestNames tests (cache.Replay (SelectedTests (calls)));
+
+        /* A slow test started last would be left running on its own */
+        if (jobs > 1)
+            tests = ysched::LongestFirst (tests, durations);
+
+        yexec::TestNames failed;
+
+        auto exited = [&](yexec::TestRun const &run) {
+            ReportProcessResults (tool, run.test, run.child);
+
+            durations[run.test] = run.seconds;
+
+            if (run.status != 0)
+                failed.push_back (run.test);
+            else if (!overBudgetTests.count (run.test))
+                cache.Store (run.test);
+        };
+
+        int const status (yexec::RelaunchCurrentProgramForEachTest (
+                              tool,
+                              tests,
+                              jobs,
+                              programArguments.size (),
+                              &programArguments[0],
+                              exited,
+                              std::cout,
+                              calls));
+
+        /* Each test's own summary is buried in its output */
+        for (std::string const &test : failed)
+            std::cout << yconst::YiqiFailedHeader << test
+                      << ": test process failed" << std::endl;
+
+        if (!durationsFile.empty ())
+            ysched::WriteDurationsFile (durationsFile, durations);
+
+        if (status == 0 && !overBudgetTests.empty ())
+            return 1;
+
+        return status;
+    }
 }
 
 void
@@ -55,39 +681,397 @@ YiqiEnvironment::TearDown()
 {
 }
 
+void
+YiqiTestListener::OnTestStart (::testing::TestInfo const &test)
+{
+    /* Budgets only apply to client code in the same test */
+    lastRegionMetrics.clear ();
+
+    for (yit::Tool::Unique const &tool : clientCodeTools)
+        tool->StartTest (std::string (test.test_case_name ()) +
+                         "." + test.name ());
+}
+
+void
+YiqiTestListener::OnTestEnd (::testing::TestInfo const &test)
+{
+    for (yit::Tool::Unique const &tool : clientCodeTools)
+        tool->EndTest (std::string (test.test_case_name ()) +
+                       "." + test.name ());
+}
+
+namespace
+{
+    /* Runs the tests under a tool with an instrumentation wrapper,
+     * returning the exit status for the whole run. This process may
+     * be replaced if the tool is the only one to run. */
+    int RunInstrumented (yit::Tool                        &tool,
+                         std::vector <char const *> const &programArguments,
+                         int                              argc,
+                         char const * const               *argv,
+                         po::options_description const    &desc,
+                         bool                             onlyTool,
+                         OutputDirectory                  &outputDirectory)
+    {
+        ysysapi::SystemCalls::Unique calls (ysysapi::MakeUNIXSystemCalls ());
+        unsigned int const           jobs (yc::ParseOptionsForJobs (argc,
+                                                                    argv,
+                                                                    desc));
+        ResultCache const            cache (
+            yc::ParseOptionsForCacheDirectory (argc, argv, desc),
+            tool,
+            *calls);
+
+        /* Each tool's results are checked against the budgets afresh */
+        overBudgetTests.clear ();
+
+        /* Tools which can only measure whole processes get
+         * a process of their own for each test */
+        if (tool.ProcessPerTest ())
+            return RunEachTest (tool,
+                                programArguments,
+                                jobs,
+                                yc::ParseOptionsForDurationsFile (argc,
+                                                                  argv,
+                                                                  desc),
+                                cache,
+                                *calls);
+
+        yexec::TestNames const          tests (
+            cache.Replay (SelectedTests (*calls)));
+        std::vector <char const *>      arguments (programArguments);
+        std::string                     filter;
+        std::unique_ptr <ShardingHidden> sharding;
+
+        if (cache.Enabled ())
+        {
+            if (tests.empty ())
+                return 0;
+
+            /* The filter only names tests in this process's shard */
+            sharding.reset (new ShardingHidden ());
+
+            /* Comes after any filter that was passed, so it wins */
+            filter = yconst::GoogleTestFilterOption +
+                     boost::algorithm::join (tests, ":");
+            arguments.push_back (filter.c_str ());
+        }
+
+        using namespace std::placeholders;
+
+        /* Tools which stream their results back have them
+         * turned into failures here as the tests run */
+        StreamedFailures          failures (tool,
+                                            yc::ParseOptionsForFailFast (argc,
+                                                                         argv,
+                                                                         desc));
+        yexec::StreamConsumerFunc consume;
+
+        if (tool.StreamsResults ())
+            consume = std::bind (&StreamedFailures::Consume,
+                                 &failures,
+                                 _1, _2, _3);
+
+        /* Tools which leave results behind for each test only
+         * need a single process, or one for each shard */
+        yexec::ProcessExitedFunc exited ([](pid_t) {});
+
+        if (tool.DumpsPerTest ())
+            exited = std::bind (ReportTestResults, std::cref (tool), _1);
+
+        int status = 0;
+
+        if (jobs > 1)
+            status = yexec::RelaunchCurrentProgramSharded (
+                         tool,
+                         jobs,
+                         arguments.size (),
+                         &arguments[0],
+                         consume,
+                         exited,
+                         std::cout,
+                         *calls);
+        else if (tool.StreamsResults ())
+            status = yexec::RelaunchCurrentProgramAndStream (
+                         tool,
+                         arguments.size (),
+                         &arguments[0],
+                         consume,
+                         *calls);
+        else if (tool.DumpsPerTest () || cache.Enabled () || !onlyTool)
+        {
+            /* Passing tests can only be cached once it exits, and
+             * other tools need this process afterwards */
+            status = yexec::RelaunchCurrentProgramAndWait (
+                         tool,
+                         arguments.size (),
+                         &arguments[0],
+                         exited,
+                         *calls);
+        }
+        else
+        {
+            /* Nothing would be left to remove it afterwards, and
+             * nothing is read back from it either */
+            outputDirectory.Remove ();
+
+            /* Does not return */
+            yexec::RelaunchCurrentProgram (tool,
+                                           arguments.size (),
+                                           &arguments[0],
+                                           *calls);
+        }
+
+        /* Every test passed, unless a tool found something in it. Problems
+         * found outside of any test that ran would be lost once all of
+         * the tests are kept, so nothing is kept until they are fixed. */
+        std::set <std::string> const &failed (failures.FailedTests ());
+        bool const                   allInTests (
+            std::all_of (failed.begin (),
+                         failed.end (),
+                         [&tests](std::string const &test) {
+                             return std::find (tests.begin (),
+                                               tests.end (),
+                                               test) != tests.end ();
+                         }));
+
+        if (status == 0 && allInTests)
+            for (std::string const &test : tests)
+                if (!failed.count (test) && !overBudgetTests.count (test))
+                    cache.Store (test);
+
+        if (status == 0 && (failures.Count () || !overBudgetTests.empty ()))
+            return 1;
+
+        return status;
+    }
+
+    /* Compares what this run measured against the baseline, or stores
+     * it as the new baseline, returning the exit status for the run */
+    int CheckBaseline (ybase::Options const &options, int status)
+    {
+        if (options.file.empty ())
+            return status;
+
+        ymeas::Results const baseline (ybase::Read (options.file));
+
+        if (options.update)
+        {
+            /* The numbers from a broken run are not worth keeping */
+            if (status != 0)
+            {
+                std::cerr << "not updating baseline " << options.file
+                          << " as tests failed" << std::endl;
+                return status;
+            }
+
+            ybase::Write (options.file,
+                          ybase::Update (baseline, measuredResults));
+            return status;
+        }
+
+        if (baseline.empty ())
+            std::cerr << "no baseline in " << options.file
+                      << ", pass --" << yconst::YiqiUpdateBaselineOption
+                      << " to create one" << std::endl;
+
+        ybase::Regressions const regressions (
+            ybase::Compare (baseline, measuredResults, options.tolerance));
+
+        if (regressions.empty ())
+            return status;
+
+        ybase::PrintRegressions (std::cout, regressions);
+
+        return status != 0 ? status : 1;
+    }
+
+    ymeas::Results ReadResultsFile (std::string const &path)
+    {
+        std::ifstream file (path);
+
+        if (!file)
+            throw std::runtime_error ("could not open results file " + path);
+
+        return ymeas::ReadResults (file);
+    }
+
+    /* Prints what changed since the earlier run, returning
+     * false if its results could not be read */
+    bool PrintDifference (ydiff::Options const &options,
+                          ymeas::Results const &after)
+    {
+        try
+        {
+            ydiff::PrintDifferences (
+                std::cout,
+                ydiff::Compare (ReadResultsFile (options.before), after),
+                options.functions);
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to compare against an earlier run: "
+                      << e.what () << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    /* Rewrites the results file so that everything measured in
+     * each test is together, in the order the tests first appear */
+    void GroupResultsByTest (std::string const &file)
+    {
+        ymeas::Results results;
+
+        {
+            std::ifstream input (file);
+            results = ymeas::ReadResults (input);
+        }
+
+        std::map <std::string, size_t> firstSeen;
+
+        for (size_t i = 0; i < results.size (); ++i)
+            firstSeen.insert (std::make_pair (results[i].test, i));
+
+        std::stable_sort (results.begin (),
+                          results.end (),
+                          [&firstSeen](ymeas::Result const &a,
+                                       ymeas::Result const &b) {
+                              return firstSeen[a.test] < firstSeen[b.test];
+                          });
+
+        std::ofstream output (file, std::ios::trunc);
+
+        for (ymeas::Result const &result : results)
+            ymeas::WriteResults (output,
+                                 result.test,
+                                 result.tool,
+                                 ymeas::Metrics { result.metric });
+    }
+}
+
 int main (int argc, char **argv)
 {
+    /* Google Test removes its own options from argv, but the
+     * instrumented process needs to see them too */
+    std::vector <char const *> const programArguments (argv, argv + argc);
+
     ::testing::InitGoogleTest (&argc, argv);
     ::testing::AddGlobalTestEnvironment(new YiqiEnvironment);
+    ::testing::UnitTest::GetInstance ()->listeners ().Append (
+        new YiqiTestListener);
 
+    po::options_description desc (yc::FetchOptionsDescription ());
     char const *activeTool = getenv (yconst::YiqiToolEnvKey);
 
+    resultsFile = yc::ParseOptionsForResultsFile (argc, argv, desc);
+
     if (activeTool)
     {
-    std::cout << yconst::YiqiRunningUnderHeader
+        std::cout << yconst::YiqiRunningUnderHeader
                   << std::string (activeTool)
                   << std::endl;
+
+        auto const toolID (yconst::ToolFromString (activeTool));
+        auto const options (yc::ParseOptionsForToolOptions (argc,
+                                                            argv,
+                                                            desc));
+        clientCodeTools.push_back (yc::MakeSpecifiedTool (toolID, options));
+
+        return RUN_ALL_TESTS ();
     }
-    else
-    {
-        po::options_description desc (yc::FetchOptionsDescription ());
 
-        /* Figure out if we need to re-exec here under valgrind */
-        yit::Tool::Unique tool (yc::ParseOptionsToToolUniquePtr (argc,
-                                                                 argv,
-                                                                 desc));
+    ydiff::Options const difference (yc::ParseOptionsForDifference (argc,
+                                                                    argv,
+                                                                    desc));
+
+    /* Two runs which have already finished are compared
+     * without running anything */
+    if (!difference.after.empty ())
+    {
+        ymeas::Results after;
 
-        /* We can skip a bit if there is no instrumentation wrapper */
-        if (!tool->InstrumentationWrapper ().empty ())
+        try
+        {
+            after = ReadResultsFile (difference.after);
+        }
+        catch (std::exception const &e)
         {
-            ysysapi::SystemCalls::Unique calls (ysysapi::MakeUNIXSystemCalls ());
+            std::cerr << "failed to read the later run: "
+                      << e.what () << std::endl;
+            return 1;
+        }
 
-            yexec::RelaunchCurrentProgram (*tool,
-                                           argc,
-                                           argv,
-                                           *calls);
+        return PrintDifference (difference, after) ? 0 : 1;
+    }
+
+    /* Start a fresh results file for this run, which the
+     * instrumented processes then append to */
+    if (!resultsFile.empty ())
+        std::ofstream (resultsFile, std::ios::trunc);
+
+    ybase::Options const baseline (yc::ParseOptionsForBaseline (argc,
+                                                                argv,
+                                                                desc));
+
+    /* Tools without an instrumentation wrapper all measure client
+     * code here, and the rest need to re-exec under valgrind */
+    yc::ToolUniquePtrs instrumented;
+
+    for (yit::Tool::Unique &tool : yc::ParseOptionsToToolUniquePtrs (argc,
+                                                                     argv,
+                                                                     desc))
+    {
+        if (tool->InstrumentationWrapper ().empty ())
+            clientCodeTools.push_back (std::move (tool));
+        else
+            instrumented.push_back (std::move (tool));
+    }
+
+    bool const onlyTool (clientCodeTools.size () + instrumented.size () == 1);
+    int        status = 0;
+
+    std::unique_ptr <OutputDirectory> outputDirectory;
+
+    if (!instrumented.empty ())
+    {
+        try
+        {
+            outputDirectory.reset (new OutputDirectory ());
+        }
+        catch (std::exception const &e)
+        {
+            std::cerr << "failed to make a directory for output files: "
+                      << e.what () << std::endl;
+            return 1;
         }
     }
 
-    return RUN_ALL_TESTS ();
+    if (!clientCodeTools.empty ())
+        status = RUN_ALL_TESTS ();
+
+    /* The first tool to fail decides the exit status */
+    for (yit::Tool::Unique const &tool : instrumented)
+    {
+        int const toolStatus (RunInstrumented (*tool,
+                                               programArguments,
+                                               argc,
+                                               argv,
+                                               desc,
+                                               onlyTool,
+                                               *outputDirectory));
+
+        if (status == 0)
+            status = toolStatus;
+    }
+
+    /* Each tool appended to the results file in turn */
+    if (!resultsFile.empty () && !onlyTool)
+        GroupResultsByTest (resultsFile);
+
+    if (!difference.before.empty ())
+        PrintDifference (difference, measuredResults);
+
+    return CheckBaseline (baseline, status);
 }
@@ -0,0 +1,26 @@
+/*
+ * heap_test.cpp
+ * Allocates twice in client code, for the heap tool to count.
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <yiqi/instrumentation.h>
+
+TEST (Heap, Allocates)
+{
+    std::unique_ptr <int> single;
+    std::vector <int>     many;
+
+    CLIENT_CODE ({
+        single.reset (new int (1));
+        many.resize (100);
+    })
+
+    EXPECT_EQ (100, many.size ());
+}
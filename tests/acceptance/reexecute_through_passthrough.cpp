@@ -459,3 +459,67 @@ TEST_F (DirectlyExecuteSimpleTest, ExecuteWithToolArgsOptionPassthroughMsg)
     EXPECT_THAT (output,
                  Contains (HasSubstr (ytp::OptionHeader)));
 }
+
+namespace
+{
+    std::string const heapTool (
+        yconst::StringFromTool (yconst::InstrumentationTool::Heap));
+}
+
+class DirectlyExecuteHeapTest :
+    public ChildOutputTest
+{
+    public:
+
+        std::string GetExecutable () const
+        {
+            return yta::heapTest;
+        }
+};
+
+TEST_F (DirectlyExecuteHeapTest, AllocationsInClientCodeCounted)
+{
+    argv.append (dashdashYiqiToolOption);
+    argv.append (heapTool);
+    launchBinaryAndWaitForReturn (yta::heapTest,
+                                  argv,
+                                  env,
+                                  childStdoutPipe.WriteEnd ());
+
+    std::vector <std::string> output (GetChildOutput ());
+
+    /* One for the int and one for the vector's elements, which are
+     * only counted if linking yiqi_heap brought in its allocation
+     * functions */
+    EXPECT_THAT (output,
+                 Contains (
+                     AllOf (HasSubstr (yconst::YiqiMeasuredHeader),
+                            HasSubstr ("Heap.Allocates " + heapTool +
+                                       " heap.allocations 2"))));
+}
+
+TEST_F (DirectlyExecuteHeapTest, AllocationsCountedTheSameWithOtherTools)
+{
+    std::string const tools (
+        std::string (yconst::StringFromTool (yconst::InstrumentationTool::Timer)) +
+        "," + heapTool + "," +
+        yconst::StringFromTool (yconst::InstrumentationTool::Rusage) + "," +
+        yconst::StringFromTool (yconst::InstrumentationTool::Perf));
+
+    argv.append (dashdashYiqiToolOption);
+    argv.append (tools);
+    launchBinaryAndWaitForReturn (yta::heapTest,
+                                  argv,
+                                  env,
+                                  childStdoutPipe.WriteEnd ());
+
+    std::vector <std::string> output (GetChildOutput ());
+
+    /* The timer's runs come after the one heap counts, so what
+     * was only allocated the first time is still counted */
+    EXPECT_THAT (output,
+                 Contains (
+                     AllOf (HasSubstr (yconst::YiqiMeasuredHeader),
+                            HasSubstr ("Heap.Allocates " + heapTool +
+                                       " heap.allocations 2"))));
+}
@@ -0,0 +1,126 @@
+/*
+ * cache_geometry.cpp
+ * Integration tests for reading caches from a sysfs directory
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gmock/gmock.h>
+
+#include "cache_geometry.h"
+
+namespace ygeo = yiqi::geometry;
+
+namespace
+{
+    struct MockIndex
+    {
+        char const *level;
+        char const *type;
+        char const *size;
+        char const *ways;
+        char const *line;
+    };
+
+    char const * const Files[] =
+    {
+        "level",
+        "type",
+        "size",
+        "ways_of_associativity",
+        "coherency_line_size"
+    };
+}
+
+class CacheGeometry :
+    public ::testing::Test
+{
+    public:
+
+        CacheGeometry () :
+            directory ("yiqi_cache_geometry_test")
+        {
+            mkdir (directory.c_str (), 0755);
+        }
+
+        ~CacheGeometry ()
+        {
+            for (std::string const &index : indices)
+            {
+                for (char const *file : Files)
+                    std::remove ((index + "/" + file).c_str ());
+
+                rmdir (index.c_str ());
+            }
+
+            rmdir (directory.c_str ());
+        }
+
+    protected:
+
+        void WriteIndex (MockIndex const &mock)
+        {
+            std::string const index (directory + "/index" +
+                                     std::to_string (indices.size ()));
+            char const * const values[] =
+            {
+                mock.level, mock.type, mock.size, mock.ways, mock.line
+            };
+
+            mkdir (index.c_str (), 0755);
+            indices.push_back (index);
+
+            for (size_t i = 0; i < sizeof (Files) / sizeof (Files[0]); ++i)
+                std::ofstream (index + "/" + Files[i]) << values[i] << "\n";
+        }
+
+        std::string const         directory;
+        std::vector <std::string> indices;
+};
+
+TEST_F (CacheGeometry, NothingReadFromEmptyDirectory)
+{
+    ygeo::Caches const caches (ygeo::ReadSystemCaches (directory));
+
+    EXPECT_EQ (0, caches.instruction.size);
+    EXPECT_EQ (0, caches.data.size);
+    EXPECT_EQ (0, caches.lastLevel.size);
+}
+
+TEST_F (CacheGeometry, LevelOneCachesByType)
+{
+    WriteIndex ({ "1", "Data", "48K", "12", "64" });
+    WriteIndex ({ "1", "Instruction", "32K", "8", "64" });
+
+    ygeo::Caches const caches (ygeo::ReadSystemCaches (directory));
+
+    EXPECT_EQ (48 * 1024, caches.data.size);
+    EXPECT_EQ (12, caches.data.associativity);
+    EXPECT_EQ (32 * 1024, caches.instruction.size);
+    EXPECT_EQ (64, caches.instruction.lineSize);
+}
+
+TEST_F (CacheGeometry, LastLevelIsHighestUnified)
+{
+    WriteIndex ({ "1", "Data", "48K", "12", "64" });
+    WriteIndex ({ "2", "Unified", "2048K", "16", "64" });
+    WriteIndex ({ "3", "Unified", "30720K", "20", "64" });
+
+    ygeo::Caches const caches (ygeo::ReadSystemCaches (directory));
+
+    EXPECT_EQ (30720 * 1024, caches.lastLevel.size);
+    EXPECT_EQ (20, caches.lastLevel.associativity);
+}
+
+TEST_F (CacheGeometry, CachesWithoutWaysSkipped)
+{
+    WriteIndex ({ "1", "Data", "48K", "0", "64" });
+
+    EXPECT_EQ (0, ygeo::ReadSystemCaches (directory).data.size);
+}
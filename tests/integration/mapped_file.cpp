@@ -0,0 +1,69 @@
+/*
+ * mapped_file.cpp
+ * Integration tests for mapping real files into memory
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+#include <gmock/gmock.h>
+
+#include "mapped_file.h"
+
+namespace ysys = yiqi::system;
+
+class MappedFile :
+    public ::testing::Test
+{
+    public:
+
+        MappedFile () :
+            path ("yiqi_mapped_file_test")
+        {
+        }
+
+        ~MappedFile ()
+        {
+            std::remove (path.c_str ());
+        }
+
+    protected:
+
+        void Write (std::string const &contents)
+        {
+            std::ofstream file (path);
+            file << contents;
+        }
+
+        std::string const path;
+};
+
+TEST_F (MappedFile, ThrowOnMissingFile)
+{
+    EXPECT_THROW ({
+        ysys::MappedFile file (path);
+    }, std::system_error);
+}
+
+TEST_F (MappedFile, EmptyFileHasNoData)
+{
+    Write ("");
+    ysys::MappedFile file (path);
+
+    EXPECT_EQ (0, file.size ());
+    EXPECT_EQ (nullptr, file.data ());
+}
+
+TEST_F (MappedFile, ContentsAreMapped)
+{
+    std::string const Contents ("mock contents");
+
+    Write (Contents);
+    ysys::MappedFile file (path);
+
+    ASSERT_EQ (Contents.size (), file.size ());
+    EXPECT_EQ (Contents, std::string (file.data (), file.size ()));
+}
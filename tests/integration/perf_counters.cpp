@@ -0,0 +1,90 @@
+/*
+ * perf_counters.cpp
+ * Integration tests for counting events with the real perf_event_open
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <gmock/gmock.h>
+
+#include "perf_counters.h"
+
+using ::testing::AnyOf;
+using ::testing::Eq;
+using ::testing::Ge;
+
+namespace ycount = yiqi::counters;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    /* Not optimised away, so that there is always something to count */
+    volatile unsigned int sink;
+
+    void Spin ()
+    {
+        for (unsigned int i = 0; i < 1000000; ++i)
+            sink = sink + i;
+    }
+
+    auto const KnownMetric = AnyOf (Eq ("Ir"),
+                                    Eq ("cycles"),
+                                    Eq ("cache.references"),
+                                    Eq ("cache.misses"),
+                                    Eq ("branch.misses"),
+                                    Eq ("task.clock.ns"),
+                                    Eq ("page.faults"),
+                                    Eq ("context.switches"));
+}
+
+/* Whether any counters can be opened depends on the kernel and on
+ * perf_event_paranoid, so these only check what was counted */
+TEST (PerfCounters, OnlyKnownMetricsAreCounted)
+{
+    ycount::Counters::Unique counters (ycount::MakePerfEventCounters ());
+
+    counters->Start ();
+    Spin ();
+    counters->Stop ();
+
+    for (ymeas::Metric const &metric : counters->Read ())
+    {
+        EXPECT_THAT (metric.name, KnownMetric);
+        EXPECT_THAT (metric.value, Ge (0));
+        EXPECT_TRUE (metric.function.empty ());
+    }
+}
+
+TEST (PerfCounters, NothingCountedWhileStopped)
+{
+    ycount::Counters::Unique counters (ycount::MakePerfEventCounters ());
+
+    counters->Start ();
+    counters->Stop ();
+    ymeas::Metrics const before (counters->Read ());
+
+    Spin ();
+    ymeas::Metrics const after (counters->Read ());
+
+    ASSERT_EQ (before.size (), after.size ());
+
+    for (size_t i = 0; i < before.size (); ++i)
+        EXPECT_EQ (before[i].value, after[i].value) << before[i].name;
+}
+
+TEST (PerfCounters, InstructionsCountedWhenAvailable)
+{
+    ycount::Counters::Unique counters (ycount::MakePerfEventCounters ());
+
+    counters->Start ();
+    Spin ();
+    counters->Stop ();
+
+    for (ymeas::Metric const &metric : counters->Read ())
+    {
+        if (metric.name == "Ir")
+        {
+            EXPECT_THAT (metric.value, Ge (1000000));
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * result_cache.cpp
+ * Integration tests for keeping results in a real directory
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <gmock/gmock.h>
+
+#include "result_cache.h"
+
+namespace ycache = yiqi::cache;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    std::string const MockKey ("0123456789abcdef");
+    std::string const MockTest ("MockCase.MockTest");
+    std::string const MockTool ("mocktool");
+}
+
+class ResultCache :
+    public ::testing::Test
+{
+    public:
+
+        ResultCache () :
+            directory ("yiqi_result_cache_test")
+        {
+        }
+
+        ~ResultCache ()
+        {
+            std::remove ((directory + "/" + MockKey).c_str ());
+            rmdir (directory.c_str ());
+        }
+
+    protected:
+
+        std::string const directory;
+};
+
+TEST_F (ResultCache, NothingKeptWithoutDirectory)
+{
+    ymeas::Metrics metrics;
+
+    EXPECT_FALSE (ycache::Lookup (directory, MockKey, metrics));
+}
+
+TEST_F (ResultCache, StoredMetricsAreLookedUp)
+{
+    ymeas::Metrics const stored =
+    {
+        { "Ir", 100, "" },
+        { "Ir", 40, "mock.cpp:function" }
+    };
+
+    ycache::Store (directory, MockKey, MockTest, MockTool, stored);
+
+    ymeas::Metrics metrics;
+
+    ASSERT_TRUE (ycache::Lookup (directory, MockKey, metrics));
+    ASSERT_EQ (2, metrics.size ());
+    EXPECT_EQ ("Ir", metrics[0].name);
+    EXPECT_EQ (100, metrics[0].value);
+    EXPECT_EQ ("mock.cpp:function", metrics[1].function);
+    EXPECT_EQ (40, metrics[1].value);
+}
+
+TEST_F (ResultCache, TestWithNothingMeasuredIsKept)
+{
+    ycache::Store (directory, MockKey, MockTest, MockTool, ymeas::Metrics ());
+
+    ymeas::Metrics metrics = { { "Ir", 1, "" } };
+
+    EXPECT_TRUE (ycache::Lookup (directory, MockKey, metrics));
+    EXPECT_TRUE (metrics.empty ());
+}
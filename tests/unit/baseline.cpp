@@ -0,0 +1,162 @@
+/*
+ * baseline.cpp:
+ * Tests for comparing measurements against a baseline
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include "baseline.h"
+#include "constants.h"
+
+using ::testing::HasSubstr;
+
+namespace yconst = yiqi::constants;
+namespace ybase = yiqi::baseline;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    std::string const MockTest ("MockCase.MockTest");
+    std::string const MockTool ("mocktool");
+
+    ymeas::Result MockResult (std::string const &metric,
+                              double            value,
+                              std::string const &function = std::string ())
+    {
+        return ymeas::Result { MockTest, MockTool, { metric, value, function } };
+    }
+
+    ybase::Tolerance const Exact = { 0, 0 };
+}
+
+TEST (Baseline, NoRegressionAtOrUnderBaseline)
+{
+    ymeas::Results const baseline = { MockResult ("Ir", 100) };
+
+    EXPECT_TRUE (ybase::Compare (baseline,
+                                 { MockResult ("Ir", 100) },
+                                 Exact).empty ());
+    EXPECT_TRUE (ybase::Compare (baseline,
+                                 { MockResult ("Ir", 50) },
+                                 Exact).empty ());
+}
+
+TEST (Baseline, RegressionOverBaseline)
+{
+    ybase::Regressions const regressions (
+        ybase::Compare ({ MockResult ("Ir", 100) },
+                        { MockResult ("Ir", 101) },
+                        Exact));
+
+    ASSERT_EQ (1, regressions.size ());
+    EXPECT_EQ (MockTest, regressions[0].test);
+    EXPECT_EQ (MockTool, regressions[0].tool);
+    EXPECT_EQ ("Ir", regressions[0].metric);
+    EXPECT_EQ (100, regressions[0].baseline);
+    EXPECT_EQ (101, regressions[0].measured);
+}
+
+TEST (Baseline, LargerOfTolerancesApplies)
+{
+    ymeas::Results const baseline = { MockResult ("Ir", 100) };
+
+    ybase::Tolerance const relative = { 0.1, 5 };
+    EXPECT_TRUE (ybase::Compare (baseline,
+                                 { MockResult ("Ir", 110) },
+                                 relative).empty ());
+    EXPECT_EQ (1, ybase::Compare (baseline,
+                                  { MockResult ("Ir", 111) },
+                                  relative).size ());
+
+    ybase::Tolerance const absolute = { 0.1, 20 };
+    EXPECT_TRUE (ybase::Compare (baseline,
+                                 { MockResult ("Ir", 120) },
+                                 absolute).empty ());
+}
+
+TEST (Baseline, IgnoreMeasurementsWithoutBaselineAndFunctions)
+{
+    ymeas::Results const baseline = { MockResult ("Ir", 100, "mock.cpp:f") };
+
+    EXPECT_TRUE (ybase::Compare (baseline,
+                                 { MockResult ("Ir", 200, "mock.cpp:f"),
+                                   MockResult ("Dr", 200) },
+                                 Exact).empty ());
+}
+
+TEST (Baseline, UpdateReplacesAndAddsWholeTestMeasurements)
+{
+    ymeas::Results const updated (
+        ybase::Update ({ MockResult ("Ir", 100), MockResult ("Dr", 10) },
+                       { MockResult ("Ir", 90),
+                         MockResult ("Dw", 5),
+                         MockResult ("Ir", 1, "mock.cpp:f") }));
+
+    ASSERT_EQ (3, updated.size ());
+    EXPECT_EQ ("Ir", updated[0].metric.name);
+    EXPECT_EQ (90, updated[0].metric.value);
+    EXPECT_EQ ("Dr", updated[1].metric.name);
+    EXPECT_EQ (10, updated[1].metric.value);
+    EXPECT_EQ ("Dw", updated[2].metric.name);
+}
+
+TEST (Baseline, PrintTableOfRegressions)
+{
+    std::stringstream ss;
+
+    ybase::PrintRegressions (ss, { { MockTest, MockTool, "Ir", 100, 110 } });
+
+    EXPECT_EQ (std::string (yconst::YiqiRegressedHeader) +
+               "1 measurements over baseline\n"
+               "  Test              Tool     Metric Baseline Measured Change\n"
+               "  MockCase.MockTest mocktool Ir     100      110      +10.00%\n",
+               ss.str ());
+}
+
+TEST (Baseline, EachRegionComparedAgainstItsOwnBaseline)
+{
+    ymeas::Results const run = { MockResult ("median.ns", 1000),
+                                 MockResult ("median.ns", 10) };
+
+    EXPECT_TRUE (ybase::Compare (ybase::Update ({}, run),
+                                 run,
+                                 Exact).empty ());
+
+    ybase::Regressions const regressions (
+        ybase::Compare (run,
+                        { MockResult ("median.ns", 1000),
+                          MockResult ("median.ns", 20) },
+                        Exact));
+
+    ASSERT_EQ (1, regressions.size ());
+    EXPECT_EQ (10, regressions[0].baseline);
+    EXPECT_EQ (20, regressions[0].measured);
+    EXPECT_EQ (1, regressions[0].region);
+}
+
+TEST (Baseline, UpdateDropsRegionsATestNoLongerHas)
+{
+    ymeas::Results const updated (
+        ybase::Update ({ MockResult ("Ir", 100),
+                         MockResult ("Ir", 200),
+                         MockResult ("Dr", 10) },
+                       { MockResult ("Ir", 90) }));
+
+    ASSERT_EQ (2, updated.size ());
+    EXPECT_EQ (90, updated[0].metric.value);
+    EXPECT_EQ ("Dr", updated[1].metric.name);
+}
+
+TEST (Baseline, PrintRegionOfTestsWithSeveral)
+{
+    std::stringstream ss;
+
+    ybase::PrintRegressions (ss,
+                             { { MockTest, MockTool, "Ir", 100, 110, 1 } });
+
+    EXPECT_THAT (ss.str (), HasSubstr ("MockCase.MockTest (region 2)"));
+}
@@ -0,0 +1,127 @@
+/*
+ * cache_geometry.cpp:
+ * Tests for describing the caches valgrind simulates
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "cache_geometry.h"
+
+using ::testing::Contains;
+using ::testing::HasSubstr;
+
+namespace ygeo = yiqi::geometry;
+
+TEST (CacheGeometry, ParseSizeInBytes)
+{
+    EXPECT_EQ (512, ygeo::ParseSize ("512"));
+}
+
+TEST (CacheGeometry, ParseSizeWithSuffix)
+{
+    EXPECT_EQ (48 * 1024, ygeo::ParseSize ("48K"));
+    EXPECT_EQ (2 * 1024 * 1024, ygeo::ParseSize ("2M"));
+}
+
+TEST (CacheGeometry, ThrowOnMalformedSize)
+{
+    EXPECT_THROW ({
+        ygeo::ParseSize ("large");
+    }, std::runtime_error);
+
+    EXPECT_THROW ({
+        ygeo::ParseSize ("32Q");
+    }, std::runtime_error);
+}
+
+TEST (CacheGeometry, PowerOfTwoSetsKept)
+{
+    ygeo::Cache const cache = { 48 * 1024, 12, 64 };
+    ygeo::Cache const simulated (ygeo::Simulatable (cache));
+
+    EXPECT_EQ (cache.size, simulated.size);
+    EXPECT_EQ (cache.associativity, simulated.associativity);
+    EXPECT_EQ (cache.lineSize, simulated.lineSize);
+}
+
+TEST (CacheGeometry, OtherSetsMadeFewerAndLarger)
+{
+    /* 24576 sets of 20 lines */
+    ygeo::Cache const cache = { 30 * 1024 * 1024, 20, 64 };
+    ygeo::Cache const simulated (ygeo::Simulatable (cache));
+
+    EXPECT_EQ (cache.size, simulated.size);
+    EXPECT_EQ (cache.lineSize, simulated.lineSize);
+    EXPECT_EQ (30, simulated.associativity);
+}
+
+TEST (CacheGeometry, SizeWorkedOutAgainFromSets)
+{
+    /* 245760 sets, rounded down to 131072 */
+    ygeo::Cache const cache = { 300 * 1024 * 1024, 20, 64 };
+    ygeo::Cache const simulated (ygeo::Simulatable (cache));
+
+    EXPECT_EQ (38, simulated.associativity);
+    EXPECT_EQ (64 * 38 * 131072, simulated.size);
+}
+
+TEST (CacheGeometry, UnknownCacheLeftAlone)
+{
+    ygeo::Cache const unknown = ygeo::Cache ();
+
+    EXPECT_EQ (0, ygeo::Simulatable (unknown).size);
+}
+
+TEST (CacheGeometry, OptionForEachKnownCache)
+{
+    ygeo::Caches caches = ygeo::Caches ();
+    caches.data = { 32 * 1024, 8, 64 };
+    caches.lastLevel = { 8 * 1024 * 1024, 16, 64 };
+
+    EXPECT_EQ ("--D1=32768,8,64 --LL=8388608,16,64",
+               ygeo::ValgrindOptions (caches));
+}
+
+TEST (CacheGeometry, NoOptionsWithoutCaches)
+{
+    EXPECT_EQ ("", ygeo::ValgrindOptions (ygeo::Caches ()));
+}
+
+TEST (CacheGeometry, OptionsAreSimulatable)
+{
+    ygeo::Caches caches = ygeo::Caches ();
+    caches.lastLevel = { 30 * 1024 * 1024, 20, 64 };
+
+    EXPECT_EQ ("--LL=31457280,30,64", ygeo::ValgrindOptions (caches));
+}
+
+TEST (CacheGeometry, NamedProfileHasEveryCache)
+{
+    ygeo::Caches const caches (ygeo::ProfileCaches ("skylake-sp"));
+
+    EXPECT_EQ (32 * 1024, caches.instruction.size);
+    EXPECT_EQ (32 * 1024, caches.data.size);
+    EXPECT_EQ (11, caches.lastLevel.associativity);
+}
+
+TEST (CacheGeometry, HostIsAProfile)
+{
+    EXPECT_THAT (ygeo::ProfileNames (), Contains (ygeo::HostProfile));
+}
+
+TEST (CacheGeometry, ThrowOnUnknownProfile)
+{
+    try
+    {
+        ygeo::ProfileCaches ("mock");
+        ADD_FAILURE () << "expected std::runtime_error";
+    }
+    catch (std::runtime_error const &e)
+    {
+        EXPECT_THAT (e.what (), HasSubstr ("skylake-sp"));
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ * cachegrind_output.cpp:
+ * Tests for reading back cachegrind output files
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "cachegrind_output.h"
+#include "measurement.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yocg = yiqi::output::cachegrind;
+
+namespace
+{
+    std::string const MockEvents ("events: Ir I1mr ILmr Dr D1mr DLmr "
+                                  "Dw D1mw DLmw\n");
+    std::string const MockSummary ("summary: 100 2 1 40 4 3 20 6 5\n");
+
+    double ValueOf (ymeas::Metrics const &metrics, std::string const &name)
+    {
+        for (ymeas::Metric const &metric : metrics)
+            if (metric.name == name)
+                return metric.value;
+
+        throw std::logic_error ("no metric named " + name);
+    }
+}
+
+TEST (CachegrindOutput, ThrowOnNoEventsLine)
+{
+    std::stringstream output (MockSummary);
+
+    EXPECT_THROW ({
+        yocg::ReadSummary (output);
+    }, std::runtime_error);
+}
+
+TEST (CachegrindOutput, ThrowOnNoSummaryLine)
+{
+    std::stringstream output (MockEvents);
+
+    EXPECT_THROW ({
+        yocg::ReadSummary (output);
+    }, std::runtime_error);
+}
+
+TEST (CachegrindOutput, ThrowOnMoreValuesThanEvents)
+{
+    std::stringstream output ("events: Ir\nsummary: 1 2\n");
+
+    EXPECT_THROW ({
+        yocg::ReadSummary (output);
+    }, std::runtime_error);
+}
+
+TEST (CachegrindOutput, OneMetricForEachEvent)
+{
+    std::stringstream output ("cmd: mock\n" + MockEvents + "fl=mock.cpp\n" +
+                              MockSummary);
+    ymeas::Metrics events (yocg::ReadSummary (output));
+
+    ASSERT_EQ (9, events.size ());
+    EXPECT_EQ ("Ir", events[0].name);
+    EXPECT_EQ (100, events[0].value);
+    EXPECT_EQ ("DLmw", events[8].name);
+    EXPECT_EQ (5, events[8].value);
+}
+
+TEST (CachegrindOutput, MissingTrailingValuesAreZero)
+{
+    std::stringstream output ("events: Ir Dr\nsummary: 7\n");
+    ymeas::Metrics events (yocg::ReadSummary (output));
+
+    ASSERT_EQ (2, events.size ());
+    EXPECT_EQ (0, events[1].value);
+}
+
+TEST (CachegrindOutput, CacheTotalsSumReadsAndWrites)
+{
+    std::stringstream output (MockEvents + MockSummary);
+    ymeas::Metrics totals (yocg::CacheTotals (yocg::ReadSummary (output)));
+
+    EXPECT_EQ (100, ValueOf (totals, "I1.refs"));
+    EXPECT_EQ (2, ValueOf (totals, "I1.misses"));
+    EXPECT_EQ (60, ValueOf (totals, "D1.refs"));
+    EXPECT_EQ (10, ValueOf (totals, "D1.misses"));
+    EXPECT_EQ (12, ValueOf (totals, "LL.refs"));
+    EXPECT_EQ (9, ValueOf (totals, "LL.misses"));
+}
+
+TEST (CachegrindOutput, CacheTotalsLeaveOutUncollectedEvents)
+{
+    std::stringstream output ("events: Ir\nsummary: 100\n");
+    ymeas::Metrics totals (yocg::CacheTotals (yocg::ReadSummary (output)));
+
+    ASSERT_EQ (1, totals.size ());
+    EXPECT_EQ ("I1.refs", totals[0].name);
+}
+
+TEST (CachegrindOutput, MissRatesOfDataReferencesAndBranches)
+{
+    std::stringstream output ("events: Dr D1mr DLmr Dw D1mw DLmw "
+                              "Bc Bcm Bi Bim\n"
+                              "summary: 60 4 3 20 6 1 50 5 8 2\n");
+    ymeas::Metrics rates (yocg::MissRates (yocg::ReadSummary (output)));
+
+    EXPECT_DOUBLE_EQ (0.125, ValueOf (rates, "D1.miss.rate"));
+    EXPECT_DOUBLE_EQ (0.05, ValueOf (rates, "LLd.miss.rate"));
+    EXPECT_DOUBLE_EQ (0.1, ValueOf (rates, "Bc.mispredict.rate"));
+    EXPECT_DOUBLE_EQ (0.25, ValueOf (rates, "Bi.mispredict.rate"));
+}
+
+TEST (CachegrindOutput, MissRatesLeaveOutUncollectedAndUnreferenced)
+{
+    std::stringstream output ("events: Ir Bc Bcm Bi Bim\n"
+                              "summary: 100 10 1 0 0\n");
+    ymeas::Metrics rates (yocg::MissRates (yocg::ReadSummary (output)));
+
+    ASSERT_EQ (1, rates.size ());
+    EXPECT_EQ ("Bc.mispredict.rate", rates[0].name);
+}
@@ -0,0 +1,402 @@
+/*
+ * callgrind_output.cpp:
+ * Tests for reading back callgrind profiles
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "callgrind_output.h"
+
+using ::testing::ElementsAre;
+
+namespace yocl = yiqi::output::callgrind;
+
+namespace
+{
+    yocl::Profile Read (std::string const &profile)
+    {
+        return yocl::ReadProfile (profile.data (), profile.size ());
+    }
+
+    yocl::Profile ReadLines (std::string const &profile)
+    {
+        return yocl::ReadProfile (profile.data (), profile.size (), true);
+    }
+
+    yocl::FunctionCosts const & Function (yocl::Profile const &profile,
+                                          std::string const   &name)
+    {
+        for (yocl::FunctionCosts const &function : profile.functions)
+            if (function.name == name)
+                return function;
+
+        throw std::logic_error ("no function named " + name);
+    }
+
+    std::string const CallingProfile ("version: 1\n"
+                                      "positions: line\n"
+                                      "events: Ir Dr\n"
+                                      "ob=(1) /mock/binary\n"
+                                      "fl=(1) mock.cpp\n"
+                                      "fn=(1) caller\n"
+                                      "10 5 1\n"
+                                      "cfn=(2) callee\n"
+                                      "calls=2 20\n"
+                                      "+1 100 10\n"
+                                      "fn=(2)\n"
+                                      "20 50 5\n"
+                                      "cfn=(2)\n"
+                                      "calls=1 20\n"
+                                      "* 7 1\n"
+                                      "totals: 155 16\n");
+}
+
+TEST (CallgrindOutput, ReadEvents)
+{
+    yocl::Profile const profile (Read ("events: Ir Dr Dw\n"));
+
+    EXPECT_THAT (profile.events, ElementsAre ("Ir", "Dr", "Dw"));
+}
+
+TEST (CallgrindOutput, ExclusiveCostIsOwnCostLines)
+{
+    yocl::Profile const profile (Read (CallingProfile));
+
+    EXPECT_THAT (Function (profile, "caller").exclusive, ElementsAre (5, 1));
+    EXPECT_THAT (Function (profile, "callee").exclusive, ElementsAre (50, 5));
+}
+
+TEST (CallgrindOutput, InclusiveCostAddsCallsToOthers)
+{
+    yocl::Profile const profile (Read (CallingProfile));
+
+    EXPECT_THAT (Function (profile, "caller").inclusive,
+                 ElementsAre (105, 11));
+
+    /* The recursive call is already in its own exclusive cost */
+    EXPECT_THAT (Function (profile, "callee").inclusive,
+                 ElementsAre (50, 5));
+}
+
+TEST (CallgrindOutput, CallsToOthersAreKept)
+{
+    yocl::Profile const profile (Read (CallingProfile));
+
+    ASSERT_EQ (1, profile.calls.size ());
+    EXPECT_EQ ("caller", profile.functions[profile.calls[0].caller].name);
+    EXPECT_EQ ("callee", profile.functions[profile.calls[0].callee].name);
+    EXPECT_THAT (profile.calls[0].inclusive, ElementsAre (100, 10));
+}
+
+TEST (CallgrindOutput, TotalsLeaveOutCallCosts)
+{
+    yocl::Profile const profile (Read (CallingProfile));
+
+    EXPECT_THAT (profile.totals, ElementsAre (55, 6));
+}
+
+TEST (CallgrindOutput, CompressedNamesReferBackToDefinition)
+{
+    yocl::Profile const profile (Read (CallingProfile));
+
+    ASSERT_EQ (2, profile.functions.size ());
+    EXPECT_EQ ("mock.cpp", Function (profile, "callee").file);
+    EXPECT_EQ ("/mock/binary", Function (profile, "callee").object);
+}
+
+TEST (CallgrindOutput, UndefinedCompressedNameThrows)
+{
+    EXPECT_THROW ({
+        Read ("events: Ir\nfn=(3)\n1 1\n");
+    }, std::runtime_error);
+}
+
+TEST (CallgrindOutput, MissingTrailingCostsAreZero)
+{
+    yocl::Profile const profile (Read ("events: Ir Dr Dw\n"
+                                       "fn=mock\n"
+                                       "1 3\n"
+                                       "2 4 1\n"));
+
+    EXPECT_THAT (Function (profile, "mock").exclusive,
+                 ElementsAre (7, 1, 0));
+}
+
+TEST (CallgrindOutput, MoreCostsThanEventsThrows)
+{
+    EXPECT_THROW ({
+        Read ("events: Ir\nfn=mock\n1 1 1\n");
+    }, std::runtime_error);
+}
+
+TEST (CallgrindOutput, CostOutsideFunctionThrows)
+{
+    EXPECT_THROW ({
+        Read ("events: Ir\n1 1\n");
+    }, std::runtime_error);
+}
+
+TEST (CallgrindOutput, RelativeAndHexPositionsWithMultipleColumns)
+{
+    yocl::Profile const profile (Read ("positions: instr line\n"
+                                       "events: Ir\n"
+                                       "fn=mock\n"
+                                       "0x4005d0 10 1\n"
+                                       "+4 * 2\n"
+                                       "-2 +1 3\n"));
+
+    EXPECT_THAT (Function (profile, "mock").exclusive, ElementsAre (6));
+}
+
+TEST (CallgrindOutput, SameFunctionInDifferentPartsIsSummed)
+{
+    yocl::Profile const profile (Read ("events: Ir\n"
+                                       "part: 1\n"
+                                       "fn=(1) mock\n"
+                                       "1 2\n"
+                                       "part: 2\n"
+                                       "fn=(1)\n"
+                                       "1 3\n"));
+
+    ASSERT_EQ (1, profile.functions.size ());
+    EXPECT_THAT (profile.functions[0].exclusive, ElementsAre (5));
+}
+
+TEST (CallgrindOutput, EventsNamedAgainInEachPartKeepTotals)
+{
+    yocl::Profile const profile (Read ("events: Ir\n"
+                                       "part: 1\n"
+                                       "fn=(1) mock\n"
+                                       "1 2\n"
+                                       "events: Ir\n"
+                                       "part: 2\n"
+                                       "fn=(1)\n"
+                                       "1 3\n"));
+
+    EXPECT_THAT (profile.totals, ElementsAre (5));
+    EXPECT_THAT (Function (profile, "mock").exclusive, ElementsAre (5));
+}
+
+TEST (CallgrindOutput, EventsOfEachPartMatchedByName)
+{
+    yocl::Profile const profile (Read ("events: Ir Dr\n"
+                                       "fn=(1) mock\n"
+                                       "1 2 4\n"
+                                       "events: Dw Ir\n"
+                                       "fn=(1)\n"
+                                       "1 1 3\n"));
+
+    EXPECT_THAT (profile.events, ElementsAre ("Ir", "Dr", "Dw"));
+    EXPECT_THAT (profile.totals, ElementsAre (5, 4, 1));
+    EXPECT_THAT (Function (profile, "mock").exclusive,
+                 ElementsAre (5, 4, 1));
+}
+
+TEST (CallgrindOutput, LastLineNeedNotEndInNewline)
+{
+    yocl::Profile const profile (Read ("events: Ir\nfn=mock\n1 2"));
+
+    EXPECT_THAT (profile.totals, ElementsAre (2));
+}
+
+TEST (CallgrindOutput, ReadTrigger)
+{
+    yocl::Profile const profile (
+        Read ("desc: Timerange: Basic block 0 - 1234\n"
+              "desc: Trigger: Client Request: MockCase.MockTest\n"
+              "events: Ir\n"));
+
+    EXPECT_EQ ("Client Request: MockCase.MockTest", profile.trigger);
+}
+
+TEST (CallgrindOutput, EventTotalsAreMetrics)
+{
+    yiqi::measurement::Metrics const totals (
+        yocl::EventTotals (Read (CallingProfile)));
+
+    ASSERT_EQ (2, totals.size ());
+    EXPECT_EQ ("Ir", totals[0].name);
+    EXPECT_EQ (55, totals[0].value);
+    EXPECT_EQ ("Dr", totals[1].name);
+    EXPECT_EQ (6, totals[1].value);
+}
+
+TEST (CallgrindOutput, FunctionTotalsNamedByFileAndFunction)
+{
+    yiqi::measurement::Metrics const totals (
+        yocl::FunctionTotals (Read ("events: Ir Dr\n"
+                                    "fl=mock.cpp\n"
+                                    "fn=mock\n"
+                                    "1 3 0\n")));
+
+    ASSERT_EQ (1, totals.size ());
+    EXPECT_EQ ("Ir", totals[0].name);
+    EXPECT_EQ (3, totals[0].value);
+    EXPECT_EQ ("mock.cpp:mock", totals[0].function);
+}
+
+TEST (CallgrindOutput, FunctionInclusiveTotalsIncludeCalls)
+{
+    yiqi::measurement::Metrics const totals (
+        yocl::FunctionInclusiveTotals (Read (CallingProfile)));
+
+    ASSERT_EQ (4, totals.size ());
+    EXPECT_EQ ("Ir.inclusive", totals[0].name);
+    EXPECT_EQ (105, totals[0].value);
+    EXPECT_EQ ("mock.cpp:caller", totals[0].function);
+    EXPECT_EQ ("Dr.inclusive", totals[1].name);
+    EXPECT_EQ (11, totals[1].value);
+}
+
+TEST (CallgrindOutput, FunctionMissRatesForEachFunction)
+{
+    yiqi::measurement::Metrics const rates (
+        yocl::FunctionMissRates (Read ("events: Ir Bc Bcm\n"
+                                       "fl=mock.cpp\n"
+                                       "fn=predictable\n"
+                                       "1 10 4 0\n"
+                                       "fn=unpredictable\n"
+                                       "2 10 4 2\n"
+                                       "fn=straight\n"
+                                       "3 10\n")));
+
+    ASSERT_EQ (2, rates.size ());
+    EXPECT_EQ ("Bc.mispredict.rate", rates[0].name);
+    EXPECT_EQ (0, rates[0].value);
+    EXPECT_EQ ("mock.cpp:predictable", rates[0].function);
+    EXPECT_EQ (0.5, rates[1].value);
+    EXPECT_EQ ("mock.cpp:unpredictable", rates[1].function);
+}
+
+TEST (CallgrindOutput, ReadCachegrindProfile)
+{
+    yocl::Profile const profile (Read ("desc: I1 cache: 32768 B, 64 B\n"
+                                       "cmd: ./mock\n"
+                                       "events: Ir I1mr ILmr Dr D1mr DLmr "
+                                       "Dw D1mw DLmw\n"
+                                       "fl=mock.cpp\n"
+                                       "fn=mock\n"
+                                       "3 10 1 1 4 1 0 2\n"
+                                       "4 5\n"
+                                       "summary: 15 1 1 4 1 0 2 0 0\n"));
+
+    EXPECT_THAT (profile.totals,
+                 ElementsAre (15, 1, 1, 4, 1, 0, 2, 0, 0));
+}
+
+TEST (CallgrindOutput, LineCostsLeaveOutCalls)
+{
+    yocl::Profile const profile (ReadLines (CallingProfile));
+
+    ASSERT_EQ (2, profile.lines.size ());
+    EXPECT_EQ ("mock.cpp", profile.lines[0].file);
+    EXPECT_EQ (10, profile.lines[0].line);
+    EXPECT_THAT (profile.lines[0].exclusive, ElementsAre (5, 1));
+    EXPECT_EQ (20, profile.lines[1].line);
+    EXPECT_THAT (profile.lines[1].exclusive, ElementsAre (50, 5));
+}
+
+TEST (CallgrindOutput, InlinedLinesAreInTheirOwnFile)
+{
+    yocl::Profile const profile (ReadLines ("events: Ir\n"
+                                            "fl=(1) mock.cpp\n"
+                                            "fn=(1) mock\n"
+                                            "1 2\n"
+                                            "fi=(2) mock.h\n"
+                                            "5 3\n"
+                                            "fe=(1)\n"
+                                            "1 4\n"));
+
+    ASSERT_EQ (2, profile.lines.size ());
+    EXPECT_EQ ("mock.cpp", profile.lines[0].file);
+    EXPECT_THAT (profile.lines[0].exclusive, ElementsAre (6));
+    EXPECT_EQ ("mock.h", profile.lines[1].file);
+    EXPECT_EQ (5, profile.lines[1].line);
+    EXPECT_THAT (profile.lines[1].exclusive, ElementsAre (3));
+}
+
+TEST (CallgrindOutput, JumpsLeaveLinePositionsInPlace)
+{
+    yocl::Profile const profile (ReadLines ("positions: line\n"
+                                            "events: Ir\n"
+                                            "fl=(1) mock.cpp\n"
+                                            "fn=(1) mock\n"
+                                            "10 2\n"
+                                            "fi=(2) mock.h\n"
+                                            "+5 3\n"
+                                            "jcnd=4/2 +3\n"
+                                            "+1\n"
+                                            "+1 7\n"
+                                            "jfi=(3) other.h\n"
+                                            "jump=1 -20\n"
+                                            "*\n"
+                                            "fe=(1)\n"
+                                            "-7 1\n"));
+
+    ASSERT_EQ (3, profile.lines.size ());
+    EXPECT_EQ ("mock.cpp", profile.lines[0].file);
+    EXPECT_EQ (10, profile.lines[0].line);
+    EXPECT_THAT (profile.lines[0].exclusive, ElementsAre (3));
+    EXPECT_EQ ("mock.h", profile.lines[1].file);
+    EXPECT_EQ (15, profile.lines[1].line);
+    EXPECT_THAT (profile.lines[1].exclusive, ElementsAre (3));
+    EXPECT_EQ ("mock.h", profile.lines[2].file);
+    EXPECT_EQ (17, profile.lines[2].line);
+    EXPECT_THAT (profile.lines[2].exclusive, ElementsAre (7));
+}
+
+TEST (CallgrindOutput, CalleeWithoutFileIsInInlinedFile)
+{
+    yocl::Profile const profile (Read ("events: Ir\n"
+                                       "fl=(1) mock.cpp\n"
+                                       "fn=(1) caller\n"
+                                       "1 1\n"
+                                       "fi=(2) mock.h\n"
+                                       "cfn=(2) callee\n"
+                                       "calls=1 5\n"
+                                       "2 10\n"
+                                       "fl=(2)\n"
+                                       "fn=(2)\n"
+                                       "5 10\n"));
+
+    ASSERT_EQ (2, profile.functions.size ());
+    EXPECT_EQ ("mock.h", Function (profile, "callee").file);
+    EXPECT_THAT (Function (profile, "caller").inclusive, ElementsAre (11));
+}
+
+TEST (CallgrindOutput, NoLineCostsWithoutLinePositions)
+{
+    yocl::Profile const profile (ReadLines ("positions: instr\n"
+                                            "events: Ir\n"
+                                            "fn=mock\n"
+                                            "0x4005d0 1\n"));
+
+    EXPECT_TRUE (profile.lines.empty ());
+}
+
+TEST (CallgrindOutput, NoLineCostsUnlessAskedFor)
+{
+    yocl::Profile const profile (Read (CallingProfile));
+
+    EXPECT_TRUE (profile.lines.empty ());
+    EXPECT_THAT (Function (profile, "callee").exclusive, ElementsAre (50, 5));
+}
+
+TEST (CallgrindOutput, LinesOfANamedAndCompressedFileAddedTogether)
+{
+    yocl::Profile const profile (ReadLines ("events: Ir\n"
+                                            "fl=mock.cpp\n"
+                                            "fn=mock\n"
+                                            "1 2\n"
+                                            "fl=(1) mock.cpp\n"
+                                            "fn=other\n"
+                                            "1 3\n"));
+
+    ASSERT_EQ (1, profile.lines.size ());
+    EXPECT_EQ ("mock.cpp", profile.lines[0].file);
+    EXPECT_THAT (profile.lines[0].exclusive, ElementsAre (5));
+}
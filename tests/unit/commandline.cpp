@@ -32,6 +32,10 @@ namespace
 {
     static std::string const MockWrapper ("mock");
     static std::string const MockOptions ("--mock");
+    static std::string const MockSecondOption ("--second");
+    static std::string const MockMultipleOptions (MockOptions +
+                                                  " " +
+                                                  MockSecondOption);
     static std::string const NilString ("");
     static std::vector <std::string> const NoOptions;
 
@@ -123,6 +127,63 @@ TEST_F (BuildCommandLine, ReturnWrapperAndOptions)
                  ElementsAreArray (matchers));
 }
 
+TEST_F (BuildCommandLine, SplitSpaceSeparatedOptionsIntoSeparateArguments)
+{
+    CommandLineArguments originalArgs (GenerateCommandLine (NoOptions));
+
+    ON_CALL (*instrumentation, InstrumentationWrapper ())
+        .WillByDefault (ReturnRef (MockWrapper));
+    ON_CALL (*instrumentation, WrapperOptions ())
+        .WillByDefault (ReturnRef (MockMultipleOptions));
+
+    auto args (ycom::BuildCommandLine (ytest::ArgumentCount (originalArgs),
+                                       ytest::Arguments (originalArgs),
+                                       *instrumentation));
+
+    Matcher <std::string> matchers[] =
+    {
+        StrEq (MockWrapper),
+        StrEq (MockOptions),
+        StrEq (MockSecondOption),
+        StrEq (ytest::MockProgramName)
+    };
+
+    EXPECT_THAT (args,
+                 ElementsAreArray (matchers));
+}
+
+TEST_F (BuildCommandLine, ForwardProgramArgumentsAfterProgramName)
+{
+    std::vector <std::string> const ProgramArguments =
+    {
+        MockItem1,
+        MockItem2
+    };
+
+    CommandLineArguments originalArgs (GenerateCommandLine (ProgramArguments));
+
+    ON_CALL (*instrumentation, InstrumentationWrapper ())
+        .WillByDefault (ReturnRef (MockWrapper));
+    ON_CALL (*instrumentation, WrapperOptions ())
+        .WillByDefault (ReturnRef (MockOptions));
+
+    auto args (ycom::BuildCommandLine (ytest::ArgumentCount (originalArgs),
+                                       ytest::Arguments (originalArgs),
+                                       *instrumentation));
+
+    Matcher <std::string> matchers[] =
+    {
+        StrEq (MockWrapper),
+        StrEq (MockOptions),
+        StrEq (ytest::MockProgramName),
+        StrEq (MockItem1),
+        StrEq (MockItem2)
+    };
+
+    EXPECT_THAT (args,
+                 ElementsAreArray (matchers));
+}
+
 namespace
 {
     ycom::CommandArguments const MockArgs =
@@ -17,6 +17,7 @@
 #include "test_util.h"
 
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::Matcher;
 using ::testing::NotNull;
@@ -189,6 +190,320 @@ TEST_F (ConstructionParameters, ParseOptionsForToolReturnsNoneIfNoOption)
     EXPECT_EQ (ExpectedTool, tool);
 }
 
+TEST_F (ConstructionParameters, ParseOptionsForToolsSplitsList)
+{
+    std::vector <std::string> const ToolArguments =
+    {
+        ArgYiqiToolOption,
+        "timer, perf,memcheck"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (ToolArguments));
+
+    auto tools (yc::ParseOptionsForTools (ArgumentCount (args),
+                                          Arguments (args),
+                                          desc));
+
+    EXPECT_THAT (tools, ElementsAre ("timer", "perf", "memcheck"));
+}
+
+TEST_F (ConstructionParameters, ParseOptionsForToolsDropsRepeats)
+{
+    std::vector <std::string> const ToolArguments =
+    {
+        ArgYiqiToolOption,
+        "timer,,memcheck,timer"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (ToolArguments));
+
+    auto tools (yc::ParseOptionsForTools (ArgumentCount (args),
+                                          Arguments (args),
+                                          desc));
+
+    EXPECT_THAT (tools, ElementsAre ("timer", "memcheck"));
+}
+
+TEST_F (ConstructionParameters, ParseOptionsForToolsReturnsNoneIfNoOption)
+{
+    CommandLineArguments args (GenerateCommandLine (NoArguments));
+
+    auto const toolId (yconst::InstrumentationTool::None);
+
+    auto tools (yc::ParseOptionsForTools (ArgumentCount (args),
+                                          Arguments (args),
+                                          desc));
+
+    EXPECT_THAT (tools, ElementsAre (yconst::StringFromTool (toolId)));
+}
+
+TEST_F (ConstructionParameters, ParseOptionsToToolUniquePtrsMakesEachTool)
+{
+    std::vector <std::string> const ToolArguments =
+    {
+        ArgYiqiToolOption,
+        "callgrind,timer"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (ToolArguments));
+
+    auto tools (yc::ParseOptionsToToolUniquePtrs (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    ASSERT_EQ (2, tools.size ());
+    EXPECT_EQ (yconst::InstrumentationTool::Callgrind,
+               tools[0]->ToolIdentifier ());
+    EXPECT_EQ (yconst::InstrumentationTool::Timer,
+               tools[1]->ToolIdentifier ());
+}
+
+TEST_F (ConstructionParameters, CallgrindFastOffByDefault)
+{
+    CommandLineArguments args (GenerateCommandLine (NoArguments));
+
+    auto options (yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    EXPECT_FALSE (options.callgrindFast);
+}
+
+TEST_F (ConstructionParameters, CallgrindFastOnIfOptionSpecified)
+{
+    std::vector <std::string> const FastArguments =
+    {
+        std::string ("--") + yconst::YiqiCallgrindFastOption
+    };
+
+    CommandLineArguments args (GenerateCommandLine (FastArguments));
+
+    auto options (yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    EXPECT_TRUE (options.callgrindFast);
+}
+
+TEST_F (ConstructionParameters, TimerIterationsFromOptions)
+{
+    std::vector <std::string> const TimerArguments =
+    {
+        std::string ("--") + yconst::YiqiTimerWarmupOption,
+        "3",
+        std::string ("--") + yconst::YiqiTimerIterationsOption,
+        "50"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (TimerArguments));
+
+    auto options (yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    EXPECT_EQ (3, options.timerWarmup);
+    EXPECT_EQ (50, options.timerIterations);
+}
+
+TEST_F (ConstructionParameters, ThrowOnZeroTimerIterations)
+{
+    std::vector <std::string> const TimerArguments =
+    {
+        std::string ("--") + yconst::YiqiTimerIterationsOption,
+        "0"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (TimerArguments));
+
+    EXPECT_THROW ({
+        yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                        Arguments (args),
+                                        desc);
+    }, std::runtime_error);
+}
+
+TEST_F (ConstructionParameters, HostCacheProfileByDefault)
+{
+    CommandLineArguments args (GenerateCommandLine (NoArguments));
+
+    auto options (yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    EXPECT_EQ ("host", options.cacheProfile);
+}
+
+TEST_F (ConstructionParameters, CacheProfileFromOptions)
+{
+    std::vector <std::string> const ProfileArguments =
+    {
+        std::string ("--") + yconst::YiqiCacheProfileOption,
+        "zen3"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (ProfileArguments));
+
+    auto options (yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    EXPECT_EQ ("zen3", options.cacheProfile);
+}
+
+TEST_F (ConstructionParameters, AnnotationDirectoryFromOptions)
+{
+    std::vector <std::string> const AnnotateArguments =
+    {
+        std::string ("--") + yconst::YiqiAnnotateOption,
+        "annotated"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (AnnotateArguments));
+
+    auto options (yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                                  Arguments (args),
+                                                  desc));
+
+    EXPECT_EQ ("annotated", options.annotationDirectory);
+}
+
+TEST_F (ConstructionParameters, ThrowOnUnknownCacheProfile)
+{
+    std::vector <std::string> const ProfileArguments =
+    {
+        std::string ("--") + yconst::YiqiCacheProfileOption,
+        "mock"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (ProfileArguments));
+
+    EXPECT_THROW ({
+        yc::ParseOptionsForToolOptions (ArgumentCount (args),
+                                        Arguments (args),
+                                        desc);
+    }, std::runtime_error);
+}
+
+TEST_F (ConstructionParameters, OneJobByDefault)
+{
+    CommandLineArguments args (GenerateCommandLine (NoArguments));
+
+    EXPECT_EQ (1, yc::ParseOptionsForJobs (ArgumentCount (args),
+                                           Arguments (args),
+                                           desc));
+}
+
+TEST_F (ConstructionParameters, JobsFromOptions)
+{
+    std::vector <std::string> const JobsArguments =
+    {
+        std::string ("--") + yconst::YiqiJobsOption,
+        "4"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (JobsArguments));
+
+    EXPECT_EQ (4, yc::ParseOptionsForJobs (ArgumentCount (args),
+                                           Arguments (args),
+                                           desc));
+}
+
+TEST_F (ConstructionParameters, AtLeastOneJobWhenZeroRequested)
+{
+    std::vector <std::string> const JobsArguments =
+    {
+        std::string ("--") + yconst::YiqiJobsOption,
+        "0"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (JobsArguments));
+
+    EXPECT_LE (1, yc::ParseOptionsForJobs (ArgumentCount (args),
+                                           Arguments (args),
+                                           desc));
+}
+
+TEST_F (ConstructionParameters, BaselineFromOptions)
+{
+    std::vector <std::string> const BaselineArguments =
+    {
+        std::string ("--") + yconst::YiqiBaselineOption,
+        "mock.baseline",
+        std::string ("--") + yconst::YiqiUpdateBaselineOption,
+        std::string ("--") + yconst::YiqiBaselineToleranceOption,
+        "0.1",
+        std::string ("--") + yconst::YiqiBaselineAbsoluteToleranceOption,
+        "5"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (BaselineArguments));
+
+    auto options (yc::ParseOptionsForBaseline (ArgumentCount (args),
+                                               Arguments (args),
+                                               desc));
+
+    EXPECT_EQ ("mock.baseline", options.file);
+    EXPECT_TRUE (options.update);
+    EXPECT_EQ (0.1, options.tolerance.relative);
+    EXPECT_EQ (5, options.tolerance.absolute);
+}
+
+TEST_F (ConstructionParameters, ThrowOnUpdatingWithoutBaseline)
+{
+    std::vector <std::string> const BaselineArguments =
+    {
+        std::string ("--") + yconst::YiqiUpdateBaselineOption
+    };
+
+    CommandLineArguments args (GenerateCommandLine (BaselineArguments));
+
+    EXPECT_THROW ({
+        yc::ParseOptionsForBaseline (ArgumentCount (args),
+                                     Arguments (args),
+                                     desc);
+    }, std::runtime_error);
+}
+
+TEST_F (ConstructionParameters, DifferenceFromOptions)
+{
+    std::vector <std::string> const DifferenceArguments =
+    {
+        std::string ("--") + yconst::YiqiDifferenceFromOption,
+        "before.results",
+        std::string ("--") + yconst::YiqiDifferenceToOption,
+        "after.results",
+        std::string ("--") + yconst::YiqiDifferenceFunctionsOption,
+        "3"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (DifferenceArguments));
+
+    auto options (yc::ParseOptionsForDifference (ArgumentCount (args),
+                                                 Arguments (args),
+                                                 desc));
+
+    EXPECT_EQ ("before.results", options.before);
+    EXPECT_EQ ("after.results", options.after);
+    EXPECT_EQ (3, options.functions);
+}
+
+TEST_F (ConstructionParameters, ThrowOnLaterRunWithoutEarlierRun)
+{
+    std::vector <std::string> const DifferenceArguments =
+    {
+        std::string ("--") + yconst::YiqiDifferenceToOption,
+        "after.results"
+    };
+
+    CommandLineArguments args (GenerateCommandLine (DifferenceArguments));
+
+    EXPECT_THROW ({
+        yc::ParseOptionsForDifference (ArgumentCount (args),
+                                       Arguments (args),
+                                       desc);
+    }, std::runtime_error);
+}
+
 class ConstructionParametersTable :
     public ConstructionParameters,
     public ::testing::WithParamInterface <yconst::InstrumentationToolName>
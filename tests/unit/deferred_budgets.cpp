@@ -0,0 +1,102 @@
+/*
+ * deferred_budgets.cpp:
+ * Tests for keeping budgets to check against what is read back
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "deferred_budgets.h"
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+namespace ybud = yiqi::budgets;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    ymeas::Results const MockResults =
+    {
+        { "Case.Test", "cachegrind", { "Ir", 100, "" } },
+        { "Case.Test", "cachegrind", { "Ir", 1000, "mock.cpp:mock" } },
+        { "Case.Other", "cachegrind", { "Ir", 5000, "" } }
+    };
+}
+
+TEST (DeferredBudgets, WrittenBudgetsReadBack)
+{
+    std::stringstream ss;
+
+    ybud::WriteBudget (ss, ybud::Budget { "Case.Test", "Ir", 1234567 });
+    ybud::WriteBudget (ss, ybud::Budget { "Case.Test", "D1.misses", 0.5 });
+
+    ybud::Budgets const budgets (ybud::ReadBudgets (ss));
+
+    ASSERT_EQ (2, budgets.size ());
+    EXPECT_EQ ("Case.Test", budgets[0].test);
+    EXPECT_EQ ("Ir", budgets[0].metric);
+    EXPECT_EQ (1234567, budgets[0].limit);
+    EXPECT_EQ ("D1.misses", budgets[1].metric);
+    EXPECT_EQ (0.5, budgets[1].limit);
+}
+
+TEST (DeferredBudgets, MalformedBudgetThrows)
+{
+    std::stringstream missing ("Case.Test\t100\n");
+    std::stringstream notNumber ("Case.Test\tIr\tmany\n");
+
+    EXPECT_THROW (ybud::ReadBudgets (missing), std::runtime_error);
+    EXPECT_THROW (ybud::ReadBudgets (notNumber), std::runtime_error);
+}
+
+TEST (DeferredBudgets, BudgetsFileNamedByProcess)
+{
+    EXPECT_EQ ("/tmp/mock/budgets.123", ybud::BudgetsFile ("/tmp/mock", 123));
+}
+
+TEST (DeferredBudgets, WithinBudgetPasses)
+{
+    ybud::Budgets const budgets = { { "Case.Test", "Ir", 100 } };
+
+    EXPECT_THAT (ybud::Check (budgets, MockResults), IsEmpty ());
+}
+
+TEST (DeferredBudgets, OverBudgetFailsItsTest)
+{
+    ybud::Budgets const budgets = { { "Case.Test", "Ir", 99 } };
+
+    ymeas::TestFailures const failures (ybud::Check (budgets, MockResults));
+
+    ASSERT_EQ (1, failures.size ());
+    EXPECT_EQ ("Case.Test", failures[0].test);
+    EXPECT_THAT (failures[0].description, HasSubstr ("Ir was 100"));
+}
+
+TEST (DeferredBudgets, OnlyTotalForItsTestCounts)
+{
+    ybud::Budgets const budgets =
+    {
+        { "Case.Test", "Ir", 500 },
+        { "Case.Other", "Ir", 10000 }
+    };
+
+    EXPECT_THAT (ybud::Check (budgets, MockResults), IsEmpty ());
+}
+
+TEST (DeferredBudgets, SkippedWhenNotMeasured)
+{
+    ybud::Budgets const budgets =
+    {
+        { "Case.Test", "D1.misses", 0 },
+        { "Case.Missing", "Ir", 0 }
+    };
+
+    EXPECT_THAT (ybud::Check (budgets, MockResults), IsEmpty ());
+}
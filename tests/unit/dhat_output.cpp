@@ -0,0 +1,194 @@
+/*
+ * dhat_output.cpp:
+ * Tests for reading back DHAT output files
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "dhat_output.h"
+#include "measurement.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yodh = yiqi::output::dhat;
+
+namespace
+{
+    /* One site in client code which allocates 4 blocks of 8 bytes
+     * and never touches the last 2 bytes of any of them, one in
+     * client code which allocates a single long lived block, and
+     * one in the test framework */
+    std::string const MockOutput (
+        "{\"dhatFileVersion\":2,\"mode\":\"heap\",\"verb\":\"Allocated\","
+        "\"bklt\":true,\"bkacc\":true,\"tu\":\"instrs\",\"Mtu\":\"instr\","
+        "\"tuth\":500,\"cmd\":\"./mock\",\"pid\":1234,\"te\":10000,"
+        "\"tg\":5000,"
+        "\"pps\":["
+        "{\"tb\":32,\"tbk\":4,\"tl\":400,\"mb\":16,\"mbk\":2,"
+        "\"gb\":8,\"gbk\":1,\"eb\":0,\"ebk\":0,\"rb\":64,\"wb\":32,"
+        "\"acc\":[-6,8,-2,0],\"fs\":[1,2,4]},"
+        "{\"tb\":1000,\"tbk\":1,\"tl\":9000,\"mb\":1000,\"mbk\":1,"
+        "\"gb\":1000,\"gbk\":1,\"eb\":1000,\"ebk\":1,\"rb\":500,"
+        "\"wb\":1000,\"fs\":[1,3,4]},"
+        "{\"tb\":5000,\"tbk\":1,\"tl\":100,\"mb\":5000,\"mbk\":1,"
+        "\"gb\":0,\"gbk\":0,\"eb\":0,\"ebk\":0,\"rb\":0,\"wb\":0,"
+        "\"fs\":[1,5]}"
+        "],"
+        "\"ftbl\":["
+        "\"[root]\","
+        "\"0x483577F: malloc (in /usr/lib/valgrind/vgpreload_dhat.so)\","
+        "\"0x109151: small (mock.cpp:5)\","
+        "\"0x109161: large (mock.cpp:10)\","
+        "\"0x109171: yiqi::ExecuteClientCode(std::function<void ()> const&) "
+        "(yiqi_main.cpp:120)\","
+        "\"0x109181: testing::Test::Run() (gtest.cc:2000)\""
+        "]}");
+
+    yodh::Profile MockProfile ()
+    {
+        std::stringstream output (MockOutput);
+        return yodh::ReadProfile (output);
+    }
+
+    double ValueOf (ymeas::Metrics const &metrics,
+                    std::string const    &name,
+                    std::string const    &function = std::string ())
+    {
+        for (ymeas::Metric const &metric : metrics)
+            if (metric.name == name && metric.function == function)
+                return metric.value;
+
+        throw std::logic_error ("no metric named " + name);
+    }
+}
+
+TEST (DhatOutput, ReadEachSite)
+{
+    yodh::Profile const profile (MockProfile ());
+
+    EXPECT_EQ (500, profile.shortLivedThreshold);
+    ASSERT_EQ (3, profile.sites.size ());
+
+    yodh::Site const &site (profile.sites[0]);
+
+    EXPECT_EQ (32, site.bytes);
+    EXPECT_EQ (4, site.blocks);
+    EXPECT_EQ (400, site.lifetimes);
+    EXPECT_EQ (64, site.reads);
+    EXPECT_EQ (32, site.writes);
+    EXPECT_THAT (site.frames,
+                 ::testing::ElementsAre (
+                     ::testing::HasSubstr ("malloc"),
+                     "0x109151: small (mock.cpp:5)",
+                     ::testing::HasSubstr ("yiqi::ExecuteClientCode")));
+}
+
+TEST (DhatOutput, UnusedBytesFromRunLengthEncodedAccesses)
+{
+    yodh::Profile const profile (MockProfile ());
+
+    /* Two offsets were never accessed, in each of four blocks */
+    EXPECT_EQ (8, profile.sites[0].unusedBytes);
+    EXPECT_GT (0, profile.sites[1].unusedBytes);
+}
+
+TEST (DhatOutput, ThrowOnMalformedOutput)
+{
+    std::stringstream output ("{\"pps\":[");
+
+    EXPECT_THROW ({
+        yodh::ReadProfile (output);
+    }, std::runtime_error);
+}
+
+TEST (DhatOutput, ThrowOnFrameOutOfRange)
+{
+    std::stringstream output ("{\"pps\":[{\"tb\":1,\"tbk\":1,\"fs\":[7]}],"
+                              "\"ftbl\":[\"[root]\"]}");
+
+    EXPECT_THROW ({
+        yodh::ReadProfile (output);
+    }, std::runtime_error);
+}
+
+TEST (DhatOutput, ThrowOnCopyProfile)
+{
+    std::stringstream output ("{\"mode\":\"copy\",\"pps\":[],\"ftbl\":[]}");
+
+    EXPECT_THROW ({
+        yodh::ReadProfile (output);
+    }, std::runtime_error);
+}
+
+TEST (DhatOutput, SiteNamedByFirstFrameOutsideAllocator)
+{
+    yodh::Profile const profile (MockProfile ());
+
+    EXPECT_EQ ("small (mock.cpp:5)", yodh::SiteName (profile.sites[0]));
+}
+
+TEST (DhatOutput, OnlyClientCodeSitesInTotals)
+{
+    ymeas::Metrics const metrics (yodh::ClientCodeMetrics (MockProfile (), 10));
+
+    EXPECT_EQ (1032, ValueOf (metrics, "bytes.allocated"));
+    EXPECT_EQ (5, ValueOf (metrics, "blocks.allocated"));
+    EXPECT_DOUBLE_EQ (564.0 / 1032, ValueOf (metrics, "reads.per.byte"));
+    EXPECT_DOUBLE_EQ (1032.0 / 1032, ValueOf (metrics, "writes.per.byte"));
+    EXPECT_EQ (8, ValueOf (metrics, "unused.bytes"));
+}
+
+TEST (DhatOutput, ShortLivedFractionOfBytes)
+{
+    ymeas::Metrics const metrics (yodh::ClientCodeMetrics (MockProfile (), 10));
+
+    /* The small blocks live for 100 instructions on average */
+    EXPECT_DOUBLE_EQ (32.0 / 1032, ValueOf (metrics, "short.lived.fraction"));
+}
+
+TEST (DhatOutput, EachSiteByBytesAllocated)
+{
+    ymeas::Metrics const metrics (yodh::ClientCodeMetrics (MockProfile (), 1));
+
+    EXPECT_EQ (1000, ValueOf (metrics, "bytes.allocated", "large (mock.cpp:10)"));
+    EXPECT_EQ (9000, ValueOf (metrics, "lifetime.mean", "large (mock.cpp:10)"));
+    EXPECT_EQ (0.5, ValueOf (metrics, "reads.per.byte", "large (mock.cpp:10)"));
+
+    /* Only the site which allocated the most */
+    EXPECT_THROW ({
+        ValueOf (metrics, "bytes.allocated", "small (mock.cpp:5)");
+    }, std::logic_error);
+}
+
+TEST (DhatOutput, SitesWithTheSameNameAddedTogether)
+{
+    yodh::Profile profile (MockProfile ());
+
+    /* Reached through a different caller, so it has a different
+     * stack, but is named the same as the small site */
+    yodh::Site other (profile.sites[0]);
+    other.frames.insert (other.frames.begin () + 2,
+                         "0x109191: caller (mock.cpp:20)");
+    profile.sites.push_back (other);
+
+    ymeas::Metrics const metrics (yodh::ClientCodeMetrics (profile, 10));
+
+    EXPECT_EQ (64, ValueOf (metrics, "bytes.allocated", "small (mock.cpp:5)"));
+    EXPECT_EQ (8, ValueOf (metrics, "blocks.allocated", "small (mock.cpp:5)"));
+    EXPECT_EQ (100, ValueOf (metrics, "lifetime.mean", "small (mock.cpp:5)"));
+    EXPECT_EQ (16, ValueOf (metrics, "unused.bytes", "small (mock.cpp:5)"));
+}
+
+TEST (DhatOutput, NothingIfClientCodeAllocatedNothing)
+{
+    yodh::Profile profile (MockProfile ());
+
+    /* Leaves only the site in the test framework */
+    profile.sites.erase (profile.sites.begin (), profile.sites.begin () + 2);
+
+    EXPECT_TRUE (yodh::ClientCodeMetrics (profile, 10).empty ());
+}
@@ -0,0 +1,208 @@
+/*
+ * difference.cpp:
+ * Tests for comparing what was measured in two runs
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include "constants.h"
+#include "difference.h"
+#include "measurement.h"
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+namespace yconst = yiqi::constants;
+namespace ydiff = yiqi::difference;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    ymeas::Result Whole (std::string const &test,
+                         std::string const &metric,
+                         double            value)
+    {
+        return ymeas::Result { test, "callgrind", { metric, value, "" } };
+    }
+
+    ymeas::Result InFunction (std::string const &function,
+                              std::string const &metric,
+                              double            value)
+    {
+        return ymeas::Result {
+            "Fixture.Test", "callgrind", { metric, value, function }
+        };
+    }
+
+    std::string Printed (ydiff::Changes const &changes,
+                         unsigned int         functions)
+    {
+        std::stringstream ss;
+        ydiff::PrintDifferences (ss, changes, functions);
+        return ss.str ();
+    }
+}
+
+TEST (Difference, CanonicalFunctionLeavesOutTemplateArguments)
+{
+    EXPECT_EQ ("a.cpp:std::vector<>::push_back(int const&)",
+               ydiff::CanonicalFunction (
+                   "a.cpp:std::vector<int, std::allocator<int> >"
+                   "::push_back(int const&)"));
+}
+
+TEST (Difference, CanonicalFunctionKeepsOperators)
+{
+    EXPECT_EQ ("a.cpp:operator<<(std::ostream&, Foo<> const&)",
+               ydiff::CanonicalFunction (
+                   "a.cpp:operator<<(std::ostream&, Foo<int> const&)"));
+    EXPECT_EQ ("a.cpp:Foo<>::operator->()",
+               ydiff::CanonicalFunction ("a.cpp:Foo<char>::operator->()"));
+}
+
+TEST (Difference, CanonicalFunctionLeavesOutClonesAndLambdaNumbers)
+{
+    EXPECT_EQ ("a.cpp:work(int)",
+               ydiff::CanonicalFunction ("a.cpp:work(int) [clone .isra.0]"));
+    EXPECT_EQ ("a.cpp:work",
+               ydiff::CanonicalFunction ("a.cpp:work.constprop.1"));
+    EXPECT_EQ ("a.cpp:main::{lambda()#}::operator()() const",
+               ydiff::CanonicalFunction (
+                   "a.cpp:main::{lambda()#2}::operator()() const"));
+}
+
+TEST (Difference, CanonicalFunctionLeavesFileAlone)
+{
+    EXPECT_EQ ("a.part.cpp:work",
+               ydiff::CanonicalFunction ("a.part.cpp:work"));
+}
+
+TEST (Difference, CompareFindsChangedMeasurements)
+{
+    ydiff::Changes const changes (
+        ydiff::Compare ({ Whole ("Fixture.Test", "Ir", 100),
+                          Whole ("Fixture.Test", "D1mr", 4) },
+                        { Whole ("Fixture.Test", "Ir", 120),
+                          Whole ("Fixture.Test", "D1mr", 4) }));
+
+    ASSERT_EQ (1, changes.size ());
+    EXPECT_EQ ("Fixture.Test", changes[0].test);
+    EXPECT_EQ ("callgrind", changes[0].tool);
+    EXPECT_EQ ("Ir", changes[0].metric);
+    EXPECT_EQ ("", changes[0].function);
+    EXPECT_EQ (100, changes[0].before);
+    EXPECT_EQ (120, changes[0].after);
+}
+
+TEST (Difference, CompareCancelsOutRenamedInstantiations)
+{
+    ydiff::Changes const changes (
+        ydiff::Compare ({ InFunction ("a.cpp:f<int>()", "Ir", 10),
+                          InFunction ("a.cpp:f<long>()", "Ir", 5) },
+                        { InFunction ("a.cpp:f<unsigned>()", "Ir", 15) }));
+
+    EXPECT_TRUE (changes.empty ());
+}
+
+TEST (Difference, CompareWorksOutRatesOfMergedFunctionsAgain)
+{
+    ymeas::Results const before =
+    {
+        InFunction ("a.cpp:f<int>()", "Dr", 10),
+        InFunction ("a.cpp:f<int>()", "Dw", 0),
+        InFunction ("a.cpp:f<int>()", "D1mr", 1),
+        InFunction ("a.cpp:f<int>()", "D1mw", 0),
+        InFunction ("a.cpp:f<int>()", "D1.miss.rate", 0.1),
+        InFunction ("a.cpp:f<long>()", "Dr", 10),
+        InFunction ("a.cpp:f<long>()", "Dw", 0),
+        InFunction ("a.cpp:f<long>()", "D1mr", 3),
+        InFunction ("a.cpp:f<long>()", "D1mw", 0),
+        InFunction ("a.cpp:f<long>()", "D1.miss.rate", 0.3)
+    };
+    ymeas::Results const after =
+    {
+        InFunction ("a.cpp:f<unsigned>()", "Dr", 20),
+        InFunction ("a.cpp:f<unsigned>()", "Dw", 0),
+        InFunction ("a.cpp:f<unsigned>()", "D1mr", 4),
+        InFunction ("a.cpp:f<unsigned>()", "D1mw", 0),
+        InFunction ("a.cpp:f<unsigned>()", "D1.miss.rate", 0.2)
+    };
+
+    EXPECT_TRUE (ydiff::Compare (before, after).empty ());
+}
+
+TEST (Difference, CompareLeavesOutTimingsOfSeveralRegions)
+{
+    ydiff::Changes const changes (
+        ydiff::Compare ({ Whole ("Fixture.Test", "median.ns", 10),
+                          Whole ("Fixture.Test", "median.ns", 20),
+                          Whole ("Fixture.Test", "Ir", 100) },
+                        { Whole ("Fixture.Test", "median.ns", 30),
+                          Whole ("Fixture.Test", "median.ns", 30),
+                          Whole ("Fixture.Test", "Ir", 100) }));
+
+    EXPECT_TRUE (changes.empty ());
+}
+
+TEST (Difference, CompareCountsMissingFunctionsAsZero)
+{
+    ydiff::Changes const changes (
+        ydiff::Compare ({ InFunction ("a.cpp:old", "Ir", 10) },
+                        { InFunction ("a.cpp:new", "Ir", 7) }));
+
+    ASSERT_EQ (2, changes.size ());
+    EXPECT_EQ ("a.cpp:new", changes[0].function);
+    EXPECT_EQ (0, changes[0].before);
+    EXPECT_EQ ("a.cpp:old", changes[1].function);
+    EXPECT_EQ (0, changes[1].after);
+}
+
+TEST (Difference, CompareLeavesOutTestsOnlyInOneRun)
+{
+    ydiff::Changes const changes (
+        ydiff::Compare ({ Whole ("Fixture.Old", "Ir", 10) },
+                        { Whole ("Fixture.New", "Ir", 20) }));
+
+    EXPECT_TRUE (changes.empty ());
+}
+
+TEST (Difference, PrintFunctionsWhichChangedMostEachWay)
+{
+    ydiff::Changes const changes (
+        ydiff::Compare ({ Whole ("Fixture.Test", "Ir", 100),
+                          InFunction ("a.cpp:slower", "Ir", 10),
+                          InFunction ("a.cpp:much_slower", "Ir", 10),
+                          InFunction ("a.cpp:faster", "Ir", 30),
+                          InFunction ("a.cpp:caller", "Ir.inclusive", 50) },
+                        { Whole ("Fixture.Test", "Ir", 150),
+                          InFunction ("a.cpp:slower", "Ir", 20),
+                          InFunction ("a.cpp:much_slower", "Ir", 60),
+                          InFunction ("a.cpp:faster", "Ir", 20),
+                          InFunction ("a.cpp:caller", "Ir.inclusive", 90) }));
+
+    std::string const printed (Printed (changes, 1));
+
+    EXPECT_THAT (printed,
+                 HasSubstr (std::string (yconst::YiqiDifferenceHeader) +
+                            "1 measurements changed"));
+    EXPECT_THAT (printed, HasSubstr ("+50.00%"));
+    EXPECT_THAT (printed, HasSubstr ("a.cpp:much_slower"));
+    EXPECT_THAT (printed, HasSubstr ("a.cpp:faster"));
+    EXPECT_THAT (printed, HasSubstr ("a.cpp:caller"));
+    EXPECT_THAT (printed, Not (HasSubstr ("a.cpp:slower")));
+
+    /* The regressed function comes before the improved one */
+    EXPECT_LT (printed.find ("a.cpp:much_slower"),
+               printed.find ("a.cpp:faster"));
+}
+
+TEST (Difference, PrintNothingChanged)
+{
+    EXPECT_EQ (std::string (yconst::YiqiDifferenceHeader) +
+               "0 measurements changed\n",
+               Printed (ydiff::Changes (), 5));
+}
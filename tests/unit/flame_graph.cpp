@@ -0,0 +1,151 @@
+/*
+ * flame_graph.cpp:
+ * Tests for folding callgrind profiles into stacks and drawing
+ * them as flame graphs
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include "callgrind_output.h"
+#include "flame_graph.h"
+
+using ::testing::DoubleEq;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::Pair;
+
+namespace yocl = yiqi::output::callgrind;
+namespace yofg = yiqi::output::flamegraph;
+
+namespace
+{
+    yocl::Profile Read (std::string const &profile)
+    {
+        return yocl::ReadProfile (profile.data (), profile.size ());
+    }
+
+    /* main calls work, which calls helper, and also calls
+     * helper itself */
+    std::string const SharedCalleeProfile ("events: Ir\n"
+                                           "fl=mock.cpp\n"
+                                           "fn=main\n"
+                                           "1 10\n"
+                                           "cfn=work\n"
+                                           "calls=1 1\n"
+                                           "2 70\n"
+                                           "cfn=helper\n"
+                                           "calls=1 1\n"
+                                           "3 20\n"
+                                           "fn=work\n"
+                                           "1 30\n"
+                                           "cfn=helper\n"
+                                           "calls=1 1\n"
+                                           "2 40\n"
+                                           "fn=helper\n"
+                                           "1 60\n");
+}
+
+TEST (FlameGraph, FoldStacksFromOutermostFunction)
+{
+    yofg::FoldedStacks const stacks (
+        yofg::FoldStacks (Read (SharedCalleeProfile), 0));
+
+    EXPECT_THAT (stacks,
+                 ElementsAre (Pair ("main", DoubleEq (10)),
+                              Pair ("main;helper", DoubleEq (20)),
+                              Pair ("main;work", DoubleEq (30)),
+                              Pair ("main;work;helper", DoubleEq (40))));
+}
+
+TEST (FlameGraph, FoldRecursiveCallsIntoSingleFrame)
+{
+    yofg::FoldedStacks const stacks (
+        yofg::FoldStacks (Read ("events: Ir\n"
+                                "fl=mock.cpp\n"
+                                "fn=main\n"
+                                "1 1\n"
+                                "cfn=a\n"
+                                "calls=1 1\n"
+                                "2 10\n"
+                                "fn=a\n"
+                                "1 4\n"
+                                "cfn=b\n"
+                                "calls=1 1\n"
+                                "2 6\n"
+                                "fn=b\n"
+                                "1 3\n"
+                                "cfn=a\n"
+                                "calls=1 1\n"
+                                "2 3\n"),
+                          0));
+
+    EXPECT_THAT (stacks,
+                 ElementsAre (Pair ("main", DoubleEq (1)),
+                              Pair ("main;a", DoubleEq (4)),
+                              Pair ("main;a;b", DoubleEq (3)),
+                              Pair ("main;a;b;a", DoubleEq (3))));
+}
+
+TEST (FlameGraph, FoldUnknownEventIsEmpty)
+{
+    EXPECT_TRUE (yofg::FoldStacks (Read (SharedCalleeProfile), 1).empty ());
+}
+
+TEST (FlameGraph, MergeStacksAddsCosts)
+{
+    yofg::FoldedStacks stacks { { "main", 1 }, { "main;work", 2 } };
+
+    yofg::MergeStacks (stacks, { { "main;work", 3 }, { "other", 4 } });
+
+    EXPECT_THAT (stacks,
+                 ElementsAre (Pair ("main", 1),
+                              Pair ("main;work", 5),
+                              Pair ("other", 4)));
+}
+
+TEST (FlameGraph, WriteFoldedStacksRoundsAndLeavesOutNothing)
+{
+    std::stringstream output;
+
+    yofg::WriteFoldedStacks (output,
+                             { { "main", 1.6 }, { "main;idle", 0.4 } });
+
+    EXPECT_EQ ("main 2\n", output.str ());
+}
+
+TEST (FlameGraph, WriteFlameGraphDrawsEachFrame)
+{
+    std::stringstream output;
+
+    yofg::WriteFlameGraph (output,
+                           yofg::FoldStacks (Read (SharedCalleeProfile), 0),
+                           "Fixture.Test",
+                           "Ir");
+
+    std::string const svg (output.str ());
+
+    EXPECT_THAT (svg, HasSubstr ("<svg"));
+    EXPECT_THAT (svg, HasSubstr (">Fixture.Test</text>"));
+    EXPECT_THAT (svg, HasSubstr ("<title>all (100 Ir, 100.00%)</title>"));
+    EXPECT_THAT (svg, HasSubstr ("<title>work (70 Ir, 70.00%)</title>"));
+    EXPECT_THAT (svg, HasSubstr ("</svg>"));
+}
+
+TEST (FlameGraph, WriteFlameGraphEscapesNames)
+{
+    std::stringstream output;
+
+    yofg::WriteFlameGraph (output,
+                           { { "std::vector<int>::push_back", 1 } },
+                           "A & B",
+                           "Ir");
+
+    EXPECT_THAT (output.str (), HasSubstr ("std::vector&lt;int&gt;"));
+    EXPECT_THAT (output.str (), HasSubstr ("A &amp; B"));
+    EXPECT_THAT (output.str (), Not (HasSubstr ("<int>")));
+}
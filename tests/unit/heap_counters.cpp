@@ -0,0 +1,146 @@
+/*
+ * heap_counters.cpp:
+ * Tests for counting heap allocations in-process
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "heap_counters.h"
+#include "measurement.h"
+
+namespace yheap = yiqi::heap;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    double ValueOf (ymeas::Metrics const &metrics,
+                    std::string const    &name)
+    {
+        for (ymeas::Metric const &metric : metrics)
+            if (metric.name == name && metric.function.empty ())
+                return metric.value;
+
+        throw std::logic_error ("no metric named " + name);
+    }
+}
+
+class HeapCounters :
+    public ::testing::Test
+{
+    public:
+
+        HeapCounters ()
+        {
+            yheap::StartCounting ();
+        }
+
+        ~HeapCounters ()
+        {
+            yheap::StopCounting ();
+        }
+};
+
+TEST_F (HeapCounters, CountingUntilStopped)
+{
+    EXPECT_TRUE (yheap::Counting ());
+    yheap::StopCounting ();
+    EXPECT_FALSE (yheap::Counting ());
+}
+
+TEST_F (HeapCounters, StartingResetsCounts)
+{
+    yheap::RecordAllocation (8, 16);
+    yheap::RecordFree (16);
+    yheap::StartCounting ();
+
+    EXPECT_EQ (0, yheap::ThreadCounts ().allocations);
+    EXPECT_EQ (0, yheap::ThreadCounts ().frees);
+    EXPECT_EQ (0, yheap::ThreadCounts ().peakLiveBytes);
+}
+
+TEST_F (HeapCounters, UsableBytesAllocatedAndFreed)
+{
+    yheap::RecordAllocation (10, 24);
+    yheap::RecordAllocation (100, 104);
+    yheap::RecordFree (24);
+
+    yheap::Counts const &counts (yheap::ThreadCounts ());
+
+    EXPECT_EQ (2, counts.allocations);
+    EXPECT_EQ (1, counts.frees);
+    EXPECT_EQ (128, counts.bytesAllocated);
+    EXPECT_EQ (24, counts.bytesFreed);
+    EXPECT_EQ (104, counts.liveBytes);
+}
+
+TEST_F (HeapCounters, PeakLiveBytesKeptAfterFree)
+{
+    yheap::RecordAllocation (100, 100);
+    yheap::RecordAllocation (50, 50);
+    yheap::RecordFree (100);
+    yheap::RecordAllocation (20, 20);
+
+    EXPECT_EQ (150, yheap::ThreadCounts ().peakLiveBytes);
+}
+
+TEST_F (HeapCounters, FreeingEarlierBlocksNeverRaisesPeak)
+{
+    yheap::RecordFree (100);
+    yheap::RecordAllocation (50, 50);
+
+    EXPECT_EQ (-50, yheap::ThreadCounts ().liveBytes);
+    EXPECT_EQ (0, yheap::ThreadCounts ().peakLiveBytes);
+}
+
+TEST_F (HeapCounters, AllocationsSortedIntoSizeClasses)
+{
+    yheap::RecordAllocation (16, 24);
+    yheap::RecordAllocation (17, 24);
+    yheap::RecordAllocation (1 << 20, 1 << 20);
+
+    yheap::Counts const &counts (yheap::ThreadCounts ());
+
+    EXPECT_EQ (1, counts.sizeClasses[0]);
+    EXPECT_EQ (1, counts.sizeClasses[1]);
+    EXPECT_EQ (1, counts.sizeClasses.back ());
+}
+
+TEST_F (HeapCounters, MetricsForTotals)
+{
+    yheap::RecordAllocation (10, 16);
+    yheap::RecordAllocation (20, 24);
+    yheap::RecordFree (16);
+
+    ymeas::Metrics const metrics (
+        yheap::CountMetrics (yheap::ThreadCounts ()));
+
+    EXPECT_EQ (2, ValueOf (metrics, "heap.allocations"));
+    EXPECT_EQ (1, ValueOf (metrics, "heap.frees"));
+    EXPECT_EQ (40, ValueOf (metrics, "heap.bytes.allocated"));
+    EXPECT_EQ (16, ValueOf (metrics, "heap.bytes.freed"));
+    EXPECT_EQ (40, ValueOf (metrics, "heap.peak.live.bytes"));
+}
+
+TEST_F (HeapCounters, MetricsOnlyForUsedSizeClasses)
+{
+    yheap::RecordAllocation (10, 16);
+    yheap::RecordAllocation (1 << 20, 1 << 20);
+
+    ymeas::Metrics const metrics (
+        yheap::CountMetrics (yheap::ThreadCounts ()));
+
+    EXPECT_EQ (7, metrics.size ());
+    EXPECT_EQ (1, ValueOf (metrics, "heap.allocations.size.le.16"));
+    EXPECT_EQ (1, ValueOf (metrics, "heap.allocations.size.gt.65536"));
+}
+
+TEST (HeapAllocationFunctions, NotInterceptedWithoutReplacements)
+{
+    /* The replacements are only in the yiqi main library, which
+     * these tests are not linked against */
+    EXPECT_FALSE (yheap::AllocationsIntercepted ());
+}
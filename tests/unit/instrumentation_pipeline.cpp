@@ -0,0 +1,268 @@
+/*
+ * instrumentation_pipeline.cpp:
+ * Test that client code is measured the same way by each tool,
+ * whichever other tools run with it
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "constants.h"
+#include "instrumentation_pipeline.h"
+#include "instrumentation_tool.h"
+#include "measurement.h"
+
+#include "instrumentation_mock.h"
+
+using ::testing::Expectation;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+namespace yconst = yiqi::constants;
+namespace yit = yiqi::instrumentation::tools;
+namespace ymeas = yiqi::measurement;
+namespace ymock = yiqi::mock;
+namespace ymockit = ymock::instrumentation::tools;
+
+class RunClientCodeUnderEach :
+    public ::testing::Test
+{
+    public:
+
+        /* Client code makes more events the first time it runs,
+         * as lazy initialisation would */
+        RunClientCodeUnderEach () :
+            events (0),
+            firstRun (true),
+            code ([this]() {
+                      events += firstRun ? 2 : 1;
+                      firstRun = false;
+                  })
+        {
+        }
+
+    protected:
+
+        /* Counts the events made between starting and stopping it,
+         * and makes overhead events itself on each of those */
+        ymockit::Tool & AddCountingTool (yconst::InstrumentationTool id,
+                                         unsigned int                overhead);
+
+        /* Runs the client code iterations times itself */
+        ymockit::Tool & AddTimer (unsigned int iterations);
+
+        /* What each tool counted, once the client code has been
+         * run under all of them */
+        std::vector <double> RunAndCount ();
+
+        /* Starts again with a fresh program and no tools */
+        void Restart ();
+
+        struct Count
+        {
+            unsigned int start;
+            unsigned int stop;
+        };
+
+        unsigned int                    events;
+        bool                            firstRun;
+        yit::Tool::ClientCode const     code;
+        std::vector <yit::Tool::Unique> tools;
+        std::list <Count>               counts;
+};
+
+ymockit::Tool &
+RunClientCodeUnderEach::AddCountingTool (yconst::InstrumentationTool id,
+                                         unsigned int                overhead)
+{
+    ymockit::Tool *tool (new ymockit::Tool ());
+    tools.push_back (yit::Tool::Unique (tool));
+    counts.push_back (Count ());
+
+    Count &count (counts.back ());
+
+    tool->IgnoreCalls ();
+    ON_CALL (*tool, ToolIdentifier ()).WillByDefault (Return (id));
+    ON_CALL (*tool, StartClientRegion ())
+        .WillByDefault (Invoke ([this, &count, overhead]() {
+                                    events += overhead;
+                                    count.start = events;
+                                }));
+    ON_CALL (*tool, StopClientRegion ())
+        .WillByDefault (Invoke ([this, &count, overhead]() {
+                                    count.stop = events;
+                                    events += overhead;
+                                }));
+    ON_CALL (*tool, ClientRegionResult ())
+        .WillByDefault (Invoke ([&count]() {
+                                    ymeas::RegionResult result;
+                                    result.metrics.push_back ({
+                                        "events",
+                                        double (count.stop - count.start),
+                                        ""
+                                    });
+                                    return result;
+                                }));
+
+    return *tool;
+}
+
+ymockit::Tool &
+RunClientCodeUnderEach::AddTimer (unsigned int iterations)
+{
+    ymockit::Tool *tool (new ymockit::Tool ());
+    tools.push_back (yit::Tool::Unique (tool));
+
+    tool->IgnoreCalls ();
+    ON_CALL (*tool, ToolIdentifier ())
+        .WillByDefault (Return (yconst::InstrumentationTool::Timer));
+    ON_CALL (*tool, RepeatsClientCode ()).WillByDefault (Return (true));
+    ON_CALL (*tool, RunClientCode (::testing::_))
+        .WillByDefault (Invoke ([iterations](yit::Tool::ClientCode const &c) {
+                                    for (unsigned int i = 0;
+                                         i < iterations;
+                                         ++i)
+                                        c ();
+
+                                    ymeas::RegionResult result;
+                                    result.metrics.push_back ({
+                                        "iterations",
+                                        double (iterations),
+                                        ""
+                                    });
+                                    return result;
+                                }));
+
+    return *tool;
+}
+
+std::vector <double>
+RunClientCodeUnderEach::RunAndCount ()
+{
+    std::vector <ymeas::RegionResult> const results (
+        yit::RunClientCodeUnderEach (tools, code));
+
+    std::vector <double> counted;
+
+    for (ymeas::RegionResult const &result : results)
+    {
+        EXPECT_EQ (1, result.metrics.size ());
+
+        if (!result.metrics.empty ())
+            counted.push_back (result.metrics.front ().value);
+    }
+
+    return counted;
+}
+
+void
+RunClientCodeUnderEach::Restart ()
+{
+    tools.clear ();
+    counts.clear ();
+    events = 0;
+    firstRun = true;
+}
+
+TEST_F (RunClientCodeUnderEach, HeapAndPerfCountTheSameAloneAndWithOthers)
+{
+    AddCountingTool (yconst::InstrumentationTool::Heap, 0);
+    std::vector <double> const heapAlone (RunAndCount ());
+
+    Restart ();
+    AddCountingTool (yconst::InstrumentationTool::Perf, 0);
+    std::vector <double> const perfAlone (RunAndCount ());
+
+    /* As in --yiqi_tool timer,heap,rusage,perf, where rusage makes
+     * events of its own to start and stop */
+    Restart ();
+    AddTimer (5);
+    AddCountingTool (yconst::InstrumentationTool::Heap, 0);
+    AddCountingTool (yconst::InstrumentationTool::Rusage, 3);
+    AddCountingTool (yconst::InstrumentationTool::Perf, 0);
+    std::vector <double> const together (RunAndCount ());
+
+    ASSERT_EQ (1, heapAlone.size ());
+    ASSERT_EQ (1, perfAlone.size ());
+    ASSERT_EQ (4, together.size ());
+
+    EXPECT_EQ (2, heapAlone[0]);
+    EXPECT_EQ (heapAlone[0], together[1]);
+    EXPECT_EQ (perfAlone[0], together[3]);
+    EXPECT_EQ (5, together[0]);
+}
+
+TEST_F (RunClientCodeUnderEach, ClientCodeRunsOnceForAllCountingTools)
+{
+    AddCountingTool (yconst::InstrumentationTool::Heap, 0);
+    AddCountingTool (yconst::InstrumentationTool::Perf, 0);
+    AddCountingTool (yconst::InstrumentationTool::Rusage, 0);
+
+    std::vector <double> const counted (RunAndCount ());
+
+    EXPECT_EQ (2, events);
+    EXPECT_EQ (std::vector <double> ({ 2, 2, 2 }), counted);
+}
+
+TEST_F (RunClientCodeUnderEach, RusageOutermostAndHeapInnermost)
+{
+    ymockit::Tool &heap (AddCountingTool (yconst::InstrumentationTool::Heap,
+                                          0));
+    ymockit::Tool &perf (AddCountingTool (yconst::InstrumentationTool::Perf,
+                                          0));
+    ymockit::Tool &rusage (AddCountingTool (yconst::InstrumentationTool::Rusage,
+                                            0));
+
+    {
+        InSequence nested;
+
+        EXPECT_CALL (rusage, StartClientRegion ());
+        EXPECT_CALL (perf, StartClientRegion ());
+        EXPECT_CALL (heap, StartClientRegion ());
+        EXPECT_CALL (heap, StopClientRegion ());
+        EXPECT_CALL (perf, StopClientRegion ());
+        EXPECT_CALL (rusage, StopClientRegion ());
+    }
+
+    RunAndCount ();
+}
+
+TEST_F (RunClientCodeUnderEach, TimerRepeatsAfterCountingToolsStop)
+{
+    ymockit::Tool &timer (AddTimer (3));
+    ymockit::Tool &heap (AddCountingTool (yconst::InstrumentationTool::Heap,
+                                          0));
+
+    Expectation stop (EXPECT_CALL (heap, StopClientRegion ()));
+    EXPECT_CALL (heap, ClientRegionResult ()).After (stop);
+    EXPECT_CALL (timer, RunClientCode (::testing::_)).After (stop);
+    EXPECT_CALL (timer, StartClientRegion ()).Times (0);
+
+    RunAndCount ();
+
+    EXPECT_EQ (5, events);
+}
+
+TEST_F (RunClientCodeUnderEach, ToolsStoppedWhenClientCodeThrows)
+{
+    ymockit::Tool &heap (AddCountingTool (yconst::InstrumentationTool::Heap,
+                                          0));
+    ymockit::Tool &perf (AddCountingTool (yconst::InstrumentationTool::Perf,
+                                          0));
+
+    EXPECT_CALL (heap, StopClientRegion ());
+    EXPECT_CALL (perf, StopClientRegion ());
+
+    yit::Tool::ClientCode const throws ([]() {
+                                            throw std::runtime_error ("");
+                                        });
+
+    EXPECT_THROW (yit::RunClientCodeUnderEach (tools, throws),
+                  std::runtime_error);
+}
@@ -0,0 +1,148 @@
+/*
+ * massif_output.cpp:
+ * Tests for reading back massif output files
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "massif_output.h"
+#include "measurement.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yoms = yiqi::output::massif;
+
+namespace
+{
+    std::string const MockOutput (
+        "desc: --stacks=yes\n"
+        "cmd: ./mock\n"
+        "time_unit: i\n"
+        "#-----------\n"
+        "snapshot=0\n"
+        "#-----------\n"
+        "time=0\n"
+        "mem_heap_B=0\n"
+        "mem_heap_extra_B=0\n"
+        "mem_stacks_B=400\n"
+        "heap_tree=empty\n"
+        "#-----------\n"
+        "snapshot=1\n"
+        "#-----------\n"
+        "time=1000\n"
+        "mem_heap_B=1000\n"
+        "mem_heap_extra_B=24\n"
+        "mem_stacks_B=200\n"
+        "heap_tree=peak\n"
+        "n3: 1000 (heap allocation functions) malloc/new/new[], --alloc-fns, etc.\n"
+        " n1: 300 0x4005B4: small (mock.cpp:5)\n"
+        "  n0: 300 0x4005D0: main (mock.cpp:20)\n"
+        " n1: 600 0x4005C4: large (mock.cpp:10)\n"
+        "  n0: 600 0x4005D0: main (mock.cpp:20)\n"
+        " n0: 100 in 2 places, all below massif's threshold (1.00%)\n"
+        "#-----------\n"
+        "snapshot=2\n"
+        "#-----------\n"
+        "time=2000\n"
+        "mem_heap_B=500\n"
+        "mem_heap_extra_B=8\n"
+        "mem_stacks_B=100\n"
+        "heap_tree=empty\n");
+
+    double ValueOf (ymeas::Metrics const &metrics,
+                    std::string const    &name,
+                    std::string const    &function = std::string ())
+    {
+        for (ymeas::Metric const &metric : metrics)
+            if (metric.name == name && metric.function == function)
+                return metric.value;
+
+        throw std::logic_error ("no metric named " + name);
+    }
+}
+
+TEST (MassifOutput, ReadEachSnapshot)
+{
+    std::stringstream output (MockOutput);
+    yoms::Snapshots const snapshots (yoms::ReadSnapshots (output));
+
+    ASSERT_EQ (3, snapshots.size ());
+    EXPECT_EQ (1000, snapshots[1].heap);
+    EXPECT_EQ (24, snapshots[1].heapExtra);
+    EXPECT_EQ (200, snapshots[1].stacks);
+    EXPECT_TRUE (snapshots[1].peak);
+    EXPECT_FALSE (snapshots[2].peak);
+}
+
+TEST (MassifOutput, OnlyTreesUnderRootWithFunctionsKept)
+{
+    std::stringstream output (MockOutput);
+    yoms::Snapshots const snapshots (yoms::ReadSnapshots (output));
+
+    ASSERT_EQ (2, snapshots[1].allocations.size ());
+    EXPECT_EQ ("small (mock.cpp:5)", snapshots[1].allocations[0].function);
+    EXPECT_EQ (300, snapshots[1].allocations[0].bytes);
+    EXPECT_EQ ("large (mock.cpp:10)", snapshots[1].allocations[1].function);
+}
+
+TEST (MassifOutput, ThrowOnMalformedHeap)
+{
+    std::stringstream output ("snapshot=0\nmem_heap_B=lots\n");
+
+    EXPECT_THROW ({
+        yoms::ReadSnapshots (output);
+    }, std::runtime_error);
+}
+
+TEST (MassifOutput, PeakFromMarkedSnapshot)
+{
+    std::stringstream output (MockOutput);
+    ymeas::Metrics const metrics (
+        yoms::PeakMetrics (yoms::ReadSnapshots (output), 10));
+
+    EXPECT_EQ (1000, ValueOf (metrics, "heap.peak.bytes"));
+    EXPECT_EQ (24, ValueOf (metrics, "heap.peak.extra.bytes"));
+}
+
+TEST (MassifOutput, StacksPeakOverAllSnapshots)
+{
+    std::stringstream output (MockOutput);
+    ymeas::Metrics const metrics (
+        yoms::PeakMetrics (yoms::ReadSnapshots (output), 10));
+
+    EXPECT_EQ (400, ValueOf (metrics, "stacks.peak.bytes"));
+}
+
+TEST (MassifOutput, PeakIsMostHeapIfNoneMarked)
+{
+    yoms::Snapshots const snapshots =
+    {
+        { 100, 8, 0, false, yoms::Allocations () },
+        { 300, 8, 0, false, yoms::Allocations () },
+        { 200, 8, 0, false, yoms::Allocations () }
+    };
+
+    EXPECT_EQ (300, ValueOf (yoms::PeakMetrics (snapshots, 10),
+                             "heap.peak.bytes"));
+}
+
+TEST (MassifOutput, LargestAllocationsFirstUpToLimit)
+{
+    std::stringstream output (MockOutput);
+    ymeas::Metrics const metrics (
+        yoms::PeakMetrics (yoms::ReadSnapshots (output), 1));
+
+    ASSERT_EQ (4, metrics.size ());
+    EXPECT_EQ ("large (mock.cpp:10)", metrics[3].function);
+    EXPECT_EQ ("heap.peak.bytes", metrics[3].name);
+    EXPECT_EQ (600, metrics[3].value);
+}
+
+TEST (MassifOutput, NothingWithoutSnapshots)
+{
+    EXPECT_TRUE (yoms::PeakMetrics (yoms::Snapshots (), 10).empty ());
+}
@@ -0,0 +1,89 @@
+/*
+ * measurement.cpp:
+ * Tests for printing, writing and reading back measurements
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "constants.h"
+#include "measurement.h"
+
+namespace yconst = yiqi::constants;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    std::string const MockTest ("MockCase.MockTest");
+    std::string const MockTool ("mocktool");
+
+    ymeas::Metrics const MockMetrics =
+    {
+        { "Ir", 1234567, "" },
+        { "Ir", 42, "mock.cpp:mock (int, char)" }
+    };
+}
+
+TEST (Measurement, PrintOnlyMetricsForAllClientCode)
+{
+    std::stringstream ss;
+    ymeas::PrintMetrics (ss, MockTest, MockTool, MockMetrics);
+
+    EXPECT_EQ (std::string (yconst::YiqiMeasuredHeader) +
+               "MockCase.MockTest mocktool Ir 1234567\n",
+               ss.str ());
+}
+
+TEST (Measurement, WriteResultsTabSeparated)
+{
+    std::stringstream ss;
+    ymeas::WriteResults (ss, MockTest, MockTool, MockMetrics);
+
+    EXPECT_EQ ("MockCase.MockTest\tmocktool\t\tIr\t1234567\n"
+               "MockCase.MockTest\tmocktool\tmock.cpp:mock (int, char)\tIr\t42\n",
+               ss.str ());
+}
+
+TEST (Measurement, ReadBackWrittenResults)
+{
+    std::stringstream ss;
+    ymeas::WriteResults (ss, MockTest, MockTool, MockMetrics);
+
+    ymeas::Results const results (ymeas::ReadResults (ss));
+
+    ASSERT_EQ (2, results.size ());
+    EXPECT_EQ (MockTest, results[1].test);
+    EXPECT_EQ (MockTool, results[1].tool);
+    EXPECT_EQ (MockMetrics[1].function, results[1].metric.function);
+    EXPECT_EQ (MockMetrics[1].name, results[1].metric.name);
+    EXPECT_EQ (MockMetrics[1].value, results[1].metric.value);
+}
+
+TEST (Measurement, ReadResultsSkipsCommentsAndEmptyLines)
+{
+    std::stringstream ss ("# comment\n\nMock.Test\ttool\t\tIr\t1\n");
+
+    EXPECT_EQ (1, ymeas::ReadResults (ss).size ());
+}
+
+TEST (Measurement, ReadResultsThrowsOnMissingFields)
+{
+    std::stringstream ss ("Mock.Test\ttool\tIr\t1\n");
+
+    EXPECT_THROW ({
+        ymeas::ReadResults (ss);
+    }, std::runtime_error);
+}
+
+TEST (Measurement, ReadResultsThrowsOnBadValue)
+{
+    std::stringstream ss ("Mock.Test\ttool\t\tIr\tmany\n");
+
+    EXPECT_THROW ({
+        ymeas::ReadResults (ss);
+    }, std::runtime_error);
+}
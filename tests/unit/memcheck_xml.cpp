@@ -0,0 +1,162 @@
+/*
+ * memcheck_xml.cpp:
+ * Tests for reading memcheck's XML output as it streams in
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include "constants.h"
+#include "memcheck_xml.h"
+
+namespace yconst = yiqi::constants;
+namespace yomc = yiqi::output::memcheck;
+
+namespace
+{
+    std::string MockOutput ()
+    {
+        std::string const marker (yconst::YiqiTestStartedMarker);
+
+        return
+            "<?xml version=\"1.0\"?>\n"
+            "<valgrindoutput>\n"
+            "<protocolversion>4</protocolversion>\n"
+            "<clientmsg><tid>1</tid><text>" + marker +
+            "MockCase.MockTest\n</text></clientmsg>\n"
+            "<error>\n"
+            "  <unique>0x0</unique>\n"
+            "  <kind>InvalidRead</kind>\n"
+            "  <what>Invalid read of size 4</what>\n"
+            "  <stack>\n"
+            "    <frame><ip>0x1</ip><obj>/mock</obj>"
+            "<fn>mock(int)</fn><dir>/src</dir>"
+            "<file>mock.cpp</file><line>42</line></frame>\n"
+            "    <frame><ip>0x2</ip><obj>/mock</obj></frame>\n"
+            "  </stack>\n"
+            "  <auxwhat>Address 0x0 is not stack'd</auxwhat>\n"
+            "  <stack>\n"
+            "    <frame><ip>0x3</ip><fn>malloc</fn></frame>\n"
+            "  </stack>\n"
+            "</error>\n"
+            "<clientmsg><tid>1</tid><text>" + marker +
+            "MockCase.OtherTest\n</text></clientmsg>\n"
+            "<error>\n"
+            "  <kind>Leak_DefinitelyLost</kind>\n"
+            "  <xwhat><text>8 bytes in 1 blocks are definitely lost"
+            "</text><leakedbytes>8</leakedbytes>"
+            "<leakedblocks>1</leakedblocks></xwhat>\n"
+            "  <stack><frame><fn>operator new(unsigned long)</fn>"
+            "</frame></stack>\n"
+            "</error>\n"
+            "</valgrindoutput>\n";
+    }
+
+    typedef std::vector <yomc::Error> Errors;
+
+    Errors ReadInPiecesOf (std::string const &output, size_t piece)
+    {
+        Errors             errors;
+        yomc::StreamReader reader ([&errors](yomc::Error const &error) {
+                                       errors.push_back (error);
+                                   });
+
+        for (size_t i = 0; i < output.size (); i += piece)
+            reader.Feed (output.data () + i,
+                         std::min (piece, output.size () - i));
+
+        return errors;
+    }
+}
+
+TEST (MemcheckXML, ErrorsTracedToTestsStarted)
+{
+    Errors const errors (ReadInPiecesOf (MockOutput (), MockOutput ().size ()));
+
+    ASSERT_EQ (2, errors.size ());
+    EXPECT_EQ ("MockCase.MockTest", errors[0].test);
+    EXPECT_EQ ("MockCase.OtherTest", errors[1].test);
+}
+
+TEST (MemcheckXML, ReadErrorKindAndWhat)
+{
+    Errors const errors (ReadInPiecesOf (MockOutput (), MockOutput ().size ()));
+
+    ASSERT_EQ (2, errors.size ());
+    EXPECT_EQ ("InvalidRead", errors[0].kind);
+    EXPECT_EQ ("Invalid read of size 4", errors[0].what);
+    EXPECT_EQ (0, errors[0].leakedBytes);
+}
+
+TEST (MemcheckXML, ReadLeakWhatAndBytes)
+{
+    Errors const errors (ReadInPiecesOf (MockOutput (), MockOutput ().size ()));
+
+    ASSERT_EQ (2, errors.size ());
+    EXPECT_EQ ("Leak_DefinitelyLost", errors[1].kind);
+    EXPECT_EQ ("8 bytes in 1 blocks are definitely lost", errors[1].what);
+    EXPECT_EQ (8, errors[1].leakedBytes);
+}
+
+TEST (MemcheckXML, OnlyFirstStackIsWhereErrorHappened)
+{
+    Errors const errors (ReadInPiecesOf (MockOutput (), MockOutput ().size ()));
+
+    ASSERT_EQ (2, errors.size ());
+    ASSERT_EQ (2, errors[0].stack.size ());
+    EXPECT_EQ ("mock(int)", errors[0].stack[0].function);
+    EXPECT_EQ ("mock.cpp", errors[0].stack[0].file);
+    EXPECT_EQ ("42", errors[0].stack[0].line);
+    EXPECT_EQ ("/mock", errors[0].stack[1].object);
+}
+
+TEST (MemcheckXML, SameErrorsWhenStreamedInSmallPieces)
+{
+    Errors const whole (ReadInPiecesOf (MockOutput (), MockOutput ().size ()));
+    Errors const pieces (ReadInPiecesOf (MockOutput (), 7));
+
+    ASSERT_EQ (whole.size (), pieces.size ());
+
+    for (size_t i = 0; i < whole.size (); ++i)
+        EXPECT_EQ (yomc::Describe (whole[i]), yomc::Describe (pieces[i]));
+}
+
+TEST (MemcheckXML, LeaksFromEntryLeakCheckLeftOut)
+{
+    std::string const started (yconst::YiqiTestStartedMarker);
+    std::string const check (yconst::YiqiEntryLeakCheckMarker);
+    std::string const done (yconst::YiqiEntryLeakCheckDoneMarker);
+    std::string const leak (
+        "<error><kind>Leak_DefinitelyLost</kind>"
+        "<xwhat><text>lost</text><leakedbytes>8</leakedbytes></xwhat>"
+        "</error>\n");
+    std::string const output (
+        "<?xml version=\"1.0\"?>\n"
+        "<valgrindoutput>\n"
+        "<clientmsg><text>" + started + "MockCase.MockTest\n"
+        "</text></clientmsg>\n"
+        "<clientmsg><text>" + check + "\n</text></clientmsg>\n" +
+        leak +
+        "<clientmsg><text>" + done + "\n</text></clientmsg>\n" +
+        leak +
+        "</valgrindoutput>\n");
+
+    Errors const errors (ReadInPiecesOf (output, output.size ()));
+
+    ASSERT_EQ (1, errors.size ());
+    EXPECT_EQ ("MockCase.MockTest", errors[0].test);
+}
+
+TEST (MemcheckXML, DescribeIncludesStack)
+{
+    Errors const errors (ReadInPiecesOf (MockOutput (), MockOutput ().size ()));
+
+    ASSERT_EQ (2, errors.size ());
+    EXPECT_EQ ("InvalidRead: Invalid read of size 4\n"
+               "    at mock(int) (mock.cpp:42)\n"
+               "    at ??? (in /mock)",
+               yomc::Describe (errors[0]));
+}
@@ -0,0 +1,62 @@
+/*
+ * metric_matchers.cpp:
+ * Tests for the matchers which check metrics against a budget
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <gmock/gmock.h>
+
+#include "measurement.h"
+#include "metric_matchers.h"
+
+using ::testing::Not;
+
+namespace ymatch = yiqi::matchers;
+namespace ymeas = yiqi::measurement;
+
+namespace
+{
+    ymeas::Metrics const MockMetrics =
+    {
+        { "Ir", 100, "" },
+        { "Ir", 1000, "mock.cpp:mock" },
+        { "median.ns", 20, "" }
+    };
+
+    yiqi::RegionMetrics const MockRegionMetrics =
+    {
+        { "Ir", 100 },
+        { "median.ns", 20 }
+    };
+}
+
+TEST (MetricMatchers, MatchAtOrUnderLimit)
+{
+    EXPECT_THAT (MockMetrics, ymatch::InstructionsLE (100));
+    EXPECT_THAT (MockMetrics, ymatch::WalltimeMedianLE (25));
+}
+
+TEST (MetricMatchers, NoMatchOverLimit)
+{
+    EXPECT_THAT (MockMetrics, Not (ymatch::InstructionsLE (99)));
+    EXPECT_THAT (MockMetrics, Not (ymatch::WalltimeMedianLE (19.5)));
+}
+
+TEST (MetricMatchers, OnlyTotalForClientCodeCounts)
+{
+    EXPECT_THAT (MockMetrics, ymatch::MetricLE ("Ir", 500));
+}
+
+TEST (MetricMatchers, SkipWhenNotMeasured)
+{
+    EXPECT_THAT (MockMetrics, ymatch::D1MissesLE (0));
+    EXPECT_THAT (MockMetrics, ymatch::HeapAllocationsLE (0));
+}
+
+TEST (MetricMatchers, MatchWhatWasMeasuredInRegion)
+{
+    EXPECT_THAT (MockRegionMetrics, ymatch::InstructionsLE (100));
+    EXPECT_THAT (MockRegionMetrics, Not (ymatch::WalltimeMedianLE (19.5)));
+    EXPECT_THAT (MockRegionMetrics, ymatch::D1MissesLE (0));
+}
@@ -379,6 +379,161 @@ TEST_F (GetEnvForTool, FirstMembersInSysEnvironmentThenInstrumentationEnv)
                  ymatch::ArrayFitsMatchers (matchers)); // tool env + null-term
 }
 
+TEST_F (GetEnvForTool, ShardEnvironmentSetsShardWithoutInheritedSharding)
+{
+    char const * const Environment[] =
+    {
+        "PATH=/mock",
+        nullptr
+    };
+
+    ON_CALL (tool, InstrumentationName ())
+        .WillByDefault (ReturnRef (ytestrexec::MockInstrumentation));
+    ON_CALL (syscalls, GetSystemEnvironment ())
+        .WillByDefault (Return (Environment));
+
+    ycom::NullTermArray environment (
+        yexec::GetShardToolEnv (tool, syscalls, yexec::Shard { 1, 4 }));
+
+    std::vector <Matcher <char const *> > const matchers =
+    {
+        StrEq ("PATH=/mock"),
+        StrEq (std::string (yconst::YiqiToolEnvKey) + "=" +
+               ytestrexec::MockInstrumentation),
+        StrEq ("GTEST_SHARD_INDEX=1"),
+        StrEq ("GTEST_TOTAL_SHARDS=4"),
+        IsNull ()
+    };
+
+    EXPECT_EQ (matchers.size (), environment.underlyingArrayLen ());
+    EXPECT_THAT (environment.underlyingArray (),
+                 ymatch::ArrayFitsMatchers (matchers));
+}
+
+TEST_F (GetEnvForTool, ShardEnvironmentSplitsInheritedShard)
+{
+    char const * const InheritedSharding[] =
+    {
+        "PATH=/mock",
+        "GTEST_SHARD_INDEX=7",
+        "GTEST_TOTAL_SHARDS=8",
+        nullptr
+    };
+
+    ON_CALL (tool, InstrumentationName ())
+        .WillByDefault (ReturnRef (ytestrexec::MockInstrumentation));
+    ON_CALL (syscalls, GetSystemEnvironment ())
+        .WillByDefault (Return (InheritedSharding));
+
+    ycom::NullTermArray environment (
+        yexec::GetShardToolEnv (tool, syscalls, yexec::Shard { 1, 4 }));
+
+    /* Shard 1 of 4 inside shard 7 of 8 */
+    std::vector <Matcher <char const *> > const matchers =
+    {
+        StrEq ("PATH=/mock"),
+        StrEq (std::string (yconst::YiqiToolEnvKey) + "=" +
+               ytestrexec::MockInstrumentation),
+        StrEq ("GTEST_SHARD_INDEX=29"),
+        StrEq ("GTEST_TOTAL_SHARDS=32"),
+        IsNull ()
+    };
+
+    EXPECT_EQ (matchers.size (), environment.underlyingArrayLen ());
+    EXPECT_THAT (environment.underlyingArray (),
+                 ymatch::ArrayFitsMatchers (matchers));
+}
+
+TEST_F (GetEnvForTool, InheritedShardReadFromEnvironment)
+{
+    char const * const InheritedSharding[] =
+    {
+        "GTEST_TOTAL_SHARDS=2",
+        "GTEST_SHARD_INDEX=1",
+        nullptr
+    };
+
+    ON_CALL (syscalls, GetSystemEnvironment ())
+        .WillByDefault (Return (InheritedSharding));
+
+    yexec::Shard const shard (yexec::InheritedShard (syscalls));
+
+    EXPECT_EQ (1, shard.index);
+    EXPECT_EQ (2, shard.total);
+}
+
+TEST_F (GetEnvForTool, TestEnvironmentLeavesOutInheritedSharding)
+{
+    char const * const InheritedSharding[] =
+    {
+        "GTEST_TOTAL_SHARDS=2",
+        "PATH=/mock",
+        "GTEST_SHARD_INDEX=1",
+        nullptr
+    };
+
+    ON_CALL (tool, InstrumentationName ())
+        .WillByDefault (ReturnRef (ytestrexec::MockInstrumentation));
+    ON_CALL (syscalls, GetSystemEnvironment ())
+        .WillByDefault (Return (InheritedSharding));
+
+    ycom::NullTermArray environment (yexec::GetTestToolEnv (tool,
+                                                            syscalls));
+
+    std::vector <Matcher <char const *> > const matchers =
+    {
+        StrEq ("PATH=/mock"),
+        StrEq (std::string (yconst::YiqiToolEnvKey) + "=" +
+               ytestrexec::MockInstrumentation),
+        IsNull ()
+    };
+
+    EXPECT_EQ (matchers.size (), environment.underlyingArrayLen ());
+    EXPECT_THAT (environment.underlyingArray (),
+                 ymatch::ArrayFitsMatchers (matchers));
+}
+
+TEST (TestsInShard, EveryTotalthTestFromIndex)
+{
+    yexec::TestNames const tests =
+    {
+        "Case.A", "Case.B", "Case.C", "Case.D", "Case.E"
+    };
+
+    EXPECT_THAT (yexec::TestsInShard (tests, yexec::Shard { 1, 2 }),
+                 ::testing::ElementsAre ("Case.B", "Case.D"));
+    EXPECT_THAT (yexec::TestsInShard (tests, yexec::Shard { 0, 2 }),
+                 ::testing::ElementsAre ("Case.A", "Case.C", "Case.E"));
+    EXPECT_EQ (tests, yexec::TestsInShard (tests, yexec::Shard { 0, 1 }));
+}
+
+TEST_F (GetEnvForTool, InvalidInheritedShardIsWholeSuite)
+{
+    char const * const InvalidSharding[] =
+    {
+        "GTEST_SHARD_INDEX=2",
+        "GTEST_TOTAL_SHARDS=2",
+        nullptr
+    };
+    char const * const OnlyIndex[] =
+    {
+        "GTEST_SHARD_INDEX=1",
+        nullptr
+    };
+
+    EXPECT_CALL (syscalls, GetSystemEnvironment ())
+        .WillOnce (Return (InvalidSharding))
+        .WillOnce (Return (OnlyIndex));
+
+    for (int i = 0; i < 2; ++i)
+    {
+        yexec::Shard const shard (yexec::InheritedShard (syscalls));
+
+        EXPECT_EQ (0, shard.index);
+        EXPECT_EQ (1, shard.total);
+    }
+}
+
 namespace
 {
     class MockFetchFunctions
@@ -528,3 +683,603 @@ TEST_F (Relaunch, VerifyCStyleEnv)
                                 _1, _2),
                      syscalls);
 }
+
+class RelaunchForEachTest :
+    public ::testing::Test
+{
+    public:
+
+        RelaunchForEachTest () :
+            tests ({ "MockCase.First", "MockCase.Second" })
+        {
+            syscalls.IgnoreCalls ();
+
+            /* Each test gets a child, nothing is exec'd in place */
+            EXPECT_CALL (syscalls, ExecInPlace (_, _, _)).Times (0);
+        }
+
+    protected:
+
+        int Run (yexec::ChildExitedFunc const &exited,
+                 unsigned int                 slots = 1)
+        {
+            return yexec::RelaunchForEachTest (
+                       tool,
+                       tests,
+                       slots,
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return std::string ();
+                       },
+                       [](yit::Tool const &t) {
+                           return yexec::NullTermArray ();
+                       },
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return yexec::NullTermArray ();
+                       },
+                       exited,
+                       output,
+                       syscalls);
+        }
+
+        std::stringstream        output;
+        ymocksysapi::SystemCalls syscalls;
+        ymockit::Tool            tool;
+        yexec::TestNames         tests;
+};
+
+TEST_F (RelaunchForEachTest, SpawnChildWithFilterForEachTest)
+{
+    for (std::string const &test : tests)
+    {
+        std::vector <Matcher <char const *> > matchers =
+        {
+            StrEq (std::string (yconst::GoogleTestFilterOption) + test),
+            IsNull ()
+        };
+
+        EXPECT_CALL (syscalls,
+                     SpawnChild (_,
+                                 ymatch::ArrayFitsMatchers (matchers),
+                                 _,
+                                 _));
+    }
+
+    Run ([](yexec::TestRun const &) {});
+}
+
+TEST_F (RelaunchForEachTest, ExitedCalledWithTestAndChild)
+{
+    pid_t const MockChild = 1234;
+    std::vector <std::string> exitedTests;
+
+    ON_CALL (syscalls, SpawnChild (_, _, _, _))
+        .WillByDefault (Return (MockChild));
+    EXPECT_CALL (syscalls, WaitForChild (MockChild)).Times (2);
+
+    Run ([&exitedTests, MockChild](yexec::TestRun const &run) {
+        EXPECT_EQ (MockChild, run.child);
+        exitedTests.push_back (run.test);
+    });
+
+    EXPECT_EQ (tests, exitedTests);
+}
+
+TEST_F (RelaunchForEachTest, ExitedCalledWithStatus)
+{
+    std::vector <int> statuses;
+
+    EXPECT_CALL (syscalls, WaitForChild (_))
+        .WillOnce (Return (1))
+        .WillOnce (Return (0));
+
+    Run ([&statuses](yexec::TestRun const &run) {
+        statuses.push_back (run.status);
+    });
+
+    EXPECT_THAT (statuses, ::testing::ElementsAre (1, 0));
+}
+
+TEST_F (RelaunchForEachTest, ReturnHighestExitStatus)
+{
+    EXPECT_CALL (syscalls, WaitForChild (_))
+        .WillOnce (Return (1))
+        .WillOnce (Return (0));
+
+    EXPECT_EQ (1, Run ([](yexec::TestRun const &) {}));
+}
+
+TEST_F (RelaunchForEachTest, OutputGoesStraightThroughOneAtATime)
+{
+    EXPECT_CALL (syscalls, CreatePipe ()).Times (0);
+    EXPECT_CALL (syscalls,
+                 SpawnChild (_, _, _, ysysapi::SystemCalls::InheritedFds ()))
+        .Times (2);
+
+    Run ([](yexec::TestRun const &) {});
+}
+
+class RelaunchForEachTestInSlots :
+    public RelaunchForEachTest
+{
+    public:
+
+        RelaunchForEachTestInSlots () :
+            nextFd (10),
+            nextChild (100)
+        {
+            tests.push_back ("MockCase.Third");
+
+            ON_CALL (syscalls, CreatePipe ())
+                .WillByDefault (::testing::Invoke ([this]() {
+                    ysysapi::SystemCalls::Pipe const pipe = { nextFd,
+                                                              nextFd + 1 };
+                    nextFd += 2;
+                    return pipe;
+                }));
+            ON_CALL (syscalls, SpawnChild (_, _, _, _))
+                .WillByDefault (::testing::InvokeWithoutArgs ([this]() {
+                    return nextChild++;
+                }));
+
+            /* Everything is always ready, and at its end */
+            ON_CALL (syscalls, PollReadable (_))
+                .WillByDefault (::testing::ReturnArg <0> ());
+            ON_CALL (syscalls, ReadFd (_, _, _))
+                .WillByDefault (Return (0));
+        }
+
+    protected:
+
+        int   nextFd;
+        pid_t nextChild;
+};
+
+TEST_F (RelaunchForEachTestInSlots, OnlyAsManyChildrenAsSlotsAtOnce)
+{
+    EXPECT_CALL (syscalls, WaitForChild (_)).Times (::testing::AnyNumber ());
+
+    ::testing::InSequence s;
+
+    /* The third test waits for a slot to be free */
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, _));
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, _));
+    EXPECT_CALL (syscalls, WaitForChild (100));
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, _));
+
+    Run ([](yexec::TestRun const &) {}, 2);
+}
+
+TEST_F (RelaunchForEachTestInSlots, NextTestStartsInFirstFreeSlot)
+{
+    std::vector <std::string> exitedTests;
+
+    /* The second test finishes before the first */
+    EXPECT_CALL (syscalls, PollReadable (_))
+        .WillOnce (Return (ysysapi::SystemCalls::Fds { 12 }))
+        .WillRepeatedly (::testing::ReturnArg <0> ());
+
+    Run ([&exitedTests](yexec::TestRun const &run) {
+             exitedTests.push_back (run.test);
+         },
+         2);
+
+    EXPECT_THAT (exitedTests,
+                 ::testing::ElementsAre ("MockCase.Second",
+                                         "MockCase.First",
+                                         "MockCase.Third"));
+}
+
+TEST_F (RelaunchForEachTestInSlots, ChildOutputGoesToPipe)
+{
+    ysysapi::SystemCalls::InheritedFds const inherited =
+    {
+        { 11, STDOUT_FILENO },
+        { 11, STDERR_FILENO }
+    };
+
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, inherited));
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, ::testing::Ne (inherited)))
+        .Times (2);
+    EXPECT_CALL (syscalls, CloseFd (_)).Times (::testing::AnyNumber ());
+    EXPECT_CALL (syscalls, CloseFd (11));
+
+    Run ([](yexec::TestRun const &) {}, 2);
+}
+
+TEST_F (RelaunchForEachTestInSlots, OutputWrittenBeforeExited)
+{
+    ::testing::Sequence reads;
+
+    EXPECT_CALL (syscalls, ReadFd (10, _, _))
+        .InSequence (reads)
+        .WillOnce (::testing::Invoke ([](int, char *buffer, size_t) {
+            std::string const chunk ("first\n");
+            std::copy (chunk.begin (), chunk.end (), buffer);
+            return chunk.size ();
+        }));
+    EXPECT_CALL (syscalls, ReadFd (10, _, _))
+        .InSequence (reads)
+        .WillOnce (Return (0));
+
+    std::string outputWhenFirstExited;
+
+    Run ([this, &outputWhenFirstExited](yexec::TestRun const &run) {
+             if (run.test == "MockCase.First")
+                 outputWhenFirstExited = output.str ();
+         },
+         2);
+
+    EXPECT_EQ ("first\n", outputWhenFirstExited);
+}
+
+TEST_F (RelaunchForEachTestInSlots, ReturnHighestExitStatus)
+{
+    EXPECT_CALL (syscalls, WaitForChild (_)).Times (::testing::AnyNumber ());
+    EXPECT_CALL (syscalls, WaitForChild (101)).WillOnce (Return (3));
+
+    EXPECT_EQ (3, Run ([](yexec::TestRun const &) {}, 2));
+}
+
+class RelaunchAndWait :
+    public ::testing::Test
+{
+    public:
+
+        RelaunchAndWait ()
+        {
+            syscalls.IgnoreCalls ();
+
+            /* The child is spawned, never exec'd in place */
+            EXPECT_CALL (syscalls, ExecInPlace (_, _, _)).Times (0);
+        }
+
+    protected:
+
+        int Run (yexec::ProcessExitedFunc const &exited)
+        {
+            return yexec::RelaunchAndWait (
+                       tool,
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return std::string ();
+                       },
+                       [](yit::Tool const &t) {
+                           return yexec::NullTermArray ();
+                       },
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return yexec::NullTermArray ();
+                       },
+                       exited,
+                       syscalls);
+        }
+
+        ymocksysapi::SystemCalls syscalls;
+        ymockit::Tool            tool;
+};
+
+TEST_F (RelaunchAndWait, SpawnOneChildWithoutFilter)
+{
+    std::vector <Matcher <char const *> > matchers =
+    {
+        IsNull ()
+    };
+
+    EXPECT_CALL (syscalls,
+                 SpawnChild (_, ymatch::ArrayFitsMatchers (matchers), _, _))
+        .Times (1);
+
+    Run ([](pid_t) {});
+}
+
+TEST_F (RelaunchAndWait, ExitedCalledWithChildOnceItExits)
+{
+    pid_t const MockChild = 1234;
+    pid_t       exitedChild = 0;
+
+    ::testing::InSequence sequence;
+
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, _))
+        .WillOnce (Return (MockChild));
+    EXPECT_CALL (syscalls, WaitForChild (MockChild))
+        .WillOnce (Return (2));
+
+    EXPECT_EQ (2, Run ([&exitedChild](pid_t child) {
+        exitedChild = child;
+    }));
+    EXPECT_EQ (MockChild, exitedChild);
+}
+
+namespace
+{
+    int const   MockReadFd = 5;
+    int const   MockWriteFd = 6;
+    pid_t const MockChild = 1234;
+}
+
+class RelaunchAndStream :
+    public ::testing::Test
+{
+    public:
+
+        RelaunchAndStream () :
+            pipe ({ MockReadFd, MockWriteFd })
+        {
+            syscalls.IgnoreCalls ();
+
+            ON_CALL (syscalls, CreatePipe ())
+                .WillByDefault (Return (pipe));
+            ON_CALL (syscalls, SpawnChild (_, _, _, _))
+                .WillByDefault (Return (MockChild));
+            ON_CALL (syscalls, ReadFd (_, _, _))
+                .WillByDefault (Return (0));
+
+            /* The child is spawned, never exec'd in place */
+            EXPECT_CALL (syscalls, ExecInPlace (_, _, _)).Times (0);
+        }
+
+    protected:
+
+        int Run (yexec::StreamConsumerFunc const &consume)
+        {
+            return yexec::RelaunchAndStream (
+                       tool,
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return std::string ();
+                       },
+                       [](yit::Tool const &t) {
+                           return yexec::NullTermArray ();
+                       },
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return yexec::NullTermArray ();
+                       },
+                       consume,
+                       syscalls);
+        }
+
+        /* Has each read from the pipe return the next chunk */
+        void ExpectReads (std::vector <std::string> const &chunks)
+        {
+            ::testing::Sequence reads;
+
+            for (std::string const &chunk : chunks)
+                EXPECT_CALL (syscalls, ReadFd (MockReadFd, _, _))
+                    .InSequence (reads)
+                    .WillOnce (::testing::Invoke (
+                        [chunk](int, char *buffer, size_t) {
+                            std::copy (chunk.begin (), chunk.end (), buffer);
+                            return chunk.size ();
+                        }));
+        }
+
+        ysysapi::SystemCalls::Pipe const pipe;
+        ymocksysapi::SystemCalls         syscalls;
+        ymockit::Tool                    tool;
+};
+
+TEST_F (RelaunchAndStream, ChildInheritsWriteEndAsResultsStreamFd)
+{
+    ysysapi::SystemCalls::InheritedFds const inherited =
+    {
+        { MockWriteFd, yconst::ResultsStreamFd }
+    };
+
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, inherited));
+
+    Run ([](pid_t, char const *, size_t) { return true; });
+}
+
+TEST_F (RelaunchAndStream, WriteEndClosedBeforeReading)
+{
+    ::testing::InSequence sequence;
+
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, _));
+    EXPECT_CALL (syscalls, CloseFd (MockWriteFd));
+    EXPECT_CALL (syscalls, ReadFd (MockReadFd, _, _));
+    EXPECT_CALL (syscalls, WaitForChild (MockChild));
+    EXPECT_CALL (syscalls, CloseFd (MockReadFd));
+
+    Run ([](pid_t, char const *, size_t) { return true; });
+}
+
+TEST_F (RelaunchAndStream, ConsumeEverythingUntilEndOfStream)
+{
+    std::string consumed;
+
+    ExpectReads ({ "first ", "second", "" });
+
+    Run ([&consumed](pid_t, char const *data, size_t size) {
+        consumed.append (data, size);
+        return true;
+    });
+
+    EXPECT_EQ ("first second", consumed);
+}
+
+TEST_F (RelaunchAndStream, KillChildWhenConsumerStops)
+{
+    /* Nothing more is read once the consumer has had enough */
+    ExpectReads ({ "first ", "second" });
+
+    EXPECT_CALL (syscalls, KillChild (MockChild));
+
+    unsigned int calls = 0;
+    Run ([&calls](pid_t, char const *, size_t) {
+        return ++calls < 2;
+    });
+
+    EXPECT_EQ (2, calls);
+}
+
+TEST_F (RelaunchAndStream, ReturnChildExitStatus)
+{
+    EXPECT_CALL (syscalls, WaitForChild (MockChild))
+        .WillOnce (Return (3));
+
+    EXPECT_EQ (3, Run ([](pid_t, char const *, size_t) { return true; }));
+}
+
+class RelaunchShards :
+    public ::testing::Test
+{
+    public:
+
+        RelaunchShards () :
+            nextFd (10),
+            nextChild (100)
+        {
+            syscalls.IgnoreCalls ();
+
+            ON_CALL (syscalls, CreatePipe ())
+                .WillByDefault (::testing::Invoke ([this]() {
+                    ysysapi::SystemCalls::Pipe const pipe = { nextFd,
+                                                              nextFd + 1 };
+                    nextFd += 2;
+                    return pipe;
+                }));
+            ON_CALL (syscalls, SpawnChild (_, _, _, _))
+                .WillByDefault (::testing::InvokeWithoutArgs ([this]() {
+                    return nextChild++;
+                }));
+
+            /* Everything is always ready, and at its end */
+            ON_CALL (syscalls, PollReadable (_))
+                .WillByDefault (::testing::ReturnArg <0> ());
+            ON_CALL (syscalls, ReadFd (_, _, _))
+                .WillByDefault (Return (0));
+
+            EXPECT_CALL (syscalls, ExecInPlace (_, _, _)).Times (0);
+        }
+
+    protected:
+
+        int Run (unsigned int                     shards,
+                 yexec::StreamConsumerFunc const &consume,
+                 yexec::ProcessExitedFunc const  &exited)
+        {
+            return yexec::RelaunchShards (
+                       tool,
+                       shards,
+                       [](yit::Tool const &t, ysysapi::SystemCalls const &c) {
+                           return std::string ();
+                       },
+                       [](yit::Tool const &t) {
+                           return yexec::NullTermArray ();
+                       },
+                       [this](yit::Tool const            &t,
+                              ysysapi::SystemCalls const &c,
+                              yexec::Shard const         &shard) {
+                           EXPECT_EQ (fetchedShards.size (), shard.index);
+                           fetchedShards.push_back (shard.total);
+                           return yexec::NullTermArray ();
+                       },
+                       consume,
+                       exited,
+                       output,
+                       syscalls);
+        }
+
+        /* Has each read from fd return the next chunk */
+        void ExpectReads (int fd, std::vector <std::string> const &chunks)
+        {
+            ::testing::Sequence reads;
+
+            for (std::string const &chunk : chunks)
+                EXPECT_CALL (syscalls, ReadFd (fd, _, _))
+                    .InSequence (reads)
+                    .WillOnce (::testing::Invoke (
+                        [chunk](int, char *buffer, size_t) {
+                            std::copy (chunk.begin (), chunk.end (), buffer);
+                            return chunk.size ();
+                        }));
+        }
+
+        int                         nextFd;
+        pid_t                       nextChild;
+        std::vector <unsigned int>  fetchedShards;
+        std::stringstream           output;
+        ymocksysapi::SystemCalls    syscalls;
+        ymockit::Tool               tool;
+};
+
+TEST_F (RelaunchShards, SpawnChildForEachShard)
+{
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, _)).Times (3);
+
+    Run (3, yexec::StreamConsumerFunc (), [](pid_t) {});
+
+    EXPECT_THAT (fetchedShards, ::testing::ElementsAre (3, 3, 3));
+}
+
+TEST_F (RelaunchShards, ChildOutputAndResultsGoToPipes)
+{
+    ysysapi::SystemCalls::InheritedFds const inherited =
+    {
+        { 11, STDOUT_FILENO },
+        { 11, STDERR_FILENO },
+        { 13, yconst::ResultsStreamFd }
+    };
+
+    EXPECT_CALL (syscalls, SpawnChild (_, _, _, inherited));
+    EXPECT_CALL (syscalls, CloseFd (11));
+    EXPECT_CALL (syscalls, CloseFd (13));
+
+    Run (1, [](pid_t, char const *, size_t) { return true; }, [](pid_t) {});
+}
+
+TEST_F (RelaunchShards, OutputOfEachChildWrittenTogether)
+{
+    /* The second shard's output arrives in between the first's */
+    ExpectReads (10, { "first ", "shard\n", "" });
+    ExpectReads (12, { "second shard\n", "" });
+
+    EXPECT_CALL (syscalls, PollReadable (_))
+        .WillOnce (Return (ysysapi::SystemCalls::Fds { 10, 12 }))
+        .WillOnce (Return (ysysapi::SystemCalls::Fds { 12, 10 }))
+        .WillRepeatedly (::testing::ReturnArg <0> ());
+
+    Run (2, yexec::StreamConsumerFunc (), [](pid_t) {});
+
+    EXPECT_EQ ("second shard\nfirst shard\n", output.str ());
+}
+
+TEST_F (RelaunchShards, ResultsConsumedWithChild)
+{
+    std::vector <pid_t> streams;
+
+    ExpectReads (12, { "results", "" });
+
+    Run (1,
+         [&streams](pid_t child, char const *data, size_t size) {
+             EXPECT_EQ ("results", std::string (data, size));
+             streams.push_back (child);
+             return true;
+         },
+         [](pid_t) {});
+
+    EXPECT_THAT (streams, ::testing::ElementsAre (100));
+}
+
+TEST_F (RelaunchShards, KillEveryChildWhenConsumerStops)
+{
+    ExpectReads (12, { "results", "" });
+
+    EXPECT_CALL (syscalls, KillChild (100));
+    EXPECT_CALL (syscalls, KillChild (101));
+
+    Run (2, [](pid_t, char const *, size_t) { return false; }, [](pid_t) {});
+}
+
+TEST_F (RelaunchShards, ExitedCalledForEachChildAndHighestStatusReturned)
+{
+    std::vector <pid_t> exited;
+
+    EXPECT_CALL (syscalls, WaitForChild (100)).WillOnce (Return (0));
+    EXPECT_CALL (syscalls, WaitForChild (101)).WillOnce (Return (2));
+
+    EXPECT_EQ (2, Run (2,
+                       yexec::StreamConsumerFunc (),
+                       [&exited](pid_t child) {
+                           exited.push_back (child);
+                       }));
+
+    EXPECT_THAT (exited, ::testing::ElementsAre (100, 101));
+}
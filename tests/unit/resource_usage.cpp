@@ -0,0 +1,145 @@
+/*
+ * resource_usage.cpp:
+ * Tests for reading back and comparing samples of resource usage
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "measurement.h"
+#include "resource_usage.h"
+
+namespace ymeas = yiqi::measurement;
+namespace yres = yiqi::resources;
+
+namespace
+{
+    std::string const MockStatus (
+        "Name:\tmock\n"
+        "State:\tR (running)\n"
+        "VmPeak:\t   10000 kB\n"
+        "VmHWM:\t    2048 kB\n"
+        "VmRSS:\t    1024 kB\n"
+        "Threads:\t1\n");
+
+    std::string const MockIO (
+        "rchar: 4000\n"
+        "wchar: 300\n"
+        "syscr: 9\n"
+        "syscw: 2\n"
+        "read_bytes: 8192\n"
+        "write_bytes: 4096\n"
+        "cancelled_write_bytes: 0\n");
+
+    double ValueOf (ymeas::Metrics const &metrics,
+                    std::string const    &name)
+    {
+        for (ymeas::Metric const &metric : metrics)
+            if (metric.name == name && metric.function.empty ())
+                return metric.value;
+
+        throw std::logic_error ("no metric named " + name);
+    }
+}
+
+TEST (ResourceUsage, ResidentSizesFromStatusInBytes)
+{
+    std::stringstream status (MockStatus);
+    yres::Usage usage = yres::Usage ();
+
+    yres::ReadStatus (status, usage);
+
+    EXPECT_EQ (1024 * 1024, usage.residentBytes);
+    EXPECT_EQ (2048 * 1024, usage.peakResidentBytes);
+}
+
+TEST (ResourceUsage, BytesReadAndWrittenFromIO)
+{
+    std::stringstream io (MockIO);
+    yres::Usage usage = yres::Usage ();
+
+    yres::ReadIO (io, usage);
+
+    EXPECT_EQ (4000, usage.readBytes);
+    EXPECT_EQ (300, usage.writtenBytes);
+    EXPECT_EQ (8192, usage.storageReadBytes);
+    EXPECT_EQ (4096, usage.storageWrittenBytes);
+}
+
+TEST (ResourceUsage, NothingSetFromEmptyFiles)
+{
+    std::stringstream empty;
+    yres::Usage usage = yres::Usage ();
+
+    yres::ReadStatus (empty, usage);
+    yres::ReadIO (empty, usage);
+
+    EXPECT_EQ (0, usage.residentBytes);
+    EXPECT_EQ (0, usage.readBytes);
+}
+
+TEST (ResourceUsage, MetricsAreDifferencesBetweenSamples)
+{
+    yres::Usage entry = yres::Usage ();
+    entry.userNanoseconds = 1000;
+    entry.voluntarySwitches = 2;
+    entry.minorFaults = 10;
+    entry.readBytes = 100;
+
+    yres::Usage exit (entry);
+    exit.userNanoseconds = 4000;
+    exit.voluntarySwitches = 5;
+    exit.minorFaults = 30;
+    exit.readBytes = 150;
+
+    ymeas::Metrics const metrics (yres::UsageMetrics (entry, exit));
+
+    EXPECT_EQ (3000, ValueOf (metrics, "cpu.user.ns"));
+    EXPECT_EQ (3, ValueOf (metrics, "context.switches.voluntary"));
+    EXPECT_EQ (20, ValueOf (metrics, "page.faults.minor"));
+    EXPECT_EQ (50, ValueOf (metrics, "io.read.bytes"));
+    EXPECT_EQ (0, ValueOf (metrics, "page.faults.major"));
+}
+
+TEST (ResourceUsage, BytesReadBySamplingLeftOut)
+{
+    yres::Usage entry = yres::Usage ();
+    entry.readBytes = 100;
+    entry.sampleReadBytes = 40;
+
+    yres::Usage exit (entry);
+    exit.readBytes = 150;
+
+    EXPECT_EQ (10, ValueOf (yres::UsageMetrics (entry, exit),
+                            "io.read.bytes"));
+}
+
+TEST (ResourceUsage, ResidentSizeCanShrink)
+{
+    yres::Usage entry = yres::Usage ();
+    entry.residentBytes = 4096;
+
+    yres::Usage exit (entry);
+    exit.residentBytes = 1024;
+    exit.peakResidentBytes = 8192;
+
+    ymeas::Metrics const metrics (yres::UsageMetrics (entry, exit));
+
+    EXPECT_EQ (-3072, ValueOf (metrics, "rss.delta.bytes"));
+    EXPECT_EQ (8192, ValueOf (metrics, "rss.peak.bytes"));
+}
+
+TEST (ResourceUsage, CountersNeverGoBackwards)
+{
+    yres::Usage entry = yres::Usage ();
+    entry.writtenBytes = 100;
+
+    yres::Usage const exit = yres::Usage ();
+
+    EXPECT_EQ (0, ValueOf (yres::UsageMetrics (entry, exit),
+                           "io.write.bytes"));
+}
@@ -0,0 +1,82 @@
+/*
+ * result_cache.cpp:
+ * Tests for naming what is kept between runs
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <gmock/gmock.h>
+
+#include "result_cache.h"
+
+namespace ycache = yiqi::cache;
+namespace ysysapi = yiqi::system::api;
+
+namespace
+{
+    std::string const MockIdentity ("build-id 0123\n");
+    std::string const MockTest ("MockCase.MockTest");
+    std::string const MockTool ("mocktool");
+    std::string const MockOptions ("--tool=mocktool");
+}
+
+TEST (ResultCache, FingerprintIsFNV1a)
+{
+    EXPECT_EQ ("cbf29ce484222325", ycache::Fingerprint (""));
+    EXPECT_EQ ("af63dc4c8601ec8c", ycache::Fingerprint ("a"));
+}
+
+TEST (ResultCache, IdentityFromBuildIDs)
+{
+    ysysapi::SystemCalls::LoadedObjects const objects =
+    {
+        { "/proc/self/exe", "0123" },
+        { "/lib/libmock.so", "4567" }
+    };
+
+    EXPECT_EQ ("build-id 0123\nbuild-id 4567\n",
+               ycache::CodeIdentity (objects));
+}
+
+TEST (ResultCache, IdentityFromPathIfNoBuildIDOrFile)
+{
+    ysysapi::SystemCalls::LoadedObjects const objects =
+    {
+        { "/nonexistent/libmock.so", "" }
+    };
+
+    EXPECT_EQ ("path /nonexistent/libmock.so\n",
+               ycache::CodeIdentity (objects));
+}
+
+TEST (ResultCache, KeyChangesWithEverythingItIsFor)
+{
+    std::string const key (ycache::Key (MockIdentity,
+                                        MockTest,
+                                        MockTool,
+                                        MockOptions));
+
+    EXPECT_EQ (key, ycache::Key (MockIdentity, MockTest, MockTool, MockOptions));
+    EXPECT_NE (key, ycache::Key ("build-id 89ab\n",
+                                 MockTest,
+                                 MockTool,
+                                 MockOptions));
+    EXPECT_NE (key, ycache::Key (MockIdentity,
+                                 "MockCase.Other",
+                                 MockTool,
+                                 MockOptions));
+    EXPECT_NE (key, ycache::Key (MockIdentity,
+                                 MockTest,
+                                 "othertool",
+                                 MockOptions));
+    EXPECT_NE (key, ycache::Key (MockIdentity,
+                                 MockTest,
+                                 MockTool,
+                                 MockOptions + " --fast"));
+}
+
+TEST (ResultCache, KeyFieldsDoNotRunTogether)
+{
+    EXPECT_NE (ycache::Key (MockIdentity, "ab", "c", MockOptions),
+               ycache::Key (MockIdentity, "a", "bc", MockOptions));
+}
@@ -0,0 +1,101 @@
+/*
+ * sax_parser.cpp:
+ * Tests for the incremental XML parser
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "sax_parser.h"
+
+using ::testing::ElementsAre;
+
+namespace yxml = yiqi::xml;
+
+namespace
+{
+    /* Records everything the parser finds, one string per callback */
+    class RecordingHandler :
+        public yxml::SAXHandler
+    {
+        public:
+
+            std::vector <std::string> events;
+
+        private:
+
+            void StartElement (std::string const &name)
+            {
+                events.push_back ("<" + name + ">");
+            }
+
+            void EndElement (std::string const &name)
+            {
+                events.push_back ("</" + name + ">");
+            }
+
+            void Text (std::string const &text)
+            {
+                events.push_back (text);
+            }
+    };
+
+    std::string const MockDocument ("<?xml version=\"1.0\"?>\n"
+                                    "<!-- a comment with <tags> -->\n"
+                                    "<a x=\"1 > 0\">\n"
+                                    "  <b>one &amp; two</b>\n"
+                                    "  <c/>\n"
+                                    "</a>\n");
+}
+
+TEST (SAXParser, ElementsAndText)
+{
+    RecordingHandler handler;
+    yxml::SAXParser  parser (handler);
+
+    parser.Feed (MockDocument.data (), MockDocument.size ());
+
+    EXPECT_THAT (handler.events, ElementsAre ("<a>",
+                                              "<b>",
+                                              "one & two",
+                                              "</b>",
+                                              "<c>",
+                                              "</c>",
+                                              "</a>"));
+}
+
+TEST (SAXParser, SameResultWhenFedOneCharacterAtATime)
+{
+    RecordingHandler whole;
+    yxml::SAXParser  wholeParser (whole);
+    wholeParser.Feed (MockDocument.data (), MockDocument.size ());
+
+    RecordingHandler pieces;
+    yxml::SAXParser  piecesParser (pieces);
+
+    for (char const &c : MockDocument)
+        piecesParser.Feed (&c, 1);
+
+    EXPECT_EQ (whole.events, pieces.events);
+}
+
+TEST (SAXParser, DecodeEntities)
+{
+    EXPECT_EQ ("<a> & \"b\" 'c'",
+               yxml::DecodeEntities ("&lt;a&gt; &amp; &quot;b&quot; &apos;c&apos;"));
+}
+
+TEST (SAXParser, DecodeCharacterReferences)
+{
+    EXPECT_EQ ("A\xc3\xa9", yxml::DecodeEntities ("&#65;&#xe9;"));
+}
+
+TEST (SAXParser, ThrowOnUnknownEntity)
+{
+    EXPECT_THROW ({
+        yxml::DecodeEntities ("&nbsp;");
+    }, std::runtime_error);
+}
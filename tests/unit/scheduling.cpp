@@ -0,0 +1,88 @@
+/*
+ * scheduling.cpp:
+ * Tests for ordering tests by how long they took last time
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "scheduling.h"
+
+using ::testing::ElementsAre;
+
+namespace ysched = yiqi::scheduling;
+
+TEST (Scheduling, LongestFirst)
+{
+    ysched::Durations const durations =
+    {
+        { "Case.Fast", 1 },
+        { "Case.Slow", 30 },
+        { "Case.Medium", 5 }
+    };
+
+    EXPECT_THAT (ysched::LongestFirst ({ "Case.Fast",
+                                         "Case.Medium",
+                                         "Case.Slow" },
+                                       durations),
+                 ElementsAre ("Case.Slow", "Case.Medium", "Case.Fast"));
+}
+
+TEST (Scheduling, UntimedTestsFirstInOriginalOrder)
+{
+    ysched::Durations const durations =
+    {
+        { "Case.Timed", 30 }
+    };
+
+    EXPECT_THAT (ysched::LongestFirst ({ "Case.New",
+                                         "Case.Timed",
+                                         "Case.Newer" },
+                                       durations),
+                 ElementsAre ("Case.New", "Case.Newer", "Case.Timed"));
+}
+
+TEST (Scheduling, EqualDurationsKeepOrder)
+{
+    ysched::Durations const durations =
+    {
+        { "Case.A", 2 },
+        { "Case.B", 2 }
+    };
+
+    EXPECT_THAT (ysched::LongestFirst ({ "Case.B", "Case.A" }, durations),
+                 ElementsAre ("Case.B", "Case.A"));
+}
+
+TEST (Scheduling, DurationsRoundTrip)
+{
+    ysched::Durations const durations =
+    {
+        { "Case.A", 1.5 },
+        { "Case.B", 0.25 }
+    };
+
+    std::stringstream ss;
+    ysched::WriteDurations (ss, durations);
+
+    EXPECT_EQ ("Case.A\t1.5\nCase.B\t0.25\n", ss.str ());
+    EXPECT_EQ (durations, ysched::ReadDurations (ss));
+}
+
+TEST (Scheduling, ThrowOnMalformedDuration)
+{
+    std::stringstream ss ("Case.A\tslow\n");
+
+    EXPECT_THROW ({
+        ysched::ReadDurations (ss);
+    }, std::runtime_error);
+}
+
+TEST (Scheduling, NoDurationsWithoutFile)
+{
+    EXPECT_TRUE (ysched::ReadDurationsFile ("/nonexistent/durations").empty ());
+}
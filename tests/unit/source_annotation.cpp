@@ -0,0 +1,176 @@
+/*
+ * source_annotation.cpp:
+ * Tests for annotating client code with what each line cost
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <sstream>
+
+#include <gmock/gmock.h>
+
+#include "callgrind_output.h"
+#include "source_annotation.h"
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::Pair;
+
+namespace yoan = yiqi::output::annotation;
+namespace yocl = yiqi::output::callgrind;
+
+namespace
+{
+    yocl::Profile Read (std::string const &profile)
+    {
+        return yocl::ReadProfile (profile.data (), profile.size (), true);
+    }
+
+    std::string const CacheProfile ("events: Ir I1mr ILmr Dr D1mr DLmr "
+                                    "Dw D1mw DLmw\n"
+                                    "fl=/src/mock.cpp\n"
+                                    "fn=mock\n"
+                                    "2 1000 0 0 10 4 1 5 2 1\n"
+                                    "12 5\n"
+                                    "fl=/usr/include/gtest/gtest.h\n"
+                                    "fn=testing::Test::Run\n"
+                                    "1 500\n");
+
+    yoan::Sources const MockSources =
+    {
+        {
+            "/src/mock.cpp",
+            { "int mock ()", "{", "    return 1;", "}", "", "", "", "",
+              "", "", "",
+              "int other;" }
+        }
+    };
+
+    std::string Text (yoan::Annotation const &annotation,
+                      yoan::Sources const    &sources)
+    {
+        std::stringstream ss;
+        yoan::WriteText (ss, annotation, sources);
+        return ss.str ();
+    }
+}
+
+TEST (SourceAnnotation, ClientFiles)
+{
+    EXPECT_TRUE (yoan::IsClientFile ("/home/mock/src/mock.cpp"));
+    EXPECT_TRUE (yoan::IsClientFile ("mock.cpp"));
+}
+
+TEST (SourceAnnotation, FrameworkAndSystemFilesAreNotClientFiles)
+{
+    EXPECT_FALSE (yoan::IsClientFile ("/opt/googletest/src/gtest.cc"));
+    EXPECT_FALSE (yoan::IsClientFile ("/home/mock/gmock/gmock-spec.h"));
+    EXPECT_FALSE (yoan::IsClientFile ("/usr/include/c++/vector"));
+    EXPECT_FALSE (yoan::IsClientFile ("/opt/include/yiqi/instrumentation.h"));
+    EXPECT_FALSE (yoan::IsClientFile ("???"));
+    EXPECT_FALSE (yoan::IsClientFile (""));
+}
+
+TEST (SourceAnnotation, OnlyClientLinesAreAdded)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read (CacheProfile));
+
+    ASSERT_EQ (1, annotation.files.size ());
+    EXPECT_THAT (annotation.files.begin ()->second,
+                 ElementsAre (Pair (2, ElementsAre (1000, 0, 0, 10, 4, 1,
+                                                    5, 2, 1)),
+                              Pair (12, ElementsAre (5, 0, 0, 0, 0, 0,
+                                                    0, 0, 0))));
+}
+
+TEST (SourceAnnotation, ProfilesAddUpByEventName)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read ("events: Ir\n"
+                                        "fl=mock.cpp\nfn=mock\n3 10\n"));
+    yoan::AddProfile (annotation, Read ("events: Dr Ir\n"
+                                        "fl=mock.cpp\nfn=mock\n3 4 20\n"));
+
+    EXPECT_THAT (annotation.events, ElementsAre ("Ir", "Dr"));
+    EXPECT_THAT (annotation.files["mock.cpp"],
+                 ElementsAre (Pair (3, ElementsAre (30, 4))));
+}
+
+TEST (SourceAnnotation, TextShowsIrAndMissesAgainstEachLine)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read (CacheProfile));
+
+    std::string const text (Text (annotation, MockSources));
+
+    EXPECT_THAT (text, HasSubstr ("Ir: 1005, D1 misses: 6, "
+                                  "LL misses: 2"));
+    EXPECT_THAT (text, HasSubstr ("1000         6         2 *      2"
+                                  "  {"));
+    EXPECT_THAT (text, HasSubstr ("   5         0         0       12"
+                                  "  int other;"));
+    EXPECT_THAT (text, HasSubstr ("   .         .         .        3"
+                                  "      return 1;"));
+    EXPECT_THAT (text, Not (HasSubstr ("gtest")));
+}
+
+TEST (SourceAnnotation, LinesFarFromCostsAreLeftOut)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read (CacheProfile));
+
+    std::string const text (Text (annotation, MockSources));
+
+    /* Line 12 is more than six lines from line 2 */
+    EXPECT_THAT (text, HasSubstr ("      5\n...\n"));
+    EXPECT_THAT (text, Not (HasSubstr ("      8")));
+}
+
+TEST (SourceAnnotation, CostsAreShownWithoutTheSource)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read (CacheProfile));
+
+    std::string const text (Text (annotation, yoan::Sources ()));
+
+    EXPECT_THAT (text, HasSubstr ("could not be read"));
+    EXPECT_THAT (text, HasSubstr ("*      2\n"));
+    EXPECT_THAT (text, Not (HasSubstr ("      3\n")));
+}
+
+TEST (SourceAnnotation, OnlyIrWithoutCacheSimulation)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read ("events: Ir\n"
+                                        "fl=mock.cpp\nfn=mock\n1 10\n"));
+
+    std::string const text (Text (annotation, yoan::Sources ()));
+
+    EXPECT_THAT (text, HasSubstr ("Client code, Ir: 10\n"));
+    EXPECT_THAT (text, Not (HasSubstr ("misses")));
+}
+
+TEST (SourceAnnotation, HTMLHighlightsHotLinesAndEscapesSource)
+{
+    yoan::Annotation annotation;
+    yoan::AddProfile (annotation, Read ("events: Ir\n"
+                                        "fl=mock.cpp\nfn=mock\n"
+                                        "1 1000\n2 1\n"));
+
+    yoan::Sources const sources =
+    {
+        { "mock.cpp", { "a < b && c", "cold ();" } }
+    };
+
+    std::stringstream ss;
+    yoan::WriteHTML (ss, annotation, sources, "Mock");
+
+    EXPECT_THAT (ss.str (), HasSubstr ("<title>Mock</title>"));
+    EXPECT_THAT (ss.str (),
+                 HasSubstr ("<tr class=\"hot\"><td class=\"cost\">1000</td>"
+                            "<td class=\"line\">1</td>"
+                            "<td>a &lt; b &amp;&amp; c</td></tr>"));
+    EXPECT_THAT (ss.str (), HasSubstr ("<tr class=\"costly\">"));
+}
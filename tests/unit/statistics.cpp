@@ -0,0 +1,80 @@
+/*
+ * statistics.cpp:
+ * Tests for summarising repeated measurements
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <stdexcept>
+
+#include <gmock/gmock.h>
+
+#include "statistics.h"
+
+namespace ystat = yiqi::statistics;
+
+TEST (Statistics, MedianOfNoSamplesThrows)
+{
+    EXPECT_THROW ({
+        ystat::Median (ystat::Samples ());
+    }, std::logic_error);
+}
+
+TEST (Statistics, MedianOfOddNumberIsMiddleValue)
+{
+    EXPECT_EQ (2, ystat::Median ({ 3, 1, 2 }));
+}
+
+TEST (Statistics, MedianOfEvenNumberIsMeanOfMiddleValues)
+{
+    EXPECT_EQ (2.5, ystat::Median ({ 4, 1, 3, 2 }));
+}
+
+TEST (Statistics, SummariseNoSamplesThrows)
+{
+    EXPECT_THROW ({
+        ystat::Summarise (ystat::Samples ());
+    }, std::logic_error);
+}
+
+TEST (Statistics, SingleSampleHasNoSpread)
+{
+    ystat::Summary const summary (ystat::Summarise ({ 5 }));
+
+    EXPECT_EQ (5, summary.min);
+    EXPECT_EQ (5, summary.median);
+    EXPECT_EQ (5, summary.mean);
+    EXPECT_EQ (0, summary.stddev);
+    EXPECT_EQ (0, summary.mad);
+    EXPECT_EQ (5, summary.ciLow);
+    EXPECT_EQ (5, summary.ciHigh);
+}
+
+TEST (Statistics, SummariseSamples)
+{
+    ystat::Summary const summary (ystat::Summarise ({ 2, 4, 4, 4, 5,
+                                                      5, 7, 9 }));
+
+    EXPECT_EQ (2, summary.min);
+    EXPECT_EQ (4.5, summary.median);
+    EXPECT_EQ (5, summary.mean);
+    EXPECT_NEAR (2.138, summary.stddev, 0.001);
+    EXPECT_EQ (0.5, summary.mad);
+}
+
+TEST (Statistics, ConfidenceIntervalUsesStudentT)
+{
+    ystat::Summary const summary (ystat::Summarise ({ 1, 3 }));
+
+    /* stddev is sqrt (2), so the half width is t(1) * sqrt (2) / sqrt (2) */
+    EXPECT_NEAR (2 - 12.706, summary.ciLow, 0.001);
+    EXPECT_NEAR (2 + 12.706, summary.ciHigh, 0.001);
+}
+
+TEST (Statistics, MADIgnoresOutliers)
+{
+    ystat::Summary const summary (ystat::Summarise ({ 10, 10, 11, 10,
+                                                      1000 }));
+
+    EXPECT_EQ (0, summary.mad);
+}
@@ -0,0 +1,60 @@
+/*
+ * testfilter.cpp:
+ * Tests for matching test names against Google Test filters
+ *
+ * See LICENCE.md for Copyright information
+ */
+
+#include <gmock/gmock.h>
+
+#include "testfilter.h"
+
+namespace ytf = yiqi::testfilter;
+
+namespace
+{
+    std::string const MockTestName ("MockCase.MockTest");
+}
+
+TEST (TestFilter, EmptyFilterMatchesEverything)
+{
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, ""));
+}
+
+TEST (TestFilter, ExactNameMatches)
+{
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, MockTestName));
+}
+
+TEST (TestFilter, OtherNameDoesNotMatch)
+{
+    EXPECT_FALSE (ytf::MatchesFilter (MockTestName, "MockCase.OtherTest"));
+}
+
+TEST (TestFilter, StarMatchesAnyCharacters)
+{
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, "MockCase.*"));
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, "*.Mock*"));
+}
+
+TEST (TestFilter, QuestionMarkMatchesSingleCharacter)
+{
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, "MockCase.MockTes?"));
+    EXPECT_FALSE (ytf::MatchesFilter (MockTestName, "MockCase.MockTest?"));
+}
+
+TEST (TestFilter, AnyOfColonSeparatedPatternsMatches)
+{
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, "Other.*:MockCase.*"));
+}
+
+TEST (TestFilter, NegativePatternExcludes)
+{
+    EXPECT_FALSE (ytf::MatchesFilter (MockTestName, "*-MockCase.*"));
+}
+
+TEST (TestFilter, OnlyNegativePatternsIncludesEverythingElse)
+{
+    EXPECT_TRUE (ytf::MatchesFilter (MockTestName, "-Other.*"));
+    EXPECT_FALSE (ytf::MatchesFilter (MockTestName, "-Other.*:MockCase.*"));
+}